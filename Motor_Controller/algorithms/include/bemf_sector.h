@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "bemf.h"
+#include "timer.h"   // TimeNs_t
 
 // Direction of rotation for BEMF sector tracking
 typedef enum {
@@ -10,11 +11,16 @@ typedef enum {
     BEMF_DIR_REV = 1
 } BemfDir_t;
 
+// Floating-phase voltage region used for zero-cross detection
+#define BEMF_ZC_REGION_NEG   (-1)
+#define BEMF_ZC_REGION_ZERO    0
+#define BEMF_ZC_REGION_POS   (+1)
+
 // State of the BEMF-based sector/speed estimator
 typedef struct
 {
-    float    last_zero_ts;    // last zero-crossing time [s]
-    float    last_period_s;   // last sector period [s] (60 el. deg segment)
+    TimeNs_t last_zero_ns;    // last zero-crossing time [ns, monotonic]
+    TimeNs_t last_period_ns;  // last sector period [ns] (60 el. deg segment)
 
     float    rpm_elec;        // estimated electrical speed [rpm]
     float    rpm_mech;        // estimated mechanical speed [rpm]
@@ -24,6 +30,8 @@ typedef struct
     bool     valid;           // overall validity flag
 
     BemfDir_t dir;            // assumed direction of rotation
+
+    int8_t   zc_prev_region;  // floating-phase region at the last update
 } BemfSectorState_t;
 
 /**
@@ -45,11 +53,11 @@ void BemfSector_init(BemfSectorState_t *s,
  *
  * @param s     state
  * @param bemf  pointer to BemfHandle_t (for voltages)
- * @param now_s current time [s] (monotonic)
+ * @param now_ns current time [ns] (monotonic)
  */
 void BemfSector_update(BemfSectorState_t *s,
                        const BemfHandle_t *bemf,
-                       float now_s);
+                       TimeNs_t now_ns);
 
 /**
  * @brief Get a copy of the current sector state.
@@ -0,0 +1,89 @@
+// foc.h
+#pragma once
+
+#include <stdbool.h>
+
+#include "pi_controller.h"
+#include "elec_angle.h"
+
+// Field-oriented current control: Clarke / Park transforms, d/q current
+// PIs and space-vector modulation. No I/O: phase currents and the rotor
+// angle come in, three phase duties go out.
+//
+// Conventions:
+//   - amplitude-invariant Clarke (a balanced set of phase peak I gives a
+//     vector of length I), alpha along phase U
+//   - theta is the electrical angle of the d axis (rotor flux) in the
+//     same frame; q leads d by 90 deg, positive iq = positive torque
+//   - voltages in volts; SVPWM turns them into duties for Vbus and can
+//     reach a vector of Vbus / sqrt(3) (the inscribed circle of the hexagon)
+
+typedef struct {
+    float alpha;
+    float beta;
+} FocAlphaBeta_t;
+
+typedef struct {
+    float d;
+    float q;
+} FocDq_t;
+
+typedef struct {
+    PI_Controller_t pi_d;     // d current -> d voltage
+    PI_Controller_t pi_q;     // q current -> q voltage
+
+    FocDq_t i;                // currents measured in the last step (A)
+    FocDq_t v;                // voltages applied in the last step (V)
+    bool    sat;              // voltage vector at the SVPWM limit
+} Foc_t;
+
+/**
+ * @brief Clarke transform of two measured phases (i_w = -(i_u + i_v)).
+ */
+void Foc_clarke(float i_u, float i_v, FocAlphaBeta_t *out);
+
+/**
+ * @brief Park transform (stationary -> rotor frame), sin/cos of theta.
+ */
+void Foc_park(const FocAlphaBeta_t *ab, float sin_t, float cos_t, FocDq_t *out);
+
+/**
+ * @brief Inverse Park transform (rotor -> stationary frame).
+ */
+void Foc_invPark(const FocDq_t *dq, float sin_t, float cos_t, FocAlphaBeta_t *out);
+
+/**
+ * @brief Space-vector modulation of a stationary voltage vector.
+ *
+ * Phase voltages from the inverse Clarke transform, the midpoint of the
+ * largest and smallest subtracted (min-max injection, same switching
+ * times as the classic sector-based SVPWM), centred on half the bus.
+ * Duties are clamped to [0, 1] past the linear range.
+ */
+void Foc_svpwm(const FocAlphaBeta_t *v, float vbus, float duty[3]);
+
+/**
+ * @brief Set up both current PIs with the same gains.
+ *
+ * For a per-phase R / L and bandwidth wc: kp = wc * L, ki = wc * R.
+ * Ts = fast-loop period.
+ */
+void Foc_init(Foc_t *f, float kp, float ki, float Ts);
+
+/**
+ * @brief Preload the PI integrators (bumpless start from a known voltage).
+ */
+void Foc_reset(Foc_t *f, float vd, float vq);
+
+/**
+ * @brief One current-control step.
+ *
+ * Measures i_d / i_q at theta, runs both PIs and modulates the
+ * result. The voltage vector is limited to Vbus / sqrt(3), d first (it
+ * holds the field), q gets what is left.
+ *
+ * @param id_ref, iq_ref  current references (A)
+ * @param duty            phase U/V/W duties out
+ */
+void Foc_step(Foc_t *f, float i_u, float i_v, ElecAngle_t theta,
+              float id_ref, float iq_ref, float vbus, float duty[3]);
@@ -0,0 +1,181 @@
+// freq_resp.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Frequency-response analyzer for a sampled loop. No I/O: the caller
+// adds the excitation somewhere in its loop, then hands back the signal
+// at the injection point (u) and the response (y) once per sample:
+//
+//     H(f) = Y(f) / U(f)
+//
+// Excitation inside a closed loop: u is the plant input after the
+// injection (excitation + controller output), so H is the plant; with u
+// the (excited) reference, H is the closed loop.
+//
+// The excitation repeats every N samples (power of two) and every
+// analysis frequency sits on a DFT bin k (k cycles per period), so the
+// excitation is exactly periodic in the record and needs no window. The
+// record is `periods` periods; U and Y are correlated against each bin
+// sample by sample (phase accumulator + table sine) over all of them,
+// which averages out noise that is not correlated with the excitation,
+// and leaves nothing to compute at the end but one complex ratio per bin.
+// Each period's U and Y are also kept apart for a coherence estimate per
+// bin: how consistently Y follows U from period to period (1 = no noise
+// or drift). A bin below the configured minimum is flagged, not dropped.
+// `settle` samples of excitation run first, to let the loop's transient
+// die out.
+//
+// Excitations:
+//   - multisine: one tone per bin, Schroeder phases (low crest factor),
+//     each amplitude / sqrt(bins)
+//   - chirp: a log sweep f_min -> f_max per period at full amplitude
+//
+// Raw u / y of the last period are kept in the preallocated log. Results
+// and log are handed to reader threads through `seq` (odd while a run
+// owns them), see FreqResp_readResult() / FreqResp_readLog().
+
+#define FRA_MAX_SAMPLES   4096      // record length limit (power of two)
+#define FRA_MAX_BINS      32
+
+typedef enum {
+    FRA_EXC_MULTISINE = 0,
+    FRA_EXC_CHIRP,
+    FRA_EXC_COUNT
+} FraExcitation_t;
+
+typedef enum {
+    FRA_IDLE = 0,
+    FRA_SETTLING,             // excitation on, not recording yet
+    FRA_RECORDING,
+    FRA_DONE,                 // results valid
+    FRA_ABORTED               // FreqResp_abort() or refused start
+} FraState_t;
+
+typedef struct {
+    FraExcitation_t exc;
+    float           amplitude;    // excitation peak (units of u)
+    float           f_min_hz;     // analysis range, bins log spaced
+    float           f_max_hz;     //   (< fs / 2)
+    int             bins;         // requested; fewer if two round to one DFT bin
+    int             samples;      // period N, power of two <= FRA_MAX_SAMPLES
+    int             periods;      // recorded (>= 1)
+    int             settle;       // samples before recording
+    float           fs_hz;        // sample rate of the caller's loop
+    float           coherence_min; // bins below are flagged (0..1; needs periods >= 2)
+} FraConfig_t;
+
+typedef struct {
+    float f_hz;
+    float gain;               // |Y / U| (units of y per unit of u)
+    float phase_deg;          // arg(Y / U), -180..180
+    float u_amp;              // excitation amplitude seen in u at this bin;
+                              // small = little energy there, gain unreliable
+    float coherence;          // period-to-period, 0..1 (1 with a single period)
+    bool  ok;                 // coherence >= cfg.coherence_min
+} FraBin_t;
+
+typedef struct {
+    FraConfig_t cfg;
+    FraState_t  state;
+    int         n;                      // samples into the current state
+    float       u0, y0;                 // first recorded sample (offset taken off)
+    int         nbins;
+
+    // Tones / DFT kernels: phase as a fraction of a turn (Q32)
+    uint32_t    ph[FRA_MAX_BINS];       // k * n / N
+    uint32_t    inc[FRA_MAX_BINS];      // k / N
+    uint32_t    ph_tone[FRA_MAX_BINS];  // Schroeder phase offset
+    float       tone_amp;
+
+    // Chirp
+    int         chirp_n;                // samples into the sweep
+    uint32_t    chirp_ph;
+    float       chirp_inc;              // phase step (turns), grows by chirp_mul
+    float       chirp_mul;
+
+    float       exc;                    // excitation of the current sample
+
+    // Current period's U and Y; folded into the sums below at its end
+    double      u_re[FRA_MAX_BINS], u_im[FRA_MAX_BINS];
+    double      y_re[FRA_MAX_BINS], y_im[FRA_MAX_BINS];
+
+    // Over the periods so far: sum U, sum Y, sum Y conj(U), sum |U|^2, sum |Y|^2
+    double      su_re[FRA_MAX_BINS], su_im[FRA_MAX_BINS];
+    double      sy_re[FRA_MAX_BINS], sy_im[FRA_MAX_BINS];
+    double      syu_re[FRA_MAX_BINS], syu_im[FRA_MAX_BINS];
+    double      suu[FRA_MAX_BINS], syy[FRA_MAX_BINS];
+
+    // ---- Handed to readers under seq ----
+    atomic_uint seq;                    // odd while a run writes below
+    int         nresult;                // bins in result (0 = none)
+    int         nlog;                   // samples in the log (the last period)
+    FraBin_t    result[FRA_MAX_BINS];
+    float       log_u[FRA_MAX_SAMPLES];
+    float       log_y[FRA_MAX_SAMPLES];
+} FreqResp_t;
+
+/**
+ * @brief Clear to IDLE (no results).
+ */
+void FreqResp_init(FreqResp_t *fr);
+
+/**
+ * @brief Check a configuration (rate, range, lengths). The message
+ *        names the first problem, for the caller's log.
+ */
+bool FreqResp_configValid(const FraConfig_t *cfg, const char **why);
+
+/**
+ * @brief Start a run (previous results dropped). False, and nothing
+ *        changed, for an invalid configuration.
+ */
+bool FreqResp_start(FreqResp_t *fr, const FraConfig_t *cfg);
+
+/**
+ * @brief Excitation to add in the current sample (0 when not running).
+ */
+static inline float FreqResp_excitation(const FreqResp_t *fr)
+{
+    return fr->exc;
+}
+
+static inline bool FreqResp_running(const FreqResp_t *fr)
+{
+    return fr->state == FRA_SETTLING || fr->state == FRA_RECORDING;
+}
+
+/**
+ * @brief End the current sample: u at the injection point, y the
+ *        response. Moves to the next excitation value; the sample that
+ *        completes the record computes the results (state DONE).
+ */
+void FreqResp_step(FreqResp_t *fr, float u, float y);
+
+/**
+ * @brief Stop a running analysis, or mark a refused start: state
+ *        ABORTED, results dropped (a partial record stays in the log).
+ */
+void FreqResp_abort(FreqResp_t *fr);
+
+/**
+ * @brief Reader side (any thread): copy up to max result bins.
+ * @return bins copied (0 = no results), -1 while a run is in progress
+ *         or one started during the copy
+ */
+int FreqResp_readResult(const FreqResp_t *fr, FraBin_t *out, int max);
+
+/**
+ * @brief Reader side (any thread): copy log samples [from, from + count)
+ *        (clipped to the record).
+ * @return samples copied, -1 as for FreqResp_readResult()
+ */
+int FreqResp_readLog(const FreqResp_t *fr, int from, int count, float *u, float *y);
+
+/**
+ * @brief Short names for status output.
+ */
+const char *FreqResp_excName(FraExcitation_t exc);
+const char *FreqResp_stateName(FraState_t state);
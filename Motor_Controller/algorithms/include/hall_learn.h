@@ -0,0 +1,100 @@
+// hall_learn.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Hall sensor commissioning. No I/O: the caller drives a voltage vector
+// at the angle this asks for (low amplitude, the rotor follows it like a
+// stepper) and hands back the raw Hall bits once per step.
+//
+// Angles are electrical degrees in the Hall frame: sector s spans
+// [60 s, 60 s + 60), so the edge entering s going forward sits at 60 s
+// (hall_interp.h). The caller maps that to its voltage vector angle.
+//
+// Mapping: the vector is stepped to the six sector centres, 30 + 60 s,
+// and held; the code read there is sector s's. The six-step vectors
+// themselves would park the rotor right on an edge. All six codes must
+// be valid and distinct.
+//
+// Edge offsets: the vector is then swept forward over `revs` electrical
+// revolutions (one mechanical revolution with revs = pole pairs) and
+// back. At each code change the vector angle is recorded against the
+// edge's nominal 60 s. The rotor trails the vector by the angle its
+// friction needs, forward and backward alike, and the sensors switch a
+// little late in each direction; the mean of both sweeps takes both out.
+// Per edge the offsets of all pole pairs are averaged.
+
+typedef enum {
+    HALL_LEARN_IDLE = 0,
+    HALL_LEARN_MAP,           // stepping to the sector centres
+    HALL_LEARN_SWEEP_FWD,
+    HALL_LEARN_SWEEP_REV,
+    HALL_LEARN_DONE,          // map / offset_deg valid
+    HALL_LEARN_FAILED         // see fail
+} HallLearnState_t;
+
+typedef enum {
+    HALL_LEARN_FAIL_NONE = 0,
+    HALL_LEARN_FAIL_CODE,         // 000 / 111 read at a sector centre
+    HALL_LEARN_FAIL_DUPLICATE,    // one code at two centres
+    HALL_LEARN_FAIL_EDGES,        // an edge missed, or out of +-30 deg
+    HALL_LEARN_FAIL_STOPPED       // aborted by the caller
+} HallLearnFail_t;
+
+typedef struct {
+    float settle_s;           // hold at each sector centre
+    float sweep_deg_s;        // vector speed (electrical)
+    int   revs;               // electrical revolutions per sweep (>= 1)
+    float Ts;                 // step period
+} HallLearnConfig_t;
+
+typedef struct {
+    HallLearnConfig_t cfg;
+    HallLearnState_t  state;
+    HallLearnFail_t   fail;
+
+    float    angle_deg;       // vector to drive, Hall frame (unwrapped)
+    float    target_deg;      // MAP: sector centre being approached
+    float    end_deg;         // SWEEP: where it stops
+    int      k;               // MAP: sector centre index
+    int      n;               // steps held at the centre
+    uint8_t  last_sector;     // decoded with the learned codes
+
+    uint8_t  code[6];         // Hall bits seen in each sector
+    double   sum_fwd[6], sum_rev[6];   // edge angle - nominal, per edge
+    int      n_fwd[6], n_rev[6];
+
+    // Results
+    uint8_t  map[8];          // Hall bits -> sector, 0xFF = invalid
+    float    offset_deg[6];   // edge entering sector s: 60 s + offset
+} HallLearn_t;
+
+/**
+ * @brief Start at the first sector centre; the first steps drive there.
+ */
+void HallLearn_start(HallLearn_t *hl, const HallLearnConfig_t *cfg);
+
+/**
+ * @brief One step with the Hall bits read this step.
+ * @return true: drive the vector at hl->angle_deg; false: outputs off
+ *         (finished: state DONE / FAILED)
+ */
+bool HallLearn_step(HallLearn_t *hl, uint8_t hall_bits);
+
+/**
+ * @brief Stop a running sequence: FAILED / STOPPED.
+ */
+void HallLearn_abort(HallLearn_t *hl);
+
+static inline bool HallLearn_running(const HallLearn_t *hl)
+{
+    return hl->state == HALL_LEARN_MAP || hl->state == HALL_LEARN_SWEEP_FWD ||
+           hl->state == HALL_LEARN_SWEEP_REV;
+}
+
+/**
+ * @brief Short names for status output.
+ */
+const char *HallLearn_stateName(HallLearnState_t state);
+const char *HallLearn_failName(HallLearnFail_t fail);
@@ -0,0 +1,80 @@
+// hall_timing.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Per-edge Hall timing compensation. No I/O: the caller reports every
+// sector change with the interval it ended.
+//
+// Hall edges are not exactly 60 electrical degrees apart (sensor
+// placement, magnet spread), so at a constant speed the sector intervals
+// alternate long and short. Around a mechanical revolution there are
+// 6 * pole_pairs sectors ("regions"); the region the rotor is in is
+// counted from the sector changes (region = 6 * pole pair + sector, the
+// pole pair numbered from wherever the count started).
+//
+// Each interval is compared with the revolution average, n * dt / sum of
+// the last n intervals, which at a constant speed is the region's width
+// relative to 60 degrees. Learned with an IIR per region, only while the
+// revolution period holds within steady_tol from one revolution to the
+// next. A skipped sector keeps the count (direction is still clear); an
+// ambiguous one (three sectors) loses it and the table starts over.
+
+#define HALL_TIMING_MAX_POLE_PAIRS  16
+#define HALL_TIMING_MAX_REGIONS     (6 * HALL_TIMING_MAX_POLE_PAIRS)
+
+typedef struct {
+    int   pole_pairs;         // 1..HALL_TIMING_MAX_POLE_PAIRS
+    float gain;               // IIR gain per learned interval (0..1)
+    float steady_tol;         // revolution period change allowed (fraction)
+} HallTimingConfig_t;
+
+typedef struct {
+    HallTimingConfig_t cfg;
+    int      n;               // regions per mechanical revolution
+    int      region;          // present region, -1 = not counted yet
+    int8_t   dir;             // +1 / -1: direction of the last edge, 0 = none
+    int      run;             // single-sector steps in a row in that direction
+    int      k;               // steps since the last steady check
+    bool     steady;          // last revolution held within steady_tol
+    float    rev_ref;         // revolution period at the last check (s)
+    uint32_t learned;         // intervals learned since the last restart
+
+    float    dt[HALL_TIMING_MAX_REGIONS];      // last interval per region (s)
+    float    width[HALL_TIMING_MAX_REGIONS];   // relative to 60 deg, mean 1
+} HallTiming_t;
+
+/**
+ * @brief Reset; all widths 1 (no correction).
+ */
+void HallTiming_init(HallTiming_t *ht, const HallTimingConfig_t *cfg);
+
+/**
+ * @brief Start a new count from the next sector (mode change, lost
+ *        track); the table starts over.
+ */
+void HallTiming_forget(HallTiming_t *ht);
+
+/**
+ * @brief One sector change.
+ * @param sector  sector entered (0..5)
+ * @param dt_s    time since the previous change (0: first sector seen)
+ * @return width of the region dt_s covered, relative to 60 deg (1 when
+ *         not known, or the interval spanned two sectors)
+ */
+float HallTiming_edge(HallTiming_t *ht, uint8_t sector, float dt_s);
+
+/**
+ * @brief No edges for a long time (standstill): the running revolution
+ *        is not learned from; the count and table stay.
+ */
+void HallTiming_stop(HallTiming_t *ht);
+
+/**
+ * @brief Widths of the regions around the present one, by sector: the
+ *        one just left, the present one and the next four in the
+ *        direction of travel. For an edge tracker running ahead of the
+ *        caller by up to four sectors.
+ */
+void HallTiming_sectorScale(const HallTiming_t *ht, float scale[6]);
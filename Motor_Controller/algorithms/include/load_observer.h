@@ -0,0 +1,59 @@
+// load_observer.h
+#pragma once
+
+#include <stdbool.h>
+
+// Load-torque disturbance observer. No I/O: speed and motor current come
+// in once per step, the load torque estimate goes out.
+//
+// From the mechanical model J dw/dt = Kt i - T_fric - T_load, the torque
+// the current makes minus friction and the torque that went into
+// accelerating the rotor is the load; the observer low-passes that at
+// bw_hz:
+//
+//     T^ = LPF(Kt i - T_fric - J dw/dt)
+//
+// without differentiating w: T^ = z - L J w, dz/dt = L (Kt i - T_fric - T^),
+// L = 2 pi bw. bw_hz <= 0 leaves the estimate at 0. T_fric is a constant
+// torque against the direction of rotation; what the model misses of it
+// shows up in the estimate.
+//
+// A speed that comes through a filter lags the current; fed back, the
+// estimate would then chase its own feedforward. lag_s puts the same
+// first-order lag on the current, so both sides of the balance line up
+// (the estimate then trails the load by lag_s on top of 1 / L). Kt (Nm/A)
+// and J (kg m^2) are the caller's model; an error in J shows up as a
+// transient on the estimate while the speed changes, an error in Kt as a
+// scale error on the current.
+
+typedef struct {
+    float j;          // inertia (kg m^2)
+    float kt;         // torque constant (Nm/A)
+    float friction;   // friction torque while turning (Nm)
+    float l;          // observer gain, alpha / Ts (~2 pi bw) (1/s)
+    float alpha;      // 1 - exp(-2 pi bw Ts): per-step filter gain
+    float beta;       // 1 - exp(-Ts / lag_s): current lag, 1 = none
+    float i_f;        // lagged current (A)
+    float z;          // integrator state (Nm)
+    float t_load;     // estimate (Nm)
+    bool  primed;     // z set from the first sample
+} LoadObserver_t;
+
+/**
+ * @brief Set the model, the bandwidth and the lag of the speed input
+ *        (0 = none) for a step of Ts; estimate 0.
+ */
+void LoadObserver_init(LoadObserver_t *o, float j, float kt, float friction_nm,
+                       float bw_hz, float lag_s, float Ts);
+
+/**
+ * @brief Restart: the next step takes its speed and current as the
+ *        starting point, with the given load estimate.
+ */
+void LoadObserver_reset(LoadObserver_t *o, float t_load);
+
+/**
+ * @brief One step: mechanical speed (rad/s) and torque-producing current
+ *        (A) of this step; returns the load torque estimate (Nm).
+ */
+float LoadObserver_step(LoadObserver_t *o, float omega_rad_s, float i_a);
@@ -0,0 +1,162 @@
+// param_ident.h
+#pragma once
+
+#include <stdbool.h>
+
+// Motor parameter identification. No I/O: the caller drives the phases
+// and hands the measurements in. Two pieces, one per loop rate:
+//
+// Standstill R / L (fast loop), one phase pair driven with a line-line
+// voltage v:
+//   - DC at two current levels (voltage ramped up until each is reached,
+//     then held, the second half averaged). The voltage the pair really
+//     sees differs from the command by the dead time and switch drops;
+//     the two-level difference takes that out:
+//
+//         R_ll = (V_hi - V_lo) / (I_hi - I_lo)
+//
+//   - outputs off until the current has decayed, then the I_hi voltage as
+//     a step. That voltage is R_ll * I_hi across the winding, so the rise
+//     L_ll di/dt = R_ll (I_hi - i) gives, up to where the current reaches
+//     step_frac of I_hi:
+//
+//         L_ll = R_ll * integral(I_hi - i) dt / (i_end - i_start)
+//
+// Kv (slow loop), from a constant-speed hold: the driven pair's
+// line-line voltage (commanded, averaged), less the standstill offset and
+// the resistive drop, is the BEMF. The offset (dead time, switch drops)
+// is what the two-level fit above leaves at zero current,
+// V_0 = V_lo - R_ll * I_lo, so the BEMF goes through the same path:
+//
+//         E_ll = V - V_0 - R_ll * I,    Kv = rpm / E_ll
+//
+// (The BEMF is not read at the terminals: the sense ADC is unipolar and
+// the outputs-off terminals swing below ground.)
+//
+// Coast (slow loop): with the outputs off the motor slows on its losses
+// alone, the ones the hold current carried. The Hall speed is quantized
+// to the sampling, so it is fitted as a period (1 / rpm), whose average
+// is unbiased; the fit gives the speed and deceleration at the middle of
+// the window.
+//
+// Line-line values throughout (six-step drives two phases in series); the
+// per-phase R / L are half.
+
+// The whole sequence as a controller runs it: standstill R / L, spin up
+// to a test speed and hold (Kv from the BEMF there; the current carries
+// the losses), coast (inertia from the deceleration under those losses)
+typedef enum {
+    PARAM_IDENT_IDLE = 0,
+    PARAM_IDENT_RL,
+    PARAM_IDENT_SPIN,
+    PARAM_IDENT_COAST,
+    PARAM_IDENT_DONE,         // results written to the runtime config
+    PARAM_IDENT_ABORTED       // see abort; nothing written
+} ParamIdentPhase_t;
+
+typedef enum {
+    PARAM_IDENT_ABORT_NONE = 0,
+    PARAM_IDENT_ABORT_STOPPED,    // disable / speed command / abort
+    PARAM_IDENT_ABORT_NOT_READY,  // not idle and stopped, or no current loop
+    PARAM_IDENT_ABORT_RL,         // standstill measurement failed
+    PARAM_IDENT_ABORT_SPIN,       // test speed not held in time, or a fault
+    PARAM_IDENT_ABORT_COAST       // no usable deceleration / BEMF (Kv)
+} ParamIdentAbort_t;
+
+typedef enum {
+    IDENT_RL_IDLE = 0,
+    IDENT_RL_RAMP_LO,         // voltage ramp up to i_lo
+    IDENT_RL_HOLD_LO,
+    IDENT_RL_RAMP_HI,         // ... on to i_hi
+    IDENT_RL_HOLD_HI,
+    IDENT_RL_DECAY,           // outputs off
+    IDENT_RL_STEP,            // V_hi step, current rise recorded
+    IDENT_RL_DONE,            // r_ll / l_ll valid
+    IDENT_RL_FAILED           // level not reached, or no usable result
+} IdentRLState_t;
+
+typedef struct {
+    float i_lo, i_hi;         // DC levels (A), 0 < i_lo < i_hi
+    float v_max;              // give up if a level needs more (V line-line)
+    float v_ramp_v_s;         // voltage ramp toward each level
+    float hold_s;             // per level
+    float decay_s;            // outputs off before the step
+    float step_frac;          // step recorded up to this fraction of I_hi
+    float step_max_s;         // ... or fails after this long
+    float Ts;                 // step period (fast loop)
+} IdentRLConfig_t;
+
+typedef struct {
+    IdentRLConfig_t cfg;
+    IdentRLState_t  state;
+
+    int    n;                 // steps into the present state
+    float  v;                 // line-line voltage to apply
+    double v_sum, i_sum;      // hold averages
+    int    m;
+    float  v_lo, i_lo;        // measured levels
+    float  v_hi, i_hi;
+    float  i_start, i_prev;   // step: first and last current
+    double area;              // step: integral (I_hi - i) dt
+
+    float  r_ll;              // results, line-line (ohm, H)
+    float  l_ll;
+} IdentRL_t;
+
+typedef struct {
+    int    n;
+    double st, stt;           // time sums
+    double sp, stp;           // period (1 / rpm) sums
+    float  t0;                // first sample's time (sums are relative)
+} IdentCoast_t;
+
+/**
+ * @brief Start the standstill sequence; the first step drives 0 V.
+ */
+void ParamIdent_rlStart(IdentRL_t *rl, const IdentRLConfig_t *cfg);
+
+/**
+ * @brief One fast-loop step with the pair current measured this tick
+ *        (positive into the driven pair).
+ * @return true: apply rl->v across the pair this tick; false: outputs
+ *         off (decay, or finished: state DONE / FAILED)
+ */
+bool ParamIdent_rlStep(IdentRL_t *rl, float i_a);
+
+static inline bool ParamIdent_rlRunning(const IdentRL_t *rl)
+{
+    return rl->state != IDENT_RL_IDLE && rl->state != IDENT_RL_DONE &&
+           rl->state != IDENT_RL_FAILED;
+}
+
+/**
+ * @brief Kv (rpm/V line-line) from a hold at rpm: line-line voltage
+ *        v_ll applied, pair current i_a. Uses the standstill results of
+ *        rl (state DONE).
+ * @return 0 when there is no usable BEMF
+ */
+float ParamIdent_kvFromHold(const IdentRL_t *rl, float v_ll, float i_a, float rpm);
+
+/**
+ * @brief Empty the coast accumulators.
+ */
+void ParamIdent_coastReset(IdentCoast_t *c);
+
+/**
+ * @brief One coast sample: time, speed (rpm > 0).
+ */
+void ParamIdent_coastAdd(IdentCoast_t *c, float t_s, float rpm);
+
+/**
+ * @brief Fit the samples so far.
+ * @param rpm       speed at the middle of the window
+ * @param decel     deceleration there (rpm/s, > 0 slowing down)
+ * @return false with too few samples or no deceleration
+ */
+bool ParamIdent_coastFit(const IdentCoast_t *c, float *rpm, float *decel);
+
+/**
+ * @brief Short names for status output.
+ */
+const char *ParamIdent_phaseName(ParamIdentPhase_t phase);
+const char *ParamIdent_abortName(ParamIdentAbort_t why);
@@ -4,6 +4,35 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#ifndef PI_SCHED_MAX_POINTS
+#define PI_SCHED_MAX_POINTS 8
+#endif
+
+/**
+ * @brief One breakpoint of a gain schedule
+ */
+typedef struct
+{
+    float x;           // Scheduling variable (e.g. speed in rpm)
+    float kp;
+    float ki;
+} PI_GainPoint_t;
+
+/**
+ * @brief Gains as a function of an operating point
+ *
+ * Linear interpolation between breakpoints (x ascending), held constant
+ * beyond the first and last. With vbus_ref > 0 the gains are also scaled
+ * by vbus_ref / vbus, for a loop whose output is a duty: the plant gain
+ * grows with the bus voltage.
+ */
+typedef struct
+{
+    int            n;                         // Breakpoints in use (0 = fixed gains)
+    PI_GainPoint_t pt[PI_SCHED_MAX_POINTS];
+    float          vbus_ref;                  // 0 = no Vbus scaling
+} PI_Schedule_t;
+
 /**
  * @brief Discrete PI controller instance
  *
@@ -21,6 +50,8 @@ typedef struct
     float out_max;     // Maximum output (saturation)
 
     float last_output; // Last computed output (for info/debug)
+
+    const PI_Schedule_t *sched;  // Gain schedule (NULL = fixed gains)
 } PI_Controller_t;
 
 /**
@@ -62,6 +93,50 @@ void PI_setGains(PI_Controller_t *pi,
                  float kp,
                  float ki);
 
+/**
+ * @brief Set output limits (keeps integrator & gains as-is)
+ *
+ * May be called between steps, e.g. to follow a limit that moves at run
+ * time (bus voltage, an inner loop that saturates).
+ */
+void PI_setLimits(PI_Controller_t *pi,
+                  float out_min,
+                  float out_max);
+
+/**
+ * @brief Set the integral state directly
+ *
+ * For bumpless transfer: preload with the output currently in force so
+ * the first step continues from it.
+ */
+void PI_setIntegrator(PI_Controller_t *pi,
+                      float value);
+
+/**
+ * @brief Attach a gain schedule (NULL = keep the gains fixed)
+ *
+ * The schedule is not copied and must outlive the controller.
+ */
+void PI_setSchedule(PI_Controller_t *pi,
+                    const PI_Schedule_t *sched);
+
+/**
+ * @brief Set kp / ki from the schedule at operating point x and bus
+ *        voltage vbus (no-op without a schedule)
+ *
+ * Call before PI_step. Bumpless: the integrator holds the sum of
+ * Ki*Ts*e already applied, so a new Ki only changes what is added next.
+ */
+void PI_schedule(PI_Controller_t *pi,
+                 float x,
+                 float vbus);
+
+/**
+ * @brief Check a schedule: 1..PI_SCHED_MAX_POINTS breakpoints, x strictly
+ *        ascending, gains >= 0
+ */
+bool PI_scheduleValid(const PI_Schedule_t *sched);
+
 /**
  * @brief Perform one PI step
  *
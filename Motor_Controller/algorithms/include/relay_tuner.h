@@ -0,0 +1,96 @@
+// relay_tuner.h
+#pragma once
+
+#include <stdbool.h>
+
+// Relay-feedback (Astrom-Hagglund) autotuner for a PI loop. No I/O: the
+// measurement comes in, the relay output goes out in place of the PI's.
+//
+// The output switches between bias + d and bias - d on the sign of the
+// error (with hysteresis), which drives the loop into a limit cycle at
+// its ultimate period Pu. From the oscillation half amplitude a:
+//
+//     Ku = 4 d / (pi * sqrt(a^2 - h^2))     (h = hysteresis)
+//
+// and the PI gains follow from the chosen rule. Gains are in the units of
+// PI_Controller_t: ki = kp / Ti (output per error-second).
+
+typedef enum {
+    RELAY_TUNE_ZN = 0,        // Ziegler-Nichols: Kp = 0.45 Ku, Ti = Pu / 1.2
+    RELAY_TUNE_TL,            // Tyreus-Luyben:   Kp = Ku / 3.2, Ti = 2.2 Pu (more damped)
+    RELAY_TUNE_RULE_COUNT
+} RelayTuneRule_t;
+
+typedef enum {
+    RELAY_TUNE_IDLE = 0,
+    RELAY_TUNE_RUNNING,
+    RELAY_TUNE_DONE,          // ku / pu / kp / ki valid
+    RELAY_TUNE_ABORTED        // see abort
+} RelayTuneState_t;
+
+typedef enum {
+    RELAY_ABORT_NONE = 0,
+    RELAY_ABORT_STOPPED,      // RelayTuner_abort() by the caller
+    RELAY_ABORT_BAND,         // measurement left setpoint +/- band
+    RELAY_ABORT_TIMEOUT,      // no result within timeout_s
+    RELAY_ABORT_NO_CYCLE      // oscillation within the hysteresis
+} RelayAbort_t;
+
+typedef struct {
+    float           setpoint;
+    float           bias;         // output around which the relay switches
+    float           amplitude;    // relay half swing d (> 0)
+    float           out_min;      // relay output limits
+    float           out_max;
+    float           hyst;         // error hysteresis h (>= 0)
+    float           band;         // abort if |error| exceeds this, once cycling
+    float           timeout_s;
+    int             skip_cycles;  // cycles to let the oscillation settle
+    int             cycles;       // cycles averaged for the result
+    RelayTuneRule_t rule;
+} RelayTuneConfig_t;
+
+typedef struct {
+    RelayTuneConfig_t cfg;
+
+    RelayTuneState_t  state;
+    RelayAbort_t      abort;
+
+    bool   high;              // relay output high (error positive)
+    int    switches;          // low -> high switches so far (cycle ends)
+    float  t_s;               // time since start
+    float  t_cycle_s;         // time of the last low -> high switch
+    float  e_max, e_min;      // error extremes in this cycle
+    double amp_sum;           // over measured cycles
+    double per_sum;
+    int    measured;
+
+    float  ku, pu_s;          // ultimate gain and period
+    float  kp, ki;            // resulting PI gains
+} RelayTuner_t;
+
+/**
+ * @brief Start a run; the first output is bias + d (measurement assumed
+ *        below the setpoint) until the error says otherwise.
+ */
+void RelayTuner_start(RelayTuner_t *rt, const RelayTuneConfig_t *cfg);
+
+/**
+ * @brief One step at period dt_s: relay output for the measurement.
+ *
+ * Leaves RUNNING for DONE or ABORTED on the step that decides it; the
+ * returned output is still the relay's, the caller takes over from then.
+ */
+float RelayTuner_step(RelayTuner_t *rt, float meas, float dt_s);
+
+/**
+ * @brief Stop a running tune (state ABORTED with the given reason).
+ */
+void RelayTuner_abort(RelayTuner_t *rt, RelayAbort_t why);
+
+/**
+ * @brief Short names for status output.
+ */
+const char *RelayTuner_ruleName(RelayTuneRule_t rule);
+const char *RelayTuner_stateName(RelayTuneState_t state);
+const char *RelayTuner_abortName(RelayAbort_t why);
@@ -0,0 +1,43 @@
+// speed_traj.h
+#pragma once
+
+// Jerk-limited (S-curve) speed trajectory. No I/O: a target comes in,
+// the speed and acceleration references for this step go out.
+//
+// The acceleration moves toward the largest value from which it can
+// still be ramped back to zero at the jerk limit without passing the
+// target,
+//
+//     a* = sign(e) * min(a_max, sqrt(2 j |e|))     (e = target - v)
+//
+// at no more than j_max per second, so every transition starts and ends
+// with an acceleration ramp instead of a torque step, and a long one
+// cruises at a_max. Units are the caller's (rpm, rpm/s, rpm/s^2).
+//
+// j_max <= 0 gives the plain rate limit: v moves at a_max, a is the
+// (stepping) slope.
+
+typedef struct {
+    float a_max;      // acceleration limit (> 0)
+    float j_max;      // jerk limit, <= 0 = none
+    float v;          // speed reference
+    float a;          // acceleration reference
+} SpeedTraj_t;
+
+/**
+ * @brief Set the limits and start at rest at v.
+ */
+void SpeedTraj_init(SpeedTraj_t *t, float a_max, float j_max, float v);
+
+/**
+ * @brief Restart from a given speed and acceleration (e.g. a speed
+ *        the caller forced, at rest).
+ */
+void SpeedTraj_reset(SpeedTraj_t *t, float v, float a);
+
+/**
+ * @brief Advance one step of dt_s toward target; returns the new v.
+ *
+ * Lands on the target exactly (a = 0) once it is within one step.
+ */
+float SpeedTraj_step(SpeedTraj_t *t, float target, float dt_s);
@@ -6,7 +6,7 @@
 // One electrical revolution = 6 commutation sectors
 #define BEMF_SECTORS_PER_ELEC_REV  6.0f
 // Minimum acceptable time between ZCs (guard against dt ~0)
-#define BEMF_MIN_PERIOD_S          1e-5f
+#define BEMF_MIN_PERIOD_NS         (10 * TIME_NS_PER_US)
 // Simple noise threshold for zero-cross detection on floating phase
 #define BEMF_ZERO_THRESH_V         0.05f   // tweak based on real noise
 
@@ -49,17 +49,18 @@ void BemfSector_init(BemfSectorState_t *s,
     memset(s, 0, sizeof(*s));
     s->sector       = (uint8_t)(start_sector % 6U);
     s->dir          = dir;
-    s->last_zero_ts = 0.0f;
-    s->last_period_s= 0.0f;
+    s->last_zero_ns = 0;
+    s->last_period_ns = 0;
     s->rpm_elec     = 0.0f;
     s->rpm_mech     = 0.0f;
     s->zero_valid   = false;
     s->valid        = false;
+    s->zc_prev_region = BEMF_ZC_REGION_ZERO;
 }
 
 void BemfSector_update(BemfSectorState_t *s,
                        const BemfHandle_t *bemf,
-                       float now_s)
+                       TimeNs_t now_ns)
 {
     if (!s || !bemf) return;
 
@@ -69,7 +70,7 @@ void BemfSector_update(BemfSectorState_t *s,
         s->valid      = false;
         s->rpm_elec   = 0.0f;
         s->rpm_mech   = 0.0f;
-        s->last_period_s = 0.0f;
+        s->last_period_ns = 0;
         return;
     }
 
@@ -81,30 +82,21 @@ void BemfSector_update(BemfSectorState_t *s,
 
     // Basic zero‑cross detection with simple hysteresis:
     // We track sign transitions from "negative region" to "positive region"
-    // to mark the sector crossing.
-    typedef enum {
-        ZC_REGION_NEG = -1,
-        ZC_REGION_ZERO = 0,
-        ZC_REGION_POS = +1
-    } ZcRegion_t;
-
-    static float prev_v = 0.0f;
-    static ZcRegion_t prev_region = ZC_REGION_ZERO;
-
-    ZcRegion_t region;
-    if (v_phase_neutral >  BEMF_ZERO_THRESH_V)      region = ZC_REGION_POS;
-    else if (v_phase_neutral < -BEMF_ZERO_THRESH_V) region = ZC_REGION_NEG;
-    else                                            region = ZC_REGION_ZERO;
+    // to mark the sector crossing. The previous region is per-tracker state
+    // (s->zc_prev_region) so several motors can be tracked side by side.
+    int8_t region;
+    if (v_phase_neutral >  BEMF_ZERO_THRESH_V)      region = BEMF_ZC_REGION_POS;
+    else if (v_phase_neutral < -BEMF_ZERO_THRESH_V) region = BEMF_ZC_REGION_NEG;
+    else                                            region = BEMF_ZC_REGION_ZERO;
 
     bool crossed = false;
     // Detect NEG -> POS crossing (optionally allow NEG->ZERO->POS)
-    if ((prev_region == ZC_REGION_NEG && region == ZC_REGION_POS) ||
-        (prev_region == ZC_REGION_NEG && region == ZC_REGION_ZERO)) {
+    if ((s->zc_prev_region == BEMF_ZC_REGION_NEG && region == BEMF_ZC_REGION_POS) ||
+        (s->zc_prev_region == BEMF_ZC_REGION_NEG && region == BEMF_ZC_REGION_ZERO)) {
         crossed = true;
     }
 
-    prev_v      = v_phase_neutral;
-    prev_region = region;
+    s->zc_prev_region = region;
 
     if (!crossed) {
         // No zero-cross this update; nothing else to do.
@@ -112,23 +104,19 @@ void BemfSector_update(BemfSectorState_t *s,
     }
 
     // --- We detected a zero-crossing on the floating phase ---
-    float dt = now_s - s->last_zero_ts;
-    if (dt < BEMF_MIN_PERIOD_S) {
+    // Period math stays in integer ns; only the interval goes to float.
+    TimeNs_t dt_ns = now_ns - s->last_zero_ns;
+    if (s->zero_valid && dt_ns < BEMF_MIN_PERIOD_NS) {
         // Ignore unrealistically small intervals
         return;
     }
 
-    s->last_zero_ts  = now_s;
-    s->last_period_s = dt;
+    if (s->zero_valid) {
+        s->last_period_ns = dt_ns;
 
-    // For a standard 6‑step scheme, we get one zero‑cross per 60 el. degrees.
-    // That means an electrical period T_elec = dt * 6.
-    float T_elec = dt * BEMF_SECTORS_PER_ELEC_REV;
-    if (T_elec < BEMF_MIN_PERIOD_S) {
-        s->valid    = false;
-        s->rpm_elec = 0.0f;
-        s->rpm_mech = 0.0f;
-    } else {
+        // For a standard 6‑step scheme, we get one zero‑cross per 60 el. degrees.
+        // That means an electrical period T_elec = dt * 6.
+        float T_elec   = time_ns_to_s(dt_ns) * BEMF_SECTORS_PER_ELEC_REV;
         float f_elec   = 1.0f / T_elec;        // Hz
         float rpm_elec = f_elec * 60.0f;       // rpm
         s->rpm_elec    = rpm_elec;
@@ -136,7 +124,9 @@ void BemfSector_update(BemfSectorState_t *s,
         s->valid       = true;
     }
 
-    s->zero_valid = true;
+    // First ZC only establishes the reference time
+    s->last_zero_ns = now_ns;
+    s->zero_valid   = true;
 
     // Advance sector according to direction
     s->sector = next_sector(s->sector, s->dir);
@@ -0,0 +1,120 @@
+// foc.c
+#include "foc.h"
+
+#include <math.h>     // sqrtf, fmaxf, fminf
+#include <string.h>   // memset
+
+#define SQRT3_2      0.86602540f   // sqrt(3) / 2
+#define INV_SQRT3    0.57735027f   // 1 / sqrt(3)
+
+// ---------------- Transforms ----------------
+
+void Foc_clarke(float i_u, float i_v, FocAlphaBeta_t *out)
+{
+    if (!out) return;
+
+    // i_beta = (i_v - i_w) / sqrt(3) with i_w = -(i_u + i_v)
+    out->alpha = i_u;
+    out->beta  = (i_u + 2.0f * i_v) * INV_SQRT3;
+}
+
+void Foc_park(const FocAlphaBeta_t *ab, float sin_t, float cos_t, FocDq_t *out)
+{
+    if (!ab || !out) return;
+
+    out->d =  ab->alpha * cos_t + ab->beta * sin_t;
+    out->q = -ab->alpha * sin_t + ab->beta * cos_t;
+}
+
+void Foc_invPark(const FocDq_t *dq, float sin_t, float cos_t, FocAlphaBeta_t *out)
+{
+    if (!dq || !out) return;
+
+    out->alpha = dq->d * cos_t - dq->q * sin_t;
+    out->beta  = dq->d * sin_t + dq->q * cos_t;
+}
+
+// ---------------- Modulation ----------------
+
+static float clamp01(float x)
+{
+    if (x < 0.0f) return 0.0f;
+    if (x > 1.0f) return 1.0f;
+    return x;
+}
+
+void Foc_svpwm(const FocAlphaBeta_t *v, float vbus, float duty[3])
+{
+    if (!v || !duty) return;
+    if (vbus <= 0.0f) {
+        duty[0] = duty[1] = duty[2] = 0.5f;
+        return;
+    }
+
+    // Inverse Clarke
+    float a = v->alpha;
+    float b = -0.5f * v->alpha + SQRT3_2 * v->beta;
+    float c = -0.5f * v->alpha - SQRT3_2 * v->beta;
+
+    float mid = 0.5f * (fmaxf(a, fmaxf(b, c)) + fminf(a, fminf(b, c)));
+    float k   = 1.0f / vbus;
+
+    duty[0] = clamp01(0.5f + (a - mid) * k);
+    duty[1] = clamp01(0.5f + (b - mid) * k);
+    duty[2] = clamp01(0.5f + (c - mid) * k);
+}
+
+// ---------------- Current control ----------------
+
+void Foc_init(Foc_t *f, float kp, float ki, float Ts)
+{
+    if (!f) return;
+    memset(f, 0, sizeof(*f));
+
+    // Limits are set every step from Vbus
+    PI_init(&f->pi_d, kp, ki, Ts, 0.0f, 0.0f);
+    PI_init(&f->pi_q, kp, ki, Ts, 0.0f, 0.0f);
+}
+
+void Foc_reset(Foc_t *f, float vd, float vq)
+{
+    if (!f) return;
+
+    PI_reset(&f->pi_d);
+    PI_reset(&f->pi_q);
+    PI_setIntegrator(&f->pi_d, vd);
+    PI_setIntegrator(&f->pi_q, vq);
+    f->v.d = vd;
+    f->v.q = vq;
+    f->sat = false;
+}
+
+void Foc_step(Foc_t *f, float i_u, float i_v, ElecAngle_t theta,
+              float id_ref, float iq_ref, float vbus, float duty[3])
+{
+    if (!f || !duty) return;
+
+    float s, c;
+    ElecAngle_sinCos(theta, &s, &c);
+
+    FocAlphaBeta_t i_ab;
+    Foc_clarke(i_u, i_v, &i_ab);
+    Foc_park(&i_ab, s, c, &f->i);
+
+    // Circular voltage limit, d axis first
+    float v_max = vbus * INV_SQRT3;
+    PI_Status_t st_d, st_q;
+
+    PI_setLimits(&f->pi_d, -v_max, v_max);
+    f->v.d = PI_step(&f->pi_d, id_ref, f->i.d, true, &st_d);
+
+    float vq_max = sqrtf(fmaxf(v_max * v_max - f->v.d * f->v.d, 0.0f));
+    PI_setLimits(&f->pi_q, -vq_max, vq_max);
+    f->v.q = PI_step(&f->pi_q, iq_ref, f->i.q, true, &st_q);
+
+    f->sat = (st_d != PI_OK) || (st_q != PI_OK);
+
+    FocAlphaBeta_t v_ab;
+    Foc_invPark(&f->v, s, c, &v_ab);
+    Foc_svpwm(&v_ab, vbus, duty);
+}
@@ -0,0 +1,349 @@
+// freq_resp.c
+#include "freq_resp.h"
+#include "elec_angle.h"
+
+#include <math.h>     // sqrtf, powf, atan2, sqrt, lround, fmod
+#include <string.h>   // memset, memcpy
+
+#define PI_D        3.14159265358979
+#define TURN_Q32    4294967296.0           // one turn in the Q32 phases
+
+static int log2_int(int n)
+{
+    int b = 0;
+    while ((1 << b) < n) b++;
+    return b;
+}
+
+static float table_sin_q32(uint32_t ph)
+{
+    return ElecAngle_sin((ElecAngle_t)(ph >> 16));
+}
+
+// Excitation for the current sample from the phases as they stand
+static float excitation(const FreqResp_t *fr)
+{
+    const FraConfig_t *c = &fr->cfg;
+
+    if (c->exc == FRA_EXC_CHIRP) {
+        return c->amplitude * table_sin_q32(fr->chirp_ph);
+    }
+
+    float x = 0.0f;
+    for (int i = 0; i < fr->nbins; i++) {
+        x += table_sin_q32(fr->ph[i] + fr->ph_tone[i]);
+    }
+    x *= fr->tone_amp;
+
+    // Schroeder phases keep the peak near amplitude; clip the rare excess
+    if (x >  c->amplitude) x =  c->amplitude;
+    if (x < -c->amplitude) x = -c->amplitude;
+    return x;
+}
+
+static void chirp_restart(FreqResp_t *fr)
+{
+    fr->chirp_n   = 0;
+    fr->chirp_ph  = 0;
+    fr->chirp_inc = fr->cfg.f_min_hz / fr->cfg.fs_hz;
+}
+
+// Writer side of the reader handoff (same scheme as the controller's
+// snapshot): odd while the run owns results and log
+static void seq_begin(FreqResp_t *fr)
+{
+    unsigned s = atomic_load_explicit(&fr->seq, memory_order_relaxed);
+    if (s & 1u) return;     // restart of a running analysis
+    atomic_store_explicit(&fr->seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static void seq_end(FreqResp_t *fr)
+{
+    unsigned s = atomic_load_explicit(&fr->seq, memory_order_relaxed);
+    if (!(s & 1u)) return;
+    atomic_store_explicit(&fr->seq, s + 1, memory_order_release);
+}
+
+void FreqResp_init(FreqResp_t *fr)
+{
+    if (!fr) return;
+    memset(fr, 0, sizeof(*fr));
+    atomic_init(&fr->seq, 0u);
+}
+
+bool FreqResp_configValid(const FraConfig_t *cfg, const char **why)
+{
+    const char *msg = NULL;
+
+    if (!cfg)                                                   msg = "no config";
+    else if (cfg->exc < FRA_EXC_MULTISINE || cfg->exc >= FRA_EXC_COUNT) msg = "bad excitation";
+    else if (cfg->fs_hz <= 0.0f)                                msg = "bad sample rate";
+    else if (cfg->amplitude <= 0.0f)                            msg = "amplitude must be > 0";
+    else if (cfg->samples < 16 || cfg->samples > FRA_MAX_SAMPLES ||
+             (cfg->samples & (cfg->samples - 1)) != 0)          msg = "samples must be a power of two, 16..FRA_MAX_SAMPLES";
+    else if (cfg->periods < 1)                                  msg = "periods must be >= 1";
+    else if (cfg->bins < 1 || cfg->bins > FRA_MAX_BINS)         msg = "bins must be 1..FRA_MAX_BINS";
+    else if (cfg->settle < 0)                                   msg = "settle must be >= 0";
+    else if (cfg->f_min_hz < cfg->fs_hz / (float)cfg->samples)  msg = "f_min below one cycle per period";
+    else if (cfg->f_max_hz < cfg->f_min_hz)                     msg = "f_max below f_min";
+    else if (cfg->f_max_hz >= 0.5f * cfg->fs_hz)                msg = "f_max at or above fs / 2";
+    else if (cfg->coherence_min < 0.0f || cfg->coherence_min > 1.0f) msg = "coherence_min must be 0..1";
+
+    if (why) *why = msg;
+    return msg == NULL;
+}
+
+bool FreqResp_start(FreqResp_t *fr, const FraConfig_t *cfg)
+{
+    if (!fr || !FreqResp_configValid(cfg, NULL)) return false;
+
+    seq_begin(fr);
+
+    fr->cfg     = *cfg;
+    fr->n       = 0;
+    fr->nresult = 0;
+    fr->nlog    = 0;
+    memset(fr->u_re, 0, sizeof(fr->u_re));
+    memset(fr->u_im, 0, sizeof(fr->u_im));
+    memset(fr->y_re, 0, sizeof(fr->y_re));
+    memset(fr->y_im, 0, sizeof(fr->y_im));
+    memset(fr->su_re, 0, sizeof(fr->su_re));
+    memset(fr->su_im, 0, sizeof(fr->su_im));
+    memset(fr->sy_re, 0, sizeof(fr->sy_re));
+    memset(fr->sy_im, 0, sizeof(fr->sy_im));
+    memset(fr->syu_re, 0, sizeof(fr->syu_re));
+    memset(fr->syu_im, 0, sizeof(fr->syu_im));
+    memset(fr->suu, 0, sizeof(fr->suu));
+    memset(fr->syy, 0, sizeof(fr->syy));
+
+    // Log-spaced frequencies rounded to DFT bins. Where they crowd
+    // together (low end, short record) take the next free bin instead.
+    int    N     = cfg->samples;
+    int    shift = 32 - log2_int(N);
+    int    k_max = N / 2 - 1;
+    int    k_last = 0;
+    double ratio = (double)cfg->f_max_hz / (double)cfg->f_min_hz;
+
+    fr->nbins = 0;
+    for (int i = 0; i < cfg->bins; i++) {
+        double f = (cfg->bins > 1) ? cfg->f_min_hz * pow(ratio, (double)i / (cfg->bins - 1))
+                                   : cfg->f_min_hz;
+        int k = (int)lround(f * N / cfg->fs_hz);
+        if (k <= k_last) k = k_last + 1;
+        if (k > k_max) break;
+
+        int m = fr->nbins;
+        fr->inc[m] = (uint32_t)k << shift;
+        fr->ph[m]  = 0;
+        k_last     = k;
+        fr->nbins++;
+    }
+
+    // Schroeder phases: phi_m = -pi m (m - 1) / M, m = 1..M
+    for (int i = 0; i < fr->nbins; i++) {
+        double m    = (double)(i + 1);
+        double turn = fmod(-m * (m - 1.0) / (2.0 * fr->nbins), 1.0);
+        if (turn < 0.0) turn += 1.0;
+        fr->ph_tone[i] = (uint32_t)(turn * TURN_Q32);
+    }
+    fr->tone_amp = cfg->amplitude / sqrtf((float)fr->nbins);
+
+    fr->chirp_mul = (float)pow(ratio, 1.0 / (double)(N - 1));
+    chirp_restart(fr);
+
+    fr->state = (cfg->settle > 0) ? FRA_SETTLING : FRA_RECORDING;
+    fr->exc   = excitation(fr);
+    return true;
+}
+
+// Period complete: add its U and Y to the sums, start the next one
+static void fold_period(FreqResp_t *fr)
+{
+    for (int i = 0; i < fr->nbins; i++) {
+        double ur = fr->u_re[i], ui = fr->u_im[i];
+        double yr = fr->y_re[i], yi = fr->y_im[i];
+
+        fr->su_re[i]  += ur;
+        fr->su_im[i]  += ui;
+        fr->sy_re[i]  += yr;
+        fr->sy_im[i]  += yi;
+        fr->syu_re[i] += yr * ur + yi * ui;
+        fr->syu_im[i] += yi * ur - yr * ui;
+        fr->suu[i]    += ur * ur + ui * ui;
+        fr->syy[i]    += yr * yr + yi * yi;
+
+        fr->u_re[i] = fr->u_im[i] = fr->y_re[i] = fr->y_im[i] = 0.0;
+    }
+}
+
+// Record complete: one complex ratio per bin, and its coherence
+//
+//     gamma^2 = |sum Y conj(U)|^2 / (sum |U|^2 * sum |Y|^2)
+//
+// over the periods: 1 when every period gives the same Y / U, down to
+// about 1 / periods when y is noise or drift uncorrelated with u.
+static void finish(FreqResp_t *fr)
+{
+    const FraConfig_t *c = &fr->cfg;
+
+    for (int i = 0; i < fr->nbins; i++) {
+        double u_mag = sqrt(fr->su_re[i] * fr->su_re[i] + fr->su_im[i] * fr->su_im[i]);
+        double y_mag = sqrt(fr->sy_re[i] * fr->sy_re[i] + fr->sy_im[i] * fr->sy_im[i]);
+
+        double ph = 0.0;
+        if (u_mag > 0.0 && y_mag > 0.0) {
+            ph = atan2(fr->sy_im[i], fr->sy_re[i]) - atan2(fr->su_im[i], fr->su_re[i]);
+            if (ph >   PI_D) ph -= 2.0 * PI_D;
+            if (ph <= -PI_D) ph += 2.0 * PI_D;
+        }
+
+        double den = fr->suu[i] * fr->syy[i];
+        double coh = (den > 0.0)
+                   ? (fr->syu_re[i] * fr->syu_re[i] + fr->syu_im[i] * fr->syu_im[i]) / den
+                   : 0.0;
+
+        FraBin_t *b  = &fr->result[i];
+        b->f_hz      = (float)((double)fr->inc[i] / TURN_Q32 * c->fs_hz);
+        b->gain      = (u_mag > 0.0) ? (float)(y_mag / u_mag) : 0.0f;
+        b->phase_deg = (float)(ph * 180.0 / PI_D);
+        b->u_amp     = (float)(2.0 * u_mag / ((double)c->samples * c->periods));
+        b->coherence = (float)coh;
+        b->ok        = b->coherence >= c->coherence_min;
+    }
+
+    fr->nresult = fr->nbins;
+    fr->nlog    = (fr->n < c->samples) ? fr->n : c->samples;
+    fr->state   = FRA_DONE;
+    fr->exc     = 0.0f;
+    seq_end(fr);
+}
+
+void FreqResp_step(FreqResp_t *fr, float u, float y)
+{
+    if (!fr || !FreqResp_running(fr)) return;
+
+    const int N = fr->cfg.samples;
+
+    if (fr->state == FRA_RECORDING) {
+        fr->log_u[fr->n & (N - 1)] = u;
+        fr->log_y[fr->n & (N - 1)] = y;
+
+        // DC is orthogonal to every bin over whole periods; take the
+        // first sample off anyway so a large operating point (rpm) does
+        // not swamp the table sine's rounding
+        if (fr->n == 0) {
+            fr->u0 = u;
+            fr->y0 = y;
+        }
+        double du = (double)(u - fr->u0);
+        double dy = (double)(y - fr->y0);
+        for (int i = 0; i < fr->nbins; i++) {
+            ElecAngle_t a = (ElecAngle_t)(fr->ph[i] >> 16);
+            float s, c;
+            ElecAngle_sinCos(a, &s, &c);
+            fr->u_re[i] += du * c;
+            fr->u_im[i] -= du * s;
+            fr->y_re[i] += dy * c;
+            fr->y_im[i] -= dy * s;
+        }
+    }
+
+    for (int i = 0; i < fr->nbins; i++) {
+        fr->ph[i] += fr->inc[i];
+    }
+    fr->chirp_ph  += (uint32_t)(fr->chirp_inc * (float)TURN_Q32);
+    fr->chirp_inc *= fr->chirp_mul;
+    if (++fr->chirp_n >= N) {
+        chirp_restart(fr);
+    }
+    fr->n++;
+
+    if (fr->state == FRA_SETTLING && fr->n >= fr->cfg.settle) {
+        // Periods (and sweeps) count from here
+        fr->state = FRA_RECORDING;
+        fr->n     = 0;
+        chirp_restart(fr);
+    } else if (fr->state == FRA_RECORDING && (fr->n & (N - 1)) == 0) {
+        fold_period(fr);
+        if (fr->n >= N * fr->cfg.periods) {
+            finish(fr);
+            return;
+        }
+    }
+
+    fr->exc = excitation(fr);
+}
+
+void FreqResp_abort(FreqResp_t *fr)
+{
+    if (!fr) return;
+
+    seq_begin(fr);
+    // Log: the samples of the period in progress
+    fr->nlog    = (fr->state == FRA_RECORDING) ? (fr->n & (fr->cfg.samples - 1)) : 0;
+    fr->nresult = 0;
+    fr->state   = FRA_ABORTED;
+    fr->exc     = 0.0f;
+    seq_end(fr);
+}
+
+int FreqResp_readResult(const FreqResp_t *fr, FraBin_t *out, int max)
+{
+    if (!fr || !out) return 0;
+
+    atomic_uint *seq = (atomic_uint *)&fr->seq;
+    unsigned s0 = atomic_load_explicit(seq, memory_order_acquire);
+    if (s0 & 1u) return -1;
+
+    int n = fr->nresult;
+    if (n > max) n = max;
+    if (n > 0) memcpy(out, fr->result, (size_t)n * sizeof(*out));
+
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(seq, memory_order_relaxed) != s0) return -1;
+    return n;
+}
+
+int FreqResp_readLog(const FreqResp_t *fr, int from, int count, float *u, float *y)
+{
+    if (!fr || !u || !y || from < 0 || count <= 0) return 0;
+
+    atomic_uint *seq = (atomic_uint *)&fr->seq;
+    unsigned s0 = atomic_load_explicit(seq, memory_order_acquire);
+    if (s0 & 1u) return -1;
+
+    int n = fr->nlog - from;
+    if (n > count) n = count;
+    if (n > 0) {
+        memcpy(u, &fr->log_u[from], (size_t)n * sizeof(*u));
+        memcpy(y, &fr->log_y[from], (size_t)n * sizeof(*y));
+    } else {
+        n = 0;
+    }
+
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(seq, memory_order_relaxed) != s0) return -1;
+    return n;
+}
+
+const char *FreqResp_excName(FraExcitation_t exc)
+{
+    switch (exc) {
+    case FRA_EXC_MULTISINE: return "multisine";
+    case FRA_EXC_CHIRP:     return "chirp";
+    default:                return "?";
+    }
+}
+
+const char *FreqResp_stateName(FraState_t state)
+{
+    switch (state) {
+    case FRA_IDLE:      return "IDLE";
+    case FRA_SETTLING:  return "SETTLING";
+    case FRA_RECORDING: return "RECORDING";
+    case FRA_DONE:      return "DONE";
+    case FRA_ABORTED:   return "ABORTED";
+    default:            return "?";
+    }
+}
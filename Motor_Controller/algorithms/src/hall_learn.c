@@ -0,0 +1,172 @@
+// hall_learn.c
+#include "hall_learn.h"
+
+#include <math.h>     // fmodf
+#include <string.h>   // memset
+
+#define SECTOR_DEG      60.0f
+#define EDGE_MAX_DEG    30.0f     // an edge further off belongs to the neighbour
+
+void HallLearn_start(HallLearn_t *hl, const HallLearnConfig_t *cfg)
+{
+    if (!hl || !cfg) return;
+    memset(hl, 0, sizeof(*hl));
+
+    hl->cfg         = *cfg;
+    if (hl->cfg.revs < 1) hl->cfg.revs = 1;
+    hl->state       = HALL_LEARN_MAP;
+    hl->angle_deg   = 0.5f * SECTOR_DEG;
+    hl->target_deg  = hl->angle_deg;
+    hl->last_sector = 0xFF;
+    memset(hl->map, 0xFF, sizeof(hl->map));
+}
+
+static float wrap180(float deg)
+{
+    deg = fmodf(deg + 180.0f, 360.0f);
+    if (deg < 0.0f) deg += 360.0f;
+    return deg - 180.0f;
+}
+
+// Sector of hall_bits by the codes learned in MAP, 0xFF = none
+static uint8_t decode(const HallLearn_t *hl, uint8_t hall_bits)
+{
+    return hl->map[hall_bits & 0x7];
+}
+
+// MAP: slew to the next sector centre, hold, read
+static void step_map(HallLearn_t *hl, uint8_t hall_bits)
+{
+    const HallLearnConfig_t *c = &hl->cfg;
+
+    if (hl->angle_deg < hl->target_deg) {
+        hl->angle_deg += c->sweep_deg_s * c->Ts;
+        if (hl->angle_deg > hl->target_deg) hl->angle_deg = hl->target_deg;
+        return;
+    }
+    if (++hl->n < (int)(c->settle_s / c->Ts)) return;
+
+    uint8_t code = hall_bits & 0x7;
+    if (code == 0 || code == 7) {
+        hl->fail  = HALL_LEARN_FAIL_CODE;
+        hl->state = HALL_LEARN_FAILED;
+        return;
+    }
+    if (hl->map[code] != 0xFF) {
+        hl->fail  = HALL_LEARN_FAIL_DUPLICATE;
+        hl->state = HALL_LEARN_FAILED;
+        return;
+    }
+    hl->code[hl->k] = code;
+    hl->map[code]   = (uint8_t)hl->k;
+    hl->n           = 0;
+
+    if (++hl->k < 6) {
+        hl->target_deg += SECTOR_DEG;
+        return;
+    }
+
+    // Last centre (330): sweep on from there, the first edge it meets is
+    // sector 0's
+    hl->last_sector = 5;
+    hl->end_deg     = hl->angle_deg + 360.0f * (float)c->revs;
+    hl->state       = HALL_LEARN_SWEEP_FWD;
+}
+
+static bool finish(HallLearn_t *hl)
+{
+    for (int s = 0; s < 6; s++) {
+        if (hl->n_fwd[s] == 0 || hl->n_rev[s] == 0) return false;
+        float off = 0.5f * (float)(hl->sum_fwd[s] / hl->n_fwd[s] + hl->sum_rev[s] / hl->n_rev[s]);
+        if (fabsf(off) >= EDGE_MAX_DEG) return false;
+        hl->offset_deg[s] = off;
+    }
+    return true;
+}
+
+static void step_sweep(HallLearn_t *hl, uint8_t hall_bits)
+{
+    const HallLearnConfig_t *c   = &hl->cfg;
+    const bool               fwd = (hl->state == HALL_LEARN_SWEEP_FWD);
+
+    uint8_t sector = decode(hl, hall_bits);
+    if (sector != 0xFF && sector != hl->last_sector) {
+        int step = ((int)sector - (int)hl->last_sector + 6) % 6;
+
+        // Forward across the edge into `sector`, backward across the one
+        // into the sector just left; a skipped sector is not recorded
+        if (fwd && step == 1) {
+            hl->sum_fwd[sector] += wrap180(hl->angle_deg - SECTOR_DEG * (float)sector);
+            hl->n_fwd[sector]++;
+        } else if (!fwd && step == 5) {
+            uint8_t e = hl->last_sector;
+            hl->sum_rev[e] += wrap180(hl->angle_deg - SECTOR_DEG * (float)e);
+            hl->n_rev[e]++;
+        }
+        hl->last_sector = sector;
+    }
+
+    float d = c->sweep_deg_s * c->Ts;
+    if (fwd) {
+        hl->angle_deg += d;
+        if (hl->angle_deg >= hl->end_deg) {
+            hl->end_deg = hl->end_deg - 360.0f * (float)c->revs;
+            hl->state   = HALL_LEARN_SWEEP_REV;
+        }
+        return;
+    }
+
+    hl->angle_deg -= d;
+    if (hl->angle_deg <= hl->end_deg) {
+        if (finish(hl)) {
+            hl->state = HALL_LEARN_DONE;
+        } else {
+            hl->fail  = HALL_LEARN_FAIL_EDGES;
+            hl->state = HALL_LEARN_FAILED;
+        }
+    }
+}
+
+bool HallLearn_step(HallLearn_t *hl, uint8_t hall_bits)
+{
+    if (!hl || !HallLearn_running(hl)) return false;
+
+    if (hl->state == HALL_LEARN_MAP) {
+        step_map(hl, hall_bits);
+    } else {
+        step_sweep(hl, hall_bits);
+    }
+    return HallLearn_running(hl);
+}
+
+void HallLearn_abort(HallLearn_t *hl)
+{
+    if (!hl || !HallLearn_running(hl)) return;
+    hl->fail  = HALL_LEARN_FAIL_STOPPED;
+    hl->state = HALL_LEARN_FAILED;
+}
+
+const char *HallLearn_stateName(HallLearnState_t state)
+{
+    switch (state) {
+    case HALL_LEARN_IDLE:      return "IDLE";
+    case HALL_LEARN_MAP:       return "MAP";
+    case HALL_LEARN_SWEEP_FWD: return "SWEEP_FWD";
+    case HALL_LEARN_SWEEP_REV: return "SWEEP_REV";
+    case HALL_LEARN_DONE:      return "DONE";
+    case HALL_LEARN_FAILED:    return "FAILED";
+    default:                   return "?";
+    }
+}
+
+const char *HallLearn_failName(HallLearnFail_t fail)
+{
+    switch (fail) {
+    case HALL_LEARN_FAIL_NONE:      return "NONE";
+    case HALL_LEARN_FAIL_CODE:      return "CODE";
+    case HALL_LEARN_FAIL_DUPLICATE: return "DUPLICATE";
+    case HALL_LEARN_FAIL_EDGES:     return "EDGES";
+    case HALL_LEARN_FAIL_STOPPED:   return "STOPPED";
+    default:                        return "?";
+    }
+}
@@ -0,0 +1,131 @@
+// hall_timing.c
+#include "hall_timing.h"
+
+#include <math.h>     // fabsf
+#include <string.h>   // memset
+
+void HallTiming_init(HallTiming_t *ht, const HallTimingConfig_t *cfg)
+{
+    if (!ht || !cfg) return;
+    memset(ht, 0, sizeof(*ht));
+
+    ht->cfg = *cfg;
+    if (ht->cfg.pole_pairs < 1) ht->cfg.pole_pairs = 1;
+    if (ht->cfg.pole_pairs > HALL_TIMING_MAX_POLE_PAIRS) {
+        ht->cfg.pole_pairs = HALL_TIMING_MAX_POLE_PAIRS;
+    }
+    ht->n = 6 * ht->cfg.pole_pairs;
+    HallTiming_forget(ht);
+}
+
+void HallTiming_forget(HallTiming_t *ht)
+{
+    if (!ht) return;
+
+    ht->region  = -1;
+    ht->dir     = 0;
+    ht->learned = 0;
+    HallTiming_stop(ht);
+    for (int i = 0; i < ht->n; i++) {
+        ht->dt[i]    = 0.0f;
+        ht->width[i] = 1.0f;
+    }
+}
+
+void HallTiming_stop(HallTiming_t *ht)
+{
+    if (!ht) return;
+
+    ht->run     = 0;
+    ht->k       = 0;
+    ht->steady  = false;
+    ht->rev_ref = 0.0f;
+}
+
+// Mean width back to 1 (the IIR keeps it there only on average)
+static void normalize(HallTiming_t *ht)
+{
+    float sum = 0.0f;
+    for (int i = 0; i < ht->n; i++) sum += ht->width[i];
+    if (sum <= 0.0f) return;
+
+    float s = (float)ht->n / sum;
+    for (int i = 0; i < ht->n; i++) ht->width[i] *= s;
+}
+
+float HallTiming_edge(HallTiming_t *ht, uint8_t sector, float dt_s)
+{
+    if (!ht || sector > 5) return 1.0f;
+
+    if (ht->region < 0) {
+        ht->region = sector;
+        return 1.0f;
+    }
+
+    int from = ht->region;
+    int d    = ((int)sector - from % 6 + 6) % 6;
+    if (d == 0) return ht->width[from];
+    if (d == 3) {
+        // Either way round: the count is lost
+        HallTiming_forget(ht);
+        ht->region = sector;
+        return 1.0f;
+    }
+
+    int step   = (d <= 2) ? d : d - 6;
+    ht->region = (from + step + ht->n) % ht->n;
+
+    if (step != 1 && step != -1) {
+        // Skipped a sector: dt spans two regions
+        HallTiming_stop(ht);
+        return 1.0f;
+    }
+    if (step != ht->dir) {
+        ht->dir = (int8_t)step;
+        HallTiming_stop(ht);
+    }
+
+    float w = ht->width[from];
+    ht->dt[from] = dt_s;
+
+    // A whole revolution of intervals in this direction first
+    if (ht->run < ht->n) {
+        if (++ht->run < ht->n) return w;
+    }
+
+    float rev = 0.0f;
+    for (int i = 0; i < ht->n; i++) rev += ht->dt[i];
+    if (rev <= 0.0f) return w;
+
+    if (ht->rev_ref <= 0.0f) {
+        ht->rev_ref = rev;
+        ht->k       = 0;
+        return w;
+    }
+    if (++ht->k >= ht->n) {
+        ht->steady  = fabsf(rev - ht->rev_ref) <= ht->cfg.steady_tol * rev;
+        ht->rev_ref = rev;
+        ht->k       = 0;
+        normalize(ht);
+    }
+
+    if (ht->steady) {
+        float e = (float)ht->n * dt_s / rev;
+        ht->width[from] += ht->cfg.gain * (e - ht->width[from]);
+        ht->learned++;
+    }
+    return w;
+}
+
+void HallTiming_sectorScale(const HallTiming_t *ht, float scale[6])
+{
+    if (!scale) return;
+    for (int s = 0; s < 6; s++) scale[s] = 1.0f;
+    if (!ht || ht->region < 0) return;
+
+    int dir = (ht->dir < 0) ? -1 : 1;
+    for (int k = -1; k <= 4; k++) {
+        int r = ((ht->region + dir * k) % ht->n + ht->n) % ht->n;
+        scale[r % 6] = ht->width[r];
+    }
+}
@@ -0,0 +1,55 @@
+// load_observer.c
+#include "load_observer.h"
+
+#include <math.h>     // expf
+#include <string.h>   // memset
+
+#define PI_F  3.14159265f
+
+void LoadObserver_init(LoadObserver_t *o, float j, float kt, float friction_nm,
+                       float bw_hz, float lag_s, float Ts)
+{
+    if (!o) return;
+    memset(o, 0, sizeof(*o));
+
+    if (bw_hz <= 0.0f || Ts <= 0.0f) return;   // alpha 0: estimate stays 0
+
+    // Exact first-order step for the filter; the speed path takes the
+    // same gain per step (alpha / Ts, ~L while L Ts is small), so the
+    // result is the filtered finite-difference torque balance
+    o->j        = j;
+    o->kt       = kt;
+    o->friction = friction_nm;
+    o->alpha    = 1.0f - expf(-2.0f * PI_F * bw_hz * Ts);
+    o->l        = o->alpha / Ts;
+    o->beta     = (lag_s > 0.0f) ? 1.0f - expf(-Ts / lag_s) : 1.0f;
+}
+
+void LoadObserver_reset(LoadObserver_t *o, float t_load)
+{
+    if (!o) return;
+    o->t_load = t_load;
+    o->primed = false;
+}
+
+float LoadObserver_step(LoadObserver_t *o, float omega_rad_s, float i_a)
+{
+    if (!o) return 0.0f;
+
+    float ljw = o->l * o->j * omega_rad_s;
+    if (!o->primed) {
+        // Start at the held estimate whatever the speed
+        o->z      = o->t_load + ljw;
+        o->i_f    = i_a;
+        o->primed = true;
+    }
+    o->i_f += o->beta * (i_a - o->i_f);
+
+    float t_fric = (omega_rad_s > 0.0f) ?  o->friction
+                 : (omega_rad_s < 0.0f) ? -o->friction : 0.0f;
+
+    // T^[k] = T^[k-1] + alpha (Kt i - T_fric - J (w[k] - w[k-1]) / Ts - T^[k-1])
+    o->z     += o->alpha * (o->kt * o->i_f - t_fric - o->t_load);
+    o->t_load = o->z - ljw;
+    return o->t_load;
+}
@@ -0,0 +1,197 @@
+// param_ident.c
+#include "param_ident.h"
+
+#include <string.h>   // memset
+
+#define COAST_MIN_SAMPLES   20
+
+void ParamIdent_rlStart(IdentRL_t *rl, const IdentRLConfig_t *cfg)
+{
+    if (!rl || !cfg) return;
+    memset(rl, 0, sizeof(*rl));
+
+    rl->cfg   = *cfg;
+    rl->state = IDENT_RL_RAMP_LO;
+}
+
+static void enter(IdentRL_t *rl, IdentRLState_t state)
+{
+    rl->state = state;
+    rl->n     = 0;
+    rl->m     = 0;
+    rl->v_sum = 0.0;
+    rl->i_sum = 0.0;
+}
+
+// Ramp the voltage until the current reaches target
+static void ramp(IdentRL_t *rl, float i_a, float target, IdentRLState_t next)
+{
+    if (i_a >= target) {
+        enter(rl, next);
+        return;
+    }
+    rl->v += rl->cfg.v_ramp_v_s * rl->cfg.Ts;
+    if (rl->v > rl->cfg.v_max) {
+        rl->state = IDENT_RL_FAILED;
+    }
+}
+
+// Hold the voltage; average over the second half
+static bool hold(IdentRL_t *rl, float i_a, float *v_out, float *i_out)
+{
+    int total = (int)(rl->cfg.hold_s / rl->cfg.Ts);
+    if (rl->n >= total / 2) {
+        rl->v_sum += rl->v;
+        rl->i_sum += i_a;
+        rl->m++;
+    }
+    if (++rl->n < total || rl->m == 0) return false;
+
+    *v_out = (float)(rl->v_sum / rl->m);
+    *i_out = (float)(rl->i_sum / rl->m);
+    return true;
+}
+
+bool ParamIdent_rlStep(IdentRL_t *rl, float i_a)
+{
+    if (!rl || !ParamIdent_rlRunning(rl)) return false;
+
+    const IdentRLConfig_t *c = &rl->cfg;
+
+    switch (rl->state) {
+    case IDENT_RL_RAMP_LO:
+        ramp(rl, i_a, c->i_lo, IDENT_RL_HOLD_LO);
+        break;
+
+    case IDENT_RL_HOLD_LO:
+        if (hold(rl, i_a, &rl->v_lo, &rl->i_lo)) {
+            enter(rl, IDENT_RL_RAMP_HI);
+        }
+        break;
+
+    case IDENT_RL_RAMP_HI:
+        ramp(rl, i_a, c->i_hi, IDENT_RL_HOLD_HI);
+        break;
+
+    case IDENT_RL_HOLD_HI:
+        if (hold(rl, i_a, &rl->v_hi, &rl->i_hi)) {
+            float di = rl->i_hi - rl->i_lo;
+            rl->r_ll = (di > 0.0f) ? (rl->v_hi - rl->v_lo) / di : 0.0f;
+            if (rl->r_ll <= 0.0f) {
+                rl->state = IDENT_RL_FAILED;
+                break;
+            }
+            enter(rl, IDENT_RL_DECAY);
+        }
+        break;
+
+    case IDENT_RL_DECAY:
+        if (++rl->n >= (int)(c->decay_s / c->Ts)) {
+            enter(rl, IDENT_RL_STEP);
+            rl->v       = rl->v_hi;
+            rl->i_start = i_a;
+            rl->i_prev  = i_a;
+            rl->area    = 0.0;
+        }
+        break;
+
+    case IDENT_RL_STEP:
+        // i_a is the current after n steps at V_hi (trapezoidal area)
+        rl->n++;
+        rl->area  += (double)(rl->i_hi - 0.5f * (rl->i_prev + i_a)) * c->Ts;
+        rl->i_prev = i_a;
+
+        if (i_a >= c->step_frac * rl->i_hi) {
+            float di = i_a - rl->i_start;
+            rl->l_ll  = (di > 0.0f) ? rl->r_ll * (float)rl->area / di : 0.0f;
+            rl->state = (rl->l_ll > 0.0f) ? IDENT_RL_DONE : IDENT_RL_FAILED;
+        } else if ((float)rl->n * c->Ts > c->step_max_s) {
+            rl->state = IDENT_RL_FAILED;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    if (!ParamIdent_rlRunning(rl)) {
+        rl->v = 0.0f;
+        return false;
+    }
+    return rl->state != IDENT_RL_DECAY;
+}
+
+float ParamIdent_kvFromHold(const IdentRL_t *rl, float v_ll, float i_a, float rpm)
+{
+    if (!rl || rl->state != IDENT_RL_DONE || rpm <= 0.0f) return 0.0f;
+
+    float v0 = rl->v_lo - rl->r_ll * rl->i_lo;
+    float e  = v_ll - v0 - rl->r_ll * i_a;
+    return (e > 0.0f) ? rpm / e : 0.0f;
+}
+
+void ParamIdent_coastReset(IdentCoast_t *c)
+{
+    if (!c) return;
+    memset(c, 0, sizeof(*c));
+}
+
+void ParamIdent_coastAdd(IdentCoast_t *c, float t_s, float rpm)
+{
+    if (!c || rpm <= 0.0f) return;
+
+    if (c->n == 0) c->t0 = t_s;
+    double t = (double)(t_s - c->t0);
+    double p = 1.0 / (double)rpm;
+
+    c->st  += t;
+    c->stt += t * t;
+    c->sp  += p;
+    c->stp += t * p;
+    c->n++;
+}
+
+bool ParamIdent_coastFit(const IdentCoast_t *c, float *rpm, float *decel)
+{
+    if (!c || c->n < COAST_MIN_SAMPLES) return false;
+
+    double n   = (double)c->n;
+    double den = n * c->stt - c->st * c->st;
+    if (den <= 0.0) return false;
+
+    // Period p(t) = a + b t; at the mean time p = mean period
+    double b     = (n * c->stp - c->st * c->sp) / den;
+    double p_mid = c->sp / n;
+    if (b <= 0.0 || p_mid <= 0.0) return false;
+
+    // rpm = 1 / p  ->  d rpm / dt = -b / p^2
+    if (rpm)   *rpm   = (float)(1.0 / p_mid);
+    if (decel) *decel = (float)(b / (p_mid * p_mid));
+    return true;
+}
+
+const char *ParamIdent_phaseName(ParamIdentPhase_t phase)
+{
+    switch (phase) {
+    case PARAM_IDENT_IDLE:    return "IDLE";
+    case PARAM_IDENT_RL:      return "RL";
+    case PARAM_IDENT_SPIN:    return "SPIN";
+    case PARAM_IDENT_COAST:   return "COAST";
+    case PARAM_IDENT_DONE:    return "DONE";
+    case PARAM_IDENT_ABORTED: return "ABORTED";
+    default:                  return "?";
+    }
+}
+
+const char *ParamIdent_abortName(ParamIdentAbort_t why)
+{
+    switch (why) {
+    case PARAM_IDENT_ABORT_NONE:      return "NONE";
+    case PARAM_IDENT_ABORT_STOPPED:   return "STOPPED";
+    case PARAM_IDENT_ABORT_NOT_READY: return "NOT_READY";
+    case PARAM_IDENT_ABORT_RL:        return "RL";
+    case PARAM_IDENT_ABORT_SPIN:      return "SPIN";
+    case PARAM_IDENT_ABORT_COAST:     return "COAST";
+    default:                          return "?";
+    }
+}
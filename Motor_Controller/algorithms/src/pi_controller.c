@@ -24,6 +24,7 @@ void PI_init(PI_Controller_t *pi,
     pi->out_min = out_min;
     pi->out_max = out_max;
     pi->last_output = 0.0f;
+    pi->sched = 0;
 }
 
 void PI_reset(PI_Controller_t *pi)
@@ -44,6 +45,80 @@ void PI_setGains(PI_Controller_t *pi,
     pi->ki = ki;
 }
 
+void PI_setLimits(PI_Controller_t *pi,
+                  float out_min,
+                  float out_max)
+{
+    if (!pi) return;
+
+    pi->out_min = out_min;
+    pi->out_max = out_max;
+}
+
+void PI_setIntegrator(PI_Controller_t *pi,
+                      float value)
+{
+    if (!pi) return;
+
+    pi->integrator = value;
+}
+
+void PI_setSchedule(PI_Controller_t *pi,
+                    const PI_Schedule_t *sched)
+{
+    if (!pi) return;
+
+    pi->sched = sched;
+}
+
+void PI_schedule(PI_Controller_t *pi,
+                 float x,
+                 float vbus)
+{
+    if (!pi || !pi->sched || pi->sched->n <= 0) return;
+
+    const PI_Schedule_t *s = pi->sched;
+    const PI_GainPoint_t *last = &s->pt[s->n - 1];
+    float kp, ki;
+
+    if (x <= s->pt[0].x) {
+        kp = s->pt[0].kp;
+        ki = s->pt[0].ki;
+    } else if (x >= last->x) {
+        kp = last->kp;
+        ki = last->ki;
+    } else {
+        int i = 0;
+        while (x >= s->pt[i + 1].x) i++;
+
+        const PI_GainPoint_t *a = &s->pt[i];
+        const PI_GainPoint_t *b = &s->pt[i + 1];
+        float t = (x - a->x) / (b->x - a->x);
+        kp = a->kp + t * (b->kp - a->kp);
+        ki = a->ki + t * (b->ki - a->ki);
+    }
+
+    if (s->vbus_ref > 0.0f && vbus > 0.0f) {
+        float k = s->vbus_ref / vbus;
+        kp *= k;
+        ki *= k;
+    }
+
+    pi->kp = kp;
+    pi->ki = ki;
+}
+
+bool PI_scheduleValid(const PI_Schedule_t *sched)
+{
+    if (!sched || sched->n < 1 || sched->n > PI_SCHED_MAX_POINTS) return false;
+
+    for (int i = 0; i < sched->n; i++) {
+        if (sched->pt[i].kp < 0.0f || sched->pt[i].ki < 0.0f) return false;
+        if (i > 0 && sched->pt[i].x <= sched->pt[i - 1].x) return false;
+    }
+    return true;
+}
+
 float PI_step(PI_Controller_t *pi,
               float ref,
               float meas,
@@ -0,0 +1,145 @@
+// relay_tuner.c
+#include "relay_tuner.h"
+
+#include <math.h>     // fabsf, sqrtf
+#include <string.h>   // memset
+
+#define PI_F  3.14159265f
+
+static float relay_output(const RelayTuner_t *rt)
+{
+    const RelayTuneConfig_t *c = &rt->cfg;
+    float u = rt->high ? c->bias + c->amplitude : c->bias - c->amplitude;
+    if (u < c->out_min) u = c->out_min;
+    if (u > c->out_max) u = c->out_max;
+    return u;
+}
+
+void RelayTuner_start(RelayTuner_t *rt, const RelayTuneConfig_t *cfg)
+{
+    if (!rt || !cfg) return;
+    memset(rt, 0, sizeof(*rt));
+
+    rt->cfg   = *cfg;
+    rt->state = RELAY_TUNE_RUNNING;
+    rt->high  = true;
+}
+
+void RelayTuner_abort(RelayTuner_t *rt, RelayAbort_t why)
+{
+    if (!rt || rt->state != RELAY_TUNE_RUNNING) return;
+
+    rt->state = RELAY_TUNE_ABORTED;
+    rt->abort = why;
+}
+
+// Ultimate gain / period from the averaged cycles, then the PI rule
+static void finish(RelayTuner_t *rt)
+{
+    const RelayTuneConfig_t *c = &rt->cfg;
+    float a  = (float)(rt->amp_sum / rt->measured);
+    float pu = (float)(rt->per_sum / rt->measured);
+
+    float a2 = a * a - c->hyst * c->hyst;
+    if (a2 <= 0.0f || pu <= 0.0f) {
+        rt->state = RELAY_TUNE_ABORTED;
+        rt->abort = RELAY_ABORT_NO_CYCLE;
+        return;
+    }
+
+    rt->ku   = 4.0f * c->amplitude / (PI_F * sqrtf(a2));
+    rt->pu_s = pu;
+
+    float ti;
+    switch (c->rule) {
+    case RELAY_TUNE_TL:
+        rt->kp = rt->ku / 3.2f;
+        ti     = 2.2f * pu;
+        break;
+    case RELAY_TUNE_ZN:
+    default:
+        rt->kp = 0.45f * rt->ku;
+        ti     = pu / 1.2f;
+        break;
+    }
+    rt->ki    = rt->kp / ti;
+    rt->state = RELAY_TUNE_DONE;
+}
+
+float RelayTuner_step(RelayTuner_t *rt, float meas, float dt_s)
+{
+    if (!rt) return 0.0f;
+    if (rt->state != RELAY_TUNE_RUNNING) return relay_output(rt);
+
+    const RelayTuneConfig_t *c = &rt->cfg;
+    float e = c->setpoint - meas;
+    rt->t_s += dt_s;
+
+    // Band applies once the measurement has crossed the setpoint (the
+    // run may start some way off it)
+    if (rt->switches > 0 && fabsf(e) > c->band) {
+        RelayTuner_abort(rt, RELAY_ABORT_BAND);
+        return relay_output(rt);
+    }
+    if (rt->t_s > c->timeout_s) {
+        RelayTuner_abort(rt, RELAY_ABORT_TIMEOUT);
+        return relay_output(rt);
+    }
+
+    if (e > rt->e_max) rt->e_max = e;
+    if (e < rt->e_min) rt->e_min = e;
+
+    if (rt->high && e < -c->hyst) {
+        rt->high = false;
+    } else if (!rt->high && e > c->hyst) {
+        // Low -> high closes a cycle
+        rt->high = true;
+        rt->switches++;
+        if (rt->switches > 1 + c->skip_cycles) {
+            rt->amp_sum += 0.5 * (double)(rt->e_max - rt->e_min);
+            rt->per_sum += (double)(rt->t_s - rt->t_cycle_s);
+            rt->measured++;
+        }
+        rt->t_cycle_s = rt->t_s;
+        rt->e_max = e;
+        rt->e_min = e;
+
+        if (rt->measured >= c->cycles) {
+            finish(rt);
+        }
+    }
+
+    return relay_output(rt);
+}
+
+const char *RelayTuner_ruleName(RelayTuneRule_t rule)
+{
+    switch (rule) {
+    case RELAY_TUNE_ZN: return "zn";
+    case RELAY_TUNE_TL: return "tl";
+    default:            return "?";
+    }
+}
+
+const char *RelayTuner_stateName(RelayTuneState_t state)
+{
+    switch (state) {
+    case RELAY_TUNE_IDLE:    return "IDLE";
+    case RELAY_TUNE_RUNNING: return "RUNNING";
+    case RELAY_TUNE_DONE:    return "DONE";
+    case RELAY_TUNE_ABORTED: return "ABORTED";
+    default:                 return "?";
+    }
+}
+
+const char *RelayTuner_abortName(RelayAbort_t why)
+{
+    switch (why) {
+    case RELAY_ABORT_NONE:     return "NONE";
+    case RELAY_ABORT_STOPPED:  return "STOPPED";
+    case RELAY_ABORT_BAND:     return "BAND";
+    case RELAY_ABORT_TIMEOUT:  return "TIMEOUT";
+    case RELAY_ABORT_NO_CYCLE: return "NO_CYCLE";
+    default:                   return "?";
+    }
+}
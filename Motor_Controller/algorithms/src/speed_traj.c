@@ -0,0 +1,66 @@
+// speed_traj.c
+#include "speed_traj.h"
+
+#include <math.h>     // sqrtf, fabsf
+#include <string.h>   // memset
+
+void SpeedTraj_init(SpeedTraj_t *t, float a_max, float j_max, float v)
+{
+    if (!t) return;
+    memset(t, 0, sizeof(*t));
+    t->a_max = a_max;
+    t->j_max = j_max;
+    t->v     = v;
+}
+
+void SpeedTraj_reset(SpeedTraj_t *t, float v, float a)
+{
+    if (!t) return;
+    t->v = v;
+    t->a = a;
+}
+
+// No jerk limit: constant-rate ramp
+static float ramp_step(SpeedTraj_t *t, float target, float dt_s)
+{
+    float max_step = t->a_max * dt_s;
+    float d = target - t->v;
+    if (d >  max_step) d =  max_step;
+    if (d < -max_step) d = -max_step;
+
+    t->v += d;
+    t->a  = d / dt_s;
+    return t->v;
+}
+
+float SpeedTraj_step(SpeedTraj_t *t, float target, float dt_s)
+{
+    if (!t) return 0.0f;
+    if (dt_s <= 0.0f) return t->v;
+    if (t->j_max <= 0.0f) return ramp_step(t, target, dt_s);
+
+    float e  = target - t->v;
+    float jd = t->j_max * dt_s;   // largest acceleration change per step
+
+    // Braking acceleration for the remaining error; the discrete form
+    // (a reached in whole steps of jd) keeps the last steps from
+    // overshooting
+    float a_abs = sqrtf(0.25f * jd * jd + 2.0f * t->j_max * fabsf(e)) - 0.5f * jd;
+    if (a_abs > t->a_max) a_abs = t->a_max;
+    float a_des = (e >= 0.0f) ? a_abs : -a_abs;
+
+    float da = a_des - t->a;
+    if (da >  jd) da =  jd;
+    if (da < -jd) da = -jd;
+    t->a += da;
+
+    float v = t->v + t->a * dt_s;
+
+    // Arrived (or would pass it) with the acceleration all but ramped out
+    if ((target - v) * e <= 0.0f && fabsf(t->a) <= jd) {
+        v    = target;
+        t->a = 0.0f;
+    }
+    t->v = v;
+    return v;
+}
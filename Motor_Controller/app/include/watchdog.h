@@ -0,0 +1,47 @@
+// watchdog.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pwm_motor.h"
+#include "motor_control.h"
+
+// Fast-loop deadline watchdog.
+//
+// The fast loop calls Watchdog_kick() once per iteration. A separate
+// SCHED_FIFO thread (higher priority than the fast loop) wakes from a
+// timerfd every WATCHDOG_PERIOD_US and checks how many fast-loop deadlines
+// have passed since the last kick. Once WATCHDOG_MISSED_DEADLINES are
+// missed in a row it forces the bridge off through a pre-opened
+// PwmMotorSafeStop_t and queues MOTOR_FAULT_TIMING.
+
+typedef struct {
+    uint32_t trips;                  // safe-stops forced so far
+    bool     tripped;                // currently tripped (cleared on next kick)
+    uint32_t max_missed;             // longest run of missed deadlines seen
+    uint64_t kicks;                  // heartbeat count
+
+    // Response latency: from the deadline that completed the missed run
+    // to the moment the safe-stop writes returned.
+    double   last_latency_s;
+    double   min_latency_s;
+    double   max_latency_s;
+} WatchdogStats_t;
+
+// Pre-open the safe-stop path for `pwm` and start the watchdog thread.
+// A trip queues the fault on `mc` (may be NULL). Returns false if the thread could not be started. Missing safe-stop
+// files are not fatal: the fault is still latched on a trip.
+bool Watchdog_init(const PwmMotor_t *pwm, MotorControl_t *mc);
+
+// Stop the watchdog thread and close the safe-stop path.
+void Watchdog_cleanup(void);
+
+// Heartbeat from the fast loop (lock-free, one clock read + two stores).
+void Watchdog_kick(void);
+
+// Called by the fast loop when it exits on purpose (shutdown), so the
+// missing heartbeat is not treated as a stall.
+void Watchdog_disarm(void);
+
+// Snapshot of the statistics (any thread).
+WatchdogStats_t Watchdog_getStats(void);
@@ -8,91 +8,79 @@
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
-#include <pthread.h>
-#include <sched.h>
 
 #include "motor_config.h"
+#include "motor_config_runtime.h"
 #include "motor_states.h"
 #include "motor_control.h"
+#include "motor_axis.h"
+#include "motor_exec.h"
 #include "pwm_motor.h"
 #include "hall.h"
 #include "bemf.h"
+#include "current_sense.h"
 #include "adc.h"
 #include "position_estimator.h"
 #include "udp_server.h"
 #include "gpio.h"
+#include "timer.h"
 #include "speed_measurement.h"
 #include "sensorless_handover.h"
 #include "status_display.h"    
-
-typedef enum {
-    SENSOR_MODE_HALL_ONLY = 0,
-    SENSOR_MODE_AUTO      = 1,
-    SENSOR_MODE_BEMF_ONLY = 2
-} SensorMode_t;
+#include "perf_counters.h"
+#include "watchdog.h"
+#include "clock_source.h"
+#include "rt_alloc_guard.h"
 
 // ---------------- Global hardware handles ----------------
 static volatile sig_atomic_t g_stop = 0;
 
 static int           g_adc_fd    = -1;
-static BemfHandle_t  g_bemf;
-static PwmMotor_t    g_pwm_motor;
-static HallHandle_t  g_hall;
+
+// The PWM driver and current sense are written by the fast loop, the BEMF
+// and Hall handles by the slow loop: keep them on separate cache lines.
+static _Alignas(CACHE_LINE_BYTES) BemfHandle_t  g_bemf;
+static _Alignas(CACHE_LINE_BYTES) PwmMotor_t    g_pwm_motor;
+static CurrentSenseHandle_t                     g_isense;
+static _Alignas(CACHE_LINE_BYTES) HallHandle_t  g_hall;
 
 // Optional: simple gate‑enable GPIO (EN_GATE)
 static GPIO_Handle  *g_drv_en_gpio = NULL;
 
-static pthread_t            g_fast_thread;
-static SensorlessHandover_t g_handover;
-static SensorMode_t         g_sensor_mode = SENSOR_MODE_HALL_ONLY;
+// The motor (estimators + controller) and the executive running its loops
+static MotorAxis_t          g_axis;
+static MotorExec_t          g_exec;
+
+// Fast-loop perf counters (opened by the fast-loop thread itself)
+static _Alignas(CACHE_LINE_BYTES) PerfCounters_t g_fast_perf;
 
 // Forward‑declared so udp_server.c / status_display.c can use them
+MotorAxis_t *Control_getAxis(void);
 SensorMode_t Control_getSensorMode(void);
 void         Control_setSensorMode(SensorMode_t mode);
+const PerfCounters_t *Control_getFastLoopPerf(void);
 
-// ---------------- Time helpers ----------------
-static double get_time_s(void)
+// ---------------- Axis access ----------------
+MotorAxis_t *Control_getAxis(void)
 {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+    return &g_axis;
 }
 
 // ---------------- Sensor mode control ----------------
 SensorMode_t Control_getSensorMode(void)
 {
-    return g_sensor_mode;
+    return g_axis.sensor_mode;
 }
 
 void Control_setSensorMode(SensorMode_t mode)
 {
-    g_sensor_mode = mode;
-
-    switch (mode) {
-    case SENSOR_MODE_HALL_ONLY:
-        // Hall sensors only
-        SpeedMeas_setMode(SPEED_SRC_HALL);
-        PosEst_setMode(POS_MODE_HALL);
-        SensorlessHandover_setEnable(&g_handover, false);
-        break;
-
-    case SENSOR_MODE_AUTO:
-        // Start in Hall; allow handover helper to switch to BEMF
-        SpeedMeas_setMode(SPEED_SRC_HALL);
-        PosEst_setMode(POS_MODE_HALL);
-        SensorlessHandover_setEnable(&g_handover, true);
-        break;
-
-    case SENSOR_MODE_BEMF_ONLY:
-        // Force sensorless
-        SpeedMeas_setMode(SPEED_SRC_BEMF);
-        PosEst_setMode(POS_MODE_BEMF);
-        SensorlessHandover_setEnable(&g_handover, false);
-        break;
-
-    default:
-        break;
-    }
+    MotorAxis_setSensorMode(&g_axis, mode);
+}
+
+// ---------------- Profiling ----------------
+const PerfCounters_t *Control_getFastLoopPerf(void)
+{
+    return &g_fast_perf;
 }
 
 // ---------------- Signal handler ----------------
@@ -131,6 +119,22 @@ static int app_hw_init(void)
         return -1;
     }
 
+    // --- Phase current sense (outputs are off: calibrate the offsets now) ---
+    if (!CurrentSense_initDefault(&g_isense, g_adc_fd)) {
+        fprintf(stderr, "CurrentSense_initDefault failed\n");
+        PwmMotor_deinit(&g_pwm_motor);
+        adc_close(g_adc_fd);
+        g_adc_fd = -1;
+        return -1;
+    }
+    if (CurrentSense_calibrate(&g_isense, ISENSE_CAL_SAMPLES)) {
+        printf("Current sense offsets: U=%.3f V, V=%.3f V\n",
+               g_isense.offset_u_v, g_isense.offset_v_v);
+    } else {
+        fprintf(stderr, "Current sense calibration failed; using nominal %.3f V\n",
+                ADC_REF_V);
+    }
+
     // Optional: enable DRV8302 EN_GATE via GPIO
     {
         unsigned int offs[1] = { DRV_EN_GATE_OFFSET };
@@ -158,23 +162,9 @@ static int app_hw_init(void)
         return -1;
     }
 
-    // --- Speed measurement (Hall + BEMF) ---
-    SpeedMeas_init();
-    SpeedMeas_setHallHandle(&g_hall);
-    SpeedMeas_setBemfHandle(&g_bemf);
-
-    // --- Motor control + position estimator ---
-    MotorControl_init(&g_pwm_motor);
-    PosEst_init(POS_MODE_HALL);   // initial mode; Control_setSensorMode will refine
-
-    // --- Sensorless handover helper ---
-    SensorlessHandover_init(&g_handover,
-                            SENSORLESS_MIN_RPM_MECH,     // from motor_config.h
-                            SENSORLESS_STABLE_SAMPLES);  // from motor_config.h
-    SensorlessHandover_setEnable(&g_handover, false);
-
-    // Start in Hall‑only mode for first bring‑up
-    Control_setSensorMode(SENSOR_MODE_HALL_ONLY);
+    // --- Speed measurement, position estimator, motor control, handover ---
+    // (starts in Hall-only mode for first bring-up)
+    MotorAxis_init(&g_axis, &g_pwm_motor, &g_hall, &g_bemf, &g_isense);
 
     return 0;
 }
@@ -182,7 +172,7 @@ static int app_hw_init(void)
 static void app_hw_deinit(void)
 {
     // Ensure motor is disabled
-    MotorControl_setEnable(false);
+    MotorControl_setEnable(&g_axis.ctrl, false);
 
     // PWM driver off
     PwmMotor_stop(&g_pwm_motor);
@@ -205,100 +195,45 @@ static void app_hw_deinit(void)
     }
 }
 
-// ---------------- Fast loop (control) thread ----------------
-static void *fast_loop_thread(void *arg)
+// ---------------- Fast loop hooks ----------------
+// The executive owns the loop threads; these run on the fast thread.
+static void fast_loop_start(int worker, void *user)
 {
-    (void)arg;
-
-    // Try to make this a real‑time SCHED_FIFO thread (best‑effort)
-    struct sched_param sp;
-    memset(&sp, 0, sizeof(sp));
-    sp.sched_priority = 80; // tune as needed, requires CAP_SYS_NICE
-    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) != 0) {
-        perror("pthread_setschedparam (SCHED_FIFO) failed; running non-RT");
-    }
-
-    const double Ts        = 1.0 / (double)FAST_LOOP_HZ;
-    const double jitter_hi = Ts * 3.0;   // upper bound on acceptable dt
-    const double jitter_lo = Ts * 0.1;   // lower bound
-
-    double t_prev = get_time_s();
-    double t_next = t_prev + Ts;
-
-    static int timing_warn_count = 0;
-
-    while (!g_stop) {
-        double t_now = get_time_s();
-        double dt    = t_now - t_prev;
-
-        // Jitter / timing *logging* (no hard latch for first bring‑up)
-        if (dt > jitter_hi || dt < jitter_lo) {
-            if ((timing_warn_count++ % 100) == 0) {
-                fprintf(stderr,
-                        "WARN: fast-loop jitter dt=%.6f s (expected %.6f s)\n",
-                        dt, Ts);
-            }
-            // If you later want to hard‑trip:
-            // MotorControl_setFault(MOTOR_FAULT_TIMING);
-        }
-
-        t_prev = t_now;
-
-        // Fast control step (commutation + duty apply)
-        MotorControl_stepFast();
-
-        // Simple sleep‑until‑next logic
-        t_now = get_time_s();
-        double sleep_s = t_next - t_now;
-        if (sleep_s < 0.0) {
-            // We're late; push next deadline forward
-            t_next = t_now + Ts;
-            continue;
-        }
-
-        struct timespec ts;
-        ts.tv_sec  = (time_t)sleep_s;
-        ts.tv_nsec = (long)((sleep_s - (double)ts.tv_sec) * 1e9);
-        nanosleep(&ts, NULL);
-
-        t_next += Ts;
+    (void)worker;
+    (void)user;
+
+#if FAST_LOOP_PERF_ENABLE
+    // Counters are per-thread, so they must be opened from here
+    if (PerfCounters_open(&g_fast_perf, FAST_LOOP_PERF_SAMPLE_ITERS)) {
+        printf("Fast-loop perf counters enabled (sample every %d iterations).\n",
+               FAST_LOOP_PERF_SAMPLE_ITERS);
+    } else {
+        fprintf(stderr, "Fast-loop perf counters unavailable; profiling off.\n");
     }
-
-    return NULL;
+#endif
 }
 
-// ---------------- Slow loop (1 kHz) ----------------
-static void slow_loop_step(void)
-{  
-    // Time stamp for speed measurement + handover
-    double now_s = get_time_s();
-
-    // 1) Update BEMF / Vbus sensing
-    Bemf_update(&g_bemf);
-    float vbus = Bemf_getVbus(&g_bemf);
-
-    // 2) Give bus voltage to motor control (stores v_bus + OV/UV faults)
-    MotorControl_updateBusVoltage(vbus);
+static void fast_loop_tick(int worker, void *user)
+{
+    (void)worker;
+    (void)user;
 
-    // 3) Update speed / sector from Hall or BEMF
-    SpeedMeas_update((float)now_s);
-    //SpeedEstimate_t spd = SpeedMeas_get();
+    // Heartbeat for the deadline watchdog
+    Watchdog_kick();
 
-    // 4) Run sensorless handover helper (Hall -> BEMF) if AUTO mode
-    if (g_sensor_mode == SENSOR_MODE_AUTO) {
-        MotorContext_t ctx = MotorControl_getContext();
-        bool dir_fwd = (ctx.cmd.direction == 0);  // 0 = forward
+    // Perf counter sampling (no-op if counters are unavailable)
+    PerfCounters_tick(&g_fast_perf);
+}
 
-        (void)SensorlessHandover_step(&g_handover,
-                                      (float)now_s,                                     
-                                      dir_fwd);
-    }
+static void fast_loop_exit(int worker, void *user)
+{
+    (void)worker;
+    (void)user;
 
-    // 5) Update position estimator (uses SpeedMeas_get())
-    PosEst_update();
+    // Intentional exit: don't let the watchdog read this as a stall
+    Watchdog_disarm();
 
-    // 6) Slow motor control (state machine + PI + slew/direction logic)
-    MotorControl_stepSlow();
+    PerfCounters_close(&g_fast_perf);
 }
 
 // ---------------- main() ----------------
@@ -307,13 +242,26 @@ int main(void)
     signal(SIGINT, handle_sigint);
     signal(SIGTERM, handle_sigint);
 
+    // Limits (current limit, trip time...) from motor_config.h, then the
+    // config file (motor characteristics from a parameter identification,
+    // Hall decoding from a Hall learn)
+    MotorConfig_initDefaults();
+    if (access(MOTOR_CONFIG_PATH, R_OK) == 0) {
+        if (MotorConfig_loadFromFile(MOTOR_CONFIG_PATH) == 0) {
+            printf("Runtime config loaded from %s.\n", MOTOR_CONFIG_PATH);
+        }
+    }
+    if (!MotorConfig_sanityCheck()) {
+        fprintf(stderr, "Warning: runtime config looks wrong, check %s.\n", MOTOR_CONFIG_PATH);
+    }
+
     if (app_hw_init() < 0) {
         fprintf(stderr, "Hardware init failed, exiting.\n");
         return 1;
     }
 
     // Start with motor disabled; UDP can enable/set RPM
-    MotorControl_setEnable(false);
+    MotorControl_setEnable(&g_axis.ctrl, false);
 
     // Start UDP server (remote control)
     if (!UDPServer_init()) {
@@ -323,10 +271,24 @@ int main(void)
     // Start periodic status display (telemetry to stdout)
     StatusDisplay_init();
 
-    // Launch fast loop RT thread
-    int err = pthread_create(&g_fast_thread, NULL, fast_loop_thread, NULL);
-    if (err != 0) {
-        fprintf(stderr, "Failed to create fast loop thread: %s\n", strerror(err));
+    // Deadline watchdog (must be running before the fast loop starts)
+    if (!Watchdog_init(&g_pwm_motor, &g_axis.ctrl)) {
+        fprintf(stderr, "Warning: fast-loop watchdog failed to start.\n");
+    }
+
+    // One worker, not pinned: fast loop (RT) + slow loop threads
+    const MotorExecHooks_t hooks = {
+        .fast_start = fast_loop_start,
+        .fast_tick  = fast_loop_tick,
+        .fast_exit  = fast_loop_exit,
+        .slow_tick  = NULL,
+        .user       = NULL
+    };
+    if (!MotorExec_init(&g_exec, 1, NULL, &hooks) ||
+        MotorExec_addAxis(&g_exec, &g_axis) < 0 ||
+        !MotorExec_start(&g_exec)) {
+        fprintf(stderr, "Failed to start the control loops.\n");
+        Watchdog_cleanup();
         UDPServer_cleanup();
         StatusDisplay_cleanup();
         app_hw_deinit();
@@ -337,14 +299,12 @@ int main(void)
     printf("  FAST_LOOP_HZ  = %d\n", FAST_LOOP_HZ);
     printf("  SPEED_LOOP_HZ = %d\n", SPEED_LOOP_HZ);
 
-    // Main thread: slow loop (approx SPEED_LOOP_HZ) + supervision
-    const double slow_Ts = 1.0 / (double)SPEED_LOOP_HZ;
+    // Main thread: supervision only (the loops run on the executive)
+    const TimeNs_t poll_Ts_ns = 10 * TIME_NS_PER_MS;
+    int ident_saved = 0;   // parameter identification runs written out
+    int hall_saved  = 0;   // Hall learn runs written out
 
     while (!g_stop) {
-        double t0 = get_time_s();
-
-        slow_loop_step();
-
         // Check UDP "stop" request
         if (UDPServer_wasStopRequested()) {
             printf("UDP requested shutdown.\n");
@@ -352,33 +312,61 @@ int main(void)
             break;
         }
 
-        // Throttle to ~SPEED_LOOP_HZ (not hard RT, just approximate)
-        double t1      = get_time_s();
-        double elapsed = t1 - t0;
-        double sleep_s = slow_Ts - elapsed;
+        // A parameter identification has new motor characteristics for
+        // this axis: keep them (file I/O stays off the loops)
+        MotorContext_t     ctx = MotorControl_getContext(&g_axis.ctrl);
+        MotorIdentStatus_t id  = ctx.ident;
+        MotorParams_t      mp  = {
+            .kv_rpm_per_v = id.kv_rpm_per_v, .r_phase_ohm  = id.r_phase_ohm,
+            .l_phase_h    = id.l_phase_h,    .inertia_kgm2 = id.inertia_kgm2,
+            .friction_nm  = id.friction_nm,
+        };
+        if (id.runs != ident_saved) {
+            ident_saved = id.runs;
+            if (MotorConfig_saveMotorParams(MOTOR_CONFIG_PATH, &mp, &ctx.hall.map) == 0) {
+                printf("Motor parameters saved to %s: Kv=%.1f R=%.4f L=%.3g J=%.3g F=%.3g\n",
+                       MOTOR_CONFIG_PATH, id.kv_rpm_per_v, id.r_phase_ohm,
+                       id.l_phase_h, id.inertia_kgm2, id.friction_nm);
+            }
+        }
 
-        if (sleep_s > 0.0) {
-            struct timespec ts;
-            ts.tv_sec  = (time_t)sleep_s;
-            ts.tv_nsec = (long)((sleep_s - (double)ts.tv_sec) * 1e9);
-            nanosleep(&ts, NULL);
+        // ... and likewise a Hall learn its map and edge offsets
+        MotorHallLearnStatus_t hs = ctx.hall;
+        if (hs.runs != hall_saved) {
+            hall_saved = hs.runs;
+            if (MotorConfig_saveMotorParams(MOTOR_CONFIG_PATH, &mp, &ctx.hall.map) == 0) {
+                printf("Hall map saved to %s: %d,%d,%d,%d,%d,%d\n",
+                       MOTOR_CONFIG_PATH, hs.code[0], hs.code[1], hs.code[2],
+                       hs.code[3], hs.code[4], hs.code[5]);
+            }
         }
+
+        Clock_sleepUntilNs(Clock_nowNs() + poll_Ts_ns);
     }
 
     printf("Shutting down...\n");
 
-    // Stop UDP and fast loop
+    // Stop UDP and the control loops
     UDPServer_cleanup();
-    g_stop = 1;
-    pthread_join(g_fast_thread, NULL);
+    MotorExec_stop(&g_exec);
+
+    // Heap use from the loop threads (only checked with -DMOTOR_RT_ALLOC_GUARD=ON)
+    RtAllocStats_t as = RtAllocGuard_getStats();
+    if (as.hooked) {
+        printf("RT alloc guard: %llu allocations, %llu frees from real-time threads\n",
+               (unsigned long long)as.allocs, (unsigned long long)as.frees);
+    }
+
+    // Fast loop has disarmed the watchdog on exit
+    Watchdog_cleanup();
 
     // Stop status display thread
     StatusDisplay_cleanup();
 
     // Make sure motor is off
-    MotorControl_setEnable(false);
+    MotorControl_setEnable(&g_axis.ctrl, false);
     app_hw_deinit();
 
     printf("Motor control app exited.\n");
     return 0;
-}
\ No newline at end of file
+}
@@ -14,6 +14,7 @@
 #include "bemf.h"
 #include "adc.h"
 #include "gpio.h"
+#include "clock_source.h"
 
 static volatile sig_atomic_t g_stop = 0;
 
@@ -23,13 +24,6 @@ static void handle_sigint(int sig)
     g_stop = 1;
 }
 
-static double get_time_s(void)
-{
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
-}
-
 int main(void)
 {
     signal(SIGINT, handle_sigint);
@@ -104,14 +98,15 @@ int main(void)
     printf("Cycling through 6-step sectors with fixed duty.\n");
 
     const float duty = 0.20f;        // 20% "duty" (really just ON/OFF in this GPIO version)
-    const double step_interval_s = 0.200; // 200 ms per sector
+    const TimeNs_t step_interval_ns = 200 * TIME_NS_PER_MS; // 200 ms per sector
 
-    double t_start = get_time_s();
+    TimeNs_t t_start = Clock_nowNs();
+    TimeNs_t t_next  = t_start;
     int sector_cmd = 0;
 
     while (!g_stop) {
-        double t_now = get_time_s();
-        double t_rel = t_now - t_start;
+        TimeNs_t t_now = Clock_nowNs();
+        double   t_rel = time_ns_to_s(t_now - t_start);
 
         // Update BEMF / VBUS
         Bemf_update(&bemf);
@@ -125,7 +120,7 @@ int main(void)
 
         // Read hall bits and sector
         uint8_t hall_bits = Hall_readBits(&hall);
-        uint8_t hall_sector = HallComm_hallToSector(hall_bits);
+        uint8_t hall_sector = HallComm_hallToSector(NULL, hall_bits);
 
         printf("t=%.3f  VBUS=%.2f V  sector_cmd=%d  duty=%.2f  "
                "hall_bits=0x%02X hall_sector=%u\n",
@@ -136,11 +131,9 @@ int main(void)
         // Next sector
         sector_cmd = (sector_cmd + 1) % 6;
 
-        // Sleep ~step_interval_s
-        struct timespec ts;
-        ts.tv_sec  = (time_t)step_interval_s;
-        ts.tv_nsec = (long)((step_interval_s - (double)ts.tv_sec) * 1e9);
-        nanosleep(&ts, NULL);
+        // Sleep until the next step
+        t_next += step_interval_ns;
+        Clock_sleepUntilNs(t_next);
     }
 
     printf("Motor GPIO test exiting...\n");
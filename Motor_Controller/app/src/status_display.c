@@ -1,8 +1,11 @@
 // status_display.c
 #include "status_display.h"
 #include "motor_control.h"
+#include "motor_axis.h"
 #include "motor_states.h"
 #include "position_estimator.h"
+#include "perf_counters.h"
+#include "watchdog.h"
 
 #include <pthread.h>
 #include <stdio.h>
@@ -11,15 +14,9 @@
 #include <stdbool.h>
 #include <string.h>
 
-// Must match the enum in main.c
-typedef enum {
-    SENSOR_MODE_HALL_ONLY = 0,
-    SENSOR_MODE_AUTO      = 1,
-    SENSOR_MODE_BEMF_ONLY = 2
-} SensorMode_t;
-
 // Provided by main.c
-extern SensorMode_t Control_getSensorMode(void);
+extern MotorAxis_t *Control_getAxis(void);
+extern const PerfCounters_t *Control_getFastLoopPerf(void);
 
 static pthread_t display_thread;
 static int keepRunning = 0;
@@ -34,6 +31,8 @@ static const char* motor_state_to_str(MotorState_t s)
     case MOTOR_STATE_ALIGN: return "ALIGN";
     case MOTOR_STATE_RUN:   return "RUN";
     case MOTOR_STATE_FAULT: return "FAULT";
+    case MOTOR_STATE_IDENT: return "IDENT";
+    case MOTOR_STATE_HALL_LEARN: return "HALL_LEARN";
     default:                return "UNKNOWN";
     }
 }
@@ -101,16 +100,17 @@ static void* display_thread_func(void *arg)
     while (keepRunning) {
         sleep(1);  // once per second
 
-        MotorContext_t ctx = MotorControl_getContext();
-        PosEst_t pe        = PosEst_get();
-        SensorMode_t sm    = Control_getSensorMode();
+        MotorAxis_t *ax    = Control_getAxis();
+        MotorContext_t ctx = MotorControl_getContext(&ax->ctrl);
+        PosEst_t pe        = PosEst_get(&ax->pos);
+        SensorMode_t sm    = ax->sensor_mode;
 
         // ctx.meas.rpm_mech should be kept in sync by MotorControl_stepSlow()
         // and SpeedMeas/PosEst.
         // We also assume MotorControl_updateBusVoltage() is populating v_bus.
         float rpm_mech = ctx.meas.rpm_mech;
         float rpm_cmd  = ctx.cmd.rpm_cmd;
-        float duty     = ctx.cmd.torque_cmd;   // currently used as duty scalar
+        float duty     = ctx.cmd.duty;         // applied by the fast loop
         float vbus     = ctx.meas.v_bus;       // make sure your context has this
         int   dir      = ctx.cmd.direction;    // 0=fwd, 1=rev
 
@@ -125,13 +125,13 @@ static void* display_thread_func(void *arg)
         // STATE=2(RUN) FAULT=0(NONE) EN=1
         // RPM=1234.5 CMD=1500.0 DUTY=0.350 DIR=0
         // SECTOR=3 ELEC_ANG=1.57 ELEC_RPM=4938.1
-        // VBUS=23.45 SENSOR_MODE=1(AUTO)
+        // VBUS=23.45 IBUS=3.21 SENSOR_MODE=1(AUTO)
         //
         // All on one line:
         printf("STATE=%d(%s) FAULT=%d(%s) EN=%d "
                "RPM=%.1f CMD=%.1f DUTY=%.3f DIR=%d "
                "SECTOR=%u ELEC_ANG=%.3f ELEC_RPM=%.1f "
-               "VBUS=%.2f SENSOR_MODE=%d(%s)\n",
+               "VBUS=%.2f IBUS=%.2f SENSOR_MODE=%d(%s)\n",
                ctx.state,
                motor_state_to_str(ctx.state),
                ctx.fault,
@@ -145,9 +145,24 @@ static void* display_thread_func(void *arg)
                elec_angle,
                elec_speed,
                vbus,
+               ctx.meas.i_bus,
                (int)sm,
                sensor_mode_to_str(sm));
 
+        // Fast-loop perf counters, only when profiling is active
+        PerfSummary_t ps = PerfCounters_getSummary(Control_getFastLoopPerf());
+        if (ps.available && ps.samples > 0) {
+            printf("PERF IPC=%.3f MPKI=%.3f CYC/IT=%.0f CTXSW/S=%.1f\n",
+                   ps.ipc, ps.mpki, ps.cycles_per_iter, ps.ctx_sw_per_s);
+        }
+
+        // Watchdog, only once it has fired
+        WatchdogStats_t ws = Watchdog_getStats();
+        if (ws.trips > 0) {
+            printf("WDOG TRIPS=%u LAT_US=%.1f LAT_MAX_US=%.1f\n",
+                   ws.trips, ws.last_latency_s * 1e6, ws.max_latency_s * 1e6);
+        }
+
         fflush(stdout);
     }
 
@@ -1,8 +1,12 @@
 // udp_server_motor.c
 #include "udp_server.h"
 #include "motor_control.h"
+#include "motor_axis.h"
 #include "motor_states.h"
 #include "position_estimator.h"
+#include "perf_counters.h"
+#include "watchdog.h"
+#include "clock_source.h"
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -10,10 +14,16 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <ctype.h>
-#include <time.h>      // <-- added
+#include <math.h>
 
 #define UDP_PORT        12345
 #define MAX_PACKET_SIZE 1500
+#define FRA_UDP_BINS    16      // result rows per reply
+#define FRA_UDP_SAMPLES 48      // log rows per reply
+
+// Provided by main.c
+extern const PerfCounters_t *Control_getFastLoopPerf(void);
+extern MotorAxis_t *Control_getAxis(void);
 
 static pthread_t server_thread;
 static int sockfd = -1;
@@ -32,14 +42,6 @@ static void to_lower_str(char *s)
     }
 }
 
-// simple local time helper (seconds, monotonic-ish)
-static double get_time_s(void)
-{
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
-}
-
 // ----------------------------------------------------
 // PUBLIC API
 // ----------------------------------------------------
@@ -84,11 +86,15 @@ void UDPServer_cleanup(void)
     if (!running && sockfd < 0) return;
 
     running = 0;
+    if (sockfd >= 0) {
+        // close() alone does not wake a thread blocked in recvfrom()
+        shutdown(sockfd, SHUT_RDWR);
+    }
+    pthread_join(server_thread, NULL);
     if (sockfd >= 0) {
         close(sockfd);
         sockfd = -1;
     }
-    pthread_join(server_thread, NULL);
     printf("Motor UDP server stopped.\n");
 }
 
@@ -108,19 +114,60 @@ static void print_help(struct sockaddr_in* client_addr, socklen_t addr_len)
         "  disable              -- disable motor\n"
         "  set rpm <value>      -- set speed command (0-5000)\n"
         "  set dir <fwd|rev>    -- set direction\n"
+        "  set comm <mode>      -- commutation: six (six-step), sine or foc\n"
         "  status               -- get motor state & telemetry\n"
         "  statusraw            -- CSV: t,rpm_cmd,rpm_mech,torque,vbus,state,fault\n"
+        "  autotune <rpm> [zn|tl] -- relay-tune the speed PI at <rpm> (motor running)\n"
+        "  autotune abort       -- stop a running tune, keep the old gains\n"
+        "  autotune status      -- tune progress / result\n"
+        "  autotune apply       -- give the result's gains to the speed PI\n"
+        "  fra <ref|out> [amp [fmin fmax]] [chirp] [current]\n"
+        "                       -- frequency response at the speed command or the\n"
+        "                          speed-loop output (motor running)\n"
+        "  fra abort            -- stop a running analysis\n"
+        "  fra status           -- analysis progress\n"
+        "  fra result [from]    -- CSV: f_hz,gain,gain_db,phase_deg,u_amp,coherence,ok\n"
+        "  fra log <from> [n]   -- CSV of the raw record: u,y\n"
+        "  ident <rpm>          -- identify R, L, Kv, inertia and friction (motor idle; spins\n"
+        "                          to <rpm>, then coasts), saved to the config file\n"
+        "  ident abort          -- stop, keep the old parameters\n"
+        "  ident status         -- identification progress / result\n"
+        "  hall learn           -- learn the Hall map and edge offsets (motor idle;\n"
+        "                          turns one revolution), saved to the config file\n"
+        "  hall abort           -- stop, keep the old Hall decoding\n"
+        "  hall status          -- Hall learn progress / result\n"
+        "  perf                 -- fast-loop perf counters (IPC, cache misses)\n"
+        "  wdog                 -- fast-loop watchdog trips & response latency\n"
+        "  ack <seq>            -- when command <seq> was applied (tick, latency)\n"
+        "  cmdq                 -- command mailbox counters & latency\n"
         "  stop                 -- shutdown program\n"
         "  help                 -- show this help\n";
     send_response(msg, client_addr, addr_len);
 }
 
+// Reply for a command posted to the control mailbox: OK + its sequence
+// number (for "ack <seq>"), or ERR if the mailbox was full.
+static void send_cmd_result(const char *what, uint32_t seq,
+                            struct sockaddr_in* client_addr,
+                            socklen_t addr_len)
+{
+    char msg[128];
+    if (seq == 0) {
+        snprintf(msg, sizeof(msg), "ERR: command queue full, %s dropped\n", what);
+    } else {
+        snprintf(msg, sizeof(msg), "OK: %s SEQ=%u\n", what, seq);
+    }
+    send_response(msg, client_addr, addr_len);
+}
+
 static void handle_set(struct sockaddr_in* client_addr,
                        socklen_t addr_len,
                        char *arg1)
 {
+    MotorAxis_t *ax = Control_getAxis();
+
     if (!arg1) {
-        send_response("ERR: set <rpm|dir> ...\n", client_addr, addr_len);
+        send_response("ERR: set <rpm|dir|comm> ...\n", client_addr, addr_len);
         return;
     }
 
@@ -139,8 +186,8 @@ static void handle_set(struct sockaddr_in* client_addr,
             send_response(msg, client_addr, addr_len);
             return;
         }
-        MotorControl_setSpeedCmd((float)rpm, MotorControl_getContext().cmd.direction);
-        send_response("OK: rpm updated\n", client_addr, addr_len);
+        uint32_t seq = MotorControl_setSpeedCmd(&ax->ctrl, (float)rpm, MotorControl_getContext(&ax->ctrl).cmd.direction);
+        send_cmd_result("rpm updated", seq, client_addr, addr_len);
         return;
     }
 
@@ -162,22 +209,378 @@ static void handle_set(struct sockaddr_in* client_addr,
             return;
         }
 
-        MotorContext_t ctx = MotorControl_getContext();
+        MotorContext_t ctx = MotorControl_getContext(&ax->ctrl);
         // direction: 0 = fwd, 1 = rev
-        MotorControl_setSpeedCmd(ctx.cmd.rpm_cmd, !forward);
-        send_response("OK: direction updated\n", client_addr, addr_len);
+        uint32_t seq = MotorControl_setSpeedCmd(&ax->ctrl, ctx.cmd.rpm_cmd, !forward);
+        send_cmd_result("direction updated", seq, client_addr, addr_len);
+        return;
+    }
+
+    // SET COMMUTATION -------------------
+    if (strcmp(arg1, "comm") == 0) {
+        char *arg2 = strtok(NULL, " \t\r\n");
+        MotorCommutation_t mode;
+        if (arg2 && (strcmp(arg2, "six") == 0 || strcmp(arg2, "sixstep") == 0)) {
+            mode = MOTOR_COMM_SIX_STEP;
+        }
+        else if (arg2 && strcmp(arg2, "sine") == 0) {
+            mode = MOTOR_COMM_SINE;
+        }
+        else if (arg2 && strcmp(arg2, "foc") == 0) {
+            mode = MOTOR_COMM_FOC;
+        } else {
+            send_response("ERR: set comm <six|sine|foc>\n", client_addr, addr_len);
+            return;
+        }
+        if (mode != MOTOR_COMM_SIX_STEP && !(ax->pwm && ax->pwm->polarity_ok)) {
+            send_response("ERR: sinusoidal / FOC need PWM polarity control\n", client_addr, addr_len);
+            return;
+        }
+        if (mode == MOTOR_COMM_FOC && !ax->ctrl.cur_loop) {
+            send_response("ERR: FOC needs the current loop (current sensing)\n", client_addr, addr_len);
+            return;
+        }
+        uint32_t seq = MotorControl_setCommutation(&ax->ctrl, mode);
+        send_cmd_result("commutation updated", seq, client_addr, addr_len);
         return;
     }
 
     send_response("ERR: unknown set command\n", client_addr, addr_len);
 }
 
+static void handle_autotune(struct sockaddr_in* client_addr,
+                            socklen_t addr_len,
+                            char *arg1)
+{
+    MotorAxis_t *ax = Control_getAxis();
+
+    // AUTOTUNE STATUS -------------------
+    if (!arg1 || strcmp(arg1, "status") == 0) {
+        MotorTuneStatus_t ts = MotorControl_getContext(&ax->ctrl).tune;
+        char msg[256];
+        snprintf(msg, sizeof(msg),
+                 "TUNE STATE=%s ABORT=%s RULE=%s CYCLES=%d "
+                 "KU=%.4g PU_S=%.4f KP=%.4g KI=%.4g APPLIED=%d\n",
+                 RelayTuner_stateName((RelayTuneState_t)ts.state),
+                 RelayTuner_abortName((RelayAbort_t)ts.abort),
+                 RelayTuner_ruleName((RelayTuneRule_t)ts.rule),
+                 ts.cycles,
+                 ts.ku,
+                 ts.pu_s,
+                 ts.kp,
+                 ts.ki,
+                 ts.applied ? 1 : 0);
+        send_response(msg, client_addr, addr_len);
+        return;
+    }
+
+    // AUTOTUNE ABORT --------------------
+    if (strcmp(arg1, "abort") == 0) {
+        uint32_t seq = MotorControl_abortAutotune(&ax->ctrl);
+        send_cmd_result("autotune abort", seq, client_addr, addr_len);
+        return;
+    }
+
+    // AUTOTUNE APPLY --------------------
+    if (strcmp(arg1, "apply") == 0) {
+        if (MotorControl_getContext(&ax->ctrl).tune.state != RELAY_TUNE_DONE) {
+            send_response("ERR: no autotune result to apply\n", client_addr, addr_len);
+            return;
+        }
+        uint32_t seq = MotorControl_applyAutotune(&ax->ctrl);
+        send_cmd_result("autotune applied", seq, client_addr, addr_len);
+        return;
+    }
+
+    // AUTOTUNE <RPM> [RULE] -------------
+    char *end = NULL;
+    long rpm = strtol(arg1, &end, 10);
+    if (end == arg1 || rpm <= 0 || rpm > MOTOR_RPM_MAX) {
+        char msg[128];
+        snprintf(msg, sizeof(msg),
+                 "ERR: autotune <1-%d> [zn|tl] | abort | status | apply\n", (int)MOTOR_RPM_MAX);
+        send_response(msg, client_addr, addr_len);
+        return;
+    }
+
+    RelayTuneRule_t rule = RELAY_TUNE_ZN;
+    char *arg2 = strtok(NULL, " \t\r\n");
+    if (arg2 && strcmp(arg2, "tl") == 0) {
+        rule = RELAY_TUNE_TL;
+    } else if (arg2 && strcmp(arg2, "zn") != 0) {
+        send_response("ERR: autotune rule must be zn|tl\n", client_addr, addr_len);
+        return;
+    }
+    if (MotorControl_getContext(&ax->ctrl).state != MOTOR_STATE_RUN) {
+        send_response("ERR: autotune needs the motor running\n", client_addr, addr_len);
+        return;
+    }
+
+    uint32_t seq = MotorControl_startAutotune(&ax->ctrl, (float)rpm, rule);
+    send_cmd_result("autotune started", seq, client_addr, addr_len);
+}
+
+static void handle_ident(struct sockaddr_in* client_addr,
+                         socklen_t addr_len,
+                         char *arg1)
+{
+    MotorAxis_t *ax = Control_getAxis();
+
+    // IDENT STATUS ----------------------
+    if (!arg1 || strcmp(arg1, "status") == 0) {
+        MotorIdentStatus_t is = MotorControl_getContext(&ax->ctrl).ident;
+        char msg[256];
+        snprintf(msg, sizeof(msg),
+                 "IDENT PHASE=%s ABORT=%s RUNS=%d R=%.4f L=%.3g KV=%.1f J=%.3g F=%.3g\n",
+                 ParamIdent_phaseName((ParamIdentPhase_t)is.phase),
+                 ParamIdent_abortName((ParamIdentAbort_t)is.abort),
+                 is.runs,
+                 is.r_phase_ohm,
+                 is.l_phase_h,
+                 is.kv_rpm_per_v,
+                 is.inertia_kgm2,
+                 is.friction_nm);
+        send_response(msg, client_addr, addr_len);
+        return;
+    }
+
+    // IDENT ABORT -----------------------
+    if (strcmp(arg1, "abort") == 0) {
+        uint32_t seq = MotorControl_abortIdent(&ax->ctrl);
+        send_cmd_result("ident abort", seq, client_addr, addr_len);
+        return;
+    }
+
+    // IDENT <RPM> -----------------------
+    char *end = NULL;
+    long rpm = strtol(arg1, &end, 10);
+    if (end == arg1 || rpm <= 0 || rpm > MOTOR_RPM_MAX) {
+        char msg[128];
+        snprintf(msg, sizeof(msg),
+                 "ERR: ident <1-%d> | abort | status\n", (int)MOTOR_RPM_MAX);
+        send_response(msg, client_addr, addr_len);
+        return;
+    }
+    if (MotorControl_getContext(&ax->ctrl).state != MOTOR_STATE_IDLE) {
+        send_response("ERR: ident needs the motor idle\n", client_addr, addr_len);
+        return;
+    }
+
+    uint32_t seq = MotorControl_startIdent(&ax->ctrl, (float)rpm);
+    send_cmd_result("ident started", seq, client_addr, addr_len);
+}
+
+static void handle_hall(struct sockaddr_in* client_addr,
+                        socklen_t addr_len,
+                        char *arg1)
+{
+    MotorAxis_t *ax = Control_getAxis();
+
+    // HALL STATUS -----------------------
+    if (!arg1 || strcmp(arg1, "status") == 0) {
+        MotorHallLearnStatus_t hs = MotorControl_getContext(&ax->ctrl).hall;
+        char msg[256];
+        snprintf(msg, sizeof(msg),
+                 "HALL STATE=%s FAIL=%s RUNS=%d MAP=%d,%d,%d,%d,%d,%d "
+                 "OFF=%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+                 HallLearn_stateName((HallLearnState_t)hs.state),
+                 HallLearn_failName((HallLearnFail_t)hs.fail),
+                 hs.runs,
+                 hs.code[0], hs.code[1], hs.code[2],
+                 hs.code[3], hs.code[4], hs.code[5],
+                 hs.offset_deg[0], hs.offset_deg[1], hs.offset_deg[2],
+                 hs.offset_deg[3], hs.offset_deg[4], hs.offset_deg[5]);
+        send_response(msg, client_addr, addr_len);
+        return;
+    }
+
+    // HALL ABORT ------------------------
+    if (strcmp(arg1, "abort") == 0) {
+        uint32_t seq = MotorControl_abortHallLearn(&ax->ctrl);
+        send_cmd_result("hall abort", seq, client_addr, addr_len);
+        return;
+    }
+
+    // HALL LEARN ------------------------
+    if (strcmp(arg1, "learn") != 0) {
+        send_response("ERR: hall learn | abort | status\n", client_addr, addr_len);
+        return;
+    }
+    if (MotorControl_getContext(&ax->ctrl).state != MOTOR_STATE_IDLE) {
+        send_response("ERR: hall learn needs the motor idle\n", client_addr, addr_len);
+        return;
+    }
+
+    uint32_t seq = MotorControl_startHallLearn(&ax->ctrl);
+    send_cmd_result("hall learn started", seq, client_addr, addr_len);
+}
+
+static void handle_fra(struct sockaddr_in* client_addr,
+                       socklen_t addr_len,
+                       char *arg1)
+{
+    MotorAxis_t *ax = Control_getAxis();
+    char msg[MAX_PACKET_SIZE];
+
+    // FRA STATUS ------------------------
+    if (!arg1 || strcmp(arg1, "status") == 0) {
+        MotorFraStatus_t fs = MotorControl_getContext(&ax->ctrl).fra;
+        snprintf(msg, sizeof(msg),
+                 "FRA STATE=%s EXC=%s POINT=%s RESP=%s PROGRESS=%d/%d BINS=%d\n",
+                 FreqResp_stateName((FraState_t)fs.state),
+                 FreqResp_excName((FraExcitation_t)fs.exc),
+                 (fs.point == MOTOR_FRA_OUTPUT) ? "out" : "ref",
+                 (fs.response == MOTOR_FRA_RESP_CURRENT) ? "current" : "speed",
+                 fs.progress,
+                 fs.samples,
+                 fs.bins);
+        send_response(msg, client_addr, addr_len);
+        return;
+    }
+
+    // FRA ABORT -------------------------
+    if (strcmp(arg1, "abort") == 0) {
+        uint32_t seq = MotorControl_abortFra(&ax->ctrl);
+        send_cmd_result("fra abort", seq, client_addr, addr_len);
+        return;
+    }
+
+    // FRA RESULT [FROM] -----------------
+    if (strcmp(arg1, "result") == 0) {
+        char *arg2 = strtok(NULL, " \t\r\n");
+        int   from = arg2 ? atoi(arg2) : 0;
+        FraBin_t bins[FRA_MAX_BINS];
+        int n = MotorControl_getFraResult(&ax->ctrl, bins, FRA_MAX_BINS);
+        if (n < 0) {
+            send_response("ERR: fra running\n", client_addr, addr_len);
+            return;
+        }
+        if (from < 0) from = 0;
+        int to = (from + FRA_UDP_BINS < n) ? from + FRA_UDP_BINS : n;
+
+        int len = snprintf(msg, sizeof(msg), "FRA RESULT FROM=%d N=%d TOTAL=%d\n",
+                           from, (to > from) ? to - from : 0, n);
+        for (int i = from; i < to; i++) {
+            const FraBin_t *b = &bins[i];
+            float db = (b->gain > 0.0f) ? 20.0f * log10f(b->gain) : -999.0f;
+            len += snprintf(msg + len, sizeof(msg) - (size_t)len,
+                            "%.3f,%.5g,%.2f,%.1f,%.4g,%.3f,%d\n",
+                            b->f_hz, b->gain, db, b->phase_deg, b->u_amp,
+                            b->coherence, b->ok ? 1 : 0);
+        }
+        send_response(msg, client_addr, addr_len);
+        return;
+    }
+
+    // FRA LOG <FROM> [N] ----------------
+    if (strcmp(arg1, "log") == 0) {
+        char *arg2 = strtok(NULL, " \t\r\n");
+        char *arg3 = strtok(NULL, " \t\r\n");
+        int from  = arg2 ? atoi(arg2) : 0;
+        int count = arg3 ? atoi(arg3) : FRA_UDP_SAMPLES;
+        if (from < 0 || count <= 0) {
+            send_response("ERR: fra log <from> [n]\n", client_addr, addr_len);
+            return;
+        }
+        if (count > FRA_UDP_SAMPLES) count = FRA_UDP_SAMPLES;
+
+        float u[FRA_UDP_SAMPLES], y[FRA_UDP_SAMPLES];
+        int n = MotorControl_getFraLog(&ax->ctrl, from, count, u, y);
+        if (n < 0) {
+            send_response("ERR: fra running\n", client_addr, addr_len);
+            return;
+        }
+        int len = snprintf(msg, sizeof(msg), "FRA LOG FROM=%d N=%d\n", from, n);
+        for (int i = 0; i < n; i++) {
+            len += snprintf(msg + len, sizeof(msg) - (size_t)len, "%.5g,%.5g\n", u[i], y[i]);
+        }
+        send_response(msg, client_addr, addr_len);
+        return;
+    }
+
+    // FRA <REF|OUT> [AMP [FMIN FMAX]] [CHIRP] [CURRENT]
+    MotorFraPoint_t point;
+    if (strcmp(arg1, "ref") == 0) {
+        point = MOTOR_FRA_SPEED_REF;
+    } else if (strcmp(arg1, "out") == 0) {
+        point = MOTOR_FRA_OUTPUT;
+    } else {
+        send_response("ERR: fra <ref|out> [amp [fmin fmax]] [chirp] [current] "
+                      "| abort | status | result | log\n", client_addr, addr_len);
+        return;
+    }
+
+    MotorContext_t ctx = MotorControl_getContext(&ax->ctrl);
+    FraConfig_t cfg = {
+        .exc       = FRA_EXC_MULTISINE,
+        .amplitude = (point == MOTOR_FRA_SPEED_REF) ? FRA_AMP_RPM
+                   : ax->ctrl.cur_loop              ? FRA_AMP_A : FRA_AMP_DUTY,
+        .f_min_hz  = FRA_F_MIN_HZ,
+        .f_max_hz  = FRA_F_MAX_HZ,
+        .bins      = FRA_BINS,
+        .samples   = FRA_SAMPLES,
+        .periods   = FRA_PERIODS,
+        .settle    = FRA_SETTLE_SAMPLES,
+        .fs_hz     = (float)SPEED_LOOP_HZ,
+        .coherence_min = FRA_COHERENCE_MIN,
+    };
+    MotorFraResponse_t resp = MOTOR_FRA_RESP_SPEED;
+
+    // Numbers in order (amp, fmin, fmax), keywords anywhere
+    float num[3];
+    int   nnum = 0;
+    char *arg;
+    while ((arg = strtok(NULL, " \t\r\n")) != NULL) {
+        char *end = NULL;
+        float v = strtof(arg, &end);
+        if (end != arg && *end == '\0' && nnum < 3) {
+            num[nnum++] = v;
+        } else if (strcmp(arg, "chirp") == 0) {
+            cfg.exc = FRA_EXC_CHIRP;
+        } else if (strcmp(arg, "multisine") == 0) {
+            cfg.exc = FRA_EXC_MULTISINE;
+        } else if (strcmp(arg, "current") == 0) {
+            resp = MOTOR_FRA_RESP_CURRENT;
+        } else if (strcmp(arg, "speed") == 0) {
+            resp = MOTOR_FRA_RESP_SPEED;
+        } else {
+            snprintf(msg, sizeof(msg), "ERR: fra: unexpected '%s'\n", arg);
+            send_response(msg, client_addr, addr_len);
+            return;
+        }
+    }
+    if (nnum == 2) {
+        send_response("ERR: fra needs both fmin and fmax\n", client_addr, addr_len);
+        return;
+    }
+    if (nnum >= 1) cfg.amplitude = num[0];
+    if (nnum == 3) {
+        cfg.f_min_hz = num[1];
+        cfg.f_max_hz = num[2];
+    }
+
+    const char *why = NULL;
+    if (!FreqResp_configValid(&cfg, &why)) {
+        snprintf(msg, sizeof(msg), "ERR: fra: %s\n", why);
+        send_response(msg, client_addr, addr_len);
+        return;
+    }
+    if (ctx.state != MOTOR_STATE_RUN) {
+        send_response("ERR: fra needs the motor running\n", client_addr, addr_len);
+        return;
+    }
+
+    uint32_t seq = MotorControl_startFra(&ax->ctrl, &cfg, point, resp);
+    send_cmd_result("fra started", seq, client_addr, addr_len);
+}
+
 // ----------------------------------------------------
 // UDP THREAD
 // ----------------------------------------------------
 static void* udp_thread_func(void* arg)
 {
     (void)arg;
+    MotorAxis_t *ax = Control_getAxis();
     char buffer[MAX_PACKET_SIZE];
     struct sockaddr_in client_addr;
     socklen_t addr_len = sizeof(client_addr);
@@ -185,8 +588,8 @@ static void* udp_thread_func(void* arg)
     while (running) {
         ssize_t bytes = recvfrom(sockfd, buffer, sizeof(buffer)-1, 0,
                                  (struct sockaddr*)&client_addr, &addr_len);
-        if (bytes < 0) {
-            if (running) perror("recvfrom");
+        if (bytes < 0 || !running) {
+            if (bytes < 0 && running) perror("recvfrom");
             break;
         }
 
@@ -210,52 +613,154 @@ static void* udp_thread_func(void* arg)
             print_help(&client_addr, addr_len);
         }
         else if (strcmp(tok, "enable") == 0) {
-            MotorControl_setEnable(true);
-            send_response("OK: motor enabled\n", &client_addr, addr_len);
+            uint32_t seq = MotorControl_setEnable(&ax->ctrl, true);
+            send_cmd_result("motor enabled", seq, &client_addr, addr_len);
         }
         else if (strcmp(tok, "disable") == 0) {
-            MotorControl_setEnable(false);
-            send_response("OK: motor disabled\n", &client_addr, addr_len);
+            uint32_t seq = MotorControl_setEnable(&ax->ctrl, false);
+            send_cmd_result("motor disabled", seq, &client_addr, addr_len);
         }
         else if (strcmp(tok, "set") == 0) {
             char *arg1 = strtok(NULL, " \t\r\n");
             handle_set(&client_addr, addr_len, arg1);
         }
+        else if (strcmp(tok, "autotune") == 0) {
+            char *arg1 = strtok(NULL, " \t\r\n");
+            handle_autotune(&client_addr, addr_len, arg1);
+        }
+        else if (strcmp(tok, "fra") == 0) {
+            char *arg1 = strtok(NULL, " \t\r\n");
+            handle_fra(&client_addr, addr_len, arg1);
+        }
+        else if (strcmp(tok, "ident") == 0) {
+            char *arg1 = strtok(NULL, " \t\r\n");
+            handle_ident(&client_addr, addr_len, arg1);
+        }
+        else if (strcmp(tok, "hall") == 0) {
+            char *arg1 = strtok(NULL, " \t\r\n");
+            handle_hall(&client_addr, addr_len, arg1);
+        }
         else if (strcmp(tok, "status") == 0) {
-            MotorContext_t ctx = MotorControl_getContext();
-            PosEst_t pe = PosEst_get();
+            MotorContext_t ctx = MotorControl_getContext(&ax->ctrl);
+            PosEst_t pe = PosEst_get(&ax->pos);
             char msg[256];
             snprintf(msg, sizeof(msg),
                      "STATE=%d FAULT=%d "
                      "RPM=%.1f CMD=%.1f DUTY=%.3f "
-                     "SECTOR=%u DIR=%d VBUS=%.2f\n",
+                     "SECTOR=%u DIR=%d COMM=%s VBUS=%.2f IBUS=%.2f "
+                     "KP=%.4g KI=%.4g LOAD=%.4f\n",
                      ctx.state,
                      ctx.fault,
                      ctx.meas.rpm_mech,
                      ctx.cmd.rpm_cmd,
-                     ctx.cmd.torque_cmd,
+                     ctx.cmd.duty,
                      pe.sector,
                      ctx.cmd.direction,
-                     ctx.meas.v_bus);
+                     (ctx.cmd.commutation == MOTOR_COMM_FOC)  ? "FOC" :
+                     (ctx.cmd.commutation == MOTOR_COMM_SINE) ? "SINE" : "SIX",
+                     ctx.meas.v_bus,
+                     ctx.meas.i_bus,
+                     ctx.cmd.speed_kp,
+                     ctx.cmd.speed_ki,
+                     ctx.meas.load_nm);
             send_response(msg, &client_addr, addr_len);
         }
         else if (strcmp(tok, "statusraw") == 0) {
             // CSV log: t,rpm_cmd,rpm_mech,torque_cmd,v_bus,state,fault
-            double t   = get_time_s();
-            MotorContext_t ctx = MotorControl_getContext();
+            double t   = Clock_nowS();   // same timebase as the control loops
+            MotorContext_t ctx = MotorControl_getContext(&ax->ctrl);
 
             char msg[256];
             snprintf(msg, sizeof(msg),
                      "%.6f,%.3f,%.3f,%.3f,%.3f,%d,%d\n",
                      t,
-                     ctx.cmd.rpm_cmd,      // internal slewed command
+                     ctx.cmd.rpm_cmd,      // internal trajectory command
                      ctx.meas.rpm_mech,    // measured RPM
-                     ctx.cmd.torque_cmd,   // PI output / duty
+                     ctx.cmd.torque_cmd,   // speed PI output (duty, or A with the current loop)
                      ctx.meas.v_bus,       // bus voltage
                      ctx.state,
                      ctx.fault);
             send_response(msg, &client_addr, addr_len);
         }
+        else if (strcmp(tok, "perf") == 0) {
+            PerfSummary_t ps = PerfCounters_getSummary(Control_getFastLoopPerf());
+            char msg[256];
+            if (!ps.available) {
+                snprintf(msg, sizeof(msg), "PERF=unavailable\n");
+            } else {
+                snprintf(msg, sizeof(msg),
+                         "PERF MASK=0x%02X SAMPLES=%u "
+                         "IPC=%.3f IPC_MIN=%.3f MPKI=%.3f MPKI_MAX=%.3f "
+                         "MISS/IT=%.2f CYC/IT=%.0f CTXSW/S=%.1f "
+                         "HW_RUN=%.2f HW_DROP=%u\n",
+                         ps.counter_mask,
+                         ps.samples,
+                         ps.ipc,
+                         ps.ipc_min,
+                         ps.mpki,
+                         ps.mpki_max,
+                         ps.misses_per_iter,
+                         ps.cycles_per_iter,
+                         ps.ctx_sw_per_s,
+                         ps.hw_running,
+                         ps.hw_dropped);
+            }
+            send_response(msg, &client_addr, addr_len);
+        }
+        else if (strcmp(tok, "wdog") == 0) {
+            WatchdogStats_t ws = Watchdog_getStats();
+            char msg[256];
+            snprintf(msg, sizeof(msg),
+                     "WDOG TRIPS=%u TRIPPED=%d MAX_MISSED=%u KICKS=%llu "
+                     "LAT_US=%.1f LAT_MIN_US=%.1f LAT_MAX_US=%.1f\n",
+                     ws.trips,
+                     ws.tripped ? 1 : 0,
+                     ws.max_missed,
+                     (unsigned long long)ws.kicks,
+                     ws.last_latency_s * 1e6,
+                     ws.min_latency_s * 1e6,
+                     ws.max_latency_s * 1e6);
+            send_response(msg, &client_addr, addr_len);
+        }
+        else if (strcmp(tok, "ack") == 0) {
+            char *arg1 = strtok(NULL, " \t\r\n");
+            if (!arg1) {
+                send_response("ERR: ack <seq>\n", &client_addr, addr_len);
+                continue;
+            }
+            uint32_t seq = (uint32_t)strtoul(arg1, NULL, 10);
+            MotorCmdAck_t ack;
+            char msg[256];
+            if (MotorControl_getCmdAck(&ax->ctrl, seq, &ack)) {
+                snprintf(msg, sizeof(msg),
+                         "ACK SEQ=%u TYPE=%d TICK=%u LAT_US=%.1f\n",
+                         ack.seq,
+                         (int)ack.type,
+                         ack.tick,
+                         (double)(ack.applied_ns - ack.posted_ns) / 1e3);
+            } else {
+                MotorCmdStats_t cs = MotorControl_getCmdStats(&ax->ctrl);
+                snprintf(msg, sizeof(msg), "ACK SEQ=%u %s\n", seq,
+                         (seq > cs.last_seq) ? "PENDING" : "EXPIRED");
+            }
+            send_response(msg, &client_addr, addr_len);
+        }
+        else if (strcmp(tok, "cmdq") == 0) {
+            MotorCmdStats_t cs = MotorControl_getCmdStats(&ax->ctrl);
+            char msg[256];
+            snprintf(msg, sizeof(msg),
+                     "CMDQ POSTED=%u APPLIED=%u DROPPED=%u LAST_SEQ=%u LAST_TICK=%u "
+                     "LAT_US=%.1f LAT_MEAN_US=%.1f LAT_MAX_US=%.1f\n",
+                     cs.posted,
+                     cs.applied,
+                     cs.dropped,
+                     cs.last_seq,
+                     cs.last_tick,
+                     cs.last_latency_s * 1e6,
+                     cs.mean_latency_s * 1e6,
+                     cs.max_latency_s * 1e6);
+            send_response(msg, &client_addr, addr_len);
+        }
         else if (strcmp(tok, "stop") == 0) {
             send_response("OK: shutdown requested\n", &client_addr, addr_len);
             g_stopRequested = 1;
@@ -0,0 +1,208 @@
+// watchdog.c
+#include "watchdog.h"
+#include "motor_config.h"
+#include "motor_control.h"
+#include "rt_alloc_guard.h"
+#include "timer.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+static pthread_t          s_thread;
+static int                s_timer_fd = -1;
+static atomic_int         s_running;
+static PwmMotorSafeStop_t s_safe_stop;
+static MotorControl_t     *s_mc;
+
+// Heartbeat written by the fast loop every tick, on a cache line of its
+// own (the struct is aligned and padded to a full line).
+static struct {
+    _Alignas(CACHE_LINE_BYTES)
+    atomic_uint_fast64_t count;
+    atomic_int_fast64_t  time_ns;
+} s_kick;
+
+// Stats are only written by the watchdog thread; readers take the mutex
+// (never the fast loop).
+static pthread_mutex_t s_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static WatchdogStats_t s_stats;
+
+// Kick and check times come from timer_now_ns(), not Clock_nowNs(): the
+// watchdog guards real-time deadlines and is paced by a CLOCK_MONOTONIC
+// timerfd, so it must not follow a virtual clock installed for the loops.
+void Watchdog_kick(void)
+{
+    atomic_store_explicit(&s_kick.time_ns, timer_now_ns(), memory_order_relaxed);
+    atomic_fetch_add_explicit(&s_kick.count, 1, memory_order_release);
+}
+
+void Watchdog_disarm(void)
+{
+    atomic_store_explicit(&s_kick.count, 0, memory_order_release);
+}
+
+static void trip(TimeNs_t deadline_ns)
+{
+    // Bridge off first, bookkeeping after
+    PwmMotor_safeStop(&s_safe_stop);
+    TimeNs_t t_done = timer_now_ns();
+
+    if (s_mc) {
+        MotorControl_requestFault(s_mc, MOTOR_FAULT_TIMING);
+    }
+
+    double latency_s = (double)(t_done - deadline_ns) * 1e-9;
+
+    pthread_mutex_lock(&s_stats_lock);
+    s_stats.trips++;
+    s_stats.tripped        = true;
+    s_stats.last_latency_s = latency_s;
+    if (s_stats.trips == 1 || latency_s < s_stats.min_latency_s) {
+        s_stats.min_latency_s = latency_s;
+    }
+    if (latency_s > s_stats.max_latency_s) {
+        s_stats.max_latency_s = latency_s;
+    }
+    pthread_mutex_unlock(&s_stats_lock);
+
+    fprintf(stderr,
+            "WATCHDOG: fast loop missed %d deadlines, outputs forced off "
+            "(latency %.1f us)\n",
+            WATCHDOG_MISSED_DEADLINES, latency_s * 1e6);
+}
+
+static void *watchdog_thread_func(void *arg)
+{
+    (void)arg;
+
+    struct sched_param sp;
+    memset(&sp, 0, sizeof(sp));
+    sp.sched_priority = WATCHDOG_THREAD_PRIO;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) != 0) {
+        perror("Watchdog: pthread_setschedparam (SCHED_FIFO) failed; running non-RT");
+    }
+
+    const TimeNs_t Ts_ns = TIME_NS_PER_S / FAST_LOOP_HZ;
+    uint64_t       last_count = 0;
+
+    RtAllocGuard_enterRt();
+
+    while (atomic_load(&s_running)) {
+        uint64_t expirations;
+        if (read(s_timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+            continue;   // EINTR, or fd closed during shutdown
+        }
+
+        uint64_t count = atomic_load_explicit(&s_kick.count, memory_order_acquire);
+        if (count == 0) {
+            last_count = 0;
+            continue;   // fast loop not started (or disarmed): nothing to watch
+        }
+
+        if (count != last_count) {
+            // Alive again: re-arm (the motor fault stays latched until cleared)
+            last_count = count;
+            pthread_mutex_lock(&s_stats_lock);
+            s_stats.tripped = false;
+            s_stats.kicks   = count;
+            pthread_mutex_unlock(&s_stats_lock);
+            continue;
+        }
+
+        TimeNs_t t_kick = atomic_load_explicit(&s_kick.time_ns, memory_order_relaxed);
+        TimeNs_t t_now  = timer_now_ns();
+        uint32_t missed = (uint32_t)((t_now - t_kick) / Ts_ns);
+
+        pthread_mutex_lock(&s_stats_lock);
+        bool already = s_stats.tripped;
+        if (missed > s_stats.max_missed) {
+            s_stats.max_missed = missed;
+        }
+        pthread_mutex_unlock(&s_stats_lock);
+
+        if (!already && missed >= WATCHDOG_MISSED_DEADLINES) {
+            trip(t_kick + (TimeNs_t)WATCHDOG_MISSED_DEADLINES * Ts_ns);
+        }
+    }
+
+    return NULL;
+}
+
+bool Watchdog_init(const PwmMotor_t *pwm, MotorControl_t *mc)
+{
+    if (atomic_load(&s_running)) {
+        return true;
+    }
+
+    s_mc = mc;
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    atomic_store(&s_kick.count, 0);
+    atomic_store(&s_kick.time_ns, 0);
+
+    if (!pwm || !PwmMotor_safeStopOpen(&s_safe_stop, pwm)) {
+        fprintf(stderr, "Watchdog: safe-stop path unavailable; will only latch faults\n");
+    }
+
+    s_timer_fd = timerfd_create(CLOCK_MONOTONIC, 0);
+    if (s_timer_fd < 0) {
+        perror("Watchdog: timerfd_create");
+        PwmMotor_safeStopClose(&s_safe_stop);
+        return false;
+    }
+
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_interval.tv_nsec = (long)WATCHDOG_PERIOD_US * 1000L;
+    its.it_value            = its.it_interval;
+    if (timerfd_settime(s_timer_fd, 0, &its, NULL) != 0) {
+        perror("Watchdog: timerfd_settime");
+        close(s_timer_fd);
+        s_timer_fd = -1;
+        PwmMotor_safeStopClose(&s_safe_stop);
+        return false;
+    }
+
+    atomic_store(&s_running, 1);
+    if (pthread_create(&s_thread, NULL, watchdog_thread_func, NULL) != 0) {
+        perror("Watchdog: pthread_create");
+        atomic_store(&s_running, 0);
+        close(s_timer_fd);
+        s_timer_fd = -1;
+        PwmMotor_safeStopClose(&s_safe_stop);
+        return false;
+    }
+
+    printf("Fast-loop watchdog started (%d us period, trip after %d missed deadlines).\n",
+           WATCHDOG_PERIOD_US, WATCHDOG_MISSED_DEADLINES);
+    return true;
+}
+
+void Watchdog_cleanup(void)
+{
+    if (!atomic_load(&s_running)) {
+        return;
+    }
+
+    // The timer keeps firing, so the thread notices within one period
+    atomic_store(&s_running, 0);
+    pthread_join(s_thread, NULL);
+
+    close(s_timer_fd);
+    s_timer_fd = -1;
+    PwmMotor_safeStopClose(&s_safe_stop);
+    printf("Fast-loop watchdog stopped.\n");
+}
+
+WatchdogStats_t Watchdog_getStats(void)
+{
+    pthread_mutex_lock(&s_stats_lock);
+    WatchdogStats_t out = s_stats;
+    pthread_mutex_unlock(&s_stats_lock);
+    return out;
+}
@@ -26,6 +26,8 @@
 //   BEMF_CH_V   --> DRV8302 EMF-B output (phase V back-EMF, attenuated by 5.1/73.1)
 //   BEMF_CH_W   --> DRV8302 EMF-C output (phase W back-EMF, attenuated by 5.1/73.1)
 //   BEMF_CH_VBUS--> DRV8302 VPD_D-O output (bus voltage, attenuated by 5.1/73.1)
+//   ISENSE_CH_U --> DRV8302 SO1 (phase U low-side shunt amplifier)
+//   ISENSE_CH_V --> DRV8302 SO2 (phase V low-side shunt amplifier)
 //
 // Notes:
 //   - All numeric offsets and channels are defined below as macros
@@ -43,9 +45,13 @@
 #define MOTOR_KV_RPM_PER_V          1000.0f     // user‑tunable
 #define MOTOR_R_PHASE_OHM           0.30f       // phase‑to‑phase/2
 #define MOTOR_L_PHASE_H             0.0001f     // approximate
+#define MOTOR_INERTIA_KGM2          2.0e-5f     // rotor plus load (acceleration feedforward)
+#define MOTOR_FRICTION_NM           2.0e-3f     // friction torque while turning (load observer)
 
 // --- Operating limits ---
 #define MOTOR_I_MAX_A               10.0f
+#define MOTOR_OC_TRIP_US            100.0f      // |i_phase| > MOTOR_I_MAX_A this long -> OVERCURRENT
+#define MOTOR_I_LIMIT_FRAC          0.8f        // cycle-by-cycle limit, fraction of MOTOR_I_MAX_A
 #define MOTOR_BUS_V_MAX_V           40.0f
 #define MOTOR_BUS_V_MIN_V           8.0f
 #define MOTOR_RPM_MAX               5000.0f
@@ -59,9 +65,135 @@
 #define CONTROL_LOOP_HZ             FAST_LOOP_HZ
 #define SPEED_LOOP_HZ               SLOW_LOOP_HZ
 
+// Inner current loop (needs phase current sensing): the speed PI commands
+// a current; bandwidth 0 = the speed PI drives the duty directly
+#define CURRENT_LOOP_BW_HZ          1000.0f     // closed-loop bandwidth
+#define CURRENT_LOOP_VBUS_NOM_V     12.0f       // assumed until Vbus is measured
+#define CURRENT_LOOP_VBUS_HYST_V    0.25f       // republish Vbus to the fast loop on this change
+
+// Speed feedforward (duty mode): the BEMF duty at rpm_cmd plus part of
+// the measured IR drop
+#define SPEED_FF_ENABLE             1
+#define SPEED_FF_IR_GAIN            0.5f        // < 1, or the current is undamped
+
+// Speed trajectory: jerk-limited S-curve to the requested speed (jerk 0 =
+// constant-rate ramp); TRAJ_ACCEL_FF feeds the planned J * alpha forward
+#define TRAJ_ACCEL_MAX_RPM_S        4000.0f
+#define TRAJ_JERK_MAX_RPM_S2        40000.0f    // full acceleration in 0.1 s
+#define TRAJ_ACCEL_FF               1
+
+// Load-torque observer (current loop only), fed forward in place of the
+// speed PI's integral; 0 = off
+#define LOAD_OBS_BW_HZ              6.0f
+
+// Speed PI gain schedules, "rpm:kp:ki, ..." interpolated on speed (empty =
+// fixed gains); duty-mode gains also scaled by VBUS_REF / Vbus if > 0
+#define SPEED_PI_SCHED_MAX_POINTS   8
+#define SPEED_PI_SCHED_DUTY         "300:0.003:0.03, 800:0.002:0.01, 1200:0.0015:0.0005"
+#define SPEED_PI_SCHED_CURRENT      ""
+#define SPEED_PI_SCHED_VBUS_REF     12.0f
+
+// Relay autotune of the speed PI (UDP "autotune"): the relay swings the
+// speed-loop output by +/- AUTOTUNE_RELAY_DUTY (duty mode) or
+// AUTOTUNE_RELAY_A (current loop) around the output in force. The run is
+// aborted, and the old gains kept, if the speed leaves the setpoint by
+// more than AUTOTUNE_BAND_FRAC or no result comes within the timeout.
+#define AUTOTUNE_RELAY_DUTY         0.05f
+#define AUTOTUNE_RELAY_A            0.5f
+#define AUTOTUNE_HYST_RPM           40.0f    // above the filtered Hall speed's noise
+#define AUTOTUNE_BAND_FRAC          0.30f
+#define AUTOTUNE_SKIP_CYCLES        2        // let the limit cycle settle
+#define AUTOTUNE_CYCLES             4        // averaged
+#define AUTOTUNE_TIMEOUT_S          5.0f
+
+// Frequency-response analysis (UDP "fra"): excitation period in slow ticks
+// (power of two, <= FRA_MAX_SAMPLES), periods averaged, amplitude per point
+#define FRA_SAMPLES                 2048     // 2 s at 1 kHz, 0.49 Hz resolution
+#define FRA_PERIODS                 4
+#define FRA_SETTLE_SAMPLES          1024
+#define FRA_BINS                    12
+#define FRA_F_MIN_HZ                0.5f
+#define FRA_F_MAX_HZ                30.0f    // well below the Hall edge rate
+#define FRA_AMP_RPM                 100.0f   // at the speed command
+#define FRA_AMP_DUTY                0.03f    // at the output, duty mode
+#define FRA_AMP_A                   0.3f     // at the output, current loop
+#define FRA_COHERENCE_MIN           0.9f     // period-to-period; bins below are flagged
+
+// Parameter identification (UDP "ident", current loop, PWM_MODULATION 3):
+// R and L at standstill, Kv and friction at IDENT_RPM, J from the coast
+#define IDENT_I_LO_A                1.0f
+#define IDENT_I_HI_A                3.0f
+#define IDENT_V_RAMP_V_S            20.0f    // toward each level
+#define IDENT_HOLD_S                0.25f
+#define IDENT_DECAY_S               0.02f
+#define IDENT_STEP_FRAC             0.6f
+#define IDENT_STEP_MAX_S            0.01f
+#define IDENT_RPM                   800.0f
+#define IDENT_SETTLE_S              1.0f     // at the test speed, before the hold
+#define IDENT_HOLD_RPM_S            0.5f     // current / voltage / speed averaged
+#define IDENT_COAST_SKIP_S          0.02f    // winding current dies out first
+#define IDENT_COAST_END_FRAC        0.75f
+#define IDENT_TIMEOUT_S             10.0f    // spin up + hold
+
+// Hall commissioning (UDP "hall learn"): Hall map from six held vectors,
+// edge offsets from a sweep forward and back
+#define HALL_LEARN_I_A              3.0f     // stiff: less stick-slip and ringing at the edges
+#define HALL_LEARN_SETTLE_S         0.3f
+#define HALL_LEARN_SWEEP_DEG_S      360.0f   // electrical
+
+// Hall edge timing compensation (hall_timing.h): per-sector widths learned
+// at steady speed, applied to the Hall speed and the fast-loop angle
+#define HALL_TIMING_COMP            1
+#define HALL_TIMING_GAIN            0.02f    // per interval
+#define HALL_TIMING_STEADY_TOL      0.05f
+
+// Runtime config file: read at startup, rewritten with the results of
+// a parameter identification or Hall commissioning
+#define MOTOR_CONFIG_PATH           "motor.cfg"
+
 // PWM frequency (for 6‑step commutation)
 #define PWM_FREQUENCY_HZ            20000       // 20 kHz
 
+// Six-step modulation (PwmModulation_t, pwm_pattern.h):
+//   0 = H_PWM-L_PWM (both switches chop)    1 = H_PWM-L_ON
+//   2 = L_PWM-H_ON                          3 = complementary (synchronous
+//                                               rectification on the chopping leg)
+// The dead time is added on top of the DRV8302's own (DTC pin).
+// The duty-mode speed PI is tuned for 0 (with a switch held on, duty 0
+// coasts instead of braking).
+#define PWM_MODULATION              0
+#define PWM_DEAD_TIME_NS            500.0f      // complementary only
+
+// Commutation in RUN (MotorCommutation_t, motor_states.h): 0 = six-step,
+// 1 = sinusoidal from the Hall angle interpolated at the fast rate
+// (hall_interp.h), with min-max injection, 2 = FOC (foc.h) on the same
+// angle, with d/q current PIs at CURRENT_LOOP_BW_HZ. Both drive
+// complementary half bridges (PWM_DEAD_TIME_NS applies), feed the speed
+// loop from the Hall edges timed at the fast rate, and fall back to
+// six-step below SINE_COMM_MIN_RPM, where the Hall edges are too far
+// apart. FOC needs current sensing.
+#define COMMUTATION_MODE            0
+#define SINE_COMM_MIN_RPM           200.0f      // mechanical
+
+// Fast-loop profiling with perf_event_open counters (cycles, instructions,
+// cache-misses, context-switches). Falls back to off if the kernel refuses.
+#define FAST_LOOP_PERF_ENABLE       1           // 0 = never open counters
+#define FAST_LOOP_PERF_SAMPLE_ITERS 2000        // iterations/sample (100 ms @ 20 kHz)
+
+// Fast-loop deadline watchdog (independent SCHED_FIFO thread + timerfd)
+#define WATCHDOG_PERIOD_US          250         // watchdog check period
+#define WATCHDOG_MISSED_DEADLINES   20          // consecutive misses to trip (1 ms @ 20 kHz)
+#define WATCHDOG_THREAD_PRIO        90          // must be above the fast loop (80)
+
+// Real-time allocation guard (only active when the malloc interposer is
+// linked in: CMake -DMOTOR_RT_ALLOC_GUARD=ON). Loop threads that allocate
+// are counted (0) or abort the process (1).
+#define RT_ALLOC_GUARD_ABORT        0
+
+// Cache line size of the target (Cortex-A53 / Cortex-A8 / x86: 64 bytes).
+// State written by different threads is kept on separate lines.
+#define CACHE_LINE_BYTES            64
+
 // ---------------------------------------------------------
 // ADC / BEMF sensing configuration
 // ---------------------------------------------------------
@@ -74,6 +206,12 @@
 #define BEMF_CH_V                   1
 #define BEMF_CH_W                   2
 #define BEMF_CH_VBUS                3
+#define ISENSE_CH_U                 4
+#define ISENSE_CH_V                 5
+
+// Current-sense offset calibration (outputs off, rotor at standstill)
+#define ISENSE_CAL_SAMPLES          256
+#define ISENSE_CAL_MAX_DEV_V        0.15f       // reject offsets this far from ADC_REF_V
 
 // Minimum Vbus where BEMF values make sense
 #define BEMF_VALID_MIN_V            1.0f
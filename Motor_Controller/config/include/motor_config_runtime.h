@@ -2,8 +2,28 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "motor_config.h"  // for the compile-time macros
 
+// Speed PI gain schedule as read from the config (see motor_config.h)
+typedef struct
+{
+    int   n;                                   // breakpoints, 0 = fixed gains
+    float rpm[SPEED_PI_SCHED_MAX_POINTS];      // ascending
+    float kp[SPEED_PI_SCHED_MAX_POINTS];
+    float ki[SPEED_PI_SCHED_MAX_POINTS];
+} SpeedGainTable_t;
+
+// Hall decoding of one motor, from a Hall commissioning (hall_learn.h).
+// Each axis decodes with its own copy, taken from the runtime config at
+// init.
+typedef struct
+{
+    int     set;                 // 0: the built-in table of hall_commutator.c
+    uint8_t map[8];              // Hall bits -> sector, 0xFF = invalid
+    float   edge_offset_deg[6];  // edge into sector s at 60 s + offset (electrical)
+} HallMap_t;
+
 // Central runtime config object. Initialized from motor_config.h
 // macros, then optionally overridden from a config file.
 typedef struct
@@ -13,9 +33,12 @@ typedef struct
     float kv_rpm_per_v;
     float r_phase_ohm;
     float l_phase_h;
+    float inertia_kgm2;
+    float friction_nm;
 
     // Limits
     float i_max_a;
+    float oc_trip_us;
     float bus_v_max_v;
     float bus_v_min_v;
     float rpm_max;
@@ -24,15 +47,44 @@ typedef struct
     float fast_loop_hz;
     float slow_loop_hz;
     float pwm_freq_hz;
+    int   pwm_modulation;     // PwmModulation_t
+    float pwm_dead_time_ns;
+    float current_bw_hz;      // inner current loop, 0 = duty mode
+    int   speed_ff;           // Kv duty feedforward in duty mode (0/1)
+    float speed_ff_ir_gain;   // share of the IR drop fed forward (0..1)
+    float traj_accel_max;     // speed trajectory acceleration limit (rpm/s)
+    float traj_jerk_max;      // ... jerk limit (rpm/s^2), 0 = plain ramp
+    int   traj_accel_ff;      // acceleration feedforward (0/1)
+    float load_obs_bw_hz;     // load-torque observer, 0 = off
+    SpeedGainTable_t speed_sched_duty;     // speed PI gains, duty mode
+    SpeedGainTable_t speed_sched_current;  // speed PI gains, current loop
+    float speed_sched_vbus_ref;            // duty gains x ref/Vbus, 0 = off
+    int   commutation;        // MotorCommutation_t (0 = six-step, 1 = sinusoidal, 2 = FOC)
+    float sine_min_rpm;       // sinusoidal below this: six-step
+    int   hall_timing_comp;   // per-edge Hall timing compensation (0/1)
 
     // Sensorless / handover
     float sensorless_min_rpm_mech;
     int   sensorless_stable_samples;
+
+    // Hall decoding the axes start with (HALL_MAP, HALL_EDGE_OFFSETS_DEG)
+    HallMap_t hall_map;
 } MotorRuntimeConfig;
 
 // Global instance (defined in motor_config_runtime.c)
 extern MotorRuntimeConfig g_motor_cfg;
 
+// Motor characteristics one controller runs on. Each controller keeps
+// its own copy, so identifying one motor leaves the others' alone.
+typedef struct
+{
+    float kv_rpm_per_v;
+    float r_phase_ohm;
+    float l_phase_h;
+    float inertia_kgm2;
+    float friction_nm;
+} MotorParams_t;
+
 /**
  * @brief Initialize runtime config from compile-time macros.
  *
@@ -54,6 +106,34 @@ void MotorConfig_initDefaults(void);
  */
 int MotorConfig_loadFromFile(const char *path);
 
+/**
+ * @brief Motor characteristics of the runtime config, compile-time
+ *        defaults for any not set (a controller's starting point).
+ */
+void MotorConfig_getMotorParams(MotorParams_t *out);
+
+/**
+ * @brief Write the motor characteristics (Kv, R, L, inertia, friction)
+ *        of one motor into a key=value file, and its Hall map and edge
+ *        offsets if hm is set (hm may be NULL).
+ *
+ * Other lines of an existing file are kept as they are; these keys are
+ * replaced (appended at the end). The file is rewritten through a
+ * temporary and renamed over, so a crash leaves the old one.
+ *
+ * @return 0 on success, -1 on an I/O error.
+ */
+int MotorConfig_saveMotorParams(const char *path, const MotorParams_t *mp, const HallMap_t *hm);
+
+/**
+ * @brief Parse a speed PI gain schedule, "rpm:kp:ki, rpm:kp:ki, ...".
+ *
+ * An empty string gives an empty table (fixed gains).
+ * @return true if well formed (rpm ascending, gains >= 0); out is left
+ *         unchanged otherwise.
+ */
+bool MotorConfig_parseSpeedSchedule(const char *s, SpeedGainTable_t *out);
+
 /**
  * @brief Perform sanity checks on the runtime config.
  *
@@ -26,14 +26,100 @@ static void trim_trailing(char *s)
     *end = '\0';
 }
 
+bool MotorConfig_parseSpeedSchedule(const char *s, SpeedGainTable_t *out)
+{
+    if (!s || !out) return false;
+
+    SpeedGainTable_t t;
+    memset(&t, 0, sizeof(t));
+
+    const char *p = trim_leading((char *)s);
+    while (*p) {
+        if (t.n >= SPEED_PI_SCHED_MAX_POINTS) {
+            fprintf(stderr, "MotorConfig: speed schedule has more than %d points\n",
+                    SPEED_PI_SCHED_MAX_POINTS);
+            return false;
+        }
+
+        float rpm, kp, ki;
+        int used = 0;
+        if (sscanf(p, " %f : %f : %f %n", &rpm, &kp, &ki, &used) != 3 ||
+            rpm < 0.0f || kp < 0.0f || ki < 0.0f ||
+            (t.n > 0 && rpm <= t.rpm[t.n - 1])) {
+            fprintf(stderr, "MotorConfig: bad speed schedule point '%s'\n", p);
+            return false;
+        }
+        t.rpm[t.n] = rpm;
+        t.kp[t.n]  = kp;
+        t.ki[t.n]  = ki;
+        t.n++;
+
+        p += used;
+        if (*p == ',') p = trim_leading((char *)p + 1);
+        else if (*p != '\0') {
+            fprintf(stderr, "MotorConfig: bad speed schedule separator '%s'\n", p);
+            return false;
+        }
+    }
+
+    *out = t;
+    return true;
+}
+
+// HALL_MAP: the Hall bits of sectors 0..5, "1,3,2,6,4,5"; each of the
+// six valid codes once
+static bool parse_hall_map(const char *s, uint8_t map[8])
+{
+    uint8_t m[8];
+    int     code[6];
+    memset(m, 0xFF, sizeof(m));
+
+    if (sscanf(s, " %d , %d , %d , %d , %d , %d", &code[0], &code[1], &code[2],
+               &code[3], &code[4], &code[5]) != 6) {
+        fprintf(stderr, "MotorConfig: bad HALL_MAP '%s'\n", s);
+        return false;
+    }
+    for (int i = 0; i < 6; i++) {
+        if (code[i] < 1 || code[i] > 6 || m[code[i]] != 0xFF) {
+            fprintf(stderr, "MotorConfig: HALL_MAP needs the codes 1..6 once each\n");
+            return false;
+        }
+        m[code[i]] = (uint8_t)i;
+    }
+    memcpy(map, m, sizeof(m));
+    return true;
+}
+
+// HALL_EDGE_OFFSETS_DEG: six offsets, within +-30 degrees
+static bool parse_hall_offsets(const char *s, float off[6])
+{
+    float o[6];
+    if (sscanf(s, " %f , %f , %f , %f , %f , %f", &o[0], &o[1], &o[2],
+               &o[3], &o[4], &o[5]) != 6) {
+        fprintf(stderr, "MotorConfig: bad HALL_EDGE_OFFSETS_DEG '%s'\n", s);
+        return false;
+    }
+    for (int i = 0; i < 6; i++) {
+        if (o[i] <= -30.0f || o[i] >= 30.0f) {
+            fprintf(stderr, "MotorConfig: HALL_EDGE_OFFSETS_DEG out of +-30 deg\n");
+            return false;
+        }
+    }
+    memcpy(off, o, sizeof(o));
+    return true;
+}
+
 void MotorConfig_initDefaults(void)
 {
     g_motor_cfg.pole_pairs   = (float)MOTOR_POLE_PAIRS;
     g_motor_cfg.kv_rpm_per_v = MOTOR_KV_RPM_PER_V;
     g_motor_cfg.r_phase_ohm  = MOTOR_R_PHASE_OHM;
     g_motor_cfg.l_phase_h    = MOTOR_L_PHASE_H;
+    g_motor_cfg.inertia_kgm2 = MOTOR_INERTIA_KGM2;
+    g_motor_cfg.friction_nm  = MOTOR_FRICTION_NM;
 
     g_motor_cfg.i_max_a      = MOTOR_I_MAX_A;
+    g_motor_cfg.oc_trip_us   = MOTOR_OC_TRIP_US;
     g_motor_cfg.bus_v_max_v  = MOTOR_BUS_V_MAX_V;
     g_motor_cfg.bus_v_min_v  = MOTOR_BUS_V_MIN_V;
     g_motor_cfg.rpm_max      = MOTOR_RPM_MAX;
@@ -41,9 +127,28 @@ void MotorConfig_initDefaults(void)
     g_motor_cfg.fast_loop_hz = (float)FAST_LOOP_HZ;
     g_motor_cfg.slow_loop_hz = (float)SLOW_LOOP_HZ;
     g_motor_cfg.pwm_freq_hz  = (float)PWM_FREQUENCY_HZ;
+    g_motor_cfg.pwm_modulation   = PWM_MODULATION;
+    g_motor_cfg.pwm_dead_time_ns = PWM_DEAD_TIME_NS;
+    g_motor_cfg.current_bw_hz = CURRENT_LOOP_BW_HZ;
+    g_motor_cfg.speed_ff      = SPEED_FF_ENABLE;
+    g_motor_cfg.speed_ff_ir_gain = SPEED_FF_IR_GAIN;
+    g_motor_cfg.traj_accel_max = TRAJ_ACCEL_MAX_RPM_S;
+    g_motor_cfg.traj_jerk_max  = TRAJ_JERK_MAX_RPM_S2;
+    g_motor_cfg.traj_accel_ff  = TRAJ_ACCEL_FF;
+    g_motor_cfg.load_obs_bw_hz = LOAD_OBS_BW_HZ;
+    MotorConfig_parseSpeedSchedule(SPEED_PI_SCHED_DUTY, &g_motor_cfg.speed_sched_duty);
+    MotorConfig_parseSpeedSchedule(SPEED_PI_SCHED_CURRENT, &g_motor_cfg.speed_sched_current);
+    g_motor_cfg.speed_sched_vbus_ref = SPEED_PI_SCHED_VBUS_REF;
+    g_motor_cfg.commutation   = COMMUTATION_MODE;
+    g_motor_cfg.sine_min_rpm  = SINE_COMM_MIN_RPM;
+    g_motor_cfg.hall_timing_comp = HALL_TIMING_COMP;
 
     g_motor_cfg.sensorless_min_rpm_mech   = SENSORLESS_MIN_RPM_MECH;
     g_motor_cfg.sensorless_stable_samples = SENSORLESS_STABLE_SAMPLES;
+
+    g_motor_cfg.hall_map.set = 0;
+    memset(g_motor_cfg.hall_map.map, 0xFF, sizeof(g_motor_cfg.hall_map.map));
+    memset(g_motor_cfg.hall_map.edge_offset_deg, 0, sizeof(g_motor_cfg.hall_map.edge_offset_deg));
 }
 
 static void apply_key_value(const char *key, const char *val_str)
@@ -59,8 +164,14 @@ static void apply_key_value(const char *key, const char *val_str)
         if (fval > 0.0f) g_motor_cfg.r_phase_ohm = fval;
     } else if (strcmp(key, "MOTOR_L_PHASE_H") == 0) {
         if (fval > 0.0f) g_motor_cfg.l_phase_h = fval;
+    } else if (strcmp(key, "MOTOR_INERTIA_KGM2") == 0) {
+        if (fval > 0.0f) g_motor_cfg.inertia_kgm2 = fval;
+    } else if (strcmp(key, "MOTOR_FRICTION_NM") == 0) {
+        if (fval >= 0.0f) g_motor_cfg.friction_nm = fval;
     } else if (strcmp(key, "MOTOR_I_MAX_A") == 0) {
         if (fval > 0.0f) g_motor_cfg.i_max_a = fval;
+    } else if (strcmp(key, "MOTOR_OC_TRIP_US") == 0) {
+        if (fval > 0.0f) g_motor_cfg.oc_trip_us = fval;
     } else if (strcmp(key, "MOTOR_BUS_V_MAX_V") == 0) {
         if (fval > 0.0f) g_motor_cfg.bus_v_max_v = fval;
     } else if (strcmp(key, "MOTOR_BUS_V_MIN_V") == 0) {
@@ -73,10 +184,44 @@ static void apply_key_value(const char *key, const char *val_str)
         if (fval > 0.0f) g_motor_cfg.slow_loop_hz = fval;
     } else if (strcmp(key, "PWM_FREQUENCY_HZ") == 0) {
         if (fval > 0.0f) g_motor_cfg.pwm_freq_hz = fval;
+    } else if (strcmp(key, "PWM_MODULATION") == 0) {
+        if (lval >= 0 && lval <= 3) g_motor_cfg.pwm_modulation = (int)lval;
+    } else if (strcmp(key, "PWM_DEAD_TIME_NS") == 0) {
+        if (fval >= 0.0f) g_motor_cfg.pwm_dead_time_ns = fval;
+    } else if (strcmp(key, "CURRENT_LOOP_BW_HZ") == 0) {
+        if (fval >= 0.0f) g_motor_cfg.current_bw_hz = fval;   // 0 = duty mode
+    } else if (strcmp(key, "SPEED_FF_ENABLE") == 0) {
+        if (lval == 0 || lval == 1) g_motor_cfg.speed_ff = (int)lval;
+    } else if (strcmp(key, "SPEED_FF_IR_GAIN") == 0) {
+        if (fval >= 0.0f && fval < 1.0f) g_motor_cfg.speed_ff_ir_gain = fval;
+    } else if (strcmp(key, "TRAJ_ACCEL_MAX_RPM_S") == 0) {
+        if (fval > 0.0f) g_motor_cfg.traj_accel_max = fval;
+    } else if (strcmp(key, "TRAJ_JERK_MAX_RPM_S2") == 0) {
+        if (fval >= 0.0f) g_motor_cfg.traj_jerk_max = fval;   // 0 = plain ramp
+    } else if (strcmp(key, "TRAJ_ACCEL_FF") == 0) {
+        if (lval == 0 || lval == 1) g_motor_cfg.traj_accel_ff = (int)lval;
+    } else if (strcmp(key, "LOAD_OBS_BW_HZ") == 0) {
+        if (fval >= 0.0f) g_motor_cfg.load_obs_bw_hz = fval;   // 0 = off
+    } else if (strcmp(key, "SPEED_PI_SCHED_DUTY") == 0) {
+        MotorConfig_parseSpeedSchedule(val_str, &g_motor_cfg.speed_sched_duty);
+    } else if (strcmp(key, "SPEED_PI_SCHED_CURRENT") == 0) {
+        MotorConfig_parseSpeedSchedule(val_str, &g_motor_cfg.speed_sched_current);
+    } else if (strcmp(key, "SPEED_PI_SCHED_VBUS_REF") == 0) {
+        if (fval >= 0.0f) g_motor_cfg.speed_sched_vbus_ref = fval;
+    } else if (strcmp(key, "COMMUTATION_MODE") == 0) {
+        if (lval >= 0 && lval <= 2) g_motor_cfg.commutation = (int)lval;
+    } else if (strcmp(key, "SINE_COMM_MIN_RPM") == 0) {
+        if (fval > 0.0f) g_motor_cfg.sine_min_rpm = fval;
+    } else if (strcmp(key, "HALL_TIMING_COMP") == 0) {
+        if (lval == 0 || lval == 1) g_motor_cfg.hall_timing_comp = (int)lval;
     } else if (strcmp(key, "SENSORLESS_MIN_RPM_MECH") == 0) {
         if (fval > 0.0f) g_motor_cfg.sensorless_min_rpm_mech = fval;
     } else if (strcmp(key, "SENSORLESS_STABLE_SAMPLES") == 0) {
         if (lval > 0) g_motor_cfg.sensorless_stable_samples = (int)lval;
+    } else if (strcmp(key, "HALL_MAP") == 0) {
+        if (parse_hall_map(val_str, g_motor_cfg.hall_map.map)) g_motor_cfg.hall_map.set = 1;
+    } else if (strcmp(key, "HALL_EDGE_OFFSETS_DEG") == 0) {
+        parse_hall_offsets(val_str, g_motor_cfg.hall_map.edge_offset_deg);
     } else {
         // Unknown key: ignore
     }
@@ -131,6 +276,100 @@ int MotorConfig_loadFromFile(const char *path)
     return 0;
 }
 
+// Keys written by MotorConfig_saveMotorParams()
+static const char *const k_motor_param_keys[] = {
+    "MOTOR_KV_RPM_PER_V",
+    "MOTOR_R_PHASE_OHM",
+    "MOTOR_L_PHASE_H",
+    "MOTOR_INERTIA_KGM2",
+    "MOTOR_FRICTION_NM",
+    "HALL_MAP",
+    "HALL_EDGE_OFFSETS_DEG",
+};
+
+static bool is_motor_param_line(const char *line)
+{
+    const char *p = trim_leading((char *)line);
+    for (size_t i = 0; i < sizeof(k_motor_param_keys) / sizeof(k_motor_param_keys[0]); i++) {
+        size_t n = strlen(k_motor_param_keys[i]);
+        if (strncmp(p, k_motor_param_keys[i], n) == 0) {
+            const char *q = trim_leading((char *)p + n);
+            if (*q == '=') return true;
+        }
+    }
+    return false;
+}
+
+void MotorConfig_getMotorParams(MotorParams_t *out)
+{
+    if (!out) return;
+    out->kv_rpm_per_v = (g_motor_cfg.kv_rpm_per_v > 0.0f) ? g_motor_cfg.kv_rpm_per_v : MOTOR_KV_RPM_PER_V;
+    out->r_phase_ohm  = (g_motor_cfg.r_phase_ohm > 0.0f) ? g_motor_cfg.r_phase_ohm : MOTOR_R_PHASE_OHM;
+    out->l_phase_h    = (g_motor_cfg.l_phase_h > 0.0f) ? g_motor_cfg.l_phase_h : MOTOR_L_PHASE_H;
+    out->inertia_kgm2 = g_motor_cfg.inertia_kgm2;
+    out->friction_nm  = g_motor_cfg.friction_nm;
+}
+
+int MotorConfig_saveMotorParams(const char *path, const MotorParams_t *mp, const HallMap_t *hm)
+{
+    if (!mp) return -1;
+
+    char tmp[256];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) {
+        fprintf(stderr, "MotorConfig_saveMotorParams: path too long\n");
+        return -1;
+    }
+
+    FILE *out = fopen(tmp, "w");
+    if (!out) {
+        perror("MotorConfig_saveMotorParams: fopen");
+        return -1;
+    }
+
+    // Keep everything else of the existing file (none is fine)
+    FILE *in = fopen(path, "r");
+    if (in) {
+        char line[256];
+        while (fgets(line, sizeof(line), in)) {
+            if (!is_motor_param_line(line)) {
+                fputs(line, out);
+            }
+        }
+        fclose(in);
+    }
+
+    fprintf(out, "MOTOR_KV_RPM_PER_V=%.6g\n", (double)mp->kv_rpm_per_v);
+    fprintf(out, "MOTOR_R_PHASE_OHM=%.6g\n",  (double)mp->r_phase_ohm);
+    fprintf(out, "MOTOR_L_PHASE_H=%.6g\n",    (double)mp->l_phase_h);
+    fprintf(out, "MOTOR_INERTIA_KGM2=%.6g\n", (double)mp->inertia_kgm2);
+    fprintf(out, "MOTOR_FRICTION_NM=%.6g\n",  (double)mp->friction_nm);
+
+    if (hm && hm->set) {
+        int code[6] = { 0 };
+        for (int bits = 0; bits < 8; bits++) {
+            uint8_t s = hm->map[bits];
+            if (s < 6) code[s] = bits;
+        }
+        const float *o = hm->edge_offset_deg;
+        fprintf(out, "HALL_MAP=%d,%d,%d,%d,%d,%d\n",
+                code[0], code[1], code[2], code[3], code[4], code[5]);
+        fprintf(out, "HALL_EDGE_OFFSETS_DEG=%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+                (double)o[0], (double)o[1], (double)o[2], (double)o[3], (double)o[4], (double)o[5]);
+    }
+
+    if (fclose(out) != 0) {
+        perror("MotorConfig_saveMotorParams: fclose");
+        remove(tmp);
+        return -1;
+    }
+    if (rename(tmp, path) != 0) {
+        perror("MotorConfig_saveMotorParams: rename");
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+}
+
 bool MotorConfig_sanityCheck(void)
 {
     bool ok = true;
@@ -145,6 +384,11 @@ bool MotorConfig_sanityCheck(void)
                 g_motor_cfg.kv_rpm_per_v);
         ok = false;
     }
+    if (g_motor_cfg.i_max_a <= 0.0f) {
+        fprintf(stderr, "MotorConfig: invalid i_max_a (%.2f)\n",
+                g_motor_cfg.i_max_a);
+        ok = false;
+    }
     if (g_motor_cfg.bus_v_min_v <= 0.0f ||
         g_motor_cfg.bus_v_min_v >= g_motor_cfg.bus_v_max_v) {
         fprintf(stderr,
@@ -169,6 +413,20 @@ bool MotorConfig_sanityCheck(void)
         ok = false;
     }
 
+    if (g_motor_cfg.pwm_freq_hz > 0.0f &&
+        g_motor_cfg.pwm_dead_time_ns * 1e-9f * g_motor_cfg.pwm_freq_hz > 0.1f) {
+        fprintf(stderr, "MotorConfig: invalid pwm_dead_time_ns (%.0f), over 10%% of the PWM period\n",
+                g_motor_cfg.pwm_dead_time_ns);
+        ok = false;
+    }
+
+    if (g_motor_cfg.current_bw_hz > g_motor_cfg.fast_loop_hz / 5.0f) {
+        // One tick of delay: much faster than this and the loop rings
+        fprintf(stderr,
+                "MotorConfig: current_bw_hz (%.0f) above fast_loop_hz/5, expect overshoot\n",
+                g_motor_cfg.current_bw_hz);
+    }
+
     if (!ok) {
         fprintf(stderr, "MotorConfig: sanity check FAILED\n");
     }
@@ -0,0 +1,76 @@
+// current_sense.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Phase current measurement handle (DRV8302 shunt amplifiers).
+ *
+ * The DRV8302 amplifies the low-side shunt voltage of phases U and V
+ * (SO1 / SO2) around a mid-rail reference; phase W follows from
+ * i_u + i_v + i_w = 0 (star connection).
+ *
+ * adc_fd:      SPI ADC file descriptor (from adc_init("/dev/spidevX.Y"))
+ * ch_u / ch_v: ADC channels of SO1 / SO2
+ * offset_*_v:  amplifier output at zero current (pin volts); ADC_REF_V
+ *              until CurrentSense_calibrate() has measured it
+ *
+ * i_*:         phase currents in amps, positive into the motor
+ */
+typedef struct {
+    int      adc_fd;
+    uint8_t  ch_u;
+    uint8_t  ch_v;
+
+    float    offset_u_v;
+    float    offset_v_v;
+    bool     calibrated;
+
+    float    i_u;
+    float    i_v;
+    float    i_w;
+} CurrentSenseHandle_t;
+
+/**
+ * @brief Initialize current sense handle with explicit channels.
+ *
+ * Does not own adc_fd; you open/close ADC outside this module.
+ */
+bool CurrentSense_init(CurrentSenseHandle_t *h,
+                       int adc_fd,
+                       uint8_t ch_u,
+                       uint8_t ch_v);
+
+/**
+ * @brief Initialize current sense handle using default channel mapping
+ *        from motor_config.h (ISENSE_CH_U/V).
+ */
+bool CurrentSense_initDefault(CurrentSenseHandle_t *h, int adc_fd);
+
+/**
+ * @brief Measure the zero-current offsets.
+ *
+ * Averages `samples` reads of each channel. Only call with the outputs
+ * off and the rotor at standstill (no current can flow). An offset more
+ * than ISENSE_CAL_MAX_DEV_V away from ADC_REF_V is rejected and the
+ * nominal mid-rail value kept.
+ *
+ * @return true if both offsets were accepted.
+ */
+bool CurrentSense_calibrate(CurrentSenseHandle_t *h, int samples);
+
+/**
+ * @brief Sample both channels and update the phase currents.
+ *
+ * Call this from the fast loop. A failed ADC read keeps the previous
+ * values.
+ */
+void CurrentSense_update(CurrentSenseHandle_t *h);
+
+/**
+ * @brief Get phase current (in amps) for U/V/W.
+ *
+ * phase: 0 = U, 1 = V, 2 = W
+ */
+float CurrentSense_getPhaseCurrent(const CurrentSenseHandle_t *h, uint8_t phase);
@@ -0,0 +1,73 @@
+// elec_angle.h
+#pragma once
+
+#include <stdint.h>
+
+// Electrical angle as a 16-bit fraction of a turn: 0 = 0 deg, 0x4000 =
+// 90 deg, 0x10000 wraps to 0. Adding, subtracting and offsetting angles
+// is plain unsigned arithmetic with free wraparound, and sin / cos come
+// from a 256-entry table with linear interpolation (max error ~8e-5,
+// resolution 0.0055 deg).
+//
+// Pure logic like pwm_pattern.h: shared by the controller and the plant
+// simulator.
+
+typedef uint16_t ElecAngle_t;
+
+#define ELEC_ANGLE_PER_RAD   10430.3783f   // 65536 / (2 pi)
+#define ELEC_ANGLE_RAD_PER   9.58737992e-5f // (2 pi) / 65536
+
+// Constant angle from degrees (may be negative), e.g. ELEC_ANGLE_DEG(-60)
+#define ELEC_ANGLE_DEG(deg) \
+    ((ElecAngle_t)(uint32_t)(int32_t)((deg) * (65536.0 / 360.0) + ((deg) < 0 ? -0.5 : 0.5)))
+
+/**
+ * @brief Radians (any value, e.g. PosEst_t.elec_angle) -> angle, rounded.
+ */
+static inline ElecAngle_t ElecAngle_fromRad(float rad)
+{
+    float x = rad * ELEC_ANGLE_PER_RAD;
+    return (ElecAngle_t)(uint32_t)(int32_t)(x + (x < 0.0f ? -0.5f : 0.5f));
+}
+
+/**
+ * @brief Angle -> radians in [0, 2pi).
+ */
+static inline float ElecAngle_toRad(ElecAngle_t a)
+{
+    return (float)a * ELEC_ANGLE_RAD_PER;
+}
+
+// sin(2 pi k / 256), k = 0..256 (elec_angle.c); the last entry repeats
+// the first so interpolation never wraps the index
+#define ELEC_ANGLE_TABLE_BITS  8
+extern const float ElecAngle_sineTable[(1 << ELEC_ANGLE_TABLE_BITS) + 1];
+
+/**
+ * @brief Table sine. Inline: the fast loop calls it a few times per tick.
+ */
+static inline float ElecAngle_sin(ElecAngle_t a)
+{
+    enum { FRAC_BITS = 16 - ELEC_ANGLE_TABLE_BITS };
+    unsigned i = (unsigned)a >> FRAC_BITS;
+    float    f = (float)((unsigned)a & ((1u << FRAC_BITS) - 1u)) * (1.0f / (float)(1u << FRAC_BITS));
+    float    y = ElecAngle_sineTable[i];
+    return y + (ElecAngle_sineTable[i + 1] - y) * f;
+}
+
+/**
+ * @brief Table cosine.
+ */
+static inline float ElecAngle_cos(ElecAngle_t a)
+{
+    return ElecAngle_sin((ElecAngle_t)(a + 0x4000u));
+}
+
+/**
+ * @brief Both at once (one table lookup each).
+ */
+static inline void ElecAngle_sinCos(ElecAngle_t a, float *s, float *c)
+{
+    *s = ElecAngle_sin(a);
+    *c = ElecAngle_cos(a);
+}
@@ -5,15 +5,22 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Handles come from a fixed pool and line storage is fixed-size, so
+// nothing here allocates: not at init, and never on the read/write path.
+#define GPIO_MAX_HANDLES   16
+#define GPIO_MAX_LINES     8     // lines per handle
+
 // Opaque GPIO object
 typedef struct {
     struct gpiod_chip *chip;
     struct gpiod_line_request *request;
-    unsigned int *offsets;
+    unsigned int offsets[GPIO_MAX_LINES];
     size_t num_lines;
+    bool in_use;
 } GPIO_Handle;
 
 // Initialize GPIO handle for a chip path and offsets
+// (NULL if num_lines > GPIO_MAX_LINES or the pool is exhausted)
 GPIO_Handle* gpio_init(const char *chip_path,
                        const unsigned int *offsets,
                        size_t num_lines,
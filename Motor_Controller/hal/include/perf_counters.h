@@ -0,0 +1,129 @@
+// perf_counters.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "timer.h"   // TimeNs_t
+
+// Hardware/software performance counters for one thread, via
+// perf_event_open(2). Meant to wrap a periodic loop (e.g. the fast loop):
+// every `sample_iters` calls to PerfCounters_tick() the counters are read,
+// and the deltas are pushed into a small ring + a running summary.
+//
+// Any counter the kernel refuses (no PMU in a VM, perf_event_paranoid,
+// missing CAP_PERFMON...) is simply marked unavailable; ticking and
+// reading the summary stay valid, the affected ratios just read as 0.
+//
+// The hardware counters are one event group (leader: cycles, or the
+// first that opens), so they always count over the same interval and the
+// ratios hold even when the PMU is multiplexed. Their deltas are scaled
+// by enabled / running time; a window the group ran for less than
+// PERF_HW_MIN_RUNNING of is dropped (hardware deltas 0, summary kept).
+
+typedef enum {
+    PERF_CNT_CYCLES = 0,
+    PERF_CNT_INSTRUCTIONS,
+    PERF_CNT_CACHE_MISSES,
+    PERF_CNT_CTX_SWITCHES,
+    PERF_CNT_COUNT
+} PerfCounterId_t;
+
+#define PERF_RING_LEN        32
+#define PERF_HW_MIN_RUNNING  0.1f
+
+// One sample = counter deltas over `iterations` loop iterations.
+typedef struct {
+    uint32_t iterations;
+    uint64_t delta[PERF_CNT_COUNT];
+    float    hw_running;         // share of the window the hardware group
+                                 // counted (< 1: multiplexed, scaled; 0: dropped)
+} PerfSample_t;
+
+// Derived numbers, published once per sample.
+typedef struct {
+    bool     available;          // at least one counter is open
+    uint8_t  counter_mask;       // bit i set = PerfCounterId_t i is open
+    uint32_t samples;            // number of samples taken so far
+
+    // Last window
+    float    ipc;                // instructions / cycles
+    float    mpki;               // cache misses per 1000 instructions
+    float    misses_per_iter;    // cache misses per loop iteration
+    float    cycles_per_iter;
+    float    ctx_sw_per_s;       // context switches per second (Clock_nowNs())
+    float    hw_running;         // PerfSample_t::hw_running of the last window
+    uint32_t hw_dropped;         // windows dropped (group hardly ran)
+
+    // Worst window seen since start (or last reset)
+    float    ipc_min;
+    float    mpki_max;
+} PerfSummary_t;
+
+typedef struct {
+    int          fd[PERF_CNT_COUNT];   // -1 = unavailable
+    uint64_t     last[PERF_CNT_COUNT]; // raw value at start of window
+    int          group_fd;             // hardware group leader, -1 = none
+    int8_t       group_pos[PERF_CNT_COUNT]; // slot in the group read, -1 = not in it
+    uint32_t     group_n;
+    uint64_t     last_enabled;         // group times at start of window (ns)
+    uint64_t     last_running;
+    uint32_t     sample_iters;         // N iterations per sample
+    uint32_t     iter_in_window;
+    TimeNs_t     window_start_ns;      // Clock_nowNs() at start of window
+
+    PerfSample_t ring[PERF_RING_LEN];
+    atomic_uint  ring_head;            // total samples written
+
+    // Summary is written by the owning thread and read by others;
+    // seq is odd while an update is in progress.
+    atomic_uint   summary_seq;
+    PerfSummary_t summary;
+} PerfCounters_t;
+
+/**
+ * @brief Open counters for the *calling* thread.
+ *
+ * Must be called from the thread being profiled (pid = 0 in
+ * perf_event_open). Never fails hard: returns true if at least one
+ * counter could be opened, false if profiling is unavailable.
+ *
+ * @param pc            instance
+ * @param sample_iters  loop iterations per sample (e.g. 2000 @ 20 kHz = 100 ms)
+ */
+bool PerfCounters_open(PerfCounters_t *pc, uint32_t sample_iters);
+
+/**
+ * @brief Count one loop iteration; reads counters every sample_iters calls.
+ *
+ * Cheap (a counter increment) except on sample boundaries, where it does
+ * one read(2) per open counter.
+ */
+void PerfCounters_tick(PerfCounters_t *pc);
+
+/**
+ * @brief Copy the latest summary (safe from any thread).
+ */
+PerfSummary_t PerfCounters_getSummary(const PerfCounters_t *pc);
+
+/**
+ * @brief Copy up to max_samples most recent raw samples, newest last.
+ *
+ * At most PERF_RING_LEN - 1: the oldest slot is the next one the owning
+ * thread rewrites, and samples it overwrote during the copy are left out.
+ *
+ * @return number of samples copied
+ */
+uint32_t PerfCounters_getRecent(const PerfCounters_t *pc,
+                                PerfSample_t *out,
+                                uint32_t max_samples);
+
+/**
+ * @brief Human-readable counter name (for logs).
+ */
+const char *PerfCounters_name(PerfCounterId_t id);
+
+/**
+ * @brief Close all counters.
+ */
+void PerfCounters_close(PerfCounters_t *pc);
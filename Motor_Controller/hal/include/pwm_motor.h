@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "pwm_pattern.h"   // PwmModulation_t
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -12,6 +14,7 @@ typedef struct {
     char period_path[128];
     char duty_path[128];
     char enable_path[128];
+    char polarity_path[128];
 } PwmMotorChannel_t;
 
 typedef struct {
@@ -19,8 +22,18 @@ typedef struct {
     double            freq_hz;
     unsigned long long period_ns;
     bool              enabled;
+
+    PwmModulation_t   modulation;
+    float             dead_time_ns;   // PWM_MOD_COMPLEMENTARY only
+    bool              late[6];        // channel runs with inversed polarity
+    bool              polarity_ok;    // every channel has a polarity attribute
 } PwmMotor_t;
 
+// Not thread-safe: enabled and late[] cache what was written to the
+// channels, so a PwmMotor_t has one owner (the controller's fast loop
+// while it runs). Other threads stop the outputs through the controller
+// or PwmMotorSafeStop_t, never by calling in here.
+
 /**
  * pwm_root: usually "/dev/hat/pwm"
  * the offsets are GPIO numbers that have PWM devices:
@@ -36,9 +49,27 @@ bool PwmMotor_init(PwmMotor_t *m,
                    unsigned int inl_c_gpio);
 
 void PwmMotor_setEnable(PwmMotor_t *m, bool enable);
+
+/**
+ * Select the six-step modulation scheme (PWM_MODULATION by default).
+ * dead_time_ns is the gap between the high side turning off and the
+ * synchronous-rectifier low side turning on (complementary only).
+ * Call with the outputs stopped. Complementary needs the channels'
+ * polarity attribute (its low side is late-aligned); without it the
+ * previous scheme is kept and false returned.
+ */
+bool PwmMotor_setModulation(PwmMotor_t *m, PwmModulation_t mod, float dead_time_ns);
 void PwmMotor_applyPhaseState(PwmMotor_t *m,
                               int u, int v, int w,
                               float duty);
+/**
+ * Drive all three phases as complementary half bridges: phase k's high
+ * side at duty[k], its low side in the rest of the period after
+ * dead_time_ns (late-aligned, so this needs polarity_ok; without it, or
+ * with the driver disabled, all outputs stay off). For sinusoidal
+ * commutation (PwmPattern_sineDuties()).
+ */
+void PwmMotor_setPhaseDuties(PwmMotor_t *m, const float duty[3]);
 void PwmMotor_setSixStep(PwmMotor_t *m,
                          uint8_t sector,
                          float duty,
@@ -46,6 +77,23 @@ void PwmMotor_setSixStep(PwmMotor_t *m,
 void PwmMotor_stop(PwmMotor_t *m);
 void PwmMotor_deinit(PwmMotor_t *m);
 
+/**
+ * Emergency-stop path with the duty/enable files of all six channels
+ * opened up front. PwmMotor_safeStop() only does pwrite(2) on those fds,
+ * so it can be called from a watchdog thread while the control thread
+ * is stalled, without touching PwmMotor_t or calling open(2).
+ */
+typedef struct {
+    int  duty_fd[6];
+    int  enable_fd[6];
+    int  polarity_fd[6];   // -1 if the channel has no polarity attribute
+    bool ready;
+} PwmMotorSafeStop_t;
+
+bool PwmMotor_safeStopOpen(PwmMotorSafeStop_t *ss, const PwmMotor_t *m);
+void PwmMotor_safeStop(PwmMotorSafeStop_t *ss);
+void PwmMotor_safeStopClose(PwmMotorSafeStop_t *ss);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
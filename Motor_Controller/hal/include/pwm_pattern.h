@@ -0,0 +1,90 @@
+// pwm_pattern.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "elec_angle.h"
+
+// Pure drive-pattern logic shared by the sysfs PWM driver (pwm_motor.c)
+// and the plant simulator. No I/O here: it only decides what the six
+// gate channels should do.
+//
+// Channel order matches PwmMotor_t.ch[]:
+//   0:INH-A, 1:INL-A, 2:INH-B, 3:INL-B, 4:INH-C, 5:INL-C
+
+#define PWM_PATTERN_CHANNELS  6
+
+// Six-step modulation: which switch of the driven pair chops.
+typedef enum {
+    PWM_MOD_HPWM_LPWM = 0,     // high and low side both chop at duty
+    PWM_MOD_HPWM_LON,          // high side chops, low side held on
+    PWM_MOD_LPWM_HON,          // low side chops, high side held on
+    PWM_MOD_COMPLEMENTARY,     // as HPWM_LON, and the chopping leg's low side
+                               // conducts in the off-time (synchronous
+                               // rectification), after a dead time
+    PWM_MOD_COUNT
+} PwmModulation_t;
+
+// Gate command for the six channels. Channel i is on for the first
+// duty[i]*T of every PWM period, or for the last duty[i]*T if late[i] is
+// set. Only complementary low sides are ever late.
+typedef struct {
+    float duty[PWM_PATTERN_CHANNELS];
+    bool  late[PWM_PATTERN_CHANNELS];
+} PwmGates_t;
+
+/**
+ * @brief Six-step phase signs (+1 high, -1 low, 0 floating) for a sector.
+ *
+ * Sector > 5 gives all zeros (all phases floating).
+ */
+void PwmPattern_sixStepSigns(uint8_t sector, bool forward,
+                             int *u, int *v, int *w);
+
+/**
+ * @brief Gate command for a phase-state command.
+ *
+ * +1 -> phase tied to the bus, -1 -> phase tied to ground, 0 -> both
+ * switches off. `mod` decides which of the two driven switches chops at
+ * `duty` and which is held on (see PwmModulation_t). duty is clamped to
+ * [0, 1].
+ *
+ * @param dead_frac  PWM_MOD_COMPLEMENTARY only: gap between the high side
+ *                   turning off and its low side turning on, as a fraction
+ *                   of the PWM period. The low side turns off at the end of
+ *                   the period, as the high side turns on; that edge relies
+ *                   on the gate driver's own dead time.
+ */
+void PwmPattern_phaseGates(int u, int v, int w, float duty,
+                           PwmModulation_t mod, float dead_frac,
+                           PwmGates_t *out);
+
+/**
+ * @brief Sinusoidal phase duties with min-max (zero-sequence) injection.
+ *
+ * Phase k gets mag/sqrt(3) * cos(angle - k*120deg); the midpoint of the
+ * largest and smallest of the three is then subtracted from all of them
+ * and the result centred on 0.5. The line-line voltages stay sinusoidal
+ * (line-line amplitude = mag * Vbus) and reach the full bus at mag = 1,
+ * about 15% more than plain sine PWM (same as space-vector PWM).
+ *
+ * @param angle  voltage vector angle, 0 = along phase U
+ * @param mag    clamped to [0, 1]
+ */
+void PwmPattern_sineDuties(ElecAngle_t angle, float mag, float duty[3]);
+
+/**
+ * @brief Gate command for three complementary half bridges.
+ *
+ * Phase k's high side is on for the first duty[k]*T, its low side for
+ * the rest of the period minus dead_frac (late-aligned, as the chopping
+ * leg of PWM_MOD_COMPLEMENTARY).
+ */
+void PwmPattern_halfBridgeGates(const float duty[3], float dead_frac,
+                                PwmGates_t *out);
+
+/**
+ * @brief Short name of a modulation scheme ("H_PWM-L_ON", ...).
+ */
+const char *PwmPattern_modulationName(PwmModulation_t mod);
@@ -0,0 +1,60 @@
+// rt_alloc_guard.h
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------------------------------------
+// Real-time allocation guard
+// ---------------------------------------------------------
+// The control loop threads must not touch the heap once running: malloc
+// can take locks, fault pages in and run for unbounded time. Loop threads
+// mark themselves with RtAllocGuard_enterRt().
+//
+// The check itself needs the malloc interposer, rt_alloc_hooks.c, linked
+// into the executable (CMake option MOTOR_RT_ALLOC_GUARD; always linked
+// into Motor_Sim_Bench). With it, every allocation or free made by a
+// marked thread is counted, or aborts the process when
+// RT_ALLOC_GUARD_ABORT is set. Without it, marking is just a thread-local
+// store and the counters stay at 0.
+
+typedef struct {
+    bool     hooked;        // interposer linked and active
+    uint64_t allocs;        // malloc/calloc/realloc/memalign from RT threads
+    uint64_t frees;         // free() from RT threads
+    uint64_t bytes;         // total bytes requested by those allocations
+    size_t   first_size;    // size of the first one (0 = none yet)
+} RtAllocStats_t;
+
+/**
+ * @brief Mark the calling thread real-time (from now on, it must not allocate).
+ */
+void RtAllocGuard_enterRt(void);
+
+/**
+ * @brief Clear the mark of the calling thread (e.g. before its teardown).
+ */
+void RtAllocGuard_leaveRt(void);
+
+/**
+ * @brief Whether the calling thread is marked real-time.
+ */
+bool RtAllocGuard_isRt(void);
+
+/**
+ * @brief Abort on the first RT allocation instead of counting it.
+ */
+void RtAllocGuard_setAbort(bool abort_on_alloc);
+
+/**
+ * @brief Counters since start (or the last reset); any thread.
+ */
+RtAllocStats_t RtAllocGuard_getStats(void);
+
+void RtAllocGuard_resetStats(void);
+
+// ---- Called by the interposer (rt_alloc_hooks.c) only; must not allocate ----
+void RtAllocGuard_setHooked(void);
+void RtAllocGuard_noteAlloc(size_t size);
+void RtAllocGuard_noteFree(void);
@@ -2,6 +2,33 @@
 #define TIMER_H
 
 #include <time.h>
+#include <stdint.h>
+
+// ---------------------------------------------------------
+// Integer nanosecond timebase
+// ---------------------------------------------------------
+// Monotonic timestamps and durations as signed 64-bit nanoseconds.
+// A float holding CLOCK_MONOTONIC seconds loses ~8 ms of resolution after
+// a day of uptime; int64 ns is exact for ~292 years. Keep timestamps and
+// period math in TimeNs_t and only convert the *elapsed* value to float
+// where it is used (e.g. rpm = 60 / period).
+typedef int64_t TimeNs_t;
+
+#define TIME_NS_PER_S    1000000000LL
+#define TIME_NS_PER_MS   1000000LL
+#define TIME_NS_PER_US   1000LL
+
+// Seconds (compile-time constant or float) -> TimeNs_t
+#define TIME_S_TO_NS(s)  ((TimeNs_t)((s) * 1e9))
+
+// Current CLOCK_MONOTONIC time in ns
+TimeNs_t timer_now_ns(void);
+
+// Convert a duration (not an absolute timestamp) to float seconds
+static inline float time_ns_to_s(TimeNs_t dt_ns)
+{
+    return (float)dt_ns * 1e-9f;
+}
 
 // Return current monotonic timestamp
 struct timespec timer_now(void);
@@ -0,0 +1,141 @@
+// current_sense.c
+#include "current_sense.h"
+#include "adc.h"           // adc_read_channel()
+#include "motor_config.h"  // ADC_REF_V, CURRENT_SENSE_GAIN, CURRENT_SHUNT_OHM, ISENSE_*
+
+#include <math.h>          // fabsf
+#include <stdio.h>
+
+// -------- Config / scaling --------
+//
+// ADC: MCP3208, 12-bit, pin full-scale 2 * ADC_REF_V (see bemf.c).
+// The shunt amplifier output sits at ADC_REF_V at zero current and moves
+// by CURRENT_SENSE_GAIN * CURRENT_SHUNT_OHM volts per amp.
+//
+
+#ifndef ISENSE_ADC_MAX_COUNTS
+#define ISENSE_ADC_MAX_COUNTS  4095.0f
+#endif
+
+#ifndef ISENSE_ADC_REF_V
+#define ISENSE_ADC_REF_V       (ADC_REF_V * 2.0f)
+#endif
+
+#define ISENSE_V_PER_A         (CURRENT_SENSE_GAIN * CURRENT_SHUNT_OHM)
+
+// Convert raw ADC counts -> pin voltage (at the ADC input)
+static inline float adc_counts_to_pin_v(int counts)
+{
+    return ((float)counts * (ISENSE_ADC_REF_V / ISENSE_ADC_MAX_COUNTS));
+}
+
+static inline float pin_v_to_amps(float v_pin, float offset_v)
+{
+    return (v_pin - offset_v) / ISENSE_V_PER_A;
+}
+
+bool CurrentSense_init(CurrentSenseHandle_t *h,
+                       int adc_fd,
+                       uint8_t ch_u,
+                       uint8_t ch_v)
+{
+    if (!h || adc_fd < 0) {
+        return false;
+    }
+
+    h->adc_fd     = adc_fd;
+    h->ch_u       = ch_u;
+    h->ch_v       = ch_v;
+
+    // Nominal mid-rail offset until calibrated
+    h->offset_u_v = ADC_REF_V;
+    h->offset_v_v = ADC_REF_V;
+    h->calibrated = false;
+
+    h->i_u        = 0.0f;
+    h->i_v        = 0.0f;
+    h->i_w        = 0.0f;
+
+    return true;
+}
+
+bool CurrentSense_initDefault(CurrentSenseHandle_t *h, int adc_fd)
+{
+    // Use default channel mapping from motor_config.h
+    return CurrentSense_init(h, adc_fd, ISENSE_CH_U, ISENSE_CH_V);
+}
+
+bool CurrentSense_calibrate(CurrentSenseHandle_t *h, int samples)
+{
+    if (!h || h->adc_fd < 0 || samples < 1) {
+        return false;
+    }
+
+    double sum_u = 0.0, sum_v = 0.0;
+    int    n     = 0;
+
+    for (int i = 0; i < samples; ++i) {
+        int raw_u = adc_read_channel(h->adc_fd, h->ch_u);
+        int raw_v = adc_read_channel(h->adc_fd, h->ch_v);
+        if (raw_u < 0 || raw_v < 0) {
+            continue;
+        }
+        sum_u += adc_counts_to_pin_v(raw_u);
+        sum_v += adc_counts_to_pin_v(raw_v);
+        n++;
+    }
+
+    if (n == 0) {
+        fprintf(stderr, "CurrentSense_calibrate: no valid ADC samples\n");
+        return false;
+    }
+
+    float off_u = (float)(sum_u / n);
+    float off_v = (float)(sum_v / n);
+
+    // A large offset means current was flowing or the amp is not wired
+    if (fabsf(off_u - ADC_REF_V) > ISENSE_CAL_MAX_DEV_V ||
+        fabsf(off_v - ADC_REF_V) > ISENSE_CAL_MAX_DEV_V) {
+        fprintf(stderr,
+                "CurrentSense_calibrate: offsets U=%.3f V V=%.3f V too far from %.3f V; "
+                "keeping nominal\n",
+                off_u, off_v, ADC_REF_V);
+        return false;
+    }
+
+    h->offset_u_v = off_u;
+    h->offset_v_v = off_v;
+    h->calibrated = true;
+    return true;
+}
+
+void CurrentSense_update(CurrentSenseHandle_t *h)
+{
+    if (!h || h->adc_fd < 0) {
+        return;
+    }
+
+    int raw_u = adc_read_channel(h->adc_fd, h->ch_u);
+    int raw_v = adc_read_channel(h->adc_fd, h->ch_v);
+    if (raw_u < 0 || raw_v < 0) {
+        return;
+    }
+
+    h->i_u = pin_v_to_amps(adc_counts_to_pin_v(raw_u), h->offset_u_v);
+    h->i_v = pin_v_to_amps(adc_counts_to_pin_v(raw_v), h->offset_v_v);
+    h->i_w = -(h->i_u + h->i_v);
+}
+
+float CurrentSense_getPhaseCurrent(const CurrentSenseHandle_t *h, uint8_t phase)
+{
+    if (!h) {
+        return 0.0f;
+    }
+
+    switch (phase) {
+        case 0: return h->i_u;
+        case 1: return h->i_v;
+        case 2: return h->i_w;
+        default: return 0.0f;
+    }
+}
@@ -0,0 +1,40 @@
+// elec_angle.c
+#include "elec_angle.h"
+
+// Generated with sin(2 pi k / 256), k = 0..256, printed to 8 decimals.
+// Built into .rodata; 1 KiB, so it stays in L1 next to the fast loop.
+const float ElecAngle_sineTable[(1 << ELEC_ANGLE_TABLE_BITS) + 1] = {
+    +0.00000000f, +0.02454123f, +0.04906767f, +0.07356456f, +0.09801714f, +0.12241068f, +0.14673047f, +0.17096189f,
+    +0.19509032f, +0.21910124f, +0.24298018f, +0.26671276f, +0.29028468f, +0.31368174f, +0.33688985f, +0.35989504f,
+    +0.38268343f, +0.40524131f, +0.42755509f, +0.44961133f, +0.47139674f, +0.49289819f, +0.51410274f, +0.53499762f,
+    +0.55557023f, +0.57580819f, +0.59569930f, +0.61523159f, +0.63439328f, +0.65317284f, +0.67155895f, +0.68954054f,
+    +0.70710678f, +0.72424708f, +0.74095113f, +0.75720885f, +0.77301045f, +0.78834643f, +0.80320753f, +0.81758481f,
+    +0.83146961f, +0.84485357f, +0.85772861f, +0.87008699f, +0.88192126f, +0.89322430f, +0.90398929f, +0.91420976f,
+    +0.92387953f, +0.93299280f, +0.94154407f, +0.94952818f, +0.95694034f, +0.96377607f, +0.97003125f, +0.97570213f,
+    +0.98078528f, +0.98527764f, +0.98917651f, +0.99247953f, +0.99518473f, +0.99729046f, +0.99879546f, +0.99969882f,
+    +1.00000000f, +0.99969882f, +0.99879546f, +0.99729046f, +0.99518473f, +0.99247953f, +0.98917651f, +0.98527764f,
+    +0.98078528f, +0.97570213f, +0.97003125f, +0.96377607f, +0.95694034f, +0.94952818f, +0.94154407f, +0.93299280f,
+    +0.92387953f, +0.91420976f, +0.90398929f, +0.89322430f, +0.88192126f, +0.87008699f, +0.85772861f, +0.84485357f,
+    +0.83146961f, +0.81758481f, +0.80320753f, +0.78834643f, +0.77301045f, +0.75720885f, +0.74095113f, +0.72424708f,
+    +0.70710678f, +0.68954054f, +0.67155895f, +0.65317284f, +0.63439328f, +0.61523159f, +0.59569930f, +0.57580819f,
+    +0.55557023f, +0.53499762f, +0.51410274f, +0.49289819f, +0.47139674f, +0.44961133f, +0.42755509f, +0.40524131f,
+    +0.38268343f, +0.35989504f, +0.33688985f, +0.31368174f, +0.29028468f, +0.26671276f, +0.24298018f, +0.21910124f,
+    +0.19509032f, +0.17096189f, +0.14673047f, +0.12241068f, +0.09801714f, +0.07356456f, +0.04906767f, +0.02454123f,
+    +0.00000000f, -0.02454123f, -0.04906767f, -0.07356456f, -0.09801714f, -0.12241068f, -0.14673047f, -0.17096189f,
+    -0.19509032f, -0.21910124f, -0.24298018f, -0.26671276f, -0.29028468f, -0.31368174f, -0.33688985f, -0.35989504f,
+    -0.38268343f, -0.40524131f, -0.42755509f, -0.44961133f, -0.47139674f, -0.49289819f, -0.51410274f, -0.53499762f,
+    -0.55557023f, -0.57580819f, -0.59569930f, -0.61523159f, -0.63439328f, -0.65317284f, -0.67155895f, -0.68954054f,
+    -0.70710678f, -0.72424708f, -0.74095113f, -0.75720885f, -0.77301045f, -0.78834643f, -0.80320753f, -0.81758481f,
+    -0.83146961f, -0.84485357f, -0.85772861f, -0.87008699f, -0.88192126f, -0.89322430f, -0.90398929f, -0.91420976f,
+    -0.92387953f, -0.93299280f, -0.94154407f, -0.94952818f, -0.95694034f, -0.96377607f, -0.97003125f, -0.97570213f,
+    -0.98078528f, -0.98527764f, -0.98917651f, -0.99247953f, -0.99518473f, -0.99729046f, -0.99879546f, -0.99969882f,
+    -1.00000000f, -0.99969882f, -0.99879546f, -0.99729046f, -0.99518473f, -0.99247953f, -0.98917651f, -0.98527764f,
+    -0.98078528f, -0.97570213f, -0.97003125f, -0.96377607f, -0.95694034f, -0.94952818f, -0.94154407f, -0.93299280f,
+    -0.92387953f, -0.91420976f, -0.90398929f, -0.89322430f, -0.88192126f, -0.87008699f, -0.85772861f, -0.84485357f,
+    -0.83146961f, -0.81758481f, -0.80320753f, -0.78834643f, -0.77301045f, -0.75720885f, -0.74095113f, -0.72424708f,
+    -0.70710678f, -0.68954054f, -0.67155895f, -0.65317284f, -0.63439328f, -0.61523159f, -0.59569930f, -0.57580819f,
+    -0.55557023f, -0.53499762f, -0.51410274f, -0.49289819f, -0.47139674f, -0.44961133f, -0.42755509f, -0.40524131f,
+    -0.38268343f, -0.35989504f, -0.33688985f, -0.31368174f, -0.29028468f, -0.26671276f, -0.24298018f, -0.21910124f,
+    -0.19509032f, -0.17096189f, -0.14673047f, -0.12241068f, -0.09801714f, -0.07356456f, -0.04906767f, -0.02454123f,
+    +0.00000000f,
+};
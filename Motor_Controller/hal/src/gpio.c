@@ -1,6 +1,42 @@
 #include "gpio.h"
-#include <stdlib.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <string.h>
+
+// ---------------- Handle pool ----------------
+
+static GPIO_Handle     s_pool[GPIO_MAX_HANDLES];
+static pthread_mutex_t s_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static GPIO_Handle *handle_alloc(void)
+{
+    GPIO_Handle *h = NULL;
+
+    pthread_mutex_lock(&s_pool_lock);
+    for (int i = 0; i < GPIO_MAX_HANDLES; ++i) {
+        if (!s_pool[i].in_use) {
+            h = &s_pool[i];
+            memset(h, 0, sizeof(*h));
+            h->in_use = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_pool_lock);
+
+    if (!h) {
+        fprintf(stderr, "gpio_init: all %d handles in use\n", GPIO_MAX_HANDLES);
+    }
+    return h;
+}
+
+static void handle_free(GPIO_Handle *h)
+{
+    pthread_mutex_lock(&s_pool_lock);
+    h->in_use = false;
+    pthread_mutex_unlock(&s_pool_lock);
+}
+
+// ---------------- Public API ----------------
 
 GPIO_Handle* gpio_init(const char *chip_path,
                        const unsigned int *offsets,
@@ -11,12 +47,18 @@ GPIO_Handle* gpio_init(const char *chip_path,
     if (!chip_path || !offsets || num_lines == 0)
         return NULL;
 
-    GPIO_Handle *handle = calloc(1, sizeof(GPIO_Handle));
+    if (num_lines > GPIO_MAX_LINES) {
+        fprintf(stderr, "gpio_init: %zu lines requested, max %d\n",
+                num_lines, GPIO_MAX_LINES);
+        return NULL;
+    }
+
+    GPIO_Handle *handle = handle_alloc();
     if (!handle) return NULL;
 
     handle->chip = gpiod_chip_open(chip_path);
     if (!handle->chip) {
-        free(handle);
+        handle_free(handle);
         return NULL;
     }
 
@@ -24,8 +66,10 @@ GPIO_Handle* gpio_init(const char *chip_path,
     struct gpiod_line_settings *line_settings = gpiod_line_settings_new();
 
     if (!line_config || !line_settings) {
+        gpiod_line_settings_free(line_settings);
+        gpiod_line_config_free(line_config);
         gpiod_chip_close(handle->chip);
-        free(handle);
+        handle_free(handle);
         return NULL;
     }
 
@@ -36,20 +80,26 @@ GPIO_Handle* gpio_init(const char *chip_path,
         gpiod_line_settings_free(line_settings);
         gpiod_line_config_free(line_config);
         gpiod_chip_close(handle->chip);
-        free(handle);
+        handle_free(handle);
         return NULL;
     }
 
     handle->request = gpiod_chip_request_lines(handle->chip, NULL, line_config);
-    handle->offsets = calloc(num_lines, sizeof(unsigned int));
+
+    gpiod_line_settings_free(line_settings);
+    gpiod_line_config_free(line_config);
+
+    if (!handle->request) {
+        gpiod_chip_close(handle->chip);
+        handle_free(handle);
+        return NULL;
+    }
+
     for (size_t i = 0; i < num_lines; i++)
         handle->offsets[i] = offsets[i];
 
     handle->num_lines = num_lines;
 
-    gpiod_line_settings_free(line_settings);
-    gpiod_line_config_free(line_config);
-
     return handle;
 }
 
@@ -61,8 +111,9 @@ void gpio_close(GPIO_Handle *handle)
         gpiod_line_request_release(handle->request);
     if (handle->chip)
         gpiod_chip_close(handle->chip);
-    free(handle->offsets);
-    free(handle);
+    handle->request = NULL;
+    handle->chip    = NULL;
+    handle_free(handle);
 }
 
 int gpio_read(GPIO_Handle *handle, unsigned int line_index)
@@ -88,7 +139,7 @@ int gpio_read_all(GPIO_Handle *handle, int *values)
     if (!handle || !values)
         return -1;
 
-    enum gpiod_line_value vals[handle->num_lines];
+    enum gpiod_line_value vals[GPIO_MAX_LINES];
     if (gpiod_line_request_get_values(handle->request, vals) < 0)
         return -1;
 
@@ -103,9 +154,9 @@ int gpio_write_all(GPIO_Handle *handle, const int *values)
     if (!handle || !values)
         return -1;
 
-    enum gpiod_line_value vals[handle->num_lines];
+    enum gpiod_line_value vals[GPIO_MAX_LINES];
     for (size_t i = 0; i < handle->num_lines; i++)
         vals[i] = values[i] ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE;
 
     return gpiod_line_request_set_values(handle->request, vals);
-}
\ No newline at end of file
+}
@@ -0,0 +1,321 @@
+// perf_counters.c
+#include "perf_counters.h"
+#include "clock_source.h"
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+// glibc has no wrapper for perf_event_open
+static int perf_event_open_sys(struct perf_event_attr *attr,
+                               pid_t pid, int cpu, int group_fd,
+                               unsigned long flags)
+{
+    return (int)syscall(SYS_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+static const struct {
+    uint32_t    type;
+    uint64_t    config;
+    const char *name;
+} s_events[PERF_CNT_COUNT] = {
+    [PERF_CNT_CYCLES]       = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,       "cycles" },
+    [PERF_CNT_INSTRUCTIONS] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,     "instructions" },
+    [PERF_CNT_CACHE_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,     "cache-misses" },
+    [PERF_CNT_CTX_SWITCHES] = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "context-switches" },
+};
+
+#define GROUP_READ_FORMAT   (PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | \
+                             PERF_FORMAT_TOTAL_TIME_RUNNING)
+
+// read(2) of the group leader with GROUP_READ_FORMAT
+typedef struct {
+    uint64_t nr;
+    uint64_t time_enabled;
+    uint64_t time_running;
+    uint64_t value[PERF_CNT_COUNT];   // leader first, then in open order
+} GroupRead_t;
+
+// Try with kernel counting first (context switches are only visible
+// there), then fall back to user-only for perf_event_paranoid >= 2.
+// group_fd >= 0 joins that leader's group.
+static int open_one(PerfCounterId_t id, int group_fd, uint64_t read_format)
+{
+    struct perf_event_attr attr;
+
+    for (int exclude_kernel = 0; exclude_kernel <= 1; ++exclude_kernel) {
+        memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = s_events[id].type;
+        attr.config         = s_events[id].config;
+        attr.disabled       = 0;
+        attr.exclude_kernel = (unsigned)exclude_kernel;
+        attr.exclude_hv     = 1;
+        attr.read_format    = read_format;
+
+        int fd = perf_event_open_sys(&attr, 0 /* this thread */, -1, group_fd, 0);
+        if (fd >= 0) {
+            return fd;
+        }
+        if (errno != EACCES && errno != EPERM) {
+            break;   // ENOENT/EOPNOTSUPP etc: event simply not supported
+        }
+    }
+    return -1;
+}
+
+static bool read_counter(int fd, uint64_t *out)
+{
+    uint64_t v = 0;
+    if (read(fd, &v, sizeof(v)) != (ssize_t)sizeof(v)) {
+        return false;
+    }
+    *out = v;
+    return true;
+}
+
+static bool read_group(const PerfCounters_t *pc, GroupRead_t *g)
+{
+    ssize_t want = (ssize_t)((3 + pc->group_n) * sizeof(uint64_t));
+    if (read(pc->group_fd, g, sizeof(*g)) != want || g->nr != pc->group_n) {
+        return false;
+    }
+    return true;
+}
+
+// Cycles, instructions, cache misses as one group: the first that opens
+// leads, the rest join it
+static void open_hw_group(PerfCounters_t *pc)
+{
+    static const PerfCounterId_t hw[] = {
+        PERF_CNT_CYCLES, PERF_CNT_INSTRUCTIONS, PERF_CNT_CACHE_MISSES
+    };
+
+    for (size_t k = 0; k < sizeof(hw) / sizeof(hw[0]); ++k) {
+        PerfCounterId_t id = hw[k];
+        pc->fd[id] = open_one(id, pc->group_fd, GROUP_READ_FORMAT);
+        if (pc->fd[id] < 0) continue;
+
+        if (pc->group_fd < 0) pc->group_fd = pc->fd[id];
+        pc->group_pos[id] = (int8_t)pc->group_n++;
+    }
+
+    GroupRead_t g;
+    if (pc->group_fd >= 0 && read_group(pc, &g)) {
+        for (int i = 0; i < PERF_CNT_COUNT; ++i) {
+            if (pc->group_pos[i] >= 0) pc->last[i] = g.value[pc->group_pos[i]];
+        }
+        pc->last_enabled = g.time_enabled;
+        pc->last_running = g.time_running;
+    }
+}
+
+bool PerfCounters_open(PerfCounters_t *pc, uint32_t sample_iters)
+{
+    if (!pc) return false;
+
+    memset(pc, 0, sizeof(*pc));
+    pc->sample_iters = (sample_iters > 0) ? sample_iters : 1;
+    atomic_init(&pc->ring_head, 0);
+    atomic_init(&pc->summary_seq, 0);
+
+    pc->group_fd = -1;
+    for (int i = 0; i < PERF_CNT_COUNT; ++i) {
+        pc->fd[i]        = -1;
+        pc->group_pos[i] = -1;
+    }
+    open_hw_group(pc);
+
+    // Software counters are never multiplexed: on their own
+    pc->fd[PERF_CNT_CTX_SWITCHES] = open_one(PERF_CNT_CTX_SWITCHES, -1, 0);
+    if (pc->fd[PERF_CNT_CTX_SWITCHES] >= 0) {
+        (void)read_counter(pc->fd[PERF_CNT_CTX_SWITCHES], &pc->last[PERF_CNT_CTX_SWITCHES]);
+    }
+
+    uint8_t mask = 0;
+    for (int i = 0; i < PERF_CNT_COUNT; ++i) {
+        if (pc->fd[i] >= 0) {
+            mask |= (uint8_t)(1u << i);
+        } else {
+            fprintf(stderr, "PerfCounters: %s unavailable (%s)\n",
+                    s_events[i].name, strerror(errno));
+        }
+    }
+
+    pc->summary.available    = (mask != 0);
+    pc->summary.counter_mask = mask;
+    pc->window_start_ns      = Clock_nowNs();
+
+    return pc->summary.available;
+}
+
+static void publish_sample(PerfCounters_t *pc, const PerfSample_t *s,
+                           double window_s)
+{
+    const uint64_t cyc   = s->delta[PERF_CNT_CYCLES];
+    const uint64_t instr = s->delta[PERF_CNT_INSTRUCTIONS];
+    const uint64_t miss  = s->delta[PERF_CNT_CACHE_MISSES];
+    const uint64_t ctxsw = s->delta[PERF_CNT_CTX_SWITCHES];
+
+    float ipc  = (cyc > 0)   ? (float)instr / (float)cyc : 0.0f;
+    float mpki = (instr > 0) ? (float)miss * 1000.0f / (float)instr : 0.0f;
+
+    unsigned seq = atomic_load_explicit(&pc->summary_seq, memory_order_relaxed);
+    atomic_store_explicit(&pc->summary_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    PerfSummary_t *sum = &pc->summary;
+    sum->samples++;
+    sum->ctx_sw_per_s    = (window_s > 0.0) ? (float)((double)ctxsw / window_s) : 0.0f;
+    sum->hw_running      = s->hw_running;
+
+    // A dropped window keeps the last hardware numbers
+    if (pc->group_fd >= 0 && s->hw_running <= 0.0f) {
+        sum->hw_dropped++;
+    } else {
+        sum->ipc             = ipc;
+        sum->mpki            = mpki;
+        sum->misses_per_iter = (float)miss / (float)s->iterations;
+        sum->cycles_per_iter = (float)cyc  / (float)s->iterations;
+
+        if (cyc > 0 && (sum->ipc_min == 0.0f || ipc < sum->ipc_min)) {
+            sum->ipc_min = ipc;
+        }
+        if (mpki > sum->mpki_max) {
+            sum->mpki_max = mpki;
+        }
+    }
+
+    atomic_store_explicit(&pc->summary_seq, seq + 2, memory_order_release);
+}
+
+void PerfCounters_tick(PerfCounters_t *pc)
+{
+    if (!pc || !pc->summary.available) return;
+
+    if (++pc->iter_in_window < pc->sample_iters) {
+        return;
+    }
+
+    PerfSample_t s;
+    memset(&s, 0, sizeof(s));
+    s.iterations = pc->iter_in_window;
+
+    // Hardware group: one read, scaled by enabled / running time
+    GroupRead_t g;
+    if (pc->group_fd >= 0 && read_group(pc, &g)) {
+        uint64_t enabled = g.time_enabled - pc->last_enabled;
+        uint64_t running = g.time_running - pc->last_running;
+        pc->last_enabled = g.time_enabled;
+        pc->last_running = g.time_running;
+
+        float frac = (enabled > 0) ? (float)((double)running / (double)enabled) : 0.0f;
+        bool  use  = (frac >= PERF_HW_MIN_RUNNING);
+        s.hw_running = use ? frac : 0.0f;
+
+        for (int i = 0; i < PERF_CNT_COUNT; ++i) {
+            if (pc->group_pos[i] < 0) continue;
+            uint64_t v  = g.value[pc->group_pos[i]];
+            uint64_t d  = v - pc->last[i];
+            pc->last[i] = v;
+            if (use) {
+                s.delta[i] = (running < enabled)
+                           ? (uint64_t)((double)d * (double)enabled / (double)running)
+                           : d;
+            }
+        }
+    }
+
+    uint64_t v;
+    if (pc->fd[PERF_CNT_CTX_SWITCHES] >= 0 &&
+        read_counter(pc->fd[PERF_CNT_CTX_SWITCHES], &v)) {
+        s.delta[PERF_CNT_CTX_SWITCHES]  = v - pc->last[PERF_CNT_CTX_SWITCHES];
+        pc->last[PERF_CNT_CTX_SWITCHES] = v;
+    }
+
+    TimeNs_t t        = Clock_nowNs();
+    double   window_s = (double)(t - pc->window_start_ns) / (double)TIME_NS_PER_S;
+    pc->window_start_ns = t;
+    pc->iter_in_window = 0;
+
+    unsigned head = atomic_load_explicit(&pc->ring_head, memory_order_relaxed);
+    pc->ring[head % PERF_RING_LEN] = s;
+    atomic_store_explicit(&pc->ring_head, head + 1, memory_order_release);
+
+    publish_sample(pc, &s, window_s);
+}
+
+PerfSummary_t PerfCounters_getSummary(const PerfCounters_t *pc)
+{
+    PerfSummary_t out;
+    memset(&out, 0, sizeof(out));
+    if (!pc) return out;
+
+    unsigned s0, s1;
+    do {
+        s0 = atomic_load_explicit(&((PerfCounters_t *)pc)->summary_seq,
+                                  memory_order_acquire);
+        out = pc->summary;
+        atomic_thread_fence(memory_order_acquire);
+        s1 = atomic_load_explicit(&((PerfCounters_t *)pc)->summary_seq,
+                                  memory_order_relaxed);
+    } while ((s0 & 1u) || s0 != s1);
+
+    return out;
+}
+
+uint32_t PerfCounters_getRecent(const PerfCounters_t *pc,
+                                PerfSample_t *out,
+                                uint32_t max_samples)
+{
+    if (!pc || !out || max_samples == 0) return 0;
+
+    unsigned head = atomic_load_explicit(&((PerfCounters_t *)pc)->ring_head,
+                                         memory_order_acquire);
+    uint32_t n = head;
+    if (n > PERF_RING_LEN) n = PERF_RING_LEN;
+    if (n > max_samples)   n = max_samples;
+
+    for (uint32_t i = 0; i < n; ++i) {
+        out[i] = pc->ring[(head - n + i) % PERF_RING_LEN];
+    }
+
+    // Sample j's slot is rewritten once the writer is on sample
+    // j + PERF_RING_LEN (ring_head == j + PERF_RING_LEN while it is): drop
+    // the oldest copies that may have been torn that way
+    atomic_thread_fence(memory_order_acquire);
+    unsigned now   = atomic_load_explicit(&((PerfCounters_t *)pc)->ring_head,
+                                          memory_order_relaxed);
+    unsigned first = head - n;
+    uint32_t drop  = (now - first >= PERF_RING_LEN) ? now - first - PERF_RING_LEN + 1 : 0;
+    if (drop >= n) return 0;
+    if (drop > 0) {
+        memmove(out, out + drop, (n - drop) * sizeof(*out));
+    }
+    return n - drop;
+}
+
+const char *PerfCounters_name(PerfCounterId_t id)
+{
+    if ((int)id < 0 || (int)id >= PERF_CNT_COUNT) return "unknown";
+    return s_events[id].name;
+}
+
+void PerfCounters_close(PerfCounters_t *pc)
+{
+    if (!pc) return;
+
+    // Only touch fds we actually opened (a zeroed instance has fd == 0)
+    for (int i = 0; i < PERF_CNT_COUNT; ++i) {
+        if ((pc->summary.counter_mask & (1u << i)) && pc->fd[i] >= 0) {
+            close(pc->fd[i]);
+        }
+        pc->fd[i] = -1;
+    }
+    pc->group_fd             = -1;
+    pc->summary.available    = false;
+    pc->summary.counter_mask = 0;
+}
@@ -1,5 +1,7 @@
 // hal/src/pwm_motor.c
 #include "pwm_motor.h"
+#include "pwm_pattern.h"
+#include "motor_config.h"   // PWM_MODULATION, PWM_DEAD_TIME_NS
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -170,6 +172,37 @@ static int pwm_set_duty(PwmMotorChannel_t *ch,
     return write_u64(ch->duty_path, duty_ns);
 }
 
+// Switch a channel between normal and inversed polarity. sysfs only
+// accepts this while the channel is disabled, so the output is parked
+// off (duty 0 normal / full duty inversed), disabled, flipped, parked off
+// again in the new sense and re-enabled.
+static int pwm_set_polarity(PwmMotor_t *m, int i, bool inversed)
+{
+    PwmMotorChannel_t *ch = &m->ch[i];
+
+    (void)pwm_set_duty(ch, m->period_ns, m->late[i] ? 1.0f : 0.0f);
+    (void)pwm_set_enabled(ch->enable_path, 0);
+    if (write_str_exact(ch->polarity_path, inversed ? "inversed" : "normal") != 0) {
+        return -1;
+    }
+    m->late[i] = inversed;
+    (void)pwm_set_duty(ch, m->period_ns, inversed ? 1.0f : 0.0f);
+    return pwm_set_enabled(ch->enable_path, 1);
+}
+
+// A late channel (on for the last duty*T of the period) is an inversed
+// channel at 1 - duty. At duty 0 or 1 the alignment does not matter, so
+// the channel keeps the polarity it has: within one modulation scheme
+// the polarity then only changes on the first commutation.
+static int pwm_set_gate(PwmMotor_t *m, int i, float duty, bool late)
+{
+    bool partial = (duty > 0.0f && duty < 1.0f);
+    if (partial && late != m->late[i]) {
+        if (pwm_set_polarity(m, i, late) != 0) return -1;
+    }
+    return pwm_set_duty(&m->ch[i], m->period_ns, m->late[i] ? 1.0f - duty : duty);
+}
+
 // ---------------- PwmMotor API ----------------
 
 static int build_channel_paths(PwmMotorChannel_t *ch,
@@ -196,6 +229,11 @@ static int build_channel_paths(PwmMotorChannel_t *ch,
                  "%s/enable", base);
     if (n <= 0 || (size_t)n >= sizeof(ch->enable_path)) return -1;
 
+    // optional: only needed for the complementary modulation
+    n = snprintf(ch->polarity_path, sizeof(ch->polarity_path),
+                 "%s/polarity", base);
+    if (n <= 0 || (size_t)n >= sizeof(ch->polarity_path)) return -1;
+
     // quick existence check
     if (access(ch->period_path, R_OK | W_OK) != 0 ||
         access(ch->duty_path,   R_OK | W_OK) != 0 ||
@@ -236,15 +274,32 @@ bool PwmMotor_init(PwmMotor_t *m,
     if (period_ns < PERIOD_NS_MIN) period_ns = PERIOD_NS_MIN;
     m->period_ns = period_ns;
 
-    // Configure all channels for this freq with duty=0
+    m->polarity_ok = true;
     for (int i = 0; i < 6; ++i) {
+        if (access(m->ch[i].polarity_path, R_OK | W_OK) != 0) {
+            m->polarity_ok = false;
+        }
+    }
+
+    // Configure all channels for this freq with duty=0, normal polarity
+    // (a previous run may have left a low side inversed)
+    for (int i = 0; i < 6; ++i) {
+        if (m->polarity_ok) {
+            (void)pwm_set_enabled(m->ch[i].enable_path, 0);
+            (void)write_str_exact(m->ch[i].polarity_path, "normal");
+        }
         if (pwm_config_channel(m, &m->ch[i], period_ns, 0.0f) != 0) {
             fprintf(stderr, "Failed to configure PWM motor channel %d\n", i);
             return false;
         }
     }
 
-    m->enabled = true;
+    m->enabled    = true;
+    m->modulation = PWM_MOD_HPWM_LON;
+    if (!PwmMotor_setModulation(m, (PwmModulation_t)PWM_MODULATION, PWM_DEAD_TIME_NS)) {
+        fprintf(stderr, "PwmMotor_init: using %s\n",
+                PwmPattern_modulationName(m->modulation));
+    }
     return true;
 }
 
@@ -253,17 +308,64 @@ void PwmMotor_setEnable(PwmMotor_t *m, bool enable)
     if (!m) return;
 
     m->enabled = enable;
+    if (enable) {
+        for (int i = 0; i < 6; ++i) {
+            (void)pwm_set_enabled(m->ch[i].enable_path, 1);
+        }
+        return;
+    }
+
+    // Every output off first, then disable, then put inversed (low-side)
+    // channels back to normal polarity so a disabled channel idles low
+    for (int i = 0; i < 6; ++i) {
+        (void)pwm_set_duty(&m->ch[i], m->period_ns, m->late[i] ? 1.0f : 0.0f);
+    }
+    for (int i = 0; i < 6; ++i) {
+        (void)pwm_set_enabled(m->ch[i].enable_path, 0);
+    }
     for (int i = 0; i < 6; ++i) {
-        if (!enable) {
-            // duty 0 and disable
+        if (m->late[i] && write_str_exact(m->ch[i].polarity_path, "normal") == 0) {
+            m->late[i] = false;
             (void)pwm_set_duty(&m->ch[i], m->period_ns, 0.0f);
-            (void)pwm_set_enabled(m->ch[i].enable_path, 0);
-        } else {
-            (void)pwm_set_enabled(m->ch[i].enable_path, 1);
         }
     }
 }
 
+bool PwmMotor_setModulation(PwmMotor_t *m, PwmModulation_t mod, float dead_time_ns)
+{
+    if (!m || (int)mod < 0 || mod >= PWM_MOD_COUNT) return false;
+
+    if (mod == PWM_MOD_COMPLEMENTARY && !m->polarity_ok) {
+        fprintf(stderr, "PwmMotor_setModulation: %s needs the PWM polarity attribute\n",
+                PwmPattern_modulationName(mod));
+        return false;
+    }
+    m->modulation   = mod;
+    m->dead_time_ns = (dead_time_ns > 0.0f) ? dead_time_ns : 0.0f;
+    return true;
+}
+
+// All six channels off (enabled driver, duty 0 in the channel's sense)
+static void pwm_all_off(PwmMotor_t *m)
+{
+    for (int i = 0; i < 6; ++i) {
+        (void)pwm_set_duty(&m->ch[i], m->period_ns, m->late[i] ? 1.0f : 0.0f);
+    }
+}
+
+// phase A -> ch[0] = INH-A, ch[1] = INL-A, etc.
+static void pwm_apply_gates(PwmMotor_t *m, const PwmGates_t *g)
+{
+    // High sides first: a channel switching polarity is parked off while
+    // it does, so the legs stay free of overlap in between
+    for (int i = 0; i < PWM_PATTERN_CHANNELS; i += 2) {
+        (void)pwm_set_gate(m, i, g->duty[i], g->late[i]);
+    }
+    for (int i = 1; i < PWM_PATTERN_CHANNELS; i += 2) {
+        (void)pwm_set_gate(m, i, g->duty[i], g->late[i]);
+    }
+}
+
 void PwmMotor_applyPhaseState(PwmMotor_t *m,
                               int u, int v, int w,
                               float duty)
@@ -271,63 +373,27 @@ void PwmMotor_applyPhaseState(PwmMotor_t *m,
     if (!m) return;
     if (!m->enabled) {
         // keep everything off
-        for (int i = 0; i < 6; ++i) {
-            (void)pwm_set_duty(&m->ch[i], m->period_ns, 0.0f);
-        }
+        pwm_all_off(m);
         return;
     }
 
-    if (duty < 0.0f) duty = 0.0f;
-    if (duty > 1.0f) duty = 1.0f;
-
-    // phase A -> ch[0] = INH-A, ch[1] = INL-A
-    float duty_inh_a = 0.0f, duty_inl_a = 0.0f;
-    if (u > 0) duty_inh_a = duty;
-    else if (u < 0) duty_inl_a = duty;
-
-    float duty_inh_b = 0.0f, duty_inl_b = 0.0f;
-    if (v > 0) duty_inh_b = duty;
-    else if (v < 0) duty_inl_b = duty;
-
-    float duty_inh_c = 0.0f, duty_inl_c = 0.0f;
-    if (w > 0) duty_inh_c = duty;
-    else if (w < 0) duty_inl_c = duty;
-
-    (void)pwm_set_duty(&m->ch[0], m->period_ns, duty_inh_a);
-    (void)pwm_set_duty(&m->ch[1], m->period_ns, duty_inl_a);
-    (void)pwm_set_duty(&m->ch[2], m->period_ns, duty_inh_b);
-    (void)pwm_set_duty(&m->ch[3], m->period_ns, duty_inl_b);
-    (void)pwm_set_duty(&m->ch[4], m->period_ns, duty_inh_c);
-    (void)pwm_set_duty(&m->ch[5], m->period_ns, duty_inl_c);
+    PwmGates_t g;
+    PwmPattern_phaseGates(u, v, w, duty, m->modulation,
+                          m->dead_time_ns / (float)m->period_ns, &g);
+    pwm_apply_gates(m, &g);
 }
 
-// same sector_to_signs as before
-static void sector_to_signs(uint8_t sector,
-                            bool forward,
-                            int *u, int *v, int *w)
+void PwmMotor_setPhaseDuties(PwmMotor_t *m, const float duty[3])
 {
-    *u = *v = *w = 0;
-    if (sector > 5) return;
-
-    if (forward) {
-        switch (sector) {
-        case 0: *u = +1; *v = -1; *w =  0; break;
-        case 1: *u = +1; *v =  0; *w = -1; break;
-        case 2: *u =  0; *v = +1; *w = -1; break;
-        case 3: *u = -1; *v = +1; *w =  0; break;
-        case 4: *u = -1; *v =  0; *w = +1; break;
-        case 5: *u =  0; *v = -1; *w = +1; break;
-        }
-    } else {
-        switch (sector) {
-        case 0: *u = -1; *v = +1; *w =  0; break;
-        case 1: *u = -1; *v =  0; *w = +1; break;
-        case 2: *u =  0; *v = -1; *w = +1; break;
-        case 3: *u = +1; *v = -1; *w =  0; break;
-        case 4: *u = +1; *v =  0; *w = -1; break;
-        case 5: *u =  0; *v = +1; *w = -1; break;
-        }
+    if (!m) return;
+    if (!m->enabled || !m->polarity_ok) {
+        pwm_all_off(m);
+        return;
     }
+
+    PwmGates_t g;
+    PwmPattern_halfBridgeGates(duty, m->dead_time_ns / (float)m->period_ns, &g);
+    pwm_apply_gates(m, &g);
 }
 
 void PwmMotor_setSixStep(PwmMotor_t *m,
@@ -337,7 +403,7 @@ void PwmMotor_setSixStep(PwmMotor_t *m,
 {
     if (!m) return;
     int u = 0, v = 0, w = 0;
-    sector_to_signs(sector, forward, &u, &v, &w);
+    PwmPattern_sixStepSigns(sector, forward, &u, &v, &w);
     PwmMotor_applyPhaseState(m, u, v, w, duty);
 }
 
@@ -353,3 +419,75 @@ void PwmMotor_deinit(PwmMotor_t *m)
     PwmMotor_stop(m);
     // nothing else to close; /dev nodes are global
 }
+
+// ---------------- Pre-opened safe-stop path ----------------
+
+bool PwmMotor_safeStopOpen(PwmMotorSafeStop_t *ss, const PwmMotor_t *m)
+{
+    if (!ss || !m) return false;
+
+    for (int i = 0; i < 6; ++i) {
+        ss->duty_fd[i]     = -1;
+        ss->enable_fd[i]   = -1;
+        ss->polarity_fd[i] = -1;
+    }
+    ss->ready = false;
+
+    for (int i = 0; i < 6; ++i) {
+        ss->duty_fd[i]   = open(m->ch[i].duty_path,   O_WRONLY);
+        ss->enable_fd[i] = open(m->ch[i].enable_path, O_WRONLY);
+        if (m->polarity_ok) {
+            ss->polarity_fd[i] = open(m->ch[i].polarity_path, O_WRONLY);
+        }
+        if (ss->duty_fd[i] < 0 || ss->enable_fd[i] < 0) {
+            fprintf(stderr, "PwmMotor_safeStopOpen: channel %d: %s\n",
+                    i, strerror(errno));
+            PwmMotor_safeStopClose(ss);
+            return false;
+        }
+    }
+
+    ss->ready = true;
+    return true;
+}
+
+void PwmMotor_safeStop(PwmMotorSafeStop_t *ss)
+{
+    if (!ss || !ss->ready) return;
+
+    // High-side duty first (gates go low even if disable is rejected),
+    // then disable, then back to normal polarity and duty 0 for the low
+    // sides. A low side left inversed by the complementary modulation can
+    // briefly turn on in between (braking, never shoot-through: its high
+    // side is already off). sysfs attributes are rewritten from offset 0
+    // each time.
+    for (int i = 0; i < 6; i += 2) {
+        (void)pwrite(ss->duty_fd[i], "0\n", 2, 0);
+    }
+    for (int i = 0; i < 6; ++i) {
+        (void)pwrite(ss->enable_fd[i], "0\n", 2, 0);
+    }
+    for (int i = 0; i < 6; ++i) {
+        if (ss->polarity_fd[i] >= 0) {
+            (void)pwrite(ss->polarity_fd[i], "normal\n", 7, 0);
+        }
+    }
+    for (int i = 1; i < 6; i += 2) {
+        (void)pwrite(ss->duty_fd[i], "0\n", 2, 0);
+    }
+}
+
+void PwmMotor_safeStopClose(PwmMotorSafeStop_t *ss)
+{
+    if (!ss) return;
+
+    for (int i = 0; i < 6; ++i) {
+        if (ss->duty_fd[i] >= 0)     close(ss->duty_fd[i]);
+        if (ss->enable_fd[i] >= 0)   close(ss->enable_fd[i]);
+        if (ss->polarity_fd[i] >= 0) close(ss->polarity_fd[i]);
+        ss->duty_fd[i]     = -1;
+        ss->enable_fd[i]   = -1;
+        ss->polarity_fd[i] = -1;
+    }
+    ss->ready = false;
+}
@@ -0,0 +1,127 @@
+// pwm_pattern.c
+#include "pwm_pattern.h"
+
+#include <math.h>
+#include <string.h>
+
+void PwmPattern_sixStepSigns(uint8_t sector, bool forward,
+                             int *u, int *v, int *w)
+{
+    *u = *v = *w = 0;
+    if (sector > 5) return;
+
+    if (forward) {
+        switch (sector) {
+        case 0: *u = +1; *v = -1; *w =  0; break;
+        case 1: *u = +1; *v =  0; *w = -1; break;
+        case 2: *u =  0; *v = +1; *w = -1; break;
+        case 3: *u = -1; *v = +1; *w =  0; break;
+        case 4: *u = -1; *v =  0; *w = +1; break;
+        case 5: *u =  0; *v = -1; *w = +1; break;
+        }
+    } else {
+        switch (sector) {
+        case 0: *u = -1; *v = +1; *w =  0; break;
+        case 1: *u = -1; *v =  0; *w = +1; break;
+        case 2: *u =  0; *v = -1; *w = +1; break;
+        case 3: *u = +1; *v = -1; *w =  0; break;
+        case 4: *u = +1; *v =  0; *w = -1; break;
+        case 5: *u =  0; *v = +1; *w = -1; break;
+        }
+    }
+}
+
+void PwmPattern_phaseGates(int u, int v, int w, float duty,
+                           PwmModulation_t mod, float dead_frac,
+                           PwmGates_t *out)
+{
+    if (duty < 0.0f) duty = 0.0f;
+    if (duty > 1.0f) duty = 1.0f;
+    if (dead_frac < 0.0f) dead_frac = 0.0f;
+
+    memset(out, 0, sizeof(*out));
+
+    const int sign[3] = { u, v, w };
+    for (int ph = 0; ph < 3; ++ph) {
+        float *hs = &out->duty[2 * ph];       // INH
+        float *ls = &out->duty[2 * ph + 1];   // INL
+
+        switch (mod) {
+        case PWM_MOD_HPWM_LON:
+            if (sign[ph] > 0) *hs = duty;
+            if (sign[ph] < 0) *ls = 1.0f;
+            break;
+
+        case PWM_MOD_LPWM_HON:
+            if (sign[ph] > 0) *hs = 1.0f;
+            if (sign[ph] < 0) *ls = duty;
+            break;
+
+        case PWM_MOD_COMPLEMENTARY:
+            if (sign[ph] > 0) {
+                // Low side on for the rest of the period, minus the dead time
+                *hs = duty;
+                *ls = 1.0f - duty - dead_frac;
+                if (*ls < 0.0f) *ls = 0.0f;
+                out->late[2 * ph + 1] = true;
+            }
+            if (sign[ph] < 0) *ls = 1.0f;
+            break;
+
+        case PWM_MOD_HPWM_LPWM:
+        default:
+            if (sign[ph] > 0) *hs = duty;
+            if (sign[ph] < 0) *ls = duty;
+            break;
+        }
+    }
+}
+
+void PwmPattern_sineDuties(ElecAngle_t angle, float mag, float duty[3])
+{
+    if (mag < 0.0f) mag = 0.0f;
+    if (mag > 1.0f) mag = 1.0f;
+
+    const float amp = mag * 0.57735027f;       // 1/sqrt(3): line-line = mag
+
+    float a = amp * ElecAngle_cos(angle);
+    float b = amp * ElecAngle_cos((ElecAngle_t)(angle - ELEC_ANGLE_DEG(120)));
+    float c = amp * ElecAngle_cos((ElecAngle_t)(angle + ELEC_ANGLE_DEG(120)));
+
+    float hi  = fmaxf(a, fmaxf(b, c));
+    float lo  = fminf(a, fminf(b, c));
+    float mid = 0.5f * (hi + lo);
+
+    duty[0] = 0.5f + a - mid;
+    duty[1] = 0.5f + b - mid;
+    duty[2] = 0.5f + c - mid;
+}
+
+void PwmPattern_halfBridgeGates(const float duty[3], float dead_frac,
+                                PwmGates_t *out)
+{
+    if (dead_frac < 0.0f) dead_frac = 0.0f;
+    memset(out, 0, sizeof(*out));
+
+    for (int ph = 0; ph < 3; ++ph) {
+        float d = duty[ph];
+        if (d < 0.0f) d = 0.0f;
+        if (d > 1.0f) d = 1.0f;
+
+        float ls = 1.0f - d - dead_frac;
+        out->duty[2 * ph]      = d;
+        out->duty[2 * ph + 1]  = (ls > 0.0f) ? ls : 0.0f;
+        out->late[2 * ph + 1]  = true;
+    }
+}
+
+const char *PwmPattern_modulationName(PwmModulation_t mod)
+{
+    switch (mod) {
+    case PWM_MOD_HPWM_LPWM:     return "H_PWM-L_PWM";
+    case PWM_MOD_HPWM_LON:      return "H_PWM-L_ON";
+    case PWM_MOD_LPWM_HON:      return "L_PWM-H_ON";
+    case PWM_MOD_COMPLEMENTARY: return "COMPLEMENTARY";
+    default:                    return "?";
+    }
+}
@@ -0,0 +1,99 @@
+// rt_alloc_guard.c
+#include "rt_alloc_guard.h"
+#include "motor_config.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Set per thread; initial-exec TLS in the executable, so reading it from
+// inside malloc never allocates.
+static _Thread_local bool s_thread_rt = false;
+
+static atomic_bool          s_hooked;
+static atomic_bool          s_abort = RT_ALLOC_GUARD_ABORT;
+static atomic_uint_fast64_t s_allocs;
+static atomic_uint_fast64_t s_frees;
+static atomic_uint_fast64_t s_bytes;
+static atomic_size_t        s_first_size;
+
+void RtAllocGuard_enterRt(void)
+{
+    s_thread_rt = true;
+}
+
+void RtAllocGuard_leaveRt(void)
+{
+    s_thread_rt = false;
+}
+
+bool RtAllocGuard_isRt(void)
+{
+    return s_thread_rt;
+}
+
+void RtAllocGuard_setAbort(bool abort_on_alloc)
+{
+    atomic_store(&s_abort, abort_on_alloc);
+}
+
+RtAllocStats_t RtAllocGuard_getStats(void)
+{
+    RtAllocStats_t st;
+    memset(&st, 0, sizeof(st));
+    st.hooked     = atomic_load(&s_hooked);
+    st.allocs     = atomic_load(&s_allocs);
+    st.frees      = atomic_load(&s_frees);
+    st.bytes      = atomic_load(&s_bytes);
+    st.first_size = atomic_load(&s_first_size);
+    return st;
+}
+
+void RtAllocGuard_resetStats(void)
+{
+    atomic_store(&s_allocs, 0);
+    atomic_store(&s_frees, 0);
+    atomic_store(&s_bytes, 0);
+    atomic_store(&s_first_size, 0);
+}
+
+// ---------------- Interposer side ----------------
+
+void RtAllocGuard_setHooked(void)
+{
+    atomic_store(&s_hooked, true);
+}
+
+// stdio may allocate, so report with a bare write(2)
+static void die(const char *msg)
+{
+    ssize_t r = write(STDERR_FILENO, msg, strlen(msg));
+    (void)r;
+    abort();
+}
+
+void RtAllocGuard_noteAlloc(size_t size)
+{
+    if (!s_thread_rt) return;
+
+    size_t zero = 0;
+    atomic_compare_exchange_strong(&s_first_size, &zero, size ? size : 1);
+    atomic_fetch_add_explicit(&s_allocs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s_bytes, size, memory_order_relaxed);
+
+    if (atomic_load_explicit(&s_abort, memory_order_relaxed)) {
+        die("RtAllocGuard: heap allocation from a real-time thread\n");
+    }
+}
+
+void RtAllocGuard_noteFree(void)
+{
+    if (!s_thread_rt) return;
+
+    atomic_fetch_add_explicit(&s_frees, 1, memory_order_relaxed);
+
+    if (atomic_load_explicit(&s_abort, memory_order_relaxed)) {
+        die("RtAllocGuard: free() from a real-time thread\n");
+    }
+}
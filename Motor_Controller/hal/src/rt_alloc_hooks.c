@@ -0,0 +1,106 @@
+// rt_alloc_hooks.c
+//
+// malloc interposer for the real-time allocation guard (rt_alloc_guard.h).
+// Compiled into the executable itself, never into a library, so it is
+// only present when asked for (CMake option MOTOR_RT_ALLOC_GUARD).
+//
+// - AddressSanitizer builds: ASan owns malloc, so use its allocation hooks.
+// - Otherwise (glibc): define malloc & co. on top of glibc's __libc_*
+//   entry points. The allocator underneath is unchanged.
+#include "rt_alloc_guard.h"
+
+#include <stddef.h>
+
+#if defined(__SANITIZE_ADDRESS__)
+
+// From <sanitizer/allocator_interface.h>, declared here since not every
+// toolchain installs the sanitizer headers
+int __sanitizer_install_malloc_and_free_hooks(
+    void (*malloc_hook)(const volatile void *ptr, size_t size),
+    void (*free_hook)(const volatile void *ptr));
+
+static void on_malloc(const volatile void *ptr, size_t size)
+{
+    (void)ptr;
+    RtAllocGuard_noteAlloc(size);
+}
+
+static void on_free(const volatile void *ptr)
+{
+    (void)ptr;
+    RtAllocGuard_noteFree();
+}
+
+__attribute__((constructor))
+static void rt_alloc_hooks_install(void)
+{
+    if (__sanitizer_install_malloc_and_free_hooks(on_malloc, on_free)) {
+        RtAllocGuard_setHooked();
+    }
+}
+
+#else
+
+#include <errno.h>
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t align, size_t size);
+extern void  __libc_free(void *ptr);
+
+void *malloc(size_t size)
+{
+    RtAllocGuard_noteAlloc(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+    RtAllocGuard_noteAlloc(n * size);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    RtAllocGuard_noteAlloc(size);
+    return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t align, size_t size)
+{
+    RtAllocGuard_noteAlloc(size);
+    return __libc_memalign(align, size);
+}
+
+void *aligned_alloc(size_t align, size_t size)
+{
+    RtAllocGuard_noteAlloc(size);
+    return __libc_memalign(align, size);
+}
+
+int posix_memalign(void **out, size_t align, size_t size)
+{
+    if (align < sizeof(void *) || (align & (align - 1)) != 0) {
+        return EINVAL;
+    }
+    RtAllocGuard_noteAlloc(size);
+    void *p = __libc_memalign(align, size);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+void free(void *ptr)
+{
+    if (ptr) RtAllocGuard_noteFree();
+    __libc_free(ptr);
+}
+
+__attribute__((constructor))
+static void rt_alloc_hooks_install(void)
+{
+    RtAllocGuard_setHooked();
+}
+
+#endif
@@ -8,6 +8,12 @@ struct timespec timer_now(void) {
     return ts;
 }
 
+TimeNs_t timer_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TimeNs_t)ts.tv_sec * TIME_NS_PER_S + (TimeNs_t)ts.tv_nsec;
+}
+
 long timer_diff_ms(struct timespec start, struct timespec end) {
     long sec_diff = end.tv_sec - start.tv_sec;
     long nsec_diff = end.tv_nsec - start.tv_nsec;
@@ -1,6 +1,8 @@
 /// fast_loop.h
 #pragma once
 
+#include "timer.h"   // TimeNs_t
+
 void FastLoop_init(float period_s);
 
 /**
@@ -9,4 +11,4 @@ void FastLoop_init(float period_s);
  * Must be called periodically at the configured rate
  * (e.g. 20 kHz) from a real-time thread.
  */
-void FastLoop_step(float now_s);
\ No newline at end of file
+void FastLoop_step(TimeNs_t now_ns);
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+#include "motor_config_runtime.h"   // HallMap_t
+
 /**
  * @brief Convert raw Hall bits (A,B,C) into a 6-step sector index.
  *
@@ -11,11 +13,22 @@
  *   bit1 = Hall B (V)
  *   bit2 = Hall C (W)
  *
+ * The axis' learned map if hm is set, else (or hm NULL) the built-in
+ * table.
+ *
  * Returns:
  *   0..5   = valid 6-step sector
  *   0xFF   = invalid pattern (0b000, 0b111, or any wiring glitch)
  */
-uint8_t HallComm_hallToSector(uint8_t hall_bits);
+uint8_t HallComm_hallToSector(const HallMap_t *hm, uint8_t hall_bits);
+
+/**
+ * @brief Electrical angle of the edge into `sector` going forward (the
+ *        sector's start): 60 deg * sector, plus the learned offset of
+ *        that edge if hm is set. Radians, may be slightly negative for
+ *        sector 0.
+ */
+float HallComm_edgeAngleRad(const HallMap_t *hm, uint8_t sector);
 
 /**
  * @brief Map 6-step sector into per-phase signs for U/V/W.
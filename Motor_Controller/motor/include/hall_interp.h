@@ -0,0 +1,88 @@
+// hall_interp.h
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "timer.h"   // TimeNs_t
+#include "motor_config_runtime.h"   // HallMap_t
+
+// Electrical angle between Hall edges, for sinusoidal commutation.
+//
+// Fed every fast-loop tick with the raw Hall bits. A sector change is an
+// edge at a known angle: the boundary between the two sectors, with
+// sector s spanning [60s, 60s + 60) electrical degrees (the frame of
+// PosEst's sector centres, 30 + 60s), moved by the learned edge offsets
+// of the axis' Hall map (HallComm_edgeAngleRad()). Between edges the
+// angle advances at the speed of the last edge-to-edge interval, in the
+// direction the sectors last moved, and stops at the far boundary of the sector if the
+// next edge is late (no overshoot while decelerating). The sector is
+// expected to take the last interval times its width over the width of
+// the sector that interval timed (HallInterp_setSectorScale(); a wide
+// sector takes longer at the same speed).
+//
+// The angle is valid after two edges in the same direction, while the
+// last interval is shorter than max_period_ns and the next edge is not
+// overdue by more than one interval.
+//
+// The last six intervals in one direction add up to an electrical
+// revolution, whatever the sector widths: HallInterp_rpmElec() turns
+// that into a speed timed at the fast rate.
+typedef struct {
+    TimeNs_t max_period_ns;   // slower than this (per sector): not valid
+
+    uint8_t  sector;          // last valid sector (0xFF = none yet)
+    int8_t   dir;             // +1 / -1: direction of the last edge, 0 = none
+    uint8_t  run;             // edges in a row in that direction (saturates)
+    TimeNs_t edge_ns;         // time of the last edge
+    TimeNs_t period_ns;       // last edge-to-edge interval
+    uint8_t  prev_sector;     // the sector period_ns timed
+    TimeNs_t rev[6];          // last intervals in one direction (ring)
+    uint8_t  rev_i;           // next slot
+    uint8_t  rev_n;           // intervals held (saturates at 6)
+
+    // Sector widths relative to 60 deg (float bits), from the slow loop
+    atomic_uint scale[6];
+
+    // Hall decoding (HallInterp_setHallMap()): sector per Hall bits, one
+    // byte each, and the edge offsets (float bits, degrees)
+    atomic_uint_fast64_t map;
+    atomic_uint          edge_deg[6];
+    atomic_bool          map_new;     // tracking starts over
+
+    float    angle_rad;       // [0, 2pi)
+    bool     valid;
+} HallInterp_t;
+
+/**
+ * @brief Reset; max_period_ns sets the lowest usable speed.
+ */
+void HallInterp_init(HallInterp_t *hi, TimeNs_t max_period_ns);
+
+/**
+ * @brief Sector widths for the next edges (SpeedMeas_sectorScale()).
+ *        Any thread; all 1 after init.
+ */
+void HallInterp_setSectorScale(HallInterp_t *hi, const float scale[6]);
+
+/**
+ * @brief Hall decoding of this motor. Any thread; the built-in table
+ *        after init. Tracking starts over at the next update.
+ */
+void HallInterp_setHallMap(HallInterp_t *hi, const HallMap_t *hm);
+
+/**
+ * @brief Track edges and update angle_rad / valid.
+ *
+ * @param hall_bits  Hall_readBits() value
+ * @param now_ns     monotonic time of the read
+ */
+void HallInterp_update(HallInterp_t *hi, uint8_t hall_bits, TimeNs_t now_ns);
+
+/**
+ * @brief Electrical rpm over the last revolution of edges (unsigned, as
+ *        SpeedEstimate_t), 0 while the angle is not valid or fewer than
+ *        six intervals in one direction were timed.
+ */
+float HallInterp_rpmElec(const HallInterp_t *hi);
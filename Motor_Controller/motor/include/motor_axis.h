@@ -0,0 +1,76 @@
+// motor_axis.h
+#pragma once
+
+#include <stdbool.h>
+
+#include "pwm_motor.h"
+#include "hall.h"
+#include "bemf.h"
+#include "current_sense.h"
+#include "timer.h"
+#include "speed_measurement.h"
+#include "hall_interp.h"
+#include "position_estimator.h"
+#include "sensorless_handover.h"
+#include "motor_control.h"
+
+// One motor: the estimator / controller instances plus the hardware
+// handles they run on. The handles are owned (opened and closed) by the
+// caller; everything else lives in the struct, so a process can hold as
+// many axes as it has hardware for.
+
+typedef enum {
+    SENSOR_MODE_HALL_ONLY = 0,
+    SENSOR_MODE_AUTO      = 1,   // start on Hall, hand over to BEMF
+    SENSOR_MODE_BEMF_ONLY = 2
+} SensorMode_t;
+
+typedef struct {
+    // Hardware (caller-owned)
+    PwmMotor_t          *pwm;
+    HallHandle_t        *hall;
+    BemfHandle_t        *bemf;
+    CurrentSenseHandle_t *isense;    // NULL = no current sensing / overcurrent trip /
+                                     // current loop (duty mode)
+
+    SpeedMeas_t          speed;
+    HallInterp_t         interp;     // fast-loop Hall angle (sinusoidal commutation)
+    PosEstimator_t       pos;
+    SensorlessHandover_t handover;
+    MotorControl_t       ctrl;
+
+    SensorMode_t         sensor_mode;
+} MotorAxis_t;
+
+/**
+ * @brief Wire up and reset all instances of one axis (Hall-only mode).
+ *
+ * @param isense  phase current sensing (may be NULL); calibrate it
+ *                before the loops start. With it the speed loop runs
+ *                through the inner current loop (CURRENT_LOOP_BW_HZ).
+ */
+void MotorAxis_init(MotorAxis_t *ax,
+                    PwmMotor_t *pwm,
+                    HallHandle_t *hall,
+                    BemfHandle_t *bemf,
+                    CurrentSenseHandle_t *isense);
+
+/**
+ * @brief Select Hall / AUTO handover / BEMF-only position sensing.
+ *
+ * Call before the loops start or from the slow-loop thread.
+ */
+void MotorAxis_setSensorMode(MotorAxis_t *ax, SensorMode_t mode);
+
+/**
+ * @brief One slow-loop (SLOW_LOOP_HZ) step: bus voltage, speed, handover,
+ *        position estimate, then the controller state machine.
+ */
+void MotorAxis_stepSlow(MotorAxis_t *ax, TimeNs_t now_ns);
+
+/**
+ * @brief One fast-loop (FAST_LOOP_HZ) step: phase currents + overcurrent
+ *        check, the interpolated Hall angle (sinusoidal commutation only),
+ *        then commutation + duty apply.
+ */
+void MotorAxis_stepFast(MotorAxis_t *ax);
@@ -0,0 +1,162 @@
+// motor_cmd_queue.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "timer.h"          // TimeNs_t
+#include "motor_config.h"   // CACHE_LINE_BYTES
+#include "freq_resp.h"      // FraConfig_t
+
+// Command mailbox between API threads (UDP, UI...) and the control loop.
+//
+// Bounded lock-free MPSC ring (per-cell sequence numbers): any number of
+// threads may post, the slow loop is the only consumer and drains the
+// ring at one fixed point of MotorControl_stepSlow(). Every accepted
+// command gets a sequence number; when it is applied the consumer records
+// an acknowledgement (slow tick + timestamps) so the poster can look up
+// exactly when, and how long after posting, it took effect.
+
+#define MOTOR_CMD_QUEUE_LEN   32   // power of two
+#define MOTOR_CMD_ACK_LEN     32   // recent acknowledgements kept (power of two)
+
+typedef enum {
+    MOTOR_CMD_ENABLE = 0,          // arg.enable
+    MOTOR_CMD_SPEED,               // arg.speed.rpm / arg.speed.direction
+    MOTOR_CMD_CLEAR_FAULT,
+    MOTOR_CMD_COMMUTATION,         // arg.commutation (MotorCommutation_t)
+    MOTOR_CMD_AUTOTUNE,            // arg.autotune
+    MOTOR_CMD_FRA,                 // arg.fra
+    MOTOR_CMD_IDENT,               // arg.ident
+    MOTOR_CMD_HALL_LEARN           // arg.hall_learn
+} MotorCmdType_t;
+
+typedef struct {
+    uint32_t       seq;            // assigned by MotorCmdQueue_post()
+    MotorCmdType_t type;
+    TimeNs_t       posted_ns;      // Clock_nowNs() when posted
+    union {
+        bool enable;
+        struct {
+            float rpm;
+            bool  direction;       // 0=fwd, 1=rev
+        } speed;
+        int  commutation;
+        struct {
+            bool  start;           // false = abort a running tune
+            bool  apply;           // with start false: apply the last result
+            float rpm;             // setpoint
+            int   rule;            // RelayTuneRule_t
+        } autotune;
+        struct {
+            bool        start;     // false = abort a running analysis
+            int         point;     // MotorFraPoint_t
+            int         response;  // MotorFraResponse_t
+            FraConfig_t cfg;
+        } fra;
+        struct {
+            bool  start;           // false = abort a running identification
+            float rpm;             // spin / coast test speed
+        } ident;
+        struct {
+            bool  start;           // false = abort a running Hall learn
+        } hall_learn;
+    } arg;
+} MotorCmd_t;
+
+typedef struct {
+    uint32_t       seq;
+    MotorCmdType_t type;
+    uint32_t       tick;           // slow-loop tick that applied it
+    TimeNs_t       posted_ns;
+    TimeNs_t       applied_ns;
+} MotorCmdAck_t;
+
+typedef struct {
+    uint32_t posted;               // accepted into the ring
+    uint32_t dropped;              // rejected, ring full
+    uint32_t applied;
+    uint32_t last_seq;             // last applied
+    uint32_t last_tick;
+
+    // Post -> apply latency
+    double   last_latency_s;
+    double   max_latency_s;
+    double   mean_latency_s;
+} MotorCmdStats_t;
+
+typedef struct {
+    atomic_uint seq;
+    MotorCmd_t  cmd;
+} MotorCmdCell_t;
+
+typedef struct {
+    atomic_uint seq;               // seq of the entry (0 = empty), written last
+    MotorCmdAck_t ack;
+} MotorCmdAckCell_t;
+
+// head, tail, acks and statistics each start a cache line: producers
+// contend on head only, and the consumer's tail stays private.
+typedef struct {
+    _Alignas(CACHE_LINE_BYTES)
+    atomic_uint       head;        // next enqueue position (producers)
+    atomic_uint       dropped;     // rejected, ring full (producers)
+
+    _Alignas(CACHE_LINE_BYTES)
+    unsigned          tail;        // next dequeue position (consumer only)
+
+    MotorCmdCell_t    cell[MOTOR_CMD_QUEUE_LEN];
+
+    _Alignas(CACHE_LINE_BYTES)
+    MotorCmdAckCell_t ack[MOTOR_CMD_ACK_LEN];
+
+    // Statistics (written by the consumer, read anywhere)
+    _Alignas(CACHE_LINE_BYTES)
+    atomic_uint       applied;
+    atomic_uint       last_seq;
+    atomic_uint       last_tick;
+    atomic_llong      last_latency_ns;
+    atomic_llong      max_latency_ns;
+    atomic_llong      sum_latency_ns;
+} MotorCmdQueue_t;
+
+/**
+ * @brief Reset the queue (no concurrent users).
+ */
+void MotorCmdQueue_init(MotorCmdQueue_t *q);
+
+/**
+ * @brief Post a command (any thread, lock-free).
+ *
+ * Stamps cmd->seq and cmd->posted_ns.
+ *
+ * @return sequence number (> 0), or 0 if the ring is full.
+ */
+uint32_t MotorCmdQueue_post(MotorCmdQueue_t *q, MotorCmd_t *cmd);
+
+/**
+ * @brief Take the oldest command (consumer thread only).
+ *
+ * @return false if the ring is empty.
+ */
+bool MotorCmdQueue_pop(MotorCmdQueue_t *q, MotorCmd_t *out);
+
+/**
+ * @brief Record that `cmd` was applied at slow tick `tick`, time `now_ns`
+ *        (consumer thread only).
+ */
+void MotorCmdQueue_ack(MotorCmdQueue_t *q, const MotorCmd_t *cmd,
+                       uint32_t tick, TimeNs_t now_ns);
+
+/**
+ * @brief Look up the acknowledgement of command `seq` (any thread).
+ *
+ * @return false if it has not been applied yet, or has aged out of the
+ *         last MOTOR_CMD_ACK_LEN acknowledgements.
+ */
+bool MotorCmdQueue_getAck(const MotorCmdQueue_t *q, uint32_t seq, MotorCmdAck_t *out);
+
+/**
+ * @brief Counters and latency summary (any thread).
+ */
+MotorCmdStats_t MotorCmdQueue_getStats(const MotorCmdQueue_t *q);
@@ -1,40 +1,317 @@
 #pragma once
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include "motor_states.h"
 #include "pwm_motor.h"
+#include "motor_cmd_queue.h"
+#include "position_estimator.h"
+#include "pi_controller.h"
+#include "filters.h"
+#include "foc.h"
+#include "relay_tuner.h"
+#include "freq_resp.h"
+#include "speed_traj.h"
+#include "load_observer.h"
+#include "param_ident.h"
+#include "hall_learn.h"
+#include "elec_angle.h"
+#include "timer.h"
+#include "motor_config.h"   // CACHE_LINE_BYTES
+#include "motor_config_runtime.h"   // MotorParams_t
 #define MOTOR_DISABLE_BUS_FAULTS 1
-// Initialize motor control with a pointer to the phase driver
-void MotorControl_init(PwmMotor_t *pwm);
+
+// What the fast loop needs each tick, packed into 8 bytes so the slow
+// loop can hand it over with one atomic store (no snapshot copy).
+typedef struct {
+    uint8_t state;                    // MotorState_t
+    uint8_t sector;                   // sector to drive (>= 6 = invalid)
+    bool    drive;                    // enabled and not faulted
+    bool    forward;
+    float   ref;                      // duty 0..1; in RUN with the current
+                                      // loop, current reference (A)
+} MotorFastCmd_t;
+
+// Parameter identification run, slow-loop side (the standstill R / L
+// sequencer runs in the fast loop)
+typedef struct {
+    float        rpm;           // spin / coast test speed
+    float        t_s;           // time in the present phase
+    float        t_hold_s;      // time at the test speed
+    float        r_ll, l_ll;    // standstill results (line-line)
+    double       i_sum, v_sum;  // hold: pair current, line-line voltage,
+    double       p_sum;         //   Hall period (1 / rpm)
+    int          n;
+    float        i_hold_a;      // hold results
+    float        v_hold;
+    float        rpm_hold;
+    IdentCoast_t coast;
+} MotorIdentRun_t;
+
+// One motor controller instance. All MotorControl_* calls take the
+// instance; nothing is shared between instances, so one process can run
+// several motors (see motor_exec.h).
+//
+// Grouped by writer, each group on its own cache line(s), so the fast
+// loop, the slow loop and the reader threads don't invalidate each
+// other's lines.
+typedef struct {
+    // ---- Fast loop: read every tick ----
+    // Written by the slow loop (only when it changes) and requestFault().
+    _Alignas(CACHE_LINE_BYTES)
+    atomic_uint_fast64_t  fast_cmd;         // packed MotorFastCmd_t
+    atomic_int            pending_fault;    // queued by MotorControl_requestFault
+    atomic_uint           vbus_v;           // packed float, Vbus for the current loop
+    PwmMotor_t           *pwm;              // fast loop only, once it runs
+    bool                  cur_loop;         // inner current loop on (set before start)
+    atomic_int            commutation;      // MotorCommutation_t in RUN
+
+    // ---- Fast loop: written every tick (fast-loop thread only) ----
+    _Alignas(CACHE_LINE_BYTES)
+    atomic_uint_fast64_t  i_meas;           // packed phase U/V currents (2 floats, A)
+    float                 i_max_a;          // overcurrent trip level (phase peak)
+    float                 i_limit_a;        // cycle-by-cycle limit (below i_max_a)
+    uint32_t              oc_trip_ticks;    // consecutive ticks over i_max_a to trip
+    uint32_t              oc_ticks;         // current run of ticks over it
+    bool                  i_chop;           // over i_limit_a: outputs off this tick
+    uint32_t              chop_ticks;       // ticks chopped so far
+    atomic_uint           duty_out;         // packed float, duty applied this tick
+    atomic_bool           cur_sat;          // current PI at full duty (read by the slow loop)
+    bool                  cur_active;       // current PI ran last tick
+    float                 duty_last;        // last duty applied (preloads the current PI)
+    PI_Controller_t       cur_pi;           // inner loop: DC-link current -> volts
+    ElecAngle_t           elec_angle;       // interpolated Hall angle (updateAngle)
+    bool                  angle_ok;         // elec_angle usable for sine commutation / FOC
+    atomic_uint           edge_rpm_elec;    // packed float, Hall edges timed at the fast
+                                            // rate over a revolution (0 = none)
+    Foc_t                 foc;              // d/q current loop (MOTOR_COMM_FOC)
+    bool                  foc_active;       // FOC ran last tick
+    IdentRL_t             ident_rl;         // standstill R / L in MOTOR_STATE_IDENT;
+                                            // set up by the slow loop before it
+                                            // publishes that state
+    atomic_bool           ident_rl_done;    // ident_rl finished (results readable)
+    atomic_uint           hall_learn_angle; // ElecAngle_t of the vector in
+                                            // MOTOR_STATE_HALL_LEARN
+
+    // ---- Slow loop: working state, slow-loop thread only ----
+    _Alignas(CACHE_LINE_BYTES)
+    MotorContext_t        ctx;
+    const PosEstimator_t *pos;
+    uint64_t              fast_cmd_last;    // last value stored to fast_cmd
+    uint8_t               run_sector;       // estimator sector of this tick
+
+    // Speed-loop output handed to the fast loop (duty, or A with cur_loop)
+    float           duty_cmd;
+
+    // Speed trajectory / direction management
+    SpeedTraj_t     traj;             // rpm_cmd / accel_cmd toward rpm_cmd_target
+    float           rpm_cmd_target;   // internal target for the trajectory
+    float           rpm_cmd_request;  // last requested rpm (user/API)
+    bool            dir_current;      // actual direction (0=fwd,1=rev)
+    bool            dir_requested;    // requested direction
+
+    // Startup open-loop state
+    int             startup_active;
+    uint8_t         startup_sector;
+    uint32_t        startup_step_count;
+    uint32_t        startup_tick_in_step;
+
+    PI_Controller_t speed_pi;         // -> duty, or current reference with cur_loop
+    PI_Schedule_t   speed_sched;      // speed_pi gains vs speed (g_motor_cfg tables)
+    RelayTuner_t    tuner;            // replaces speed_pi while running
+    bool            tune_applied;     // tuner's result given to speed_pi
+    float           i_ref_max;        // speed PI output limit with cur_loop (A)
+    LoadObserver_t  load_obs;         // load torque -> speed-loop feedforward
+    MotorParams_t   params;           // motor model: config, then identified
+    MotorIdentRun_t ident;            // parameter identification (ctx.ident)
+    HallLearn_t     hall_learn;       // Hall commissioning (ctx.hall)
+    bool            hall_map_new;     // ctx.hall.map not taken yet (takeHallMap)
+    uint8_t         hall_bits;        // raw Hall bits of this tick (updateHall)
+    LPF1_t          speed_filt;       // speed PI feedback with cur_loop
+    LPF1_t          obs_speed_filt;   // load observer speed (Hall edge periods)
+    float           vbus_pub;         // last Vbus stored to vbus_v
+
+    TimeNs_t        last_time_ns;     // previous stepSlow() time
+    uint32_t        slow_tick;
+
+    // Frequency-response analysis; results / log read by other threads
+    // under fra.seq
+    FreqResp_t         fra;
+    MotorFraPoint_t    fra_point;
+    MotorFraResponse_t fra_resp;
+
+    // ---- Commands from API threads (split into lines internally) ----
+    MotorCmdQueue_t cmdq;
+
+    // ---- Published snapshot for reader threads (MotorControl_getContext) ----
+    _Alignas(CACHE_LINE_BYTES)
+    atomic_uint     snap_seq;
+    MotorContext_t  snap[2];
+} MotorControl_t;
+
+// Initialize motor control with a pointer to the phase driver and the
+// position estimator of the same motor
+void MotorControl_init(MotorControl_t *mc, PwmMotor_t *pwm, const PosEstimator_t *pos);
+
+// Switch the inner current loop on or off (off = the speed PI drives the
+// duty directly). Needs MotorControl_updateCurrents() every fast tick.
+// Gains follow from g_motor_cfg.current_bw_hz and the motor R / L.
+// Only before the loops start.
+void MotorControl_setCurrentLoop(MotorControl_t *mc, bool en);
 
 // Called from the fast loop (e.g. FAST_LOOP_HZ)
-// Handles commutation + duty application
-void MotorControl_stepFast(void);
+// Handles commutation + duty application (current PI in RUN)
+void MotorControl_stepFast(MotorControl_t *mc);
 
 // Called from the slow loop (e.g. SPEED_LOOP_HZ)
-// Handles state machine, PI speed control, slew limiting, etc.
-void MotorControl_stepSlow(void);
+// Handles state machine, PI speed control, speed trajectory, etc.
+void MotorControl_stepSlow(MotorControl_t *mc);
+
+// Get a snapshot of the current context (state, commands, measurements).
+// Safe from any thread: returns the copy published by the last
+// stepSlow()/setFault(), never a half-updated one. Does not block the
+// control loops.
+MotorContext_t MotorControl_getContext(MotorControl_t *mc);
 
-// Get a snapshot of the current context (state, commands, measurements)
-MotorContext_t MotorControl_getContext(void);
+// Commands below are posted to a lock-free mailbox (any thread) and
+// applied, in order, at the start of the next stepSlow(). Each returns the
+// command's sequence number, or 0 if the mailbox was full.
 
 // High-level API: enable/disable motor (state machine will respect this)
-void MotorControl_setEnable(bool en);
+uint32_t MotorControl_setEnable(MotorControl_t *mc, bool en);
 
 // High-level API: set requested speed and direction.
 // rpm_cmd   : desired mechanical RPM (>=0)
 // direction : 0 = forward, 1 = reverse
-void MotorControl_setSpeedCmd(float rpm_cmd, bool direction);
+uint32_t MotorControl_setSpeedCmd(MotorControl_t *mc, float rpm_cmd, bool direction);
+
+// Select six-step, sinusoidal or FOC commutation for RUN (startup is
+// always six-step). Sinusoidal and FOC drive the three phases as
+// complementary half bridges, so they need a driver with polarity_ok; FOC
+// also needs the current loop (phase current sensing). Otherwise nothing
+// is posted and 0 returned. The default is g_motor_cfg.commutation.
+uint32_t MotorControl_setCommutation(MotorControl_t *mc, MotorCommutation_t mode);
+
+// Relay-autotune the speed PI around rpm (RUN only, forward or reverse as
+// now). The speed-loop output toggles around the value in force until
+// the limit cycle is measured, and the gains from `rule` are published;
+// the speed PI keeps its gains until MotorControl_applyAutotune(). Leaving
+// RUN, the speed band or the timeout aborts the run. Progress and result
+// in ctx.tune.
+uint32_t MotorControl_startAutotune(MotorControl_t *mc, float rpm, RelayTuneRule_t rule);
+uint32_t MotorControl_abortAutotune(MotorControl_t *mc);
+
+// Give the last completed tune's gains to the speed PI, in place of the
+// fixed or scheduled ones (not while a tune, frequency response or
+// identification runs).
+uint32_t MotorControl_applyAutotune(MotorControl_t *mc);
+
+// Measure the frequency response of the running loop (RUN only, not
+// during an autotune): the excitation in cfg is added at `point` every
+// slow tick and `resp` recorded against the signal there (freq_resp.h;
+// cfg->fs_hz is set to SPEED_LOOP_HZ here). Leaving RUN or a new speed
+// command aborts it. Returns 0, nothing posted, for an invalid cfg.
+// Progress in ctx.fra.
+uint32_t MotorControl_startFra(MotorControl_t *mc, const FraConfig_t *cfg,
+                               MotorFraPoint_t point, MotorFraResponse_t resp);
+uint32_t MotorControl_abortFra(MotorControl_t *mc);
+
+// Identify the motor's R, L, Kv, J and friction (param_ident.h): from IDLE,
+// stopped, with the current loop on and complementary modulation. DC and
+// a voltage step on one phase pair at standstill, then a spin up to rpm
+// (forward) and hold, and a coast with the outputs off. On success the
+// results replace this controller's motor model (the current loop gains
+// and the load observer follow; g_motor_cfg and other controllers are
+// left alone) and ctx.ident.runs counts up; saving them is the
+// application's job (MotorConfig_saveMotorParams() with ctx.ident). A
+// disable, speed command, fault or abort ends the run with the motor
+// disabled and the model untouched.
+// Progress and results in ctx.ident.
+uint32_t MotorControl_startIdent(MotorControl_t *mc, float rpm);
+uint32_t MotorControl_abortIdent(MotorControl_t *mc);
+
+// Learn the Hall map and edge offsets (hall_learn.h): from IDLE, stopped.
+// A voltage vector steps the rotor to the six sector centres, then sweeps
+// one mechanical revolution forward and back. On success the map and
+// offsets become this motor's Hall decoding (ctx.hall.map, handed to
+// the estimators through MotorControl_takeHallMap(); g_motor_cfg and
+// other axes are left alone) and ctx.hall.runs counts up; saving them is
+// the application's job (MotorConfig_saveMotorParams() with
+// ctx.hall.map). A disable, speed command, fault or abort ends it with
+// the motor disabled and the decoding untouched. Progress and results
+// in ctx.hall.
+uint32_t MotorControl_startHallLearn(MotorControl_t *mc);
+uint32_t MotorControl_abortHallLearn(MotorControl_t *mc);
+
+// Slow-loop thread only. The Hall decoding a completed Hall learn found,
+// once: true and *out filled the first call after it, false otherwise.
+bool MotorControl_takeHallMap(MotorControl_t *mc, HallMap_t *out);
+
+// Gain / phase per frequency of the last complete analysis, and its raw
+// record (u at the injection point, y the response) from sample `from`.
+// Any thread. Return the count copied, 0 if none, -1 while one runs.
+int MotorControl_getFraResult(MotorControl_t *mc, FraBin_t *out, int max);
+int MotorControl_getFraLog(MotorControl_t *mc, int from, int count, float *u, float *y);
 
 // Report a fault (overcurrent, timing, hall timeout, etc.)
-// This forces the state machine into MOTOR_STATE_FAULT and disables outputs.
-void MotorControl_setFault(MotorFault_t fault);
+// This forces the state machine into MOTOR_STATE_FAULT and publishes
+// drive=0; the fast loop turns the outputs off on its next tick.
+// Slow-loop thread only; other threads use requestFault().
+void MotorControl_setFault(MotorControl_t *mc, MotorFault_t fault);
+
+// Thread-safe variant of setFault() for callers outside the control
+// threads (e.g. the fast-loop watchdog). The fault is only queued here;
+// stepFast() forces the outputs off at once and the next stepSlow()
+// latches it via setFault().
+void MotorControl_requestFault(MotorControl_t *mc, MotorFault_t fault);
 
 // Explicitly clear a latched fault.
 // Puts the controller back to MOTOR_STATE_IDLE with enable=false,
 // and zeroes rpm/torque commands. Host must call setEnable() again.
-void MotorControl_clearFault(void);
+uint32_t MotorControl_clearFault(MotorControl_t *mc);
+
+// Acknowledgement of command `seq` (slow tick and time it was applied).
+// False while still queued, or once it has aged out of the ack history.
+bool MotorControl_getCmdAck(MotorControl_t *mc, uint32_t seq, MotorCmdAck_t *out);
+
+// Mailbox counters and post -> apply latency summary.
+MotorCmdStats_t MotorControl_getCmdStats(MotorControl_t *mc);
+
+// Feed measured phase currents (amps, W = -(U+V)) into the controller.
+// Publishes them to ctx.meas (picked up by the next stepSlow()) and
+// checks the largest |i|:
+//   - above MOTOR_I_LIMIT_FRAC * i_max: stepFast() turns the outputs off
+//     for this PWM period (cycle-by-cycle limit, like the DRV8302's own)
+//   - above i_max for the trip time: MOTOR_FAULT_OVERCURRENT is queued
+//     (g_motor_cfg.i_max_a / oc_trip_us)
+// Fast-loop thread only (call before stepFast(), so a trip turns the
+// outputs off in the same tick).
+void MotorControl_updateCurrents(MotorControl_t *mc, float i_u, float i_v);
+
+// Feed the interpolated electrical angle (hall_interp.h, rad) into the
+// controller. With sinusoidal commutation or FOC, RUN uses it while
+// `valid`, and falls back to six-step on the estimator sector while it is
+// not (low speed, no Hall edges yet); the speed loop then takes rpm_elec
+// (HallInterp_rpmElec(), 0 = none) over the slow loop's polled Hall speed,
+// as does the load observer in any commutation.
+// Fast-loop thread only (before stepFast()).
+void MotorControl_updateAngle(MotorControl_t *mc, float elec_angle_rad, float rpm_elec,
+                              bool valid);
+
+// Commutation in force (any thread).
+MotorCommutation_t MotorControl_getCommutation(MotorControl_t *mc);
+
+// Whether the fast loop is to time the Hall edges for updateAngle():
+// sinusoidal commutation and FOC take the angle, the load observer the
+// speed (any thread).
+bool MotorControl_wantsHallEdges(MotorControl_t *mc);
+
+// Raw Hall bits of this slow tick (Hall commissioning). Slow-loop thread
+// only (call before stepSlow()).
+void MotorControl_updateHall(MotorControl_t *mc, uint8_t hall_bits);
 
 // Feed measured bus voltage into the controller.
 // This stores v_bus into the measurement struct and automatically
 // trips OVERVOLT / UNDERVOLT faults based on motor_config.h limits.
-void MotorControl_updateBusVoltage(float vbus);
\ No newline at end of file
+// Slow-loop thread only (call before stepSlow()).
+void MotorControl_updateBusVoltage(MotorControl_t *mc, float vbus);
\ No newline at end of file
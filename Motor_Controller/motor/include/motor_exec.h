@@ -0,0 +1,116 @@
+// motor_exec.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "motor_axis.h"
+#include "motor_config.h"   // CACHE_LINE_BYTES
+
+// Executive: runs the fast and slow loops of several MotorAxis_t.
+//
+// Axes are spread over `num_workers` workers. Each worker owns two
+// threads, optionally pinned to one CPU:
+//   - fast thread (SCHED_FIFO, best-effort): every 1/FAST_LOOP_HZ, steps
+//     the fast loop of each of its axes, back to back
+//   - slow thread (normal priority): every 1/SLOW_LOOP_HZ, steps the
+//     slow loop of each of its axes
+// This is the same split as the single-motor app; with one worker and
+// one axis it is exactly that app. Both loop threads are marked real-time
+// for the allocation guard (rt_alloc_guard.h).
+//
+// All timing goes through the clock provider (clock_source.h).
+
+#define MOTOR_EXEC_MAX_WORKERS          8
+#define MOTOR_EXEC_MAX_AXES_PER_WORKER  32
+
+#define MOTOR_EXEC_FAST_PRIO            80   // SCHED_FIFO priority (needs CAP_SYS_NICE)
+
+// Optional callbacks, all given the worker index and `user`.
+typedef struct {
+    void (*fast_start)(int worker, void *user);  // fast thread, before the loop
+    void (*fast_tick)(int worker, void *user);   // fast thread, after each tick
+    void (*fast_exit)(int worker, void *user);   // fast thread, after the loop
+    void (*slow_tick)(int worker, void *user);   // slow thread, after each tick
+    void  *user;
+} MotorExecHooks_t;
+
+typedef struct {
+    int      num_axes;
+    uint64_t ticks;              // fast-loop ticks run
+    uint64_t overruns;           // ticks that ended past the next deadline
+    double   work_last_s;        // time spent stepping the axes in one tick
+    double   work_mean_s;
+    double   work_max_s;
+} MotorExecStats_t;
+
+struct MotorExec;
+
+// Each worker starts a cache line, and its stats (written every fast
+// tick) get their own, so workers on different CPUs never share a line.
+typedef struct {
+    _Alignas(CACHE_LINE_BYTES)
+    struct MotorExec *exec;
+    int               index;
+    int               cpu;       // -1 = not pinned
+
+    MotorAxis_t      *axes[MOTOR_EXEC_MAX_AXES_PER_WORKER];
+    int               num_axes;
+
+    pthread_t         fast_thread;
+    pthread_t         slow_thread;
+    bool              fast_started;
+    bool              slow_started;
+
+    // Fast-thread stats (written by the fast thread only)
+    _Alignas(CACHE_LINE_BYTES)
+    atomic_uint_fast64_t ticks;
+    atomic_uint_fast64_t overruns;
+    atomic_llong         work_last_ns;
+    atomic_llong         work_max_ns;
+    atomic_llong         work_sum_ns;
+} MotorExecWorker_t;
+
+typedef struct MotorExec {
+    MotorExecWorker_t worker[MOTOR_EXEC_MAX_WORKERS];
+    int               num_workers;
+    MotorExecHooks_t  hooks;
+    atomic_bool       running;
+} MotorExec_t;
+
+/**
+ * @brief Set up `num_workers` workers (no threads started yet).
+ *
+ * @param cpus   CPU for each worker, or NULL to leave all unpinned
+ * @param hooks  optional callbacks (may be NULL)
+ */
+bool MotorExec_init(MotorExec_t *ex,
+                    int num_workers,
+                    const int *cpus,
+                    const MotorExecHooks_t *hooks);
+
+/**
+ * @brief Assign an axis to the worker with the fewest axes.
+ *
+ * Only before MotorExec_start().
+ *
+ * @return worker index, or -1 if every worker is full.
+ */
+int MotorExec_addAxis(MotorExec_t *ex, MotorAxis_t *ax);
+
+/**
+ * @brief Start the fast and slow threads of every worker.
+ */
+bool MotorExec_start(MotorExec_t *ex);
+
+/**
+ * @brief Stop and join all threads.
+ */
+void MotorExec_stop(MotorExec_t *ex);
+
+/**
+ * @brief Fast-loop statistics of one worker (any thread).
+ */
+MotorExecStats_t MotorExec_getStats(const MotorExec_t *ex, int worker);
@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "motor_config.h"
+#include "motor_config_runtime.h"   // HallMap_t
 
 typedef enum {
     MOTOR_FAULT_NONE = 0,
@@ -18,9 +19,32 @@ typedef enum {
     MOTOR_STATE_IDLE = 0,
     MOTOR_STATE_ALIGN,
     MOTOR_STATE_RUN,
-    MOTOR_STATE_FAULT
+    MOTOR_STATE_FAULT,
+    MOTOR_STATE_IDENT,     // standstill R / L injection (parameter identification)
+    MOTOR_STATE_HALL_LEARN // Hall commissioning: rotor stepped by a voltage vector
 } MotorState_t;
 
+// How RUN drives the phases
+typedef enum {
+    MOTOR_COMM_SIX_STEP = 0,   // Hall/BEMF sector, PwmModulation_t of the driver
+    MOTOR_COMM_SINE,           // sinusoidal duties from the interpolated Hall angle
+    MOTOR_COMM_FOC             // field-oriented current control (foc.h) on that angle
+} MotorCommutation_t;
+
+// Frequency-response analysis: where the excitation goes in ...
+typedef enum {
+    MOTOR_FRA_SPEED_REF = 0,   // speed command: closed speed loop
+    MOTOR_FRA_OUTPUT           // speed-loop output (duty, or A with the current
+                               // loop): the plant the speed PI drives
+} MotorFraPoint_t;
+
+// ... and what is measured
+typedef enum {
+    MOTOR_FRA_RESP_SPEED = 0,  // filtered speed (the speed PI's feedback)
+    MOTOR_FRA_RESP_CURRENT     // bus current: with the current loop and the
+                               // output point, the closed current loop
+} MotorFraResponse_t;
+
 typedef struct {
     float rpm_mech;
     float rpm_elec;
@@ -29,18 +53,75 @@ typedef struct {
     float i_phase_v;
     float i_phase_w;
     float v_bus;
+    float load_nm;     // load torque estimate (observer), Nm
 } MotorMeasurements_t;
 
 typedef struct {
     float rpm_cmd;
-    float torque_cmd;
+    float accel_cmd;   // trajectory acceleration at rpm_cmd (rpm/s)
+    float torque_cmd;  // speed-loop output: duty 0..1, or current reference (A)
+                       // when the inner current loop is on
+    float duty;        // duty applied by the fast loop (0..1)
+    float speed_kp;    // speed PI gains in force (scheduled)
+    float speed_ki;
     bool  enable;
     bool  direction;   // 0=fwd, 1=rev
+    MotorCommutation_t commutation;
 } MotorCommand_t;
 
+// Speed PI relay autotune (relay_tuner.h)
+typedef struct {
+    int   state;       // RelayTuneState_t
+    int   abort;       // RelayAbort_t
+    int   rule;        // RelayTuneRule_t
+    int   cycles;      // cycles measured so far
+    float ku;          // ultimate gain (output per rpm)
+    float pu_s;        // ultimate period
+    float kp, ki;      // result (DONE), not in use until applied
+    bool  applied;     // kp / ki given to the speed PI ("autotune apply")
+} MotorTuneStatus_t;
+
+// Frequency-response analysis (freq_resp.h)
+typedef struct {
+    int   state;       // FraState_t
+    int   exc;         // FraExcitation_t
+    int   point;       // MotorFraPoint_t
+    int   response;    // MotorFraResponse_t
+    int   progress;    // samples recorded
+    int   samples;     // record length (all periods)
+    int   bins;        // analysis frequencies
+} MotorFraStatus_t;
+
+// Motor parameter identification (param_ident.h)
+typedef struct {
+    int   phase;         // ParamIdentPhase_t
+    int   abort;         // ParamIdentAbort_t
+    int   runs;          // completed runs
+    float r_phase_ohm;   // motor model in use: the config's until a run
+    float l_phase_h;     // completes, then its results
+    float kv_rpm_per_v;
+    float inertia_kgm2;
+    float friction_nm;
+} MotorIdentStatus_t;
+
+// Hall sensor commissioning (hall_learn.h)
+typedef struct {
+    int     state;          // HallLearnState_t
+    int     fail;           // HallLearnFail_t
+    int     runs;           // completed runs
+    uint8_t code[6];        // results of the last completed run: Hall
+    float   offset_deg[6];  // bits per sector, edge offsets (electrical)
+    HallMap_t map;          // decoding in use: the config's until a run
+                            // completes, then its results
+} MotorHallLearnStatus_t;
+
 typedef struct {
     MotorState_t        state;
     MotorFault_t        fault;   // <-- make sure this exists
     MotorMeasurements_t meas;
     MotorCommand_t      cmd;
+    MotorTuneStatus_t   tune;
+    MotorFraStatus_t    fra;
+    MotorIdentStatus_t  ident;
+    MotorHallLearnStatus_t hall;
 } MotorContext_t;
\ No newline at end of file
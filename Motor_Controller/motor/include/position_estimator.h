@@ -5,6 +5,7 @@
 #include <stdbool.h>
 #include "hall.h"
 #include "bemf.h"
+#include "speed_measurement.h"
 
 typedef enum {
     POS_MODE_HALL = 0,
@@ -18,8 +19,15 @@ typedef struct {
     uint8_t  sector;       // 0..5 for 6-step
     bool     valid;
 } PosEst_t;
-void PosEst_setBemfHandle(BemfHandle_t *bh);
-void PosEst_init(PosMode_t mode);
-void PosEst_setMode(PosMode_t mode);
-void PosEst_update(void);
-PosEst_t PosEst_get(void);
\ No newline at end of file
+
+// One position estimator (one per motor), fed by a SpeedMeas_t
+typedef struct {
+    PosMode_t          mode;
+    PosEst_t           est;
+    const SpeedMeas_t *speed;
+} PosEstimator_t;
+
+void PosEst_init(PosEstimator_t *pe, const SpeedMeas_t *speed, PosMode_t mode);
+void PosEst_setMode(PosEstimator_t *pe, PosMode_t mode);
+void PosEst_update(PosEstimator_t *pe);
+PosEst_t PosEst_get(const PosEstimator_t *pe);
@@ -7,6 +7,7 @@
 #include "speed_measurement.h"   // SpeedEstimate_t, SpeedSource_t
 #include "position_estimator.h"  // PosMode_t
 #include "bemf_sector.h"         // BemfDir_t
+#include "timer.h"               // TimeNs_t
 
 typedef struct
 {
@@ -15,16 +16,23 @@ typedef struct
     float min_rpm_mech;      // minimum mechanical RPM before we consider BEMF
     int   min_valid_samples; // how many consecutive valid samples required
     int   valid_count;       // running count of valid samples over threshold
+
+    SpeedMeas_t    *speed;   // estimators of the motor this helper switches
+    PosEstimator_t *pos;
 } SensorlessHandover_t;
 
 /**
  * @brief Initialize handover helper.
  *
  * @param h                  instance
+ * @param speed              speed estimator to watch and switch to BEMF
+ * @param pos                position estimator to switch to POS_MODE_BEMF
  * @param min_rpm_mech       minimum mech RPM to allow handover (e.g. 500.0f)
  * @param min_valid_samples  consecutive samples over threshold (e.g. 50)
  */
 void SensorlessHandover_init(SensorlessHandover_t *h,
+                             SpeedMeas_t *speed,
+                             PosEstimator_t *pos,
                              float min_rpm_mech,
                              int   min_valid_samples);
 
@@ -42,11 +50,11 @@ void SensorlessHandover_setEnable(SensorlessHandover_t *h, bool enable);
  * you're still running in Hall mode.
  *
  * @param h              instance
- * @param now_s          current time in seconds (monotonic)
+ * @param now_ns         current time in ns (monotonic)
  * @param direction_fwd  true for forward, false for reverse
  *
  * @return true if the helper *just* completed the handover in this call.
  */
 bool SensorlessHandover_step(SensorlessHandover_t *h,
-                             float now_s,
+                             TimeNs_t now_ns,
                              bool direction_fwd);
\ No newline at end of file
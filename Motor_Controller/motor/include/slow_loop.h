@@ -1,6 +1,8 @@
 // slow_loop.h
 #pragma once
 
+#include "timer.h"   // TimeNs_t
+
 /**
  * @brief Initialize slow loop timing.
  *
@@ -11,6 +13,6 @@ void SlowLoop_init(float period_s);
 /**
  * @brief Run slow loop tasks if it's time.
  *
- * Call this frequently from main() with a monotonic timestamp in seconds.
+ * Call this frequently from main() with a monotonic timestamp in ns.
  */
-void SlowLoop_run(float now_s);
+void SlowLoop_run(TimeNs_t now_ns);
@@ -7,6 +7,9 @@
 #include "hall.h"
 #include "bemf.h"
 #include "bemf_sector.h"
+#include "hall_timing.h"
+#include "motor_config_runtime.h"   // HallMap_t
+#include "timer.h"       // TimeNs_t
 
 typedef enum {
     SPEED_SRC_HALL = 0,
@@ -16,29 +19,58 @@ typedef enum {
 typedef struct {
     float   rpm_mech;
     float   rpm_elec;
-    float   last_period_s;
+    TimeNs_t last_period_ns; // last sector (60 el. deg) period
     uint8_t sector;      // 0..5 valid, 0xFF = invalid / unknown
     bool    valid;
 } SpeedEstimate_t;
 
-void SpeedMeas_init(void);
+// One speed/sector estimator (one per motor)
+typedef struct {
+    SpeedEstimate_t   est;
+    SpeedSource_t     mode;
+
+    HallHandle_t     *hall;
+    HallMap_t         hall_map;     // this motor's Hall decoding
+
+    // BEMF sensorless backend
+    BemfHandle_t     *bemf;
+    BemfSectorState_t bemf_state;
+
+    // Hall-only internal state
+    uint8_t           last_sector;
+    TimeNs_t          last_edge_ns;
+    bool              have_edge;
+    HallTiming_t      timing;       // per-edge widths (HALL_TIMING_*)
+
+    // SPEED_MEAS_HALL_DEBUG bookkeeping
+    uint8_t           dbg_last_sector;
+    uint8_t           dbg_last_bits;
+} SpeedMeas_t;
+
+void SpeedMeas_init(SpeedMeas_t *sm);
 
 /**
  * @brief Select whether speed/sector comes from HALL or BEMF.
  */
-void SpeedMeas_setMode(SpeedSource_t src);
+void SpeedMeas_setMode(SpeedMeas_t *sm, SpeedSource_t src);
 
 /**
  * @brief Attach Hall handle (used in HALL mode).
  */
-void SpeedMeas_setHallHandle(HallHandle_t *hh);
+void SpeedMeas_setHallHandle(SpeedMeas_t *sm, HallHandle_t *hh);
+
+/**
+ * @brief Hall decoding of this motor (the runtime config's after init).
+ *        The learned sector widths start over.
+ */
+void SpeedMeas_setHallMap(SpeedMeas_t *sm, const HallMap_t *hm);
 
 /**
  * @brief Attach BEMF handle (used in BEMF mode).
  *
  * The ADC/BEMF module is updated elsewhere via Bemf_update().
  */
-void SpeedMeas_setBemfHandle(BemfHandle_t *bh);
+void SpeedMeas_setBemfHandle(SpeedMeas_t *sm, BemfHandle_t *bh);
 
 /**
  * @brief Initialize BEMF tracking after alignment / open-loop startup.
@@ -46,7 +78,7 @@ void SpeedMeas_setBemfHandle(BemfHandle_t *bh);
  * @param start_sector  initial sector (0..5)
  * @param dir           direction (BEMF_DIR_FWD / BEMF_DIR_REV)
  */
-void SpeedMeas_bemfAlign(uint8_t start_sector, BemfDir_t dir);
+void SpeedMeas_bemfAlign(SpeedMeas_t *sm, uint8_t start_sector, BemfDir_t dir);
 
 /**
  * @brief Update speed estimation.
@@ -54,16 +86,24 @@ void SpeedMeas_bemfAlign(uint8_t start_sector, BemfDir_t dir);
  * In HALL mode:
  *   - reads Hall bits
  *   - detects sector changes
- *   - computes RPM from time between sector edges
+ *   - computes RPM from time between sector edges, each corrected by
+ *     the learned width of its sector (hall_timing.h)
  *
  * In BEMF mode:
  *   - uses BemfSector_update() + BemfSectorState_t
  *
- * Call this from a periodic (fast) task with monotonic now_s [seconds].
+ * Call this from a periodic (fast) task with monotonic now_ns [ns].
+ */
+void SpeedMeas_update(SpeedMeas_t *sm, TimeNs_t now_ns);
+
+/**
+ * @brief Learned sector widths around the present Hall sector, for the
+ *        fast-loop angle (HallInterp_setSectorScale()); all 1 with the
+ *        compensation off or not in HALL mode.
  */
-void SpeedMeas_update(float now_s);
+void SpeedMeas_sectorScale(const SpeedMeas_t *sm, float scale[6]);
 
 /**
  * @brief Get latest speed + sector estimate.
  */
-SpeedEstimate_t SpeedMeas_get(void);
\ No newline at end of file
+SpeedEstimate_t SpeedMeas_get(const SpeedMeas_t *sm);
\ No newline at end of file
@@ -14,6 +14,10 @@
  *
  * All other patterns invalid (0b000, 0b111, etc.)
  *
+ * This is the built-in table; a Hall commissioning (hall_learn.h) finds
+ * the motor's own (HallMap_t), with the offsets of the edges from their
+ * nominal 60 s.
+ *
  * hall_bits encoding (must match Hall_readBits()):
  *   bit0 = Hall A (U)
  *   bit1 = Hall B (V)
@@ -40,9 +44,21 @@ static const uint8_t s_hall_to_sector[8] = {
     0xFF   // 0b111
 };
 
-uint8_t HallComm_hallToSector(uint8_t hall_bits)
+uint8_t HallComm_hallToSector(const HallMap_t *hm, uint8_t hall_bits)
+{
+    const uint8_t *map = (hm && hm->set) ? hm->map : s_hall_to_sector;
+    return map[hall_bits & 0x7];
+}
+
+float HallComm_edgeAngleRad(const HallMap_t *hm, uint8_t sector)
 {
-    return s_hall_to_sector[hall_bits & 0x7];
+    if (sector >= 6) return 0.0f;
+
+    float deg = 60.0f * (float)sector;
+    if (hm && hm->set) {
+        deg += hm->edge_offset_deg[sector];
+    }
+    return deg * (3.14159265f / 180.0f);
 }
 
 /*
@@ -0,0 +1,173 @@
+// hall_interp.c
+#include "hall_interp.h"
+#include "hall_commutator.h"
+
+#include <string.h>
+
+#define TWO_PI_F     6.28318531f
+#define RUN_MAX      3
+
+void HallInterp_init(HallInterp_t *hi, TimeNs_t max_period_ns)
+{
+    if (!hi) return;
+    memset(hi, 0, sizeof(*hi));
+    hi->max_period_ns = max_period_ns;
+    hi->sector        = 0xFF;
+    hi->prev_sector   = 0xFF;
+
+    const float ones[6] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+    for (int s = 0; s < 6; s++) atomic_init(&hi->scale[s], 0u);
+    HallInterp_setSectorScale(hi, ones);
+
+    atomic_init(&hi->map, 0);
+    for (int s = 0; s < 6; s++) atomic_init(&hi->edge_deg[s], 0u);
+    atomic_init(&hi->map_new, false);
+    HallInterp_setHallMap(hi, NULL);
+}
+
+void HallInterp_setHallMap(HallInterp_t *hi, const HallMap_t *hm)
+{
+    if (!hi) return;
+
+    // Offsets first: the fast loop takes them after the table
+    for (int s = 0; s < 6; s++) {
+        float    deg = (hm && hm->set) ? hm->edge_offset_deg[s] : 0.0f;
+        unsigned w;
+        memcpy(&w, &deg, sizeof(w));
+        atomic_store_explicit(&hi->edge_deg[s], w, memory_order_relaxed);
+    }
+    uint64_t packed = 0;
+    for (int bits = 0; bits < 8; bits++) {
+        packed |= (uint64_t)HallComm_hallToSector(hm, (uint8_t)bits) << (8 * bits);
+    }
+    atomic_store_explicit(&hi->map, packed, memory_order_release);
+    atomic_store_explicit(&hi->map_new, true, memory_order_release);
+}
+
+// The decoding in force, as a set HallMap_t
+static void load_map(HallInterp_t *hi, HallMap_t *hm)
+{
+    uint64_t packed = atomic_load_explicit(&hi->map, memory_order_acquire);
+    hm->set = 1;
+    for (int bits = 0; bits < 8; bits++) {
+        hm->map[bits] = (uint8_t)(packed >> (8 * bits));
+    }
+    for (int s = 0; s < 6; s++) {
+        unsigned w = atomic_load_explicit(&hi->edge_deg[s], memory_order_relaxed);
+        memcpy(&hm->edge_offset_deg[s], &w, sizeof(w));
+    }
+}
+
+void HallInterp_setSectorScale(HallInterp_t *hi, const float scale[6])
+{
+    if (!hi || !scale) return;
+    for (int s = 0; s < 6; s++) {
+        unsigned w;
+        memcpy(&w, &scale[s], sizeof(w));
+        atomic_store_explicit(&hi->scale[s], w, memory_order_relaxed);
+    }
+}
+
+static float sector_scale(const HallInterp_t *hi, uint8_t sector)
+{
+    if (sector > 5) return 1.0f;
+    unsigned w = atomic_load_explicit((atomic_uint *)&hi->scale[sector], memory_order_relaxed);
+    float    v;
+    memcpy(&v, &w, sizeof(v));
+    return (v > 0.0f) ? v : 1.0f;
+}
+
+void HallInterp_update(HallInterp_t *hi, uint8_t hall_bits, TimeNs_t now_ns)
+{
+    if (!hi) return;
+
+    if (atomic_exchange_explicit(&hi->map_new, false, memory_order_acquire)) {
+        // Sectors decoded before mean something else now
+        hi->sector      = 0xFF;
+        hi->prev_sector = 0xFF;
+        hi->dir         = 0;
+        hi->run         = 0;
+        hi->rev_n       = 0;
+    }
+    HallMap_t hm;
+    load_map(hi, &hm);
+
+    uint8_t sector = HallComm_hallToSector(&hm, hall_bits);
+    if (sector == 0xFF) {
+        // Glitch or unplugged: start over
+        hi->sector = 0xFF;
+        hi->dir    = 0;
+        hi->run    = 0;
+        hi->rev_n  = 0;
+        hi->valid  = false;
+        return;
+    }
+
+    if (hi->sector == 0xFF) {
+        hi->sector  = sector;
+        hi->edge_ns = now_ns;
+        hi->valid   = false;
+        return;
+    }
+
+    if (sector != hi->sector) {
+        int step = ((int)sector - (int)hi->sector + 6) % 6;
+        int dir  = (step == 1) ? +1 : (step == 5) ? -1 : 0;   // else: skipped a sector
+
+        if (dir != 0 && dir == hi->dir) {
+            if (hi->run < RUN_MAX) hi->run++;
+        } else {
+            hi->run = (dir != 0) ? 1 : 0;
+        }
+        hi->period_ns   = now_ns - hi->edge_ns;
+
+        // Intervals between two edges the same way round make up a revolution
+        if (dir != 0 && dir == hi->dir) {
+            hi->rev[hi->rev_i] = hi->period_ns;
+            hi->rev_i = (uint8_t)((hi->rev_i + 1) % 6);
+            if (hi->rev_n < 6) hi->rev_n++;
+        } else {
+            hi->rev_n = 0;
+        }
+        hi->dir       = (int8_t)dir;
+        hi->edge_ns     = now_ns;
+        hi->prev_sector = hi->sector;
+        hi->sector      = sector;
+    }
+
+    // This sector's expected duration
+    float expect = (float)hi->period_ns * sector_scale(hi, hi->sector) /
+                   sector_scale(hi, hi->prev_sector);
+
+    TimeNs_t since = now_ns - hi->edge_ns;
+    hi->valid = hi->run >= 2 &&
+                hi->period_ns > 0 &&
+                hi->period_ns <= hi->max_period_ns &&
+                (float)since <= 2.0f * expect;
+
+    // Edge angle: entered going forward at the sector's start, going
+    // backward at its end (learned edge offsets included)
+    float start = HallComm_edgeAngleRad(&hm, hi->sector);
+    float end   = HallComm_edgeAngleRad(&hm, (uint8_t)((hi->sector + 1) % 6));
+    if (hi->sector == 5) end += TWO_PI_F;
+    float span  = end - start;
+    float edge  = (hi->dir < 0) ? end : start;
+
+    float frac = hi->valid ? (float)since / expect : 0.5f;
+    if (frac > 1.0f) frac = 1.0f;
+
+    float angle = hi->valid ? edge + (float)hi->dir * frac * span
+                            : start + 0.5f * span;
+    if (angle < 0.0f)       angle += TWO_PI_F;
+    if (angle >= TWO_PI_F)  angle -= TWO_PI_F;
+    hi->angle_rad = angle;
+}
+
+float HallInterp_rpmElec(const HallInterp_t *hi)
+{
+    if (!hi || !hi->valid || hi->rev_n < 6) return 0.0f;
+
+    TimeNs_t rev_ns = 0;
+    for (int i = 0; i < 6; i++) rev_ns += hi->rev[i];
+    return (rev_ns > 0) ? (float)(60.0 * (double)TIME_NS_PER_S / (double)rev_ns) : 0.0f;
+}
@@ -0,0 +1,150 @@
+// motor_axis.c
+#include "motor_axis.h"
+#include "motor_config.h"
+#include "motor_config_runtime.h"   // g_motor_cfg
+#include "clock_source.h"
+
+#include <string.h>
+
+void MotorAxis_init(MotorAxis_t *ax,
+                    PwmMotor_t *pwm,
+                    HallHandle_t *hall,
+                    BemfHandle_t *bemf,
+                    CurrentSenseHandle_t *isense)
+{
+    if (!ax) return;
+    memset(ax, 0, sizeof(*ax));
+
+    ax->pwm    = pwm;
+    ax->hall   = hall;
+    ax->bemf   = bemf;
+    ax->isense = isense;
+
+    // --- Speed measurement (Hall + BEMF) ---
+    SpeedMeas_init(&ax->speed);
+    SpeedMeas_setHallHandle(&ax->speed, hall);
+    SpeedMeas_setBemfHandle(&ax->speed, bemf);
+    SpeedMeas_setHallMap(&ax->speed, &g_motor_cfg.hall_map);
+
+    // --- Fast-loop Hall angle: one sector at SINE_COMM_MIN_RPM at most ---
+    float min_rpm = (g_motor_cfg.sine_min_rpm > 0.0f) ? g_motor_cfg.sine_min_rpm : SINE_COMM_MIN_RPM;
+    double sector_s = 60.0 / ((double)min_rpm * (double)g_motor_cfg.pole_pairs * 6.0);
+    HallInterp_init(&ax->interp, (TimeNs_t)(sector_s * (double)TIME_NS_PER_S));
+    HallInterp_setHallMap(&ax->interp, &g_motor_cfg.hall_map);
+
+    // --- Modulation scheme (the driver keeps its default if it cannot) ---
+    if (pwm) {
+        (void)PwmMotor_setModulation(pwm, (PwmModulation_t)g_motor_cfg.pwm_modulation,
+                                     g_motor_cfg.pwm_dead_time_ns);
+    }
+
+    // --- Motor control + position estimator ---
+    PosEst_init(&ax->pos, &ax->speed, POS_MODE_HALL);
+    MotorControl_init(&ax->ctrl, pwm, &ax->pos);
+    // Inner current loop whenever the phase currents are measured
+    MotorControl_setCurrentLoop(&ax->ctrl, isense != NULL);
+
+    // --- Sensorless handover helper ---
+    SensorlessHandover_init(&ax->handover,
+                            &ax->speed,
+                            &ax->pos,
+                            SENSORLESS_MIN_RPM_MECH,     // from motor_config.h
+                            SENSORLESS_STABLE_SAMPLES);  // from motor_config.h
+
+    MotorAxis_setSensorMode(ax, SENSOR_MODE_HALL_ONLY);
+}
+
+void MotorAxis_setSensorMode(MotorAxis_t *ax, SensorMode_t mode)
+{
+    if (!ax) return;
+    ax->sensor_mode = mode;
+
+    switch (mode) {
+    case SENSOR_MODE_HALL_ONLY:
+        // Hall sensors only
+        SpeedMeas_setMode(&ax->speed, SPEED_SRC_HALL);
+        PosEst_setMode(&ax->pos, POS_MODE_HALL);
+        SensorlessHandover_setEnable(&ax->handover, false);
+        break;
+
+    case SENSOR_MODE_AUTO:
+        // Start in Hall; allow handover helper to switch to BEMF
+        SpeedMeas_setMode(&ax->speed, SPEED_SRC_HALL);
+        PosEst_setMode(&ax->pos, POS_MODE_HALL);
+        SensorlessHandover_setEnable(&ax->handover, true);
+        break;
+
+    case SENSOR_MODE_BEMF_ONLY:
+        // Force sensorless
+        SpeedMeas_setMode(&ax->speed, SPEED_SRC_BEMF);
+        PosEst_setMode(&ax->pos, POS_MODE_BEMF);
+        SensorlessHandover_setEnable(&ax->handover, false);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void MotorAxis_stepSlow(MotorAxis_t *ax, TimeNs_t now_ns)
+{
+    if (!ax) return;
+
+    // 1) Update BEMF / Vbus sensing
+    if (ax->bemf) {
+        Bemf_update(ax->bemf);
+
+        // 2) Give bus voltage to motor control (stores v_bus + OV/UV faults)
+        MotorControl_updateBusVoltage(&ax->ctrl, Bemf_getVbus(ax->bemf));
+    }
+
+    // 3) Update speed / sector from Hall or BEMF
+    SpeedMeas_update(&ax->speed, now_ns);
+    if (ax->hall) {
+        MotorControl_updateHall(&ax->ctrl, Hall_readBits(ax->hall));
+    }
+    // A Hall learn's decoding to this axis' estimators
+    HallMap_t hm;
+    if (MotorControl_takeHallMap(&ax->ctrl, &hm)) {
+        SpeedMeas_setHallMap(&ax->speed, &hm);
+        HallInterp_setHallMap(&ax->interp, &hm);
+    }
+    // ... and the learned Hall sector widths to the fast-loop angle
+    float scale[6];
+    SpeedMeas_sectorScale(&ax->speed, scale);
+    HallInterp_setSectorScale(&ax->interp, scale);
+
+    // 4) Run sensorless handover helper (Hall -> BEMF) if AUTO mode
+    if (ax->sensor_mode == SENSOR_MODE_AUTO) {
+        MotorContext_t ctx = MotorControl_getContext(&ax->ctrl);
+        bool dir_fwd = (ctx.cmd.direction == 0);  // 0 = forward
+
+        (void)SensorlessHandover_step(&ax->handover, now_ns, dir_fwd);
+    }
+
+    // 5) Update position estimator (uses SpeedMeas_get())
+    PosEst_update(&ax->pos);
+
+    // 6) Slow motor control (state machine + PI + trajectory/direction logic)
+    MotorControl_stepSlow(&ax->ctrl);
+}
+
+void MotorAxis_stepFast(MotorAxis_t *ax)
+{
+    if (!ax) return;
+
+    // Currents first: an overcurrent trip turns the outputs off this tick
+    if (ax->isense) {
+        CurrentSense_update(ax->isense);
+        MotorControl_updateCurrents(&ax->ctrl, ax->isense->i_u, ax->isense->i_v);
+    }
+
+    // The Hall lines are only read at the fast rate when sinusoidal
+    // commutation or FOC needs the angle, or the load observer the speed
+    if (ax->hall && MotorControl_wantsHallEdges(&ax->ctrl)) {
+        HallInterp_update(&ax->interp, Hall_readBits(ax->hall), Clock_nowNs());
+        MotorControl_updateAngle(&ax->ctrl, ax->interp.angle_rad,
+                                 HallInterp_rpmElec(&ax->interp), ax->interp.valid);
+    }
+    MotorControl_stepFast(&ax->ctrl);
+}
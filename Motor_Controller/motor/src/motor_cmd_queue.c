@@ -0,0 +1,172 @@
+// motor_cmd_queue.c
+#include "motor_cmd_queue.h"
+#include "clock_source.h"
+
+#include <string.h>
+
+#define QUEUE_MASK   (MOTOR_CMD_QUEUE_LEN - 1u)
+#define ACK_MASK     (MOTOR_CMD_ACK_LEN - 1u)
+
+_Static_assert((MOTOR_CMD_QUEUE_LEN & QUEUE_MASK) == 0, "MOTOR_CMD_QUEUE_LEN must be a power of two");
+_Static_assert((MOTOR_CMD_ACK_LEN & ACK_MASK) == 0, "MOTOR_CMD_ACK_LEN must be a power of two");
+
+void MotorCmdQueue_init(MotorCmdQueue_t *q)
+{
+    if (!q) return;
+    memset(q, 0, sizeof(*q));
+
+    // Cell i is free for the producer that claims position i
+    for (unsigned i = 0; i < MOTOR_CMD_QUEUE_LEN; ++i) {
+        atomic_init(&q->cell[i].seq, i);
+    }
+    atomic_init(&q->head, 0);
+    q->tail = 0;
+
+    for (unsigned i = 0; i < MOTOR_CMD_ACK_LEN; ++i) {
+        atomic_init(&q->ack[i].seq, 0);
+    }
+    atomic_init(&q->dropped, 0);
+    atomic_init(&q->applied, 0);
+    atomic_init(&q->last_seq, 0);
+    atomic_init(&q->last_tick, 0);
+    atomic_init(&q->last_latency_ns, 0);
+    atomic_init(&q->max_latency_ns, 0);
+    atomic_init(&q->sum_latency_ns, 0);
+}
+
+// ---------------- Producers ----------------
+
+uint32_t MotorCmdQueue_post(MotorCmdQueue_t *q, MotorCmd_t *cmd)
+{
+    if (!q || !cmd) return 0;
+
+    unsigned pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+    MotorCmdCell_t *c;
+
+    for (;;) {
+        c = &q->cell[pos & QUEUE_MASK];
+        unsigned seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+        int diff = (int)(seq - pos);
+
+        if (diff == 0) {
+            // Cell free for this position: claim it
+            if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+            // pos reloaded by the failed CAS
+        } else if (diff < 0) {
+            // Consumer has not freed this cell yet: ring full
+            atomic_fetch_add_explicit(&q->dropped, 1, memory_order_relaxed);
+            return 0;
+        } else {
+            pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+        }
+    }
+
+    // Position is unique and increasing, so it doubles as the command seq
+    cmd->seq       = pos + 1;
+    cmd->posted_ns = Clock_nowNs();
+    c->cmd         = *cmd;
+    atomic_store_explicit(&c->seq, pos + 1, memory_order_release);
+
+    return cmd->seq;
+}
+
+// ---------------- Consumer ----------------
+
+bool MotorCmdQueue_pop(MotorCmdQueue_t *q, MotorCmd_t *out)
+{
+    if (!q || !out) return false;
+
+    MotorCmdCell_t *c = &q->cell[q->tail & QUEUE_MASK];
+    unsigned seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+    if ((int)(seq - (q->tail + 1)) < 0) {
+        return false;   // empty (or producer still writing this cell)
+    }
+
+    *out = c->cmd;
+    atomic_store_explicit(&c->seq, q->tail + MOTOR_CMD_QUEUE_LEN, memory_order_release);
+    q->tail++;
+    return true;
+}
+
+void MotorCmdQueue_ack(MotorCmdQueue_t *q, const MotorCmd_t *cmd,
+                       uint32_t tick, TimeNs_t now_ns)
+{
+    if (!q || !cmd) return;
+
+    MotorCmdAckCell_t *a = &q->ack[cmd->seq & ACK_MASK];
+
+    // seq = 0 marks the cell as being rewritten
+    atomic_store_explicit(&a->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    a->ack.seq        = cmd->seq;
+    a->ack.type       = cmd->type;
+    a->ack.tick       = tick;
+    a->ack.posted_ns  = cmd->posted_ns;
+    a->ack.applied_ns = now_ns;
+
+    atomic_store_explicit(&a->seq, cmd->seq, memory_order_release);
+
+    long long lat = (long long)(now_ns - cmd->posted_ns);
+    if (lat < 0) lat = 0;
+
+    atomic_store_explicit(&q->last_latency_ns, lat, memory_order_relaxed);
+    if (lat > atomic_load_explicit(&q->max_latency_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&q->max_latency_ns, lat, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&q->sum_latency_ns, lat, memory_order_relaxed);
+    atomic_store_explicit(&q->last_tick, tick, memory_order_relaxed);
+    atomic_store_explicit(&q->last_seq, cmd->seq, memory_order_relaxed);
+    atomic_fetch_add_explicit(&q->applied, 1, memory_order_release);
+}
+
+// ---------------- Readers ----------------
+
+bool MotorCmdQueue_getAck(const MotorCmdQueue_t *q, uint32_t seq, MotorCmdAck_t *out)
+{
+    if (!q || !out || seq == 0) return false;
+
+    MotorCmdAckCell_t *a = (MotorCmdAckCell_t *)&q->ack[seq & ACK_MASK];
+
+    unsigned s0 = atomic_load_explicit(&a->seq, memory_order_acquire);
+    if (s0 != seq) {
+        return false;
+    }
+    *out = a->ack;
+    atomic_thread_fence(memory_order_acquire);
+    unsigned s1 = atomic_load_explicit(&a->seq, memory_order_relaxed);
+
+    // Overwritten while copying: the ack has aged out anyway
+    return s1 == seq;
+}
+
+MotorCmdStats_t MotorCmdQueue_getStats(const MotorCmdQueue_t *q)
+{
+    MotorCmdStats_t st;
+    memset(&st, 0, sizeof(st));
+    if (!q) return st;
+
+    MotorCmdQueue_t *mq = (MotorCmdQueue_t *)q;
+
+    st.applied   = atomic_load_explicit(&mq->applied, memory_order_acquire);
+    st.posted    = atomic_load_explicit(&mq->head, memory_order_relaxed);
+    st.dropped   = atomic_load_explicit(&mq->dropped, memory_order_relaxed);
+    st.last_seq  = atomic_load_explicit(&mq->last_seq, memory_order_relaxed);
+    st.last_tick = atomic_load_explicit(&mq->last_tick, memory_order_relaxed);
+
+    long long last = atomic_load_explicit(&mq->last_latency_ns, memory_order_relaxed);
+    long long max  = atomic_load_explicit(&mq->max_latency_ns, memory_order_relaxed);
+    long long sum  = atomic_load_explicit(&mq->sum_latency_ns, memory_order_relaxed);
+
+    st.last_latency_s = (double)last / (double)TIME_NS_PER_S;
+    st.max_latency_s  = (double)max / (double)TIME_NS_PER_S;
+    st.mean_latency_s = (st.applied > 0)
+                        ? (double)sum / (double)TIME_NS_PER_S / (double)st.applied
+                        : 0.0;
+
+    return st;
+}
@@ -1,16 +1,20 @@
 // motor_control.c
 #include "motor_control.h"
 #include "motor_config.h"
+#include "motor_config_runtime.h"   // g_motor_cfg (current limit, trip time, R/L)
 #include "position_estimator.h"
 #include "pi_controller.h"    // <-- use shared PI controller
+#include "clock_source.h"
+#include "pwm_pattern.h"      // six-step phase signs (current loop), sine duties
+#include "foc.h"
+#include "motor_cmd_queue.h"
+#include <stdio.h>
 #include <string.h>           // memset
-#include <math.h>             // fabsf
+#include <math.h>             // fabsf, fmaxf, ceilf, sqrtf
+#include <stdatomic.h>
 
 // ---------------- Tunable constants ----------------
 
-// Max allowed change in commanded speed per second (rpm/s)
-#define MOTOR_RPM_SLEW_RATE      2000.0f   // e.g. 2000 rpm per second
-
 // Threshold below which we consider the motor "stopped enough" to flip direction
 #define MOTOR_RPM_REV_THRESHOLD   100.0f   // rpm
 
@@ -18,7 +22,8 @@
 #define MOTOR_RPM_STOP_THRESHOLD   50.0f   // rpm
 
 // Startup (open-loop) commutation settings
-#define STARTUP_DUTY             0.20f     // fixed duty during open-loop
+#define STARTUP_DUTY             0.60f     // fixed duty during open-loop (H_PWM-L_PWM)
+#define STARTUP_DUTY_HELD_ON     0.20f     // same mean phase voltage with one switch held on
 #define STARTUP_STEPS_TOTAL      36       // number of sector steps (e.g. 6 sectors * 6 revs)
 #define STARTUP_TICKS_PER_STEP   100        // how many slow-loop ticks per sector
 #define STARTUP_HANDOVER_RPM     50.0f     // when rpm_mech > this, hand over to RUN
@@ -29,246 +34,1388 @@
 #define SPEED_PI_OUT_MIN_DEFAULT   0.0f
 #define SPEED_PI_OUT_MAX_DEFAULT   1.0f
 
-// ---------------- Static context & handles ----------------
+// Speed PI with the inner current loop: output is a current reference (A),
+// limited to the cycle-by-cycle limit
+#define SPEED_PI_KP_CURRENT        0.005f    // A per rpm
+#define SPEED_PI_KI_CURRENT        0.050f    // A per rpm*s
+// Without the back-EMF damping of duty mode the speed loop sees every
+// step of the Hall speed estimate; smooth it first
+#define SPEED_FB_FILTER_TAU_S      0.010f
+
+#define RPM_TO_RAD_S               (2.0f * 3.14159265f / 60.0f)
+
+// Sinusoidal commutation: voltage vector angle relative to the Hall angle
+// (hall_interp.h frame, sector s centred on 60s + 30 deg). Six-step
+// sector s drives the vector at 60s - 30 deg forward and 60s + 150 deg
+// in reverse, so these offsets make the sine drive pass through the
+// six-step vector at every sector centre.
+#define SINE_ANGLE_OFFSET_FWD     ELEC_ANGLE_DEG(-60)
+#define SINE_ANGLE_OFFSET_REV     ELEC_ANGLE_DEG(120)
+
+// FOC: the forward sine vector above is the q axis (in phase with the
+// BEMF), so the d axis (rotor flux) lags it by 90 deg. Reverse drives the
+// same axes with negative iq.
+#define FOC_D_AXIS_OFFSET         ELEC_ANGLE_DEG(-150)
+// iq per amp of the speed PI's current reference: the six-step pair
+// current and the sine drive's sine_dc_current() read I when the phase
+// peak is 2/sqrt(3) * I, so the speed loop keeps its gain
+#define FOC_IQ_PER_DC_A           1.15470054f
+
+// Parameter identification: phase pair (six-step sector) of the
+// standstill R / L injection
+#define IDENT_SECTOR              0
+
+// Hall commissioning: a voltage vector at angle a holds the rotor at
+// a + 150 deg in the Hall frame (RUN drives at angle - 60 deg, 90 deg
+// ahead of where the rotor would settle)
+#define HALL_LEARN_VECTOR_OFFSET  ELEC_ANGLE_DEG(-150)
+
+// ---------------- Published snapshot ----------------
+// Latched double buffer: the writer bumps snap_seq (odd) and rewrites
+// snap[0] while readers use snap[1], then bumps it again (even) and
+// rewrites snap[1] while readers use snap[0]. A reader therefore
+// never copies the half being written; it only retries if the sequence
+// moved during its copy, i.e. a publish landed in the middle of it.
+
+// Writer side: slow-loop thread only (init, stepSlow, setFault).
+static void publish_context(MotorControl_t *mc)
+{
+    unsigned seq = atomic_load_explicit(&mc->snap_seq, memory_order_relaxed);
+
+    atomic_store_explicit(&mc->snap_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    mc->snap[0] = mc->ctx;
+
+    atomic_store_explicit(&mc->snap_seq, seq + 2, memory_order_release);
+    atomic_thread_fence(memory_order_release);
+    mc->snap[1] = mc->ctx;
+}
+
+static MotorContext_t read_snapshot(MotorControl_t *mc)
+{
+    MotorContext_t out;
+    unsigned s0, s1;
+    do {
+        s0  = atomic_load_explicit(&mc->snap_seq, memory_order_acquire);
+        out = mc->snap[s0 & 1u];
+        atomic_thread_fence(memory_order_acquire);
+        s1  = atomic_load_explicit(&mc->snap_seq, memory_order_relaxed);
+    } while (s0 != s1);
+
+    return out;
+}
+
+// ---------------- Fast-loop command ----------------
+// The fast loop never touches ctx or the snapshot: at the end of each
+// slow tick (and on setFault) the slow loop packs what it needs into one
+// word. The store is skipped when nothing changed, so in steady state the
+// fast loop's line stays shared-clean in its cache.
+
+_Static_assert(sizeof(MotorFastCmd_t) == sizeof(uint64_t), "MotorFastCmd_t must pack into 64 bits");
+
+static float clamp_duty(float duty)
+{
+    if (duty < 0.0f) return 0.0f;
+    if (duty > 1.0f) return 1.0f;
+    return duty;
+}
+
+// Single floats between the loops go through an atomic word
+static void store_float(atomic_uint *a, float v)
+{
+    unsigned w;
+    memcpy(&w, &v, sizeof(w));
+    atomic_store_explicit(a, w, memory_order_relaxed);
+}
+
+static float load_float(const atomic_uint *a)
+{
+    unsigned w = atomic_load_explicit((atomic_uint *)a, memory_order_relaxed);
+    float    v;
+    memcpy(&v, &w, sizeof(v));
+    return v;
+}
+
+// Slow-loop thread only.
+static void publish_fast_cmd(MotorControl_t *mc)
+{
+    MotorFastCmd_t fc;
+    memset(&fc, 0, sizeof(fc));
+    fc.state   = (uint8_t)mc->ctx.state;
+    fc.drive   = mc->ctx.cmd.enable && mc->ctx.fault == MOTOR_FAULT_NONE;
+    fc.forward = (mc->ctx.cmd.direction == 0);   // 0 = forward
+    // RUN with the current loop: torque_cmd is a current reference
+    if (mc->cur_loop && mc->ctx.state == MOTOR_STATE_RUN) {
+        fc.ref = fmaxf(mc->ctx.cmd.torque_cmd, 0.0f);
+    } else {
+        fc.ref = clamp_duty(mc->ctx.cmd.torque_cmd);
+    }
+    // ALIGN = open-loop startup sector, IDENT = the injection pair, RUN =
+    // estimator sector
+    fc.sector  = (mc->ctx.state == MOTOR_STATE_ALIGN) ? mc->startup_sector
+               : (mc->ctx.state == MOTOR_STATE_IDENT) ? IDENT_SECTOR
+                                                      : mc->run_sector;
+
+    uint64_t w;
+    memcpy(&w, &fc, sizeof(w));
+    if (w != mc->fast_cmd_last) {
+        mc->fast_cmd_last = w;
+        atomic_store_explicit(&mc->fast_cmd, w, memory_order_release);
+    }
+}
+
+static MotorFastCmd_t read_fast_cmd(MotorControl_t *mc)
+{
+    uint64_t w = atomic_load_explicit(&mc->fast_cmd, memory_order_acquire);
+    MotorFastCmd_t fc;
+    memcpy(&fc, &w, sizeof(fc));
+    return fc;
+}
+
+// ---------------- PWM output helpers ----------------
+// Fast loop only: the PwmMotor_t is not shared with any other thread
+// (MotorControl_init() touches it before the loops start).
+
+// Outputs off. PwmMotor_stop() rewrites all six channels, so only do it
+// when the driver is actually on (the fast loop calls this every tick).
+static void pwm_outputs_off(MotorControl_t *mc)
+{
+    if (mc->pwm && mc->pwm->enabled) {
+        PwmMotor_stop(mc->pwm);
+    }
+}
 
-static MotorContext_t s_ctx;
-static PwmMotor_t    *s_pwm = NULL;
+// Duty in force, for the current PI preload and the published context
+static void record_duty(MotorControl_t *mc, float duty)
+{
+    if (duty != mc->duty_last) {
+        mc->duty_last = duty;
+        store_float(&mc->duty_out, duty);
+    }
+}
+
+// Drive one six-step sector. PwmMotor_stop() leaves the driver disabled
+// (and a disabled driver ignores phase commands), so re-enable first.
+static void pwm_drive_six_step(MotorControl_t *mc, uint8_t sector, float duty, bool forward)
+{
+    if (!mc->pwm) return;
+    if (!mc->pwm->enabled) {
+        PwmMotor_setEnable(mc->pwm, true);
+    }
+    PwmMotor_setSixStep(mc->pwm, sector, duty, forward);
+}
 
-// Current duty command (0..1) that fast loop will apply
-static float s_duty_cmd = 0.0f;
+// Six-step duty of the driver's modulation scheme <-> line-line voltage
+// as a fraction of Vbus (H_PWM-L_PWM drives the pair at 2*duty - 1). The
+// sine drive and FOC go through these, so the speed and current loops
+// see one gain whichever commutation is active.
+static float duty_to_line_frac(const MotorControl_t *mc, float duty)
+{
+    return (mc->pwm && mc->pwm->modulation == PWM_MOD_HPWM_LPWM) ? 2.0f * duty - 1.0f : duty;
+}
 
-// Slew / direction management
-static float s_rpm_cmd_target  = 0.0f;  // internal target for slew
-static float s_rpm_cmd_request = 0.0f;  // last requested rpm (user/API)
-static bool  s_dir_current     = false; // actual direction (0=fwd,1=rev)
-static bool  s_dir_requested   = false; // requested direction
+static float line_frac_to_duty(const MotorControl_t *mc, float frac)
+{
+    return (mc->pwm && mc->pwm->modulation == PWM_MOD_HPWM_LPWM) ? 0.5f * (frac + 1.0f) : frac;
+}
 
-// Startup open-loop state
-static int      s_startup_active       = 0;
-static uint8_t  s_startup_sector       = 0;
-static uint32_t s_startup_step_count   = 0;
-static uint32_t s_startup_tick_in_step = 0;
+// Drive the three phases with sinusoidal duties at the six-step `duty`.
+static void pwm_drive_sine(MotorControl_t *mc, ElecAngle_t v_angle, float duty)
+{
+    if (!mc->pwm) return;
+    if (!mc->pwm->enabled) {
+        PwmMotor_setEnable(mc->pwm, true);
+    }
+    float d[3];
+    PwmPattern_sineDuties(v_angle, duty_to_line_frac(mc, duty), d);
+    PwmMotor_setPhaseDuties(mc->pwm, d);
+}
 
-// Shared PI controller instance (from pi_controller.c)
-static PI_Controller_t s_speed_pi;
+// Drive the three phases with duties computed elsewhere (FOC)
+static void pwm_drive_duties(MotorControl_t *mc, const float duty[3])
+{
+    if (!mc->pwm) return;
+    if (!mc->pwm->enabled) {
+        PwmMotor_setEnable(mc->pwm, true);
+    }
+    PwmMotor_setPhaseDuties(mc->pwm, duty);
+}
 
-// ---------------- Slew‑rate & direction logic ----------------
+// ---------------- Speed trajectory & direction logic ----------------
 
-// Update s_rpm_cmd_target and direction based on requested values and actual speed.
-static void update_target_and_direction(void)
+// Update mc->rpm_cmd_target and direction based on requested values and actual speed.
+static void update_target_and_direction(MotorControl_t *mc)
 {
-    float rpm_abs = fabsf(s_ctx.meas.rpm_mech);
+    float rpm_abs = fabsf(mc->ctx.meas.rpm_mech);
 
-    if (s_dir_requested != s_dir_current) {
+    if (mc->dir_requested != mc->dir_current) {
         // Direction change requested
         if (rpm_abs <= MOTOR_RPM_REV_THRESHOLD) {
             // Slow enough: flip direction now
-            s_dir_current       = s_dir_requested;
-            s_ctx.cmd.direction = s_dir_current;     // 0=fwd,1=rev
-            s_rpm_cmd_target    = s_rpm_cmd_request;
+            mc->dir_current       = mc->dir_requested;
+            mc->ctx.cmd.direction = mc->dir_current;     // 0=fwd,1=rev
+            mc->rpm_cmd_target    = mc->rpm_cmd_request;
         } else {
             // Too fast to reverse: brake toward zero (target = 0)
-            s_rpm_cmd_target    = 0.0f;
+            mc->rpm_cmd_target    = 0.0f;
         }
     } else {
         // Direction unchanged: follow requested rpm
-        s_rpm_cmd_target = s_rpm_cmd_request;
+        mc->rpm_cmd_target = mc->rpm_cmd_request;
     }
 
     // Clamp target
-    if (s_rpm_cmd_target > MOTOR_RPM_MAX)  s_rpm_cmd_target = MOTOR_RPM_MAX;
-    if (s_rpm_cmd_target < 0.0f)           s_rpm_cmd_target = 0.0f;
+    if (mc->rpm_cmd_target > MOTOR_RPM_MAX)  mc->rpm_cmd_target = MOTOR_RPM_MAX;
+    if (mc->rpm_cmd_target < 0.0f)           mc->rpm_cmd_target = 0.0f;
 }
 
-// Slew s_ctx.cmd.rpm_cmd toward s_rpm_cmd_target with a rate limit.
-static void update_speed_slew(void)
+// Move mc->ctx.cmd.rpm_cmd toward mc->rpm_cmd_target on the jerk-limited
+// trajectory; ctx.cmd.accel_cmd is its acceleration. A speed set
+// directly since the last tick (startup handover, autotune, stop)
+// restarts the trajectory there, at rest. Limits are read every tick,
+// like the feedforward settings.
+static void update_speed_trajectory(MotorControl_t *mc)
 {
-    // Per-step max change in RPM, based on configured slow loop rate
-    float max_step = MOTOR_RPM_SLEW_RATE / (float)SPEED_LOOP_HZ;
+    SpeedTraj_t *t = &mc->traj;
+    t->a_max = g_motor_cfg.traj_accel_max;
+    t->j_max = g_motor_cfg.traj_jerk_max;
 
-    float diff = s_rpm_cmd_target - s_ctx.cmd.rpm_cmd;
-    if (diff > max_step) {
-        diff = max_step;
-    } else if (diff < -max_step) {
-        diff = -max_step;
+    if (t->v != mc->ctx.cmd.rpm_cmd) {
+        SpeedTraj_reset(t, mc->ctx.cmd.rpm_cmd, 0.0f);
     }
-
-    s_ctx.cmd.rpm_cmd += diff;
+    float rpm = SpeedTraj_step(t, mc->rpm_cmd_target, 1.0f / (float)SPEED_LOOP_HZ);
 
     // Safety clamp
-    if (s_ctx.cmd.rpm_cmd > MOTOR_RPM_MAX) s_ctx.cmd.rpm_cmd = MOTOR_RPM_MAX;
-    if (s_ctx.cmd.rpm_cmd < 0.0f)          s_ctx.cmd.rpm_cmd = 0.0f;
+    if (rpm > MOTOR_RPM_MAX || rpm < 0.0f) {
+        rpm = (rpm < 0.0f) ? 0.0f : MOTOR_RPM_MAX;
+        SpeedTraj_reset(t, rpm, 0.0f);
+    }
+    mc->ctx.cmd.rpm_cmd   = rpm;
+    mc->ctx.cmd.accel_cmd = t->a;
 }
 
 // ---------------- Public API ----------------
 
-void MotorControl_init(PwmMotor_t *pwm)
+// Load observer on the motor model, Kt = 60 / (2 pi Kv), with the speed
+// feedback filter's lag on its current input
+static void load_observer_init(MotorControl_t *mc)
 {
-    s_pwm = pwm;
-    memset(&s_ctx, 0, sizeof(s_ctx));
+    const MotorParams_t *mp = &mc->params;
+    LoadObserver_init(&mc->load_obs, mp->inertia_kgm2, 1.0f / (RPM_TO_RAD_S * mp->kv_rpm_per_v),
+                      mp->friction_nm, g_motor_cfg.load_obs_bw_hz, SPEED_FB_FILTER_TAU_S,
+                      1.0f / (float)SPEED_LOOP_HZ);
+}
 
-    s_ctx.state         = MOTOR_STATE_IDLE;
-    s_ctx.fault         = MOTOR_FAULT_NONE;
-    s_ctx.cmd.enable    = false;
-    s_ctx.cmd.direction = false;   // default forward (0=fwd,1=rev)
-    s_ctx.cmd.rpm_cmd   = 0.0f;
-    s_ctx.cmd.torque_cmd= 0.0f;
+// The observer works on the current the loop delivers, so it runs with
+// the current loop only: in duty mode the current is not (V - BEMF) / 2R
+// once it stops flowing for part of the PWM period
+static bool load_observer_on(const MotorControl_t *mc)
+{
+    return mc->cur_loop && mc->load_obs.alpha > 0.0f;
+}
 
-    s_duty_cmd          = 0.0f;
-    s_rpm_cmd_target    = 0.0f;
-    s_rpm_cmd_request   = 0.0f;
-    s_dir_current       = false;   // forward
-    s_dir_requested     = false;
+void MotorControl_init(MotorControl_t *mc, PwmMotor_t *pwm, const PosEstimator_t *pos)
+{
+    memset(mc, 0, sizeof(*mc));
+    mc->pwm = pwm;
+    mc->pos = pos;
+
+    mc->ctx.state         = MOTOR_STATE_IDLE;
+    mc->ctx.fault         = MOTOR_FAULT_NONE;
+    mc->ctx.cmd.enable    = false;
+    mc->ctx.cmd.direction = false;   // default forward (0=fwd,1=rev)
+    mc->ctx.cmd.rpm_cmd   = 0.0f;
+    mc->ctx.cmd.accel_cmd = 0.0f;
+    mc->ctx.cmd.torque_cmd= 0.0f;
+    SpeedTraj_init(&mc->traj, g_motor_cfg.traj_accel_max, g_motor_cfg.traj_jerk_max, 0.0f);
+
+    // Motor model: the config's, until an identification replaces it
+    MotorConfig_getMotorParams(&mc->params);
+    mc->ctx.ident.r_phase_ohm  = mc->params.r_phase_ohm;
+    mc->ctx.ident.l_phase_h    = mc->params.l_phase_h;
+    mc->ctx.ident.kv_rpm_per_v = mc->params.kv_rpm_per_v;
+    mc->ctx.ident.inertia_kgm2 = mc->params.inertia_kgm2;
+    mc->ctx.ident.friction_nm  = mc->params.friction_nm;
+    load_observer_init(mc);
+
+    mc->duty_cmd          = 0.0f;
+    mc->rpm_cmd_target    = 0.0f;
+    mc->rpm_cmd_request   = 0.0f;
+    mc->dir_current       = false;   // forward
+    mc->dir_requested     = false;
 
     // startup state
-    s_startup_active       = 0;
-    s_startup_sector       = 0;
-    s_startup_step_count   = 0;
-    s_startup_tick_in_step = 0;
+    mc->startup_active       = 0;
+    mc->startup_sector       = 0;
+    mc->startup_step_count   = 0;
+    mc->startup_tick_in_step = 0;
+
+    atomic_store(&mc->pending_fault, MOTOR_FAULT_NONE);
+
+    // Overcurrent limit (runtime config, compile-time default if unset)
+    float i_max   = (g_motor_cfg.i_max_a > 0.0f) ? g_motor_cfg.i_max_a : MOTOR_I_MAX_A;
+    float trip_us = (g_motor_cfg.oc_trip_us > 0.0f) ? g_motor_cfg.oc_trip_us : MOTOR_OC_TRIP_US;
+    mc->i_max_a       = i_max;
+    mc->i_limit_a     = i_max * MOTOR_I_LIMIT_FRAC;
+    mc->i_chop        = false;
+    mc->chop_ticks    = 0;
+    mc->oc_trip_ticks = (uint32_t)ceilf(trip_us * (float)FAST_LOOP_HZ / 1e6f);
+    if (mc->oc_trip_ticks < 1) mc->oc_trip_ticks = 1;
+    mc->oc_ticks      = 0;
+    atomic_init(&mc->i_meas, 0);
+
+    // Current loop: off until MotorControl_setCurrentLoop()
+    mc->i_ref_max  = mc->i_limit_a;
+    mc->vbus_pub   = CURRENT_LOOP_VBUS_NOM_V;
+    mc->duty_last  = 0.0f;
+    mc->cur_active = false;
+    atomic_init(&mc->vbus_v, 0);
+    atomic_init(&mc->duty_out, 0);
+    atomic_init(&mc->cur_sat, false);
+    store_float(&mc->vbus_v, mc->vbus_pub);
+    store_float(&mc->duty_out, 0.0f);
+
+    // Commutation (runtime config); sinusoidal only where the driver can
+    // (FOC also needs the current loop; without it RUN stays six-step)
+    MotorCommutation_t comm = (MotorCommutation_t)g_motor_cfg.commutation;
+    if (comm != MOTOR_COMM_SIX_STEP && !(pwm && pwm->polarity_ok)) {
+        fprintf(stderr, "MotorControl_init: %s needs PWM polarity control; using six-step\n",
+                (comm == MOTOR_COMM_FOC) ? "FOC" : "sinusoidal commutation");
+        comm = MOTOR_COMM_SIX_STEP;
+    }
+    mc->ctx.cmd.commutation = comm;
+    atomic_init(&mc->commutation, (int)comm);
+    mc->elec_angle = 0;
+    mc->angle_ok   = false;
+    atomic_init(&mc->edge_rpm_elec, 0);
+    store_float(&mc->edge_rpm_elec, 0.0f);
+    mc->foc_active = false;
+    memset(&mc->tuner, 0, sizeof(mc->tuner));
+    mc->tune_applied = false;
+    FreqResp_init(&mc->fra);
+    mc->fra_point = MOTOR_FRA_SPEED_REF;
+    mc->fra_resp  = MOTOR_FRA_RESP_SPEED;
+    memset(&mc->ident_rl, 0, sizeof(mc->ident_rl));
+    memset(&mc->ident, 0, sizeof(mc->ident));
+    atomic_init(&mc->ident_rl_done, false);
+    memset(&mc->hall_learn, 0, sizeof(mc->hall_learn));
+    atomic_init(&mc->hall_learn_angle, 0u);
+    mc->ctx.hall.map  = g_motor_cfg.hall_map;   // until a Hall learn
+    mc->hall_map_new  = false;
+
+    MotorCmdQueue_init(&mc->cmdq);
+    mc->slow_tick    = 0;
+    mc->last_time_ns = 0;
+    mc->run_sector   = 0xFF;   // nothing estimated yet
+    mc->fast_cmd_last = ~(uint64_t)0;
+    publish_fast_cmd(mc);
+    publish_context(mc);
+
+    // Speed PI in duty mode
+    MotorControl_setCurrentLoop(mc, false);
+
+    if (mc->pwm) {
+        PwmMotor_stop(mc->pwm);      // ensure outputs off
+    }
+}
 
-    // Initialize the shared speed PI controller
-    float Ts = 1.0f / (float)SPEED_LOOP_HZ;  // slow-loop period
-    PI_init(&s_speed_pi,
-            SPEED_PI_KP_DEFAULT,
-            SPEED_PI_KI_DEFAULT,
-            Ts,
-            SPEED_PI_OUT_MIN_DEFAULT,
-            SPEED_PI_OUT_MAX_DEFAULT);
+// Attach the speed PI gain schedule from a config table (none if empty)
+static void load_speed_schedule(MotorControl_t *mc, const SpeedGainTable_t *t,
+                                float vbus_ref)
+{
+    PI_Schedule_t *s = &mc->speed_sched;
+    memset(s, 0, sizeof(*s));
+
+    int n = t->n;
+    if (n > PI_SCHED_MAX_POINTS) n = PI_SCHED_MAX_POINTS;
+    for (int i = 0; i < n; i++) {
+        s->pt[i].x  = t->rpm[i];
+        s->pt[i].kp = t->kp[i];
+        s->pt[i].ki = t->ki[i];
+    }
+    s->n        = n;
+    s->vbus_ref = vbus_ref;
 
-    if (s_pwm) {
-        PwmMotor_stop(s_pwm);      // ensure outputs off
+    if (n > 0 && !PI_scheduleValid(s)) {
+        fprintf(stderr, "MotorControl: invalid speed gain schedule, keeping fixed gains\n");
+        s->n = 0;
     }
+    PI_setSchedule(&mc->speed_pi, s->n > 0 ? s : NULL);
+    mc->ctx.cmd.speed_kp = mc->speed_pi.kp;
+    mc->ctx.cmd.speed_ki = mc->speed_pi.ki;
 }
 
-MotorContext_t MotorControl_getContext(void)
+// Current PI / FOC gains from the motor model's R and L. Six-step drives two
+// phases in series: line-line R and L. Kp = wc*L, Ki = wc*R cancels the
+// R/L pole, leaving a first-order loop at bw.
+static void current_loop_gains(MotorControl_t *mc)
 {
-    return s_ctx;
+    float r  = mc->params.r_phase_ohm;
+    float l  = mc->params.l_phase_h;
+    float wc = 2.0f * 3.14159265f * g_motor_cfg.current_bw_hz;
+    PI_init(&mc->cur_pi,
+            wc * 2.0f * l,           // V per A
+            wc * 2.0f * r,           // V per A*s
+            1.0f / (float)FAST_LOOP_HZ,
+            0.0f,
+            mc->vbus_pub);           // line volts out, up to Vbus (low end per step)
+
+    // FOC regulates phase currents: per-phase R and L
+    Foc_init(&mc->foc, wc * l, wc * r, 1.0f / (float)FAST_LOOP_HZ);
 }
 
-void MotorControl_setEnable(bool en)
+void MotorControl_setCurrentLoop(MotorControl_t *mc, bool en)
 {
-    // If we’re in FAULT, ignore attempts to re-enable
-    if (s_ctx.state == MOTOR_STATE_FAULT && en) {
+    float bw = g_motor_cfg.current_bw_hz;
+    mc->cur_loop = en && bw > 0.0f;
+
+    // Shared speed PI: duty out, or current reference for the inner loop
+    float Ts = 1.0f / (float)SPEED_LOOP_HZ;  // slow-loop period
+    LPF1_init(&mc->speed_filt, 1.0f - expf(-Ts / SPEED_FB_FILTER_TAU_S));
+    LPF1_init(&mc->obs_speed_filt, 1.0f - expf(-Ts / SPEED_FB_FILTER_TAU_S));
+    if (!mc->cur_loop) {
+        PI_init(&mc->speed_pi,
+                SPEED_PI_KP_DEFAULT,
+                SPEED_PI_KI_DEFAULT,
+                Ts,
+                SPEED_PI_OUT_MIN_DEFAULT,
+                SPEED_PI_OUT_MAX_DEFAULT);
+        load_speed_schedule(mc, &g_motor_cfg.speed_sched_duty,
+                            g_motor_cfg.speed_sched_vbus_ref);
         return;
     }
-    s_ctx.cmd.enable = en;
+    PI_init(&mc->speed_pi,
+            SPEED_PI_KP_CURRENT,
+            SPEED_PI_KI_CURRENT,
+            Ts,
+            0.0f,
+            mc->i_ref_max);
+    // Current reference out: the bus voltage does not enter the loop gain
+    load_speed_schedule(mc, &g_motor_cfg.speed_sched_current, 0.0f);
+
+    current_loop_gains(mc);
 }
 
-void MotorControl_setSpeedCmd(float rpm_cmd, bool direction)
+MotorContext_t MotorControl_getContext(MotorControl_t *mc)
+{
+    return read_snapshot(mc);
+}
+
+uint32_t MotorControl_setEnable(MotorControl_t *mc, bool en)
+{
+    MotorCmd_t cmd = { .type = MOTOR_CMD_ENABLE, .arg.enable = en };
+    return MotorCmdQueue_post(&mc->cmdq, &cmd);
+}
+
+uint32_t MotorControl_setSpeedCmd(MotorControl_t *mc, float rpm_cmd, bool direction)
 {
     // Clamp user request
     if (rpm_cmd > MOTOR_RPM_MAX)  rpm_cmd = MOTOR_RPM_MAX;
     if (rpm_cmd < 0.0f)           rpm_cmd = 0.0f;
 
-    s_rpm_cmd_request = rpm_cmd;
-    s_dir_requested   = direction;   // 0=fwd,1=rev
+    MotorCmd_t cmd = {
+        .type = MOTOR_CMD_SPEED,
+        .arg.speed = { .rpm = rpm_cmd, .direction = direction },   // 0=fwd,1=rev
+    };
+    return MotorCmdQueue_post(&mc->cmdq, &cmd);
+}
+
+uint32_t MotorControl_setCommutation(MotorControl_t *mc, MotorCommutation_t mode)
+{
+    if (mode != MOTOR_COMM_SIX_STEP && mode != MOTOR_COMM_SINE && mode != MOTOR_COMM_FOC) {
+        return 0;
+    }
+    if (mode != MOTOR_COMM_SIX_STEP && !(mc->pwm && mc->pwm->polarity_ok)) {
+        fprintf(stderr, "MotorControl_setCommutation: %s needs PWM polarity control\n",
+                (mode == MOTOR_COMM_FOC) ? "FOC" : "sinusoidal");
+        return 0;
+    }
+    if (mode == MOTOR_COMM_FOC && !mc->cur_loop) {
+        fprintf(stderr, "MotorControl_setCommutation: FOC needs the current loop\n");
+        return 0;
+    }
+    MotorCmd_t cmd = { .type = MOTOR_CMD_COMMUTATION, .arg.commutation = (int)mode };
+    return MotorCmdQueue_post(&mc->cmdq, &cmd);
+}
+
+uint32_t MotorControl_startAutotune(MotorControl_t *mc, float rpm, RelayTuneRule_t rule)
+{
+    if (rpm <= 0.0f || rpm > MOTOR_RPM_MAX ||
+        rule < RELAY_TUNE_ZN || rule >= RELAY_TUNE_RULE_COUNT) {
+        return 0;
+    }
+    MotorCmd_t cmd = {
+        .type = MOTOR_CMD_AUTOTUNE,
+        .arg.autotune = { .start = true, .rpm = rpm, .rule = (int)rule },
+    };
+    return MotorCmdQueue_post(&mc->cmdq, &cmd);
+}
+
+uint32_t MotorControl_abortAutotune(MotorControl_t *mc)
+{
+    MotorCmd_t cmd = { .type = MOTOR_CMD_AUTOTUNE, .arg.autotune = { .start = false } };
+    return MotorCmdQueue_post(&mc->cmdq, &cmd);
+}
+
+uint32_t MotorControl_applyAutotune(MotorControl_t *mc)
+{
+    MotorCmd_t cmd = {
+        .type = MOTOR_CMD_AUTOTUNE,
+        .arg.autotune = { .start = false, .apply = true },
+    };
+    return MotorCmdQueue_post(&mc->cmdq, &cmd);
+}
+
+uint32_t MotorControl_startFra(MotorControl_t *mc, const FraConfig_t *cfg,
+                               MotorFraPoint_t point, MotorFraResponse_t resp)
+{
+    if (!cfg ||
+        point < MOTOR_FRA_SPEED_REF || point > MOTOR_FRA_OUTPUT ||
+        resp < MOTOR_FRA_RESP_SPEED || resp > MOTOR_FRA_RESP_CURRENT) {
+        return 0;
+    }
+    MotorCmd_t cmd = {
+        .type = MOTOR_CMD_FRA,
+        .arg.fra = { .start = true, .point = (int)point, .response = (int)resp, .cfg = *cfg },
+    };
+    cmd.arg.fra.cfg.fs_hz = (float)SPEED_LOOP_HZ;
+    if (!FreqResp_configValid(&cmd.arg.fra.cfg, NULL)) {
+        return 0;
+    }
+    return MotorCmdQueue_post(&mc->cmdq, &cmd);
+}
+
+uint32_t MotorControl_abortFra(MotorControl_t *mc)
+{
+    MotorCmd_t cmd = { .type = MOTOR_CMD_FRA, .arg.fra = { .start = false } };
+    return MotorCmdQueue_post(&mc->cmdq, &cmd);
+}
+
+uint32_t MotorControl_startIdent(MotorControl_t *mc, float rpm)
+{
+    if (rpm <= 0.0f || rpm > MOTOR_RPM_MAX) {
+        return 0;
+    }
+    MotorCmd_t cmd = { .type = MOTOR_CMD_IDENT, .arg.ident = { .start = true, .rpm = rpm } };
+    return MotorCmdQueue_post(&mc->cmdq, &cmd);
+}
+
+uint32_t MotorControl_abortIdent(MotorControl_t *mc)
+{
+    MotorCmd_t cmd = { .type = MOTOR_CMD_IDENT, .arg.ident = { .start = false } };
+    return MotorCmdQueue_post(&mc->cmdq, &cmd);
 }
 
-void MotorControl_setFault(MotorFault_t fault)
+uint32_t MotorControl_startHallLearn(MotorControl_t *mc)
+{
+    MotorCmd_t cmd = { .type = MOTOR_CMD_HALL_LEARN, .arg.hall_learn = { .start = true } };
+    return MotorCmdQueue_post(&mc->cmdq, &cmd);
+}
+
+uint32_t MotorControl_abortHallLearn(MotorControl_t *mc)
+{
+    MotorCmd_t cmd = { .type = MOTOR_CMD_HALL_LEARN, .arg.hall_learn = { .start = false } };
+    return MotorCmdQueue_post(&mc->cmdq, &cmd);
+}
+
+bool MotorControl_takeHallMap(MotorControl_t *mc, HallMap_t *out)
+{
+    if (!mc->hall_map_new || !out) return false;
+    *out = mc->ctx.hall.map;
+    mc->hall_map_new = false;
+    return true;
+}
+
+int MotorControl_getFraResult(MotorControl_t *mc, FraBin_t *out, int max)
+{
+    return FreqResp_readResult(&mc->fra, out, max);
+}
+
+int MotorControl_getFraLog(MotorControl_t *mc, int from, int count, float *u, float *y)
+{
+    return FreqResp_readLog(&mc->fra, from, count, u, y);
+}
+
+MotorCommutation_t MotorControl_getCommutation(MotorControl_t *mc)
+{
+    return (MotorCommutation_t)atomic_load_explicit(&mc->commutation, memory_order_relaxed);
+}
+
+bool MotorControl_wantsHallEdges(MotorControl_t *mc)
+{
+    return MotorControl_getCommutation(mc) != MOTOR_COMM_SIX_STEP || load_observer_on(mc);
+}
+
+bool MotorControl_getCmdAck(MotorControl_t *mc, uint32_t seq, MotorCmdAck_t *out)
+{
+    return MotorCmdQueue_getAck(&mc->cmdq, seq, out);
+}
+
+MotorCmdStats_t MotorControl_getCmdStats(MotorControl_t *mc)
+{
+    return MotorCmdQueue_getStats(&mc->cmdq);
+}
+
+void MotorControl_setFault(MotorControl_t *mc, MotorFault_t fault)
 {
     // Don't clear faults or overwrite first cause here
-    if (s_ctx.state == MOTOR_STATE_FAULT) {
+    if (mc->ctx.state == MOTOR_STATE_FAULT) {
         return;
     }
 
-    s_ctx.fault = fault;
-    s_ctx.state = MOTOR_STATE_FAULT;
+    mc->ctx.fault = fault;
+    mc->ctx.state = MOTOR_STATE_FAULT;
 
     // Immediately shut everything down
-    s_ctx.cmd.enable      = false;
-    s_ctx.cmd.rpm_cmd     = 0.0f;
-    s_rpm_cmd_target      = 0.0f;
-    s_ctx.cmd.torque_cmd  = 0.0f;
-    s_rpm_cmd_request     = 0.0f;
-    s_duty_cmd            = 0.0f;
+    mc->ctx.cmd.enable      = false;
+    mc->ctx.cmd.rpm_cmd     = 0.0f;
+    mc->rpm_cmd_target      = 0.0f;
+    mc->ctx.cmd.torque_cmd  = 0.0f;
+    mc->rpm_cmd_request     = 0.0f;
+    mc->duty_cmd            = 0.0f;
+
+    // The fast loop and readers must see the fault right away; the fast
+    // loop turns the outputs off on its next tick
+    publish_fast_cmd(mc);
+    publish_context(mc);
+}
 
-    if (s_pwm) {
-        PwmMotor_stop(s_pwm);
+void MotorControl_requestFault(MotorControl_t *mc, MotorFault_t fault)
+{
+    if (fault == MOTOR_FAULT_NONE) {
+        return;
+    }
+    int expected = MOTOR_FAULT_NONE;
+    // Keep the first cause if several requests race
+    atomic_compare_exchange_strong(&mc->pending_fault, &expected, (int)fault);
+}
+
+// Latch a fault queued by MotorControl_requestFault(), if any. The
+// request is cleared only after drive=0 is published: until then the
+// fast loop keeps the outputs off on the pending fault alone.
+static void latch_pending_fault(MotorControl_t *mc)
+{
+    int f = atomic_load(&mc->pending_fault);
+    if (f != MOTOR_FAULT_NONE) {
+        MotorControl_setFault(mc, (MotorFault_t)f);
+        atomic_compare_exchange_strong(&mc->pending_fault, &f, MOTOR_FAULT_NONE);
     }
 }
 
 // Explicit clear-fault API: call from UDP or UI when it's safe to try again.
-void MotorControl_clearFault(void)
+uint32_t MotorControl_clearFault(MotorControl_t *mc)
+{
+    MotorCmd_t cmd = { .type = MOTOR_CMD_CLEAR_FAULT };
+    return MotorCmdQueue_post(&mc->cmdq, &cmd);
+}
+
+static void clear_fault_now(MotorControl_t *mc)
 {
+    // A fault requested since this tick's latch wins over the clear
+    if (atomic_load(&mc->pending_fault) != MOTOR_FAULT_NONE) {
+        latch_pending_fault(mc);
+        return;
+    }
+
     // Reset fault and state, but keep motor disabled so host must re-enable.
-    s_ctx.fault          = MOTOR_FAULT_NONE;
-    s_ctx.state          = MOTOR_STATE_IDLE;
-    s_ctx.cmd.enable     = false;
-    s_ctx.cmd.rpm_cmd    = 0.0f;
-    s_ctx.cmd.torque_cmd = 0.0f;
-    s_rpm_cmd_target     = 0.0f;
-    s_rpm_cmd_request    = 0.0f;
-    s_duty_cmd           = 0.0f;
+    mc->ctx.fault          = MOTOR_FAULT_NONE;
+    mc->ctx.state          = MOTOR_STATE_IDLE;
+    mc->ctx.cmd.enable     = false;
+    mc->ctx.cmd.rpm_cmd    = 0.0f;
+    mc->ctx.cmd.torque_cmd = 0.0f;
+    mc->rpm_cmd_target     = 0.0f;
+    mc->rpm_cmd_request    = 0.0f;
+    mc->duty_cmd           = 0.0f;
 
     // Reset startup sequence
-    s_startup_active       = 0;
-    s_startup_sector       = 0;
-    s_startup_step_count   = 0;
-    s_startup_tick_in_step = 0;
+    mc->startup_active       = 0;
+    mc->startup_sector       = 0;
+    mc->startup_step_count   = 0;
+    mc->startup_tick_in_step = 0;
 
     // Reset PI integrator
-    PI_reset(&s_speed_pi);
-    // Don't touch s_dir_current / s_dir_requested; let host decide direction.
+    PI_reset(&mc->speed_pi);
+    // Don't touch mc->dir_current / mc->dir_requested; let host decide direction.
+}
+
+// Speed feedback for the speed PI. The Hall estimate comes
+// from edge periods quantized to the slow-loop tick, so near 1500 rpm it
+// jumps between 1250 and 2500; averaging the period (rather than its
+// reciprocal) keeps the mean speed unbiased.
+static float filtered_speed(MotorControl_t *mc)
+{
+    float rpm = mc->ctx.meas.rpm_mech;
+    if (rpm < MOTOR_RPM_STOP_THRESHOLD) {
+        LPF1_reset(&mc->speed_filt, 1.0f / MOTOR_RPM_STOP_THRESHOLD);
+        return rpm;
+    }
+    return 1.0f / LPF1_apply(&mc->speed_filt, 1.0f / rpm);
+}
+
+// Current that gives the trajectory's acceleration: J * alpha / Kt,
+// with Kt = 60 / (2 pi Kv) Nm/A and alpha in rad/s^2.
+static float accel_current(const MotorControl_t *mc, float kv)
+{
+    if (!g_motor_cfg.traj_accel_ff) {
+        return 0.0f;
+    }
+    return mc->params.inertia_kgm2 * mc->ctx.cmd.accel_cmd
+         * RPM_TO_RAD_S * RPM_TO_RAD_S * kv;
+}
+
+// Current that carries the observer's load estimate and the modelled
+// friction (0 with it off)
+static float load_current(const MotorControl_t *mc)
+{
+    if (!load_observer_on(mc)) {
+        return 0.0f;
+    }
+    return (mc->load_obs.t_load + mc->load_obs.friction) / mc->load_obs.kt;
+}
+
+// What the speed PI's output is added to. With the current loop: the
+// current the planned acceleration and the observed load take. In duty
+// mode: the duty that holds rpm_cmd in steady state, i.e. the BEMF at
+// that speed plus the resistive drop of part of the measured current and
+// of the acceleration current, as a fraction of Vbus in the six-step
+// duty of the modulation scheme. The speed PI then only has to find the
+// model error.
+static float speed_feedforward(const MotorControl_t *mc)
+{
+    float kv = mc->params.kv_rpm_per_v;
+    float r  = mc->params.r_phase_ohm;
+
+    if (mc->cur_loop) {
+        return accel_current(mc, kv) + load_current(mc);
+    }
+    if (!g_motor_cfg.speed_ff) {
+        return 0.0f;
+    }
+
+    // Line-line: two phases in series
+    float v = mc->ctx.cmd.rpm_cmd / kv
+            + 2.0f * r * (g_motor_cfg.speed_ff_ir_gain * mc->ctx.meas.i_bus
+                          + accel_current(mc, kv));
+    return clamp_duty(line_frac_to_duty(mc, v / mc->vbus_pub));
+}
+
+// ---------------- Parameter identification ----------------
+
+static bool ident_running(const MotorControl_t *mc)
+{
+    int ph = mc->ctx.ident.phase;
+    return ph == PARAM_IDENT_RL || ph == PARAM_IDENT_SPIN || ph == PARAM_IDENT_COAST;
+}
+
+// End a run without results: motor disabled and stopped, config untouched
+static void ident_abort(MotorControl_t *mc, ParamIdentAbort_t why)
+{
+    fprintf(stderr, "MotorControl: parameter identification aborted (%s), model unchanged\n",
+            ParamIdent_abortName(why));
+    mc->ctx.ident.phase = PARAM_IDENT_ABORTED;
+    mc->ctx.ident.abort = why;
+
+    if (mc->ctx.state == MOTOR_STATE_IDENT) {
+        mc->ctx.state = MOTOR_STATE_IDLE;
+    }
+    mc->ctx.cmd.enable  = false;
+    mc->rpm_cmd_request = 0.0f;
+    mc->rpm_cmd_target  = 0.0f;
+}
+
+// Start with the standstill R / L: the sequencer is set up here, before
+// the IDENT state that hands it to the fast loop is published. Kv comes
+// from the voltage applied at a small current, which only follows the
+// duty if the winding conducts continuously: complementary modulation.
+static void ident_start(MotorControl_t *mc, float rpm)
+{
+    if (mc->ctx.state != MOTOR_STATE_IDLE || !mc->cur_loop ||
+        !mc->pwm || mc->pwm->modulation != PWM_MOD_COMPLEMENTARY ||
+        fabsf(mc->ctx.meas.rpm_mech) >= MOTOR_RPM_STOP_THRESHOLD ||
+        mc->tuner.state == RELAY_TUNE_RUNNING || FreqResp_running(&mc->fra)) {
+        fprintf(stderr, "MotorControl: identification needs the motor idle and stopped, "
+                        "with the current loop and complementary modulation\n");
+        mc->ctx.ident.phase = PARAM_IDENT_ABORTED;
+        mc->ctx.ident.abort = PARAM_IDENT_ABORT_NOT_READY;
+        return;
+    }
+
+    IdentRLConfig_t c = {
+        .i_lo       = IDENT_I_LO_A,
+        .i_hi       = IDENT_I_HI_A,
+        .v_max      = mc->vbus_pub,
+        .v_ramp_v_s = IDENT_V_RAMP_V_S,
+        .hold_s     = IDENT_HOLD_S,
+        .decay_s    = IDENT_DECAY_S,
+        .step_frac  = IDENT_STEP_FRAC,
+        .step_max_s = IDENT_STEP_MAX_S,
+        .Ts         = 1.0f / (float)FAST_LOOP_HZ,
+    };
+    ParamIdent_rlStart(&mc->ident_rl, &c);
+    atomic_store_explicit(&mc->ident_rl_done, false, memory_order_relaxed);
+
+    memset(&mc->ident, 0, sizeof(mc->ident));
+    mc->ident.rpm       = rpm;
+    mc->ctx.ident.phase = PARAM_IDENT_RL;
+    mc->ctx.ident.abort = PARAM_IDENT_ABORT_NONE;
+
+    // Forward, driven, no speed request until the spin
+    mc->dir_requested     = false;
+    mc->dir_current       = false;
+    mc->ctx.cmd.direction = false;
+    mc->rpm_cmd_request   = 0.0f;
+    mc->ctx.cmd.enable    = true;
+    mc->ctx.state         = MOTOR_STATE_IDENT;
+}
+
+// Coast fitted: Kv from the BEMF of the hold, J from the deceleration
+// under the losses the hold current carried, J = Kt * I_hold / (dw/dt),
+// and those losses as the friction torque, Kt * I_hold.
+// Then everything goes into this controller's model at once. The outputs are off, so
+// the fast loop is not running the current PI while its gains change.
+static void ident_finish(MotorControl_t *mc)
+{
+    MotorIdentRun_t *r = &mc->ident;
+    float rpm, decel;
+    float kv = ParamIdent_kvFromHold(&mc->ident_rl, r->v_hold, r->i_hold_a, r->rpm_hold);
+    if (!ParamIdent_coastFit(&r->coast, &rpm, &decel) || kv <= 0.0f || r->i_hold_a <= 0.0f) {
+        ident_abort(mc, PARAM_IDENT_ABORT_COAST);
+        return;
+    }
+
+    float kt = 1.0f / (RPM_TO_RAD_S * kv);
+    float j  = kt * r->i_hold_a / (decel * RPM_TO_RAD_S);
+
+    mc->params.r_phase_ohm  = 0.5f * r->r_ll;
+    mc->params.l_phase_h    = 0.5f * r->l_ll;
+    mc->params.kv_rpm_per_v = kv;
+    mc->params.inertia_kgm2 = j;
+    mc->params.friction_nm  = kt * r->i_hold_a;
+    current_loop_gains(mc);
+    load_observer_init(mc);
+
+    MotorIdentStatus_t *is = &mc->ctx.ident;
+    is->phase        = PARAM_IDENT_DONE;
+    is->r_phase_ohm  = mc->params.r_phase_ohm;
+    is->l_phase_h    = mc->params.l_phase_h;
+    is->kv_rpm_per_v = kv;
+    is->inertia_kgm2 = j;
+    is->friction_nm  = mc->params.friction_nm;
+    is->runs++;
+}
+
+// Spin and coast, once per slow tick after the state machine
+static void ident_update(MotorControl_t *mc)
+{
+    MotorIdentRun_t *r  = &mc->ident;
+    const float      Ts = 1.0f / (float)SPEED_LOOP_HZ;
+
+    if (ident_running(mc) && mc->ctx.state == MOTOR_STATE_FAULT) {
+        ident_abort(mc, (mc->ctx.ident.phase == PARAM_IDENT_RL) ? PARAM_IDENT_ABORT_RL
+                                                                : PARAM_IDENT_ABORT_SPIN);
+        return;
+    }
+
+    switch (mc->ctx.ident.phase) {
+    case PARAM_IDENT_SPIN:
+        r->t_s += Ts;
+        if (r->t_s > IDENT_TIMEOUT_S) {
+            ident_abort(mc, PARAM_IDENT_ABORT_SPIN);
+            break;
+        }
+        // At the test speed once the trajectory has arrived
+        if (mc->ctx.state != MOTOR_STATE_RUN || mc->ctx.cmd.rpm_cmd != r->rpm) {
+            r->t_hold_s = 0.0f;
+            break;
+        }
+        r->t_hold_s += Ts;
+        if (r->t_hold_s > IDENT_SETTLE_S && mc->ctx.meas.rpm_mech > 0.0f) {
+            float duty = load_float(&mc->duty_out);
+            r->i_sum += mc->ctx.meas.i_bus;
+            r->v_sum += duty_to_line_frac(mc, duty) * mc->vbus_pub;
+            r->p_sum += 1.0 / (double)mc->ctx.meas.rpm_mech;
+            r->n++;
+        }
+        if (r->t_hold_s >= IDENT_SETTLE_S + IDENT_HOLD_RPM_S && r->n > 0) {
+            r->i_hold_a = (float)(r->i_sum / r->n);
+            r->v_hold   = (float)(r->v_sum / r->n);
+            r->rpm_hold = (float)(r->n / r->p_sum);
+
+            // Outputs off: RUN drops to IDLE and the motor coasts
+            mc->ctx.cmd.enable  = false;
+            mc->rpm_cmd_request = 0.0f;
+            mc->ctx.ident.phase = PARAM_IDENT_COAST;
+            r->t_s = 0.0f;
+            ParamIdent_coastReset(&r->coast);
+        }
+        break;
+
+    case PARAM_IDENT_COAST:
+        r->t_s += Ts;
+        if (r->t_s < IDENT_COAST_SKIP_S) {
+            break;
+        }
+        if (mc->ctx.meas.rpm_mech > IDENT_COAST_END_FRAC * r->rpm_hold &&
+            r->t_s < IDENT_TIMEOUT_S) {
+            ParamIdent_coastAdd(&r->coast, r->t_s, mc->ctx.meas.rpm_mech);
+            break;
+        }
+        ident_finish(mc);
+        break;
+
+    default:
+        break;
+    }
+}
+
+// ---------------- Hall commissioning ----------------
+
+// Vector amplitude for about HALL_LEARN_I_A through the configured R,
+// as the duty the sine drive takes
+static float hall_learn_duty(const MotorControl_t *mc)
+{
+    float r    = mc->params.r_phase_ohm;
+    float frac = (mc->vbus_pub > 0.0f) ? HALL_LEARN_I_A * 2.0f * r / mc->vbus_pub : 0.0f;
+    return clamp_duty(line_frac_to_duty(mc, frac));
+}
+
+static void hall_learn_start(MotorControl_t *mc)
+{
+    if (mc->ctx.state != MOTOR_STATE_IDLE || !mc->pwm || mc->vbus_pub <= 0.0f ||
+        fabsf(mc->ctx.meas.rpm_mech) >= MOTOR_RPM_STOP_THRESHOLD ||
+        ident_running(mc)) {
+        fprintf(stderr, "MotorControl: Hall learn needs the motor idle and stopped\n");
+        return;
+    }
+
+    HallLearnConfig_t c = {
+        .settle_s    = HALL_LEARN_SETTLE_S,
+        .sweep_deg_s = HALL_LEARN_SWEEP_DEG_S,
+        .revs        = (int)(g_motor_cfg.pole_pairs + 0.5f),
+        .Ts          = 1.0f / (float)SPEED_LOOP_HZ,
+    };
+    HallLearn_start(&mc->hall_learn, &c);
+
+    memset(&mc->ctx.hall.code, 0, sizeof(mc->ctx.hall.code));
+    memset(&mc->ctx.hall.offset_deg, 0, sizeof(mc->ctx.hall.offset_deg));
+    mc->ctx.hall.state = mc->hall_learn.state;
+    mc->ctx.hall.fail  = HALL_LEARN_FAIL_NONE;
+
+    mc->rpm_cmd_request = 0.0f;
+    mc->ctx.cmd.enable  = true;
+    mc->ctx.state       = MOTOR_STATE_HALL_LEARN;
+}
+
+// Finished, failed or stopped: outputs off, and the results (if any)
+// into the config. The motor is at a standstill and commutation does not
+// use the Hall decoding while it is.
+static void hall_learn_end(MotorControl_t *mc)
+{
+    const HallLearn_t *hl = &mc->hall_learn;
+
+    if (mc->ctx.state == MOTOR_STATE_HALL_LEARN) {
+        mc->ctx.state = MOTOR_STATE_IDLE;
+    }
+    mc->ctx.cmd.enable     = false;
+    mc->ctx.cmd.torque_cmd = 0.0f;
+    mc->ctx.hall.state     = hl->state;
+    mc->ctx.hall.fail      = hl->fail;
+
+    if (hl->state != HALL_LEARN_DONE) {
+        fprintf(stderr, "MotorControl: Hall learn failed (%s), decoding unchanged\n",
+                HallLearn_failName(hl->fail));
+        return;
+    }
+
+    HallMap_t *hm = &mc->ctx.hall.map;
+    memcpy(hm->map, hl->map, sizeof(hm->map));
+    memcpy(hm->edge_offset_deg, hl->offset_deg, sizeof(hm->edge_offset_deg));
+    hm->set = 1;
+    mc->hall_map_new = true;
+
+    memcpy(mc->ctx.hall.code, hl->code, sizeof(mc->ctx.hall.code));
+    memcpy(mc->ctx.hall.offset_deg, hl->offset_deg, sizeof(mc->ctx.hall.offset_deg));
+    mc->ctx.hall.runs++;
+}
+
+// ---------------- Speed PI autotune ----------------
+
+// Start a relay run around the speed-loop output that holds the present
+// speed: feedforward plus integrator (the proportional term only carries
+// the speed estimate's noise). The speed command moves to the setpoint
+// too, so the PI resumes there.
+static void autotune_start(MotorControl_t *mc, float rpm, RelayTuneRule_t rule)
+{
+    if (mc->ctx.state != MOTOR_STATE_RUN || FreqResp_running(&mc->fra) || ident_running(mc)) {
+        fprintf(stderr, "MotorControl: autotune needs the motor running, "
+                        "no frequency response or identification in progress\n");
+        memset(&mc->tuner, 0, sizeof(mc->tuner));
+        mc->tuner.cfg.rule = rule;
+        mc->tuner.state    = RELAY_TUNE_ABORTED;
+        mc->tuner.abort    = RELAY_ABORT_STOPPED;
+        return;
+    }
+
+    RelayTuneConfig_t c = {
+        .setpoint    = rpm,
+        .bias        = speed_feedforward(mc) + mc->speed_pi.integrator,
+        .amplitude   = mc->cur_loop ? AUTOTUNE_RELAY_A : AUTOTUNE_RELAY_DUTY,
+        .out_min     = 0.0f,
+        .out_max     = mc->cur_loop ? mc->i_ref_max : 1.0f,
+        .hyst        = AUTOTUNE_HYST_RPM,
+        .band        = AUTOTUNE_BAND_FRAC * rpm,
+        .timeout_s   = AUTOTUNE_TIMEOUT_S,
+        .skip_cycles = AUTOTUNE_SKIP_CYCLES,
+        .cycles      = AUTOTUNE_CYCLES,
+        .rule        = rule,
+    };
+    RelayTuner_start(&mc->tuner, &c);
+    mc->tune_applied = false;
+
+    mc->rpm_cmd_request = rpm;
+    mc->rpm_cmd_target  = rpm;
+    mc->ctx.cmd.rpm_cmd = rpm;
+}
+
+// Run ended on this tick. The PI goes on with the gains it had: the
+// result is only published, a rule's gains can be worse than a hand tune.
+// The PI has not stepped during the run, so its integrator still holds
+// the output from before it (bumpless).
+static void autotune_end(MotorControl_t *mc)
+{
+    const RelayTuner_t *rt = &mc->tuner;
+    if (rt->state == RELAY_TUNE_DONE) {
+        fprintf(stderr, "MotorControl: autotune done (kp %.4g, ki %.4g), "
+                        "gains unchanged until applied\n",
+                (double)rt->kp, (double)rt->ki);
+    } else {
+        fprintf(stderr, "MotorControl: autotune aborted (%s), gains unchanged\n",
+                RelayTuner_abortName(rt->abort));
+    }
+}
+
+// The last result replaces the fixed or scheduled gains
+static void autotune_apply(MotorControl_t *mc)
+{
+    const RelayTuner_t *rt = &mc->tuner;
+    if (rt->state != RELAY_TUNE_DONE || FreqResp_running(&mc->fra) || ident_running(mc)) {
+        fprintf(stderr, "MotorControl: no autotune result to apply, "
+                        "or a frequency response or identification in progress\n");
+        return;
+    }
+    PI_setSchedule(&mc->speed_pi, NULL);
+    PI_setGains(&mc->speed_pi, rt->kp, rt->ki);
+    mc->tune_applied = true;
+}
+
+static void publish_tune(MotorControl_t *mc)
+{
+    const RelayTuner_t *rt = &mc->tuner;
+    MotorTuneStatus_t  *ts = &mc->ctx.tune;
+    ts->state   = (int)rt->state;
+    ts->abort   = (int)rt->abort;
+    ts->rule    = (int)rt->cfg.rule;
+    ts->cycles  = rt->measured;
+    ts->ku      = rt->ku;
+    ts->pu_s    = rt->pu_s;
+    ts->kp      = rt->kp;
+    ts->ki      = rt->ki;
+    ts->applied = mc->tune_applied;
+}
+
+// ---------------- Frequency response ----------------
+
+static void fra_start(MotorControl_t *mc, const FraConfig_t *cfg,
+                      MotorFraPoint_t point, MotorFraResponse_t resp)
+{
+    if (mc->ctx.state != MOTOR_STATE_RUN || mc->tuner.state == RELAY_TUNE_RUNNING ||
+        ident_running(mc)) {
+        fprintf(stderr, "MotorControl: frequency response needs the motor running, "
+                        "no autotune or identification in progress\n");
+        FreqResp_abort(&mc->fra);
+        return;
+    }
+    if (!FreqResp_start(&mc->fra, cfg)) {
+        FreqResp_abort(&mc->fra);
+        return;
+    }
+    mc->fra_point = point;
+    mc->fra_resp  = resp;
+}
+
+static void fra_stop(MotorControl_t *mc)
+{
+    if (FreqResp_running(&mc->fra)) {
+        fprintf(stderr, "MotorControl: frequency response aborted\n");
+        FreqResp_abort(&mc->fra);
+    }
+}
+
+static void publish_fra(MotorControl_t *mc)
+{
+    const FreqResp_t *fr = &mc->fra;
+    MotorFraStatus_t *fs = &mc->ctx.fra;
+    fs->state    = (int)fr->state;
+    fs->exc      = (int)fr->cfg.exc;
+    fs->point    = (int)mc->fra_point;
+    fs->response = (int)mc->fra_resp;
+    int total    = fr->cfg.samples * fr->cfg.periods;
+    fs->progress = (fr->state == FRA_RECORDING) ? fr->n
+                 : (fr->state == FRA_DONE)      ? total : 0;
+    fs->samples  = total;
+    fs->bins     = fr->nbins;
+}
+
+// Apply one mailbox command (slow-loop thread).
+static void apply_command(MotorControl_t *mc, const MotorCmd_t *cmd)
+{
+    switch (cmd->type) {
+    case MOTOR_CMD_ENABLE:
+        // If we're in FAULT, ignore attempts to re-enable
+        if (mc->ctx.state == MOTOR_STATE_FAULT && cmd->arg.enable) {
+            break;
+        }
+        if (ident_running(mc)) {
+            // Either way the identification is over (motor disabled)
+            ident_abort(mc, PARAM_IDENT_ABORT_STOPPED);
+            break;
+        }
+        if (HallLearn_running(&mc->hall_learn)) {
+            HallLearn_abort(&mc->hall_learn);
+            hall_learn_end(mc);
+            break;
+        }
+        mc->ctx.cmd.enable = cmd->arg.enable;
+        break;
+    case MOTOR_CMD_SPEED:
+        if (ident_running(mc)) {
+            ident_abort(mc, PARAM_IDENT_ABORT_STOPPED);
+        }
+        if (HallLearn_running(&mc->hall_learn)) {
+            HallLearn_abort(&mc->hall_learn);
+            hall_learn_end(mc);
+        }
+        mc->rpm_cmd_request = cmd->arg.speed.rpm;
+        mc->dir_requested   = cmd->arg.speed.direction;
+        if (mc->tuner.state == RELAY_TUNE_RUNNING) {
+            // A new speed ends the tune
+            RelayTuner_abort(&mc->tuner, RELAY_ABORT_STOPPED);
+            autotune_end(mc);
+        }
+        // ... and a frequency response
+        fra_stop(mc);
+        break;
+    case MOTOR_CMD_CLEAR_FAULT:
+        clear_fault_now(mc);
+        break;
+    case MOTOR_CMD_COMMUTATION:
+        mc->ctx.cmd.commutation = (MotorCommutation_t)cmd->arg.commutation;
+        atomic_store_explicit(&mc->commutation, cmd->arg.commutation, memory_order_relaxed);
+        break;
+    case MOTOR_CMD_AUTOTUNE:
+        if (cmd->arg.autotune.start) {
+            autotune_start(mc, cmd->arg.autotune.rpm, (RelayTuneRule_t)cmd->arg.autotune.rule);
+        } else if (cmd->arg.autotune.apply) {
+            autotune_apply(mc);
+        } else if (mc->tuner.state == RELAY_TUNE_RUNNING) {
+            RelayTuner_abort(&mc->tuner, RELAY_ABORT_STOPPED);
+            autotune_end(mc);
+        }
+        break;
+    case MOTOR_CMD_FRA:
+        if (cmd->arg.fra.start) {
+            fra_start(mc, &cmd->arg.fra.cfg,
+                      (MotorFraPoint_t)cmd->arg.fra.point,
+                      (MotorFraResponse_t)cmd->arg.fra.response);
+        } else {
+            fra_stop(mc);
+        }
+        break;
+    case MOTOR_CMD_IDENT:
+        if (cmd->arg.ident.start) {
+            if (!ident_running(mc)) {
+                ident_start(mc, cmd->arg.ident.rpm);
+            }
+        } else if (ident_running(mc)) {
+            ident_abort(mc, PARAM_IDENT_ABORT_STOPPED);
+        }
+        break;
+    case MOTOR_CMD_HALL_LEARN:
+        if (cmd->arg.hall_learn.start) {
+            if (!HallLearn_running(&mc->hall_learn)) {
+                hall_learn_start(mc);
+            }
+        } else if (HallLearn_running(&mc->hall_learn)) {
+            HallLearn_abort(&mc->hall_learn);
+            hall_learn_end(mc);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+// Drain the mailbox in posting order and acknowledge each command with
+// the tick that applied it.
+static void drain_commands(MotorControl_t *mc, TimeNs_t now_ns)
+{
+    MotorCmd_t cmd;
+    while (MotorCmdQueue_pop(&mc->cmdq, &cmd)) {
+        apply_command(mc, &cmd);
+        MotorCmdQueue_ack(&mc->cmdq, &cmd, mc->slow_tick, now_ns);
+    }
 }
 
-void MotorControl_updateBusVoltage(float vbus)
+void MotorControl_updateHall(MotorControl_t *mc, uint8_t hall_bits)
 {
-    s_ctx.meas.v_bus = vbus;
+    mc->hall_bits = hall_bits;
+}
+
+void MotorControl_updateBusVoltage(MotorControl_t *mc, float vbus)
+{
+    mc->ctx.meas.v_bus = vbus;
+
+    // Current loop output scaling; only real changes touch the fast line
+    if (vbus > BEMF_VALID_MIN_V &&
+        fabsf(vbus - mc->vbus_pub) > CURRENT_LOOP_VBUS_HYST_V) {
+        mc->vbus_pub = vbus;
+        store_float(&mc->vbus_v, vbus);
+    }
 
-    if (s_ctx.state == MOTOR_STATE_FAULT) {
+    if (mc->ctx.state == MOTOR_STATE_FAULT) {
         return;
     }
 
 #ifndef MOTOR_DISABLE_BUS_FAULTS
     if (vbus > MOTOR_BUS_V_MAX_V) {
-        MotorControl_setFault(MOTOR_FAULT_OVERVOLT);
+        MotorControl_setFault(mc, MOTOR_FAULT_OVERVOLT);
     } else if (vbus < MOTOR_BUS_V_MIN_V && vbus > 0.1f) {
-        MotorControl_setFault(MOTOR_FAULT_UNDERVOLT);
+        MotorControl_setFault(mc, MOTOR_FAULT_UNDERVOLT);
     }
 #endif
 }
 
+// ---------------- Current sensing / overcurrent ----------------
+
+static float phase_current_peak(float i_u, float i_v, float i_w)
+{
+    return fmaxf(fabsf(i_u), fmaxf(fabsf(i_v), fabsf(i_w)));
+}
+
+void MotorControl_updateCurrents(MotorControl_t *mc, float i_u, float i_v)
+{
+    // One word, like fast_cmd in the other direction
+    float    pair[2] = { i_u, i_v };
+    uint64_t w;
+    memcpy(&w, pair, sizeof(w));
+    atomic_store_explicit(&mc->i_meas, w, memory_order_relaxed);
+
+    float peak = phase_current_peak(i_u, i_v, -(i_u + i_v));
+
+    // Cycle-by-cycle limit: let the current decay for one period
+    mc->i_chop = (peak > mc->i_limit_a);
+    if (mc->i_chop) {
+        mc->chop_ticks++;
+    }
+
+    // Trip only on a sustained excess: single-sample spikes (switching
+    // edges, ADC noise) are filtered by the trip time
+    if (peak > mc->i_max_a) {
+        if (mc->oc_ticks < mc->oc_trip_ticks) {
+            mc->oc_ticks++;
+        }
+        if (mc->oc_ticks >= mc->oc_trip_ticks) {
+            MotorControl_requestFault(mc, MOTOR_FAULT_OVERCURRENT);
+        }
+    } else {
+        mc->oc_ticks = 0;
+    }
+}
+
+void MotorControl_updateAngle(MotorControl_t *mc, float elec_angle_rad, float rpm_elec,
+                              bool valid)
+{
+    mc->elec_angle = ElecAngle_fromRad(elec_angle_rad);
+    mc->angle_ok   = valid;
+    store_float(&mc->edge_rpm_elec, valid ? rpm_elec : 0.0f);
+}
+
 // ---------------- Internal helpers ----------------
 
-static void update_measurements(void)
+static void update_measurements(MotorControl_t *mc)
 {
     // Use Position Estimator for RPM; it already pulls from SpeedMeasurement
-    PosEst_t pe = PosEst_get();
-    s_ctx.meas.rpm_mech = pe.mech_speed;
-    s_ctx.meas.rpm_elec = pe.elec_speed;
-    // TODO: wire actual bus current/phase currents if you have them
+    PosEst_t pe = PosEst_get(mc->pos);
+    mc->ctx.meas.rpm_mech = pe.mech_speed;
+    mc->ctx.meas.rpm_elec = pe.elec_speed;
+    mc->run_sector        = pe.sector;
+
+    // Sine / FOC read the Hall lines at the fast rate: a revolution of
+    // edges timed there beats the slow loop's 1 kHz-polled estimate,
+    // whose noise the speed PI would otherwise pass on as torque
+    float edge_rpm = load_float(&mc->edge_rpm_elec);
+    if (edge_rpm > 0.0f &&
+        atomic_load_explicit(&mc->commutation, memory_order_relaxed) != MOTOR_COMM_SIX_STEP) {
+        mc->ctx.meas.rpm_elec = edge_rpm;
+        mc->ctx.meas.rpm_mech = edge_rpm / (float)MOTOR_POLE_PAIRS;
+    }
+
+    // Latest phase currents from the fast loop (all zero without sensing)
+    uint64_t w = atomic_load_explicit(&mc->i_meas, memory_order_relaxed);
+    float    pair[2];
+    memcpy(pair, &w, sizeof(pair));
+    mc->ctx.meas.i_phase_u = pair[0];
+    mc->ctx.meas.i_phase_v = pair[1];
+    mc->ctx.meas.i_phase_w = -(pair[0] + pair[1]);
+    // Six-step: the bus current flows through the two driven phases
+    mc->ctx.meas.i_bus     = phase_current_peak(mc->ctx.meas.i_phase_u,
+                                                mc->ctx.meas.i_phase_v,
+                                                mc->ctx.meas.i_phase_w);
+
+    mc->ctx.cmd.duty = load_float(&mc->duty_out);
+
+    // Set by the RUN handler
+    mc->ctx.meas.load_nm = 0.0f;
 }
 
 // State handlers
 
-static void handle_idle_state(void)
+static void handle_idle_state(MotorControl_t *mc)
 {
-    s_duty_cmd = 0.0f;
-    if (s_pwm) {
-        PwmMotor_stop(s_pwm);
-    }
+    mc->duty_cmd = 0.0f;
 
     // Transition out of IDLE when enable is asserted and user
     // actually wants some non-zero speed
-    if (s_ctx.cmd.enable && s_rpm_cmd_request > 0.0f) {
+    if (mc->ctx.cmd.enable && mc->rpm_cmd_request > 0.0f) {
         // initialize startup sequence
-        s_startup_active       = 1;
-        s_startup_step_count   = 0;
-        s_startup_tick_in_step = 0;
+        mc->startup_active       = 1;
+        mc->startup_step_count   = 0;
+        mc->startup_tick_in_step = 0;
 
         // try to start from current hall sector if valid, else 0
-        PosEst_t pe = PosEst_get();
+        PosEst_t pe = PosEst_get(mc->pos);
         if (pe.sector < 6) {
-            s_startup_sector = pe.sector;
+            mc->startup_sector = pe.sector;
         } else {
-            s_startup_sector = 0;
+            mc->startup_sector = 0;
         }
 
-        s_ctx.state = MOTOR_STATE_ALIGN;   // use ALIGN as "startup" state
+        mc->ctx.state = MOTOR_STATE_ALIGN;   // use ALIGN as "startup" state
     }
 }
 
-static void handle_align_state(void)
+// With both switches chopping the winding sees +Vbus for duty*T and
+// -Vbus (freewheel diodes) for the rest; holding one switch on freewheels
+// at ~0 V instead, so the same duty drives about three times the current.
+static float startup_duty(const MotorControl_t *mc)
+{
+    if (mc->pwm && mc->pwm->modulation != PWM_MOD_HPWM_LPWM) {
+        return STARTUP_DUTY_HELD_ON;
+    }
+    return STARTUP_DUTY;
+}
+
+static void handle_align_state(MotorControl_t *mc)
 {
     // Open-loop 6-step startup.
     // We ignore the PI loop here and just drive a fixed duty and manually
@@ -276,197 +1423,534 @@ static void handle_align_state(void)
     // steps), we transition to RUN and let the normal loop take over.
 
     // If somehow disabled or user zeroed the command, bail back to IDLE:
-    if (!s_ctx.cmd.enable || s_rpm_cmd_request <= 0.0f) {
-        s_ctx.state          = MOTOR_STATE_IDLE;
-        s_startup_active     = 0;
-        s_ctx.cmd.rpm_cmd    = 0.0f;
-        s_ctx.cmd.torque_cmd = 0.0f;
-        s_duty_cmd           = 0.0f;
-        if (s_pwm) {
-            PwmMotor_stop(s_pwm);
-        }
+    if (!mc->ctx.cmd.enable || mc->rpm_cmd_request <= 0.0f) {
+        mc->ctx.state          = MOTOR_STATE_IDLE;
+        mc->startup_active     = 0;
+        mc->ctx.cmd.rpm_cmd    = 0.0f;
+        mc->ctx.cmd.torque_cmd = 0.0f;
+        mc->duty_cmd           = 0.0f;
         return;
     }
 
     // Force a known duty during startup
-    s_ctx.cmd.torque_cmd = STARTUP_DUTY;
-    s_duty_cmd           = STARTUP_DUTY;
+    mc->ctx.cmd.torque_cmd = startup_duty(mc);
+    mc->duty_cmd           = startup_duty(mc);
 
     // Update counters at slow-loop rate
-    if (s_startup_active) {
-        s_startup_tick_in_step++;
-        if (s_startup_tick_in_step >= STARTUP_TICKS_PER_STEP) {
-            s_startup_tick_in_step = 0;
-            s_startup_step_count++;
-            s_startup_sector = (uint8_t)((s_startup_sector + 1) % 6);
+    if (mc->startup_active) {
+        mc->startup_tick_in_step++;
+        if (mc->startup_tick_in_step >= STARTUP_TICKS_PER_STEP) {
+            mc->startup_tick_in_step = 0;
+            mc->startup_step_count++;
+            mc->startup_sector = (uint8_t)((mc->startup_sector + 1) % 6);
         }
     }
 
     // in handle_align_state(), replace the handover condition with:
-    float rpm_abs = fabsf(s_ctx.meas.rpm_mech);
+    float rpm_abs = fabsf(mc->ctx.meas.rpm_mech);
 
     // require BOTH: some RPM AND enough steps
     if (rpm_abs > STARTUP_HANDOVER_RPM &&
-    s_startup_step_count >= STARTUP_STEPS_TOTAL/2) {
-    s_startup_active     = 0;
-    s_ctx.state          = MOTOR_STATE_RUN;
-    s_ctx.cmd.rpm_cmd    = s_rpm_cmd_request;
-    s_ctx.cmd.torque_cmd = STARTUP_DUTY;
+    mc->startup_step_count >= STARTUP_STEPS_TOTAL/2) {
+    mc->startup_active     = 0;
+    mc->ctx.state          = MOTOR_STATE_RUN;
+    mc->ctx.cmd.rpm_cmd    = mc->rpm_cmd_request;
+    mc->ctx.cmd.torque_cmd = startup_duty(mc);
+    LPF1_reset(&mc->speed_filt, 1.0f / rpm_abs);
+    LPF1_reset(&mc->obs_speed_filt, 1.0f / rpm_abs);
+    LoadObserver_reset(&mc->load_obs, 0.0f);
+    if (mc->cur_loop) {
+        // Torque is commanded directly: ramp the speed from where it is
+        // (the trajectory bounds the acceleration) and start from the
+        // current the startup duty draws
+        mc->ctx.cmd.rpm_cmd    = rpm_abs;
+        mc->ctx.cmd.torque_cmd = mc->ctx.meas.i_bus;
+    } else if (g_motor_cfg.speed_ff) {
+        // Bumpless: ramp from the handover speed and preload the
+        // integrator with what the startup duty adds to the feedforward
+        mc->ctx.cmd.rpm_cmd = rpm_abs;
+        PI_reset(&mc->speed_pi);
+        PI_setIntegrator(&mc->speed_pi, startup_duty(mc) - speed_feedforward(mc));
+    }
 }
 
 }
 
-static void handle_run_state(float dt_s)
+static void handle_run_state(MotorControl_t *mc, float dt_s)
 {
     (void)dt_s; // currently unused; reserved for future
 
-    float rpm_abs = fabsf(s_ctx.meas.rpm_mech);
+    float rpm_abs = fabsf(mc->ctx.meas.rpm_mech);
 
     // If motor disabled or user requested zero speed and we're basically stopped,
     // fall back to IDLE.
-    if (!s_ctx.cmd.enable ||
-        (s_rpm_cmd_request <= 0.0f && rpm_abs < MOTOR_RPM_STOP_THRESHOLD)) {
-        s_ctx.state          = MOTOR_STATE_IDLE;
-        s_ctx.cmd.rpm_cmd    = 0.0f;
-        s_rpm_cmd_target     = 0.0f;
-        s_duty_cmd           = 0.0f;
-        if (s_pwm) {
-            PwmMotor_stop(s_pwm);
-        }
+    if (!mc->ctx.cmd.enable ||
+        (mc->rpm_cmd_request <= 0.0f && rpm_abs < MOTOR_RPM_STOP_THRESHOLD)) {
+        mc->ctx.state          = MOTOR_STATE_IDLE;
+        mc->ctx.cmd.rpm_cmd    = 0.0f;
+        mc->rpm_cmd_target     = 0.0f;
+        mc->duty_cmd           = 0.0f;
         return;
     }
 
-    // Speed PI: ref = slewed rpm command, meas = actual rpm
-    PI_Status_t pi_status;
-    float duty = PI_step(&s_speed_pi,
-                         s_ctx.cmd.rpm_cmd,      // ref
-                         s_ctx.meas.rpm_mech,    // meas
-                         true,                   // use anti-windup
-                         &pi_status);            // optional, can be ignored
+    // Speed feedback. The load observer runs ahead of the feedforward on
+    // the speed over the last electrical revolution of Hall edges timed
+    // at the fast rate, period-averaged like the PI's (the filtered
+    // 1 kHz-polled one until there is one): differentiated, the polling
+    // quantization would swamp the estimate, and the filter matches the
+    // observer's current lag.
+    float rpm_fb = filtered_speed(mc);
+    if (load_observer_on(mc)) {
+        float rpm_obs = load_float(&mc->edge_rpm_elec) / (float)MOTOR_POLE_PAIRS;
+        if (rpm_obs > 0.0f) {
+            rpm_obs = 1.0f / LPF1_apply(&mc->obs_speed_filt, 1.0f / rpm_obs);
+        } else {
+            rpm_obs = rpm_fb;
+        }
+        // The current reference, which the loop tracks in every
+        // commutation (the sampled peak phase current is not it under sine
+        // drive); the measurement while the loop is out of voltage
+        float i_obs = mc->duty_cmd;
+        if (atomic_load_explicit(&mc->cur_sat, memory_order_relaxed)) {
+            i_obs = mc->ctx.meas.i_bus;
+        }
+        mc->ctx.meas.load_nm = LoadObserver_step(&mc->load_obs, rpm_obs * RPM_TO_RAD_S, i_obs);
+    }
+
+    // The PI works around the feedforward, limited so the sum stays
+    // within 0..i_ref_max (current loop) or 0..1 (duty).
+    //
+    // Cascade anti-windup: while the current PI sits at full duty the
+    // motor cannot take more current, so cap the speed loop at what it
+    // asks for now (its integrator stops winding up) until the inner loop
+    // comes off the limit.
+    float ff = speed_feedforward(mc);
+    if (mc->cur_loop) {
+        float hi = mc->i_ref_max;
+        if (atomic_load_explicit(&mc->cur_sat, memory_order_relaxed) &&
+            mc->duty_cmd < hi) {
+            hi = mc->duty_cmd;
+        }
+        PI_setLimits(&mc->speed_pi, -ff, hi - ff);
+    } else {
+        PI_setLimits(&mc->speed_pi, SPEED_PI_OUT_MIN_DEFAULT - ff, SPEED_PI_OUT_MAX_DEFAULT - ff);
+    }
+
+    // Frequency response: excitation on the speed command, or on the
+    // output below
+    bool  fra     = FreqResp_running(&mc->fra);
+    float exc     = fra ? FreqResp_excitation(&mc->fra) : 0.0f;
+    float rpm_ref = mc->ctx.cmd.rpm_cmd;
+    if (fra && mc->fra_point == MOTOR_FRA_SPEED_REF) {
+        rpm_ref += exc;
+    }
+
+    // Speed PI: ref = trajectory rpm command, meas = actual rpm; gains from
+    // the schedule at the measured speed
+    PI_schedule(&mc->speed_pi, rpm_fb, mc->vbus_pub);
+    float out;
+    if (mc->tuner.state == RELAY_TUNE_RUNNING) {
+        // Autotune: the relay drives the output instead of the PI
+        out = RelayTuner_step(&mc->tuner, rpm_fb, 1.0f / (float)SPEED_LOOP_HZ);
+        if (mc->tuner.state != RELAY_TUNE_RUNNING) {
+            autotune_end(mc);
+        }
+    } else {
+        // The load observer's feedforward is the integral action while it
+        // runs: an integrator on top would wind up over the dip the
+        // observer then covers, and overshoot
+        float ki = mc->speed_pi.ki;
+        if (load_observer_on(mc)) {
+            mc->speed_pi.ki = 0.0f;
+        }
+        PI_Status_t pi_status;
+        out = ff + PI_step(&mc->speed_pi,
+                           rpm_ref,                  // ref
+                           rpm_fb,                   // meas
+                           true,                   // use anti-windup
+                           &pi_status);            // optional, can be ignored
+        mc->speed_pi.ki = ki;
+    }
+    mc->ctx.cmd.speed_kp = mc->speed_pi.kp;
+    mc->ctx.cmd.speed_ki = load_observer_on(mc) ? 0.0f : mc->speed_pi.ki;
+
+    if (fra && mc->fra_point == MOTOR_FRA_OUTPUT) {
+        out += exc;
+        if (mc->cur_loop && out > mc->i_ref_max) out = mc->i_ref_max;
+    }
 
     // Clamp for safety as well
-    if (duty < 0.0f) duty = 0.0f;
-    if (duty > 1.0f) duty = 1.0f;
+    if (out < 0.0f) out = 0.0f;
+    if (!mc->cur_loop && out > 1.0f) out = 1.0f;
+
+    // Record what went in at the injection point (after the clamps) and
+    // what came back
+    if (fra) {
+        float u = (mc->fra_point == MOTOR_FRA_SPEED_REF) ? rpm_ref : out;
+        float y = (mc->fra_resp == MOTOR_FRA_RESP_CURRENT) ? mc->ctx.meas.i_bus : rpm_fb;
+        FreqResp_step(&mc->fra, u, y);
+    }
 
-    // This is also our "torque command" for now (0..1)
-    s_ctx.cmd.torque_cmd = duty;
-    s_duty_cmd           = duty;
+    // Torque command: duty (0..1), or current reference (A)
+    mc->ctx.cmd.torque_cmd = out;
+    mc->duty_cmd           = out;
 }
 
-static void handle_fault_state(void)
+// Standstill R / L: the fast loop runs the injection; once it reports
+// back, on to the spin (IDLE starts up from the speed request)
+static void handle_ident_state(MotorControl_t *mc)
 {
-    // Stay in FAULT until an explicit reset
-    s_ctx.cmd.enable      = false;
-    s_ctx.cmd.rpm_cmd     = 0.0f;
-    s_ctx.cmd.torque_cmd  = 0.0f;
-    s_rpm_cmd_target      = 0.0f;
-    s_rpm_cmd_request     = 0.0f;
-    s_duty_cmd            = 0.0f;
+    mc->ctx.cmd.torque_cmd = 0.0f;
+    mc->duty_cmd           = 0.0f;
 
-    if (s_pwm) {
-        PwmMotor_stop(s_pwm);
+    if (!atomic_load_explicit(&mc->ident_rl_done, memory_order_acquire)) {
+        return;
+    }
+
+    const IdentRL_t *rl = &mc->ident_rl;
+    if (rl->state != IDENT_RL_DONE) {
+        ident_abort(mc, PARAM_IDENT_ABORT_RL);
+        return;
     }
+    mc->ident.r_ll = rl->r_ll;
+    mc->ident.l_ll = rl->l_ll;
+
+    mc->ctx.state       = MOTOR_STATE_IDLE;
+    mc->rpm_cmd_request = mc->ident.rpm;
+    mc->ctx.ident.phase = PARAM_IDENT_SPIN;
+}
+
+// Hall commissioning: one sequencer step on this tick's Hall bits; the
+// fast loop drives the vector it asks for
+static void handle_hall_learn_state(MotorControl_t *mc)
+{
+    HallLearn_t *hl = &mc->hall_learn;
+
+    if (!HallLearn_step(hl, mc->hall_bits)) {
+        hall_learn_end(mc);
+        return;
+    }
+    ElecAngle_t a = (ElecAngle_t)(ElecAngle_fromRad(hl->angle_deg * (3.14159265f / 180.0f)) +
+                                  HALL_LEARN_VECTOR_OFFSET);
+    atomic_store_explicit(&mc->hall_learn_angle, a, memory_order_relaxed);
+
+    mc->ctx.cmd.torque_cmd = hall_learn_duty(mc);
+    mc->duty_cmd           = 0.0f;
+    mc->ctx.hall.state     = hl->state;
+}
+
+static void handle_fault_state(MotorControl_t *mc)
+{
+    // Stay in FAULT until an explicit reset
+    mc->ctx.cmd.enable      = false;
+    mc->ctx.cmd.rpm_cmd     = 0.0f;
+    mc->ctx.cmd.torque_cmd  = 0.0f;
+    mc->rpm_cmd_target      = 0.0f;
+    mc->rpm_cmd_request     = 0.0f;
+    mc->duty_cmd            = 0.0f;
 }
 
 // ---------------- Slow loop ----------------
 
-void MotorControl_stepSlow(void)
+void MotorControl_stepSlow(MotorControl_t *mc)
 {
     // NOTE: This is called from slow loop (e.g. SPEED_LOOP_HZ Hz)
-    static float s_last_time_s = 0.0f;
-
-    float now_s = 0.0f; // If you want real dt, pass now_s in from caller
-    float dt_s  = 0.0f;
+    // Same clock as the loops (virtual under simulation)
+    TimeNs_t now_ns = Clock_nowNs();
+    float    dt_s   = 0.0f;
 
-    if (s_last_time_s > 0.0f) {
-        dt_s = now_s - s_last_time_s;
-        if (dt_s < 0.0f) dt_s = 0.0f;
+    if (mc->last_time_ns > 0 && now_ns > mc->last_time_ns) {
+        dt_s = time_ns_to_s(now_ns - mc->last_time_ns);
     }
-    s_last_time_s = now_s;
+    mc->last_time_ns = now_ns;
+
+    mc->slow_tick++;
+
+    // 0) Latch faults raised by other threads (watchdog etc.), then
+    //    apply commands posted since the last tick
+    latch_pending_fault(mc);
+    drain_commands(mc, now_ns);
 
     // 1) Update measurements (speed, etc.)
-    update_measurements();
+    update_measurements(mc);
 
     // 2) Update internal target and direction based on user requests & actual speed
-    update_target_and_direction();
+    update_target_and_direction(mc);
 
-    // 3) Slew rpm_cmd toward target
-    update_speed_slew();
+    // 3) Move rpm_cmd toward target on the trajectory
+    update_speed_trajectory(mc);
 
     // 4) State machine
-    switch (s_ctx.state) {
+    switch (mc->ctx.state) {
     case MOTOR_STATE_IDLE:
-        handle_idle_state();
+        handle_idle_state(mc);
         break;
     case MOTOR_STATE_ALIGN:
-        handle_align_state();
+        handle_align_state(mc);
         break;
     case MOTOR_STATE_RUN:
-        handle_run_state(dt_s);
+        handle_run_state(mc, dt_s);
+        break;
+    case MOTOR_STATE_IDENT:
+        handle_ident_state(mc);
+        break;
+    case MOTOR_STATE_HALL_LEARN:
+        handle_hall_learn_state(mc);
         break;
     case MOTOR_STATE_FAULT:
     default:
-        handle_fault_state();
+        handle_fault_state(mc);
         break;
     }
+
+    // A tune only runs in RUN
+    if (mc->tuner.state == RELAY_TUNE_RUNNING && mc->ctx.state != MOTOR_STATE_RUN) {
+        RelayTuner_abort(&mc->tuner, RELAY_ABORT_STOPPED);
+        autotune_end(mc);
+    }
+    publish_tune(mc);
+
+    // ... and so does a frequency response
+    if (mc->ctx.state != MOTOR_STATE_RUN) {
+        fra_stop(mc);
+    }
+    publish_fra(mc);
+
+    // Parameter identification: spin / coast steps
+    ident_update(mc);
+
+    // A Hall learn a fault has interrupted
+    if (HallLearn_running(&mc->hall_learn) && mc->ctx.state != MOTOR_STATE_HALL_LEARN) {
+        HallLearn_abort(&mc->hall_learn);
+        hall_learn_end(mc);
+    }
+
+    // 5) Hand the result to the fast loop, and one consistent snapshot
+    //    per tick to the other threads
+    publish_fast_cmd(mc);
+    publish_context(mc);
 }
 
 // ---------------- Fast loop ----------------
 
-void MotorControl_stepFast(void)
+// DC-link current of a six-step sector: the driven pair carries it, into
+// the high-side phase and out of the low-side one. Signed, so current the
+// motor pushes back (braking, a late commutation) reads negative.
+static float six_step_dc_current(const MotorControl_t *mc, uint8_t sector, bool forward)
 {
-    // If disabled or faulted, always turn everything off.
-    if (!s_ctx.cmd.enable || s_ctx.fault != MOTOR_FAULT_NONE) {
-        s_duty_cmd = 0.0f;
-        if (s_pwm) {
-            PwmMotor_stop(s_pwm);
-        }
+    uint64_t bits = atomic_load_explicit((atomic_uint_fast64_t *)&mc->i_meas, memory_order_relaxed);
+    float    pair[2];
+    memcpy(pair, &bits, sizeof(pair));
+
+    int u, v, w;
+    PwmPattern_sixStepSigns(sector, forward, &u, &v, &w);
+    return 0.5f * ((float)u * pair[0] + (float)v * pair[1] - (float)w * (pair[0] + pair[1]));
+}
+
+// Sinusoidal equivalent: the current in phase with the voltage vector,
+// scaled so a six-step pair current I reads I at the sector centre
+// (sum(i_k * cos(angle - k*120deg)) is sqrt(3) * I there).
+static float sine_dc_current(const MotorControl_t *mc, ElecAngle_t v_angle)
+{
+    uint64_t bits = atomic_load_explicit((atomic_uint_fast64_t *)&mc->i_meas, memory_order_relaxed);
+    float    i[2];
+    memcpy(i, &bits, sizeof(i));
+
+    float p = i[0] * ElecAngle_cos(v_angle)
+            + i[1] * ElecAngle_cos((ElecAngle_t)(v_angle - ELEC_ANGLE_DEG(120)))
+            - (i[0] + i[1]) * ElecAngle_cos((ElecAngle_t)(v_angle + ELEC_ANGLE_DEG(120)));
+    return p * 0.57735027f;   // 1/sqrt(3)
+}
+
+// Inner current loop (fast-loop thread): PI on the DC-link current, line
+// voltage out, turned into the modulation scheme's duty. `sine`: the
+// phases are driven sinusoidally at v_angle, `sector` is not used.
+static float current_loop_step(MotorControl_t *mc, uint8_t sector, bool forward,
+                               bool sine, ElecAngle_t v_angle, float i_ref)
+{
+    float vbus = load_float(&mc->vbus_v);
+    float i_dc = sine ? sine_dc_current(mc, v_angle)
+                      : six_step_dc_current(mc, sector, forward);
+
+    // Entering RUN (or driving again, or leaving FOC): continue from the
+    // duty in force
+    if (!mc->cur_active) {
+        PI_setIntegrator(&mc->cur_pi, duty_to_line_frac(mc, mc->duty_last) * vbus);
+        mc->cur_active = true;
+        mc->foc_active = false;
+    }
+
+    // Line voltage: down to the scheme's duty 0 in six-step (-Vbus for
+    // H_PWM-L_PWM, whose diodes keep the current from reversing), the
+    // sine amplitude is not taken below 0
+    float v_lo = sine ? 0.0f : duty_to_line_frac(mc, 0.0f) * vbus;
+    PI_setLimits(&mc->cur_pi, v_lo, vbus);
+    PI_Status_t st;
+    float v = PI_step(&mc->cur_pi, i_ref, i_dc, true, &st);
+
+    // The slow loop reads this once per tick; only store changes
+    bool sat = (st == PI_SAT_HIGH);
+    if (sat != atomic_load_explicit(&mc->cur_sat, memory_order_relaxed)) {
+        atomic_store_explicit(&mc->cur_sat, sat, memory_order_relaxed);
+    }
+    return clamp_duty(line_frac_to_duty(mc, v / vbus));
+}
+
+// FOC step (fast-loop thread): d/q currents at the interpolated angle,
+// id = 0, iq from the speed PI's current reference. Returns the six-step
+// duty with the same line-line voltage, for the preload on the way back
+// and the published context.
+static float foc_loop_step(MotorControl_t *mc, bool forward, float i_ref)
+{
+    float vbus = load_float(&mc->vbus_v);
+
+    // Entering FOC: continue from the duty in force, all of it on q
+    if (!mc->foc_active) {
+        float vq = duty_to_line_frac(mc, mc->duty_last) * vbus * 0.57735027f;   // / sqrt(3)
+        Foc_reset(&mc->foc, 0.0f, forward ? vq : -vq);
+        mc->foc_active = true;
+        mc->cur_active = false;
+    }
+
+    uint64_t bits = atomic_load_explicit(&mc->i_meas, memory_order_relaxed);
+    float    i[2];
+    memcpy(i, &bits, sizeof(i));
+
+    float iq_ref = i_ref * FOC_IQ_PER_DC_A;
+    float d[3];
+    Foc_step(&mc->foc, i[0], i[1], (ElecAngle_t)(mc->elec_angle + FOC_D_AXIS_OFFSET),
+             0.0f, forward ? iq_ref : -iq_ref, vbus, d);
+    pwm_drive_duties(mc, d);
+
+    if (mc->foc.sat != atomic_load_explicit(&mc->cur_sat, memory_order_relaxed)) {
+        atomic_store_explicit(&mc->cur_sat, mc->foc.sat, memory_order_relaxed);
+    }
+    float v = sqrtf(mc->foc.v.d * mc->foc.v.d + mc->foc.v.q * mc->foc.v.q);
+    return clamp_duty(line_frac_to_duty(mc, v * 1.73205081f / vbus));   // * sqrt(3)
+}
+
+// Standstill R / L (fast-loop thread): the sequencer's line-line voltage
+// across the pair of `sector`, as six-step duty of the modulation scheme.
+// Reports back once, when it has finished.
+static void ident_rl_step(MotorControl_t *mc, uint8_t sector)
+{
+    float vbus = load_float(&mc->vbus_v);
+    float i    = six_step_dc_current(mc, sector, true);
+
+    if (ParamIdent_rlStep(&mc->ident_rl, i)) {
+        float duty = clamp_duty(line_frac_to_duty(mc, mc->ident_rl.v / vbus));
+        record_duty(mc, duty);
+        pwm_drive_six_step(mc, sector, duty, true);
         return;
     }
 
-    // ALIGN = open-loop startup
-    if (s_ctx.state == MOTOR_STATE_ALIGN) {
-        // Use the startup sector and fixed duty
-        uint8_t sector = s_startup_sector;
+    record_duty(mc, 0.0f);
+    pwm_outputs_off(mc);
+    if (!ParamIdent_rlRunning(&mc->ident_rl) &&
+        !atomic_load_explicit(&mc->ident_rl_done, memory_order_relaxed)) {
+        atomic_store_explicit(&mc->ident_rl_done, true, memory_order_release);
+    }
+}
+
+// Current PI (and FOC) idle: the next RUN tick preloads it again
+static void current_loop_stop(MotorControl_t *mc)
+{
+    if (mc->cur_active || mc->foc_active) {
+        mc->cur_active = false;
+        mc->foc_active = false;
+        atomic_store_explicit(&mc->cur_sat, false, memory_order_relaxed);
+    }
+}
+
+void MotorControl_stepFast(MotorControl_t *mc)
+{
+    // The fast loop runs on its own thread and only reads its own line:
+    // the packed command from the last stepSlow() and the queued fault.
+    // A queued fault (watchdog) kills the outputs here and is latched by
+    // the next stepSlow(). The fault is read first: stepSlow() clears it
+    // only after publishing drive=0, so a cleared one means the command
+    // read next already carries the fault.
+    int pending = atomic_load_explicit(&mc->pending_fault, memory_order_acquire);
+    MotorFastCmd_t fc = read_fast_cmd(mc);
+
+    // If disabled or faulted, always turn everything off
+    if (!fc.drive || pending != MOTOR_FAULT_NONE) {
+        current_loop_stop(mc);
+        record_duty(mc, 0.0f);
+        pwm_outputs_off(mc);
+        return;
+    }
+
+    // Same for one period when the cycle-by-cycle current limit is hit
+    // (the current PI holds its state meanwhile)
+    if (mc->i_chop) {
+        pwm_outputs_off(mc);
+        return;
+    }
+
+    // ALIGN = open-loop startup: startup sector + fixed duty
+    if (fc.state == MOTOR_STATE_ALIGN) {
+        uint8_t sector = fc.sector;
         if (sector >= 6) {
             sector = 0;
         }
+        current_loop_stop(mc);
+        record_duty(mc, fc.ref);
+        pwm_drive_six_step(mc, sector, fc.ref, fc.forward);
+        return;
+    }
 
-        float duty = s_ctx.cmd.torque_cmd;
-        if (duty < 0.0f) duty = 0.0f;
-        if (duty > 1.0f) duty = 1.0f;
+    // IDENT = standstill R / L injection on one phase pair
+    if (fc.state == MOTOR_STATE_IDENT) {
+        current_loop_stop(mc);
+        ident_rl_step(mc, fc.sector);
+        return;
+    }
 
-        bool dir_fwd = (s_ctx.cmd.direction == 0);
-        if (s_pwm) {
-            PwmMotor_setSixStep(s_pwm, sector, duty, dir_fwd);
-        }
+    // HALL_LEARN = the commissioning vector, open loop
+    if (fc.state == MOTOR_STATE_HALL_LEARN) {
+        ElecAngle_t a = (ElecAngle_t)atomic_load_explicit(&mc->hall_learn_angle,
+                                                          memory_order_relaxed);
+        current_loop_stop(mc);
+        record_duty(mc, fc.ref);
+        pwm_drive_sine(mc, a, fc.ref);
         return;
     }
 
     // Normal RUN mode (closed-loop with PI)
-    if (s_ctx.state != MOTOR_STATE_RUN) {
+    if (fc.state != MOTOR_STATE_RUN) {
         // any other state => outputs off
-        s_duty_cmd = 0.0f;
-        if (s_pwm) {
-            PwmMotor_stop(s_pwm);
-        }
+        current_loop_stop(mc);
+        record_duty(mc, 0.0f);
+        pwm_outputs_off(mc);
         return;
     }
 
-    // RUN: use estimator sector + PI duty
-    PosEst_t pe = PosEst_get();
-    uint8_t sector = pe.sector;
-    if (sector >= 6) {
-        MotorControl_setFault(MOTOR_FAULT_TIMING);
+    // RUN: estimator sector + PI duty
+    if (fc.sector >= 6) {
+        MotorControl_requestFault(mc, MOTOR_FAULT_TIMING);
+        pwm_outputs_off(mc);
         return;
     }
 
-    float duty = s_ctx.cmd.torque_cmd;
-    if (duty < 0.0f) duty = 0.0f;
-    if (duty > 1.0f) duty = 1.0f;
-
-    bool dir_fwd = (s_ctx.cmd.direction == 0);
-    if (s_pwm) {
-        PwmMotor_setSixStep(s_pwm, sector, duty, dir_fwd);
+    // Sinusoidal commutation and FOC need the interpolated angle; until
+    // it is valid (low speed, first edges) six-step carries on
+    int comm = atomic_load_explicit(&mc->commutation, memory_order_relaxed);
+    if (comm == MOTOR_COMM_FOC && mc->cur_loop && mc->angle_ok) {
+        record_duty(mc, foc_loop_step(mc, fc.forward, fc.ref));
+        return;
     }
-}
\ No newline at end of file
+    bool  sine    = mc->angle_ok && comm == MOTOR_COMM_SINE;
+    ElecAngle_t v_angle = (ElecAngle_t)(mc->elec_angle +
+                                        (fc.forward ? SINE_ANGLE_OFFSET_FWD : SINE_ANGLE_OFFSET_REV));
+
+    // Speed PI output is the duty, or the current PI's reference
+    float duty = mc->cur_loop ? current_loop_step(mc, fc.sector, fc.forward, sine, v_angle, fc.ref)
+                              : fc.ref;
+    record_duty(mc, duty);
+    if (sine) {
+        pwm_drive_sine(mc, v_angle, duty);
+    } else {
+        pwm_drive_six_step(mc, fc.sector, duty, fc.forward);
+    }
+}
@@ -0,0 +1,268 @@
+// motor_exec.c
+#define _GNU_SOURCE   // pthread_setaffinity_np
+#include "motor_exec.h"
+#include "motor_config.h"
+#include "clock_source.h"
+#include "rt_alloc_guard.h"
+
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+
+// ---------------- Thread setup ----------------
+
+static void pin_to_cpu(const MotorExecWorker_t *w, const char *what)
+{
+    if (w->cpu < 0) return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(w->cpu, &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        fprintf(stderr, "MotorExec: worker %d %s thread: cannot pin to CPU %d: %s\n",
+                w->index, what, w->cpu, strerror(err));
+    }
+}
+
+// ---------------- Fast loop ----------------
+
+static void *fast_thread_func(void *arg)
+{
+    MotorExecWorker_t *w  = (MotorExecWorker_t *)arg;
+    MotorExec_t       *ex = w->exec;
+
+    pin_to_cpu(w, "fast");
+
+    // Try to make this a real‑time SCHED_FIFO thread (best‑effort)
+    struct sched_param sp;
+    memset(&sp, 0, sizeof(sp));
+    sp.sched_priority = MOTOR_EXEC_FAST_PRIO;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) != 0) {
+        perror("pthread_setschedparam (SCHED_FIFO) failed; running non-RT");
+    }
+
+    if (ex->hooks.fast_start) {
+        ex->hooks.fast_start(w->index, ex->hooks.user);
+    }
+
+    const TimeNs_t Ts_ns     = TIME_NS_PER_S / FAST_LOOP_HZ;
+    const TimeNs_t jitter_hi = Ts_ns * 3;    // upper bound on acceptable dt
+    const TimeNs_t jitter_lo = Ts_ns / 10;   // lower bound
+
+    TimeNs_t t_prev = Clock_nowNs();
+    TimeNs_t t_next = t_prev + Ts_ns;
+
+    int timing_warn_count = 0;
+
+    // Setup done: no heap use from here on
+    RtAllocGuard_enterRt();
+
+    while (atomic_load_explicit(&ex->running, memory_order_relaxed)) {
+        TimeNs_t t_now = Clock_nowNs();
+        TimeNs_t dt    = t_now - t_prev;
+
+        // Jitter / timing *logging* (hard trips are the watchdog's job)
+        if (dt > jitter_hi || dt < jitter_lo) {
+            if ((timing_warn_count++ % 100) == 0) {
+                fprintf(stderr,
+                        "WARN: fast-loop jitter dt=%.6f s (expected %.6f s)\n",
+                        time_ns_to_s(dt), time_ns_to_s(Ts_ns));
+            }
+        }
+        t_prev = t_now;
+
+        // Fast control step of every axis on this worker
+        for (int i = 0; i < w->num_axes; ++i) {
+            MotorAxis_stepFast(w->axes[i]);
+        }
+
+        TimeNs_t t_done = Clock_nowNs();
+        long long work  = (long long)(t_done - t_now);
+        atomic_store_explicit(&w->work_last_ns, work, memory_order_relaxed);
+        atomic_fetch_add_explicit(&w->work_sum_ns, work, memory_order_relaxed);
+        if (work > atomic_load_explicit(&w->work_max_ns, memory_order_relaxed)) {
+            atomic_store_explicit(&w->work_max_ns, work, memory_order_relaxed);
+        }
+        atomic_fetch_add_explicit(&w->ticks, 1, memory_order_release);
+
+        if (ex->hooks.fast_tick) {
+            ex->hooks.fast_tick(w->index, ex->hooks.user);
+        }
+
+        // Sleep until the next absolute deadline
+        t_now = Clock_nowNs();
+        if (t_now >= t_next) {
+            // We're late; push next deadline forward
+            atomic_fetch_add_explicit(&w->overruns, 1, memory_order_relaxed);
+            t_next = t_now + Ts_ns;
+            continue;
+        }
+
+        Clock_sleepUntilNs(t_next);
+        t_next += Ts_ns;
+    }
+
+    RtAllocGuard_leaveRt();
+
+    if (ex->hooks.fast_exit) {
+        ex->hooks.fast_exit(w->index, ex->hooks.user);
+    }
+    return NULL;
+}
+
+// ---------------- Slow loop ----------------
+
+static void *slow_thread_func(void *arg)
+{
+    MotorExecWorker_t *w  = (MotorExecWorker_t *)arg;
+    MotorExec_t       *ex = w->exec;
+
+    pin_to_cpu(w, "slow");
+
+    const TimeNs_t slow_Ts_ns = TIME_NS_PER_S / SLOW_LOOP_HZ;
+
+    RtAllocGuard_enterRt();
+
+    while (atomic_load_explicit(&ex->running, memory_order_relaxed)) {
+        TimeNs_t t0 = Clock_nowNs();
+
+        for (int i = 0; i < w->num_axes; ++i) {
+            MotorAxis_stepSlow(w->axes[i], t0);
+        }
+
+        if (ex->hooks.slow_tick) {
+            ex->hooks.slow_tick(w->index, ex->hooks.user);
+        }
+
+        // Throttle to ~SLOW_LOOP_HZ (not hard RT, just approximate)
+        Clock_sleepUntilNs(t0 + slow_Ts_ns);
+    }
+
+    RtAllocGuard_leaveRt();
+    return NULL;
+}
+
+// ---------------- Public API ----------------
+
+bool MotorExec_init(MotorExec_t *ex,
+                    int num_workers,
+                    const int *cpus,
+                    const MotorExecHooks_t *hooks)
+{
+    if (!ex || num_workers < 1 || num_workers > MOTOR_EXEC_MAX_WORKERS) {
+        fprintf(stderr, "MotorExec_init: need 1..%d workers\n", MOTOR_EXEC_MAX_WORKERS);
+        return false;
+    }
+    memset(ex, 0, sizeof(*ex));
+
+    ex->num_workers = num_workers;
+    if (hooks) {
+        ex->hooks = *hooks;
+    }
+    atomic_init(&ex->running, false);
+
+    for (int i = 0; i < num_workers; ++i) {
+        MotorExecWorker_t *w = &ex->worker[i];
+        w->exec  = ex;
+        w->index = i;
+        w->cpu   = cpus ? cpus[i] : -1;
+        atomic_init(&w->ticks, 0);
+        atomic_init(&w->overruns, 0);
+        atomic_init(&w->work_last_ns, 0);
+        atomic_init(&w->work_max_ns, 0);
+        atomic_init(&w->work_sum_ns, 0);
+    }
+    return true;
+}
+
+int MotorExec_addAxis(MotorExec_t *ex, MotorAxis_t *ax)
+{
+    if (!ex || !ax) return -1;
+
+    int best = -1;
+    for (int i = 0; i < ex->num_workers; ++i) {
+        const MotorExecWorker_t *w = &ex->worker[i];
+        if (w->num_axes >= MOTOR_EXEC_MAX_AXES_PER_WORKER) continue;
+        if (best < 0 || w->num_axes < ex->worker[best].num_axes) {
+            best = i;
+        }
+    }
+    if (best < 0) {
+        fprintf(stderr, "MotorExec_addAxis: all workers full\n");
+        return -1;
+    }
+
+    MotorExecWorker_t *w = &ex->worker[best];
+    w->axes[w->num_axes++] = ax;
+    return best;
+}
+
+bool MotorExec_start(MotorExec_t *ex)
+{
+    if (!ex) return false;
+    atomic_store(&ex->running, true);
+
+    for (int i = 0; i < ex->num_workers; ++i) {
+        MotorExecWorker_t *w = &ex->worker[i];
+
+        int err = pthread_create(&w->slow_thread, NULL, slow_thread_func, w);
+        if (err != 0) {
+            fprintf(stderr, "MotorExec: worker %d slow thread: %s\n", i, strerror(err));
+            MotorExec_stop(ex);
+            return false;
+        }
+        w->slow_started = true;
+
+        err = pthread_create(&w->fast_thread, NULL, fast_thread_func, w);
+        if (err != 0) {
+            fprintf(stderr, "MotorExec: worker %d fast thread: %s\n", i, strerror(err));
+            MotorExec_stop(ex);
+            return false;
+        }
+        w->fast_started = true;
+    }
+    return true;
+}
+
+void MotorExec_stop(MotorExec_t *ex)
+{
+    if (!ex) return;
+    atomic_store(&ex->running, false);
+
+    for (int i = 0; i < ex->num_workers; ++i) {
+        MotorExecWorker_t *w = &ex->worker[i];
+        if (w->fast_started) {
+            pthread_join(w->fast_thread, NULL);
+            w->fast_started = false;
+        }
+        if (w->slow_started) {
+            pthread_join(w->slow_thread, NULL);
+            w->slow_started = false;
+        }
+    }
+}
+
+MotorExecStats_t MotorExec_getStats(const MotorExec_t *ex, int worker)
+{
+    MotorExecStats_t st;
+    memset(&st, 0, sizeof(st));
+    if (!ex || worker < 0 || worker >= ex->num_workers) return st;
+
+    MotorExecWorker_t *w = (MotorExecWorker_t *)&ex->worker[worker];
+
+    st.num_axes = w->num_axes;
+    st.ticks    = atomic_load_explicit(&w->ticks, memory_order_acquire);
+    st.overruns = atomic_load_explicit(&w->overruns, memory_order_relaxed);
+
+    long long last = atomic_load_explicit(&w->work_last_ns, memory_order_relaxed);
+    long long max  = atomic_load_explicit(&w->work_max_ns, memory_order_relaxed);
+    long long sum  = atomic_load_explicit(&w->work_sum_ns, memory_order_relaxed);
+
+    st.work_last_s = (double)last / (double)TIME_NS_PER_S;
+    st.work_max_s  = (double)max / (double)TIME_NS_PER_S;
+    st.work_mean_s = (st.ticks > 0)
+                     ? (double)sum / (double)TIME_NS_PER_S / (double)st.ticks
+                     : 0.0;
+    return st;
+}
@@ -2,118 +2,122 @@
 #include <string.h>     // memset
 
 // ---------------------------------------------------------
-// Global motor context (owned by control layer)
+// Helpers on a caller-owned MotorContext_t (one per motor)
 // ---------------------------------------------------------
-static MotorContext_t g_motor_ctx;
-
 
 // ---------------------------------------------------------
 // Initialization
 // ---------------------------------------------------------
-void MotorStates_init(void)
+void MotorStates_init(MotorContext_t *ctx)
 {
-    memset(&g_motor_ctx, 0, sizeof(g_motor_ctx));
+    if (!ctx) return;
+    memset(ctx, 0, sizeof(*ctx));
 
-    g_motor_ctx.state = MOTOR_STATE_IDLE;
+    ctx->state = MOTOR_STATE_IDLE;
 
     // Measurements default to 0
-    g_motor_ctx.meas.rpm_mech  = 0.0f;
-    g_motor_ctx.meas.rpm_elec  = 0.0f;
-    g_motor_ctx.meas.i_bus     = 0.0f;
-    g_motor_ctx.meas.i_phase_u = 0.0f;
-    g_motor_ctx.meas.i_phase_v = 0.0f;
-    g_motor_ctx.meas.i_phase_w = 0.0f;
-    g_motor_ctx.meas.v_bus     = 0.0f;
+    ctx->meas.rpm_mech  = 0.0f;
+    ctx->meas.rpm_elec  = 0.0f;
+    ctx->meas.i_bus     = 0.0f;
+    ctx->meas.i_phase_u = 0.0f;
+    ctx->meas.i_phase_v = 0.0f;
+    ctx->meas.i_phase_w = 0.0f;
+    ctx->meas.v_bus     = 0.0f;
 
     // Default commands
-    g_motor_ctx.cmd.rpm_cmd    = 0.0f;
-    g_motor_ctx.cmd.torque_cmd = 0.0f;
-    g_motor_ctx.cmd.enable     = false;
-    g_motor_ctx.cmd.direction  = false;   // forward
+    ctx->cmd.rpm_cmd    = 0.0f;
+    ctx->cmd.torque_cmd = 0.0f;
+    ctx->cmd.duty       = 0.0f;
+    ctx->cmd.enable     = false;
+    ctx->cmd.direction  = false;   // forward
 }
 
 
 // ---------------------------------------------------------
 // Getters
 // ---------------------------------------------------------
-MotorContext_t MotorStates_get(void)
-{
-    return g_motor_ctx;      // returned by value (safe snapshot)
-}
-
-MotorContext_t *MotorStates_ptr(void)
+MotorContext_t MotorStates_get(const MotorContext_t *ctx)
 {
-    return &g_motor_ctx;     // direct pointer (optional)
+    return *ctx;             // returned by value
 }
 
 
 // ---------------------------------------------------------
 // Command setters
 // ---------------------------------------------------------
-void MotorStates_setCommand(const MotorCommand_t *cmd)
+void MotorStates_setCommand(MotorContext_t *ctx, const MotorCommand_t *cmd)
 {
-    if (!cmd) return;
-    g_motor_ctx.cmd = *cmd;
+    if (!ctx || !cmd) return;
+    ctx->cmd = *cmd;
 }
 
-void MotorStates_setEnable(bool en)
+void MotorStates_setEnable(MotorContext_t *ctx, bool en)
 {
-    g_motor_ctx.cmd.enable = en;
+    if (!ctx) return;
+    ctx->cmd.enable = en;
 }
 
-void MotorStates_setDirection(bool dir)
+void MotorStates_setDirection(MotorContext_t *ctx, bool dir)
 {
-    g_motor_ctx.cmd.direction = dir;
+    if (!ctx) return;
+    ctx->cmd.direction = dir;
 }
 
-void MotorStates_setSpeedCmd(float rpm)
+void MotorStates_setSpeedCmd(MotorContext_t *ctx, float rpm)
 {
-    g_motor_ctx.cmd.rpm_cmd = rpm;
+    if (!ctx) return;
+    ctx->cmd.rpm_cmd = rpm;
 }
 
-void MotorStates_setTorqueCmd(float tq)
+void MotorStates_setTorqueCmd(MotorContext_t *ctx, float tq)
 {
-    g_motor_ctx.cmd.torque_cmd = tq;
+    if (!ctx) return;
+    ctx->cmd.torque_cmd = tq;
 }
 
 
 // ---------------------------------------------------------
 // Measurement setters
 // ---------------------------------------------------------
-void MotorStates_setMeasurements(const MotorMeasurements_t *meas)
+void MotorStates_setMeasurements(MotorContext_t *ctx, const MotorMeasurements_t *meas)
 {
-    if (!meas) return;
-    g_motor_ctx.meas = *meas;
+    if (!ctx || !meas) return;
+    ctx->meas = *meas;
 }
 
-void MotorStates_updateElectricalSpeed(float rpm_elec)
+void MotorStates_updateElectricalSpeed(MotorContext_t *ctx, float rpm_elec)
 {
-    g_motor_ctx.meas.rpm_elec = rpm_elec;
+    if (!ctx) return;
+    ctx->meas.rpm_elec = rpm_elec;
 }
 
-void MotorStates_updateMechanicalSpeed(float rpm_mech)
+void MotorStates_updateMechanicalSpeed(MotorContext_t *ctx, float rpm_mech)
 {
-    g_motor_ctx.meas.rpm_mech = rpm_mech;
+    if (!ctx) return;
+    ctx->meas.rpm_mech = rpm_mech;
 }
 
-void MotorStates_updateVbus(float v)
+void MotorStates_updateVbus(MotorContext_t *ctx, float v)
 {
-    g_motor_ctx.meas.v_bus = v;
+    if (!ctx) return;
+    ctx->meas.v_bus = v;
 }
 
-void MotorStates_updateCurrents(float iu, float iv, float iw, float ibus)
+void MotorStates_updateCurrents(MotorContext_t *ctx, float iu, float iv, float iw, float ibus)
 {
-    g_motor_ctx.meas.i_phase_u = iu;
-    g_motor_ctx.meas.i_phase_v = iv;
-    g_motor_ctx.meas.i_phase_w = iw;
-    g_motor_ctx.meas.i_bus     = ibus;
+    if (!ctx) return;
+    ctx->meas.i_phase_u = iu;
+    ctx->meas.i_phase_v = iv;
+    ctx->meas.i_phase_w = iw;
+    ctx->meas.i_bus     = ibus;
 }
 
 
 // ---------------------------------------------------------
 // State machine setter
 // ---------------------------------------------------------
-void MotorStates_setState(MotorState_t new_state)
+void MotorStates_setState(MotorContext_t *ctx, MotorState_t new_state)
 {
-    g_motor_ctx.state = new_state;
+    if (!ctx) return;
+    ctx->state = new_state;
 }
\ No newline at end of file
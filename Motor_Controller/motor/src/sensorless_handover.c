@@ -4,6 +4,8 @@
 #include "position_estimator.h"   // PosEst_setMode
 
 void SensorlessHandover_init(SensorlessHandover_t *h,
+                             SpeedMeas_t *speed,
+                             PosEstimator_t *pos,
                              float min_rpm_mech,
                              int   min_valid_samples)
 {
@@ -14,6 +16,8 @@ void SensorlessHandover_init(SensorlessHandover_t *h,
     h->min_rpm_mech      = min_rpm_mech;
     h->min_valid_samples = (min_valid_samples > 0) ? min_valid_samples : 1;
     h->valid_count       = 0;
+    h->speed             = speed;
+    h->pos               = pos;
 }
 
 void SensorlessHandover_setEnable(SensorlessHandover_t *h, bool enable)
@@ -26,12 +30,12 @@ void SensorlessHandover_setEnable(SensorlessHandover_t *h, bool enable)
 }
 
 bool SensorlessHandover_step(SensorlessHandover_t *h,
-                             float now_s,
+                             TimeNs_t now_ns,
                              bool direction_fwd)
 {
-    (void)now_s;  // Reserved for possible future timing-based logic
+    (void)now_ns; // Reserved for possible future timing-based logic
 
-    if (!h || !h->enabled) {
+    if (!h || !h->enabled || !h->speed || !h->pos) {
         return false;
     }
     if (h->done) {
@@ -40,7 +44,7 @@ bool SensorlessHandover_step(SensorlessHandover_t *h,
     }
 
     // We assume SpeedMeas is still in Hall mode here.
-    SpeedEstimate_t est = SpeedMeas_get();
+    SpeedEstimate_t est = SpeedMeas_get(h->speed);
 
     // Need valid speed and sector from Hall path
     if (!est.valid || est.sector == 0xFF || est.sector >= 6) {
@@ -66,13 +70,13 @@ bool SensorlessHandover_step(SensorlessHandover_t *h,
 
     // 1) Align BEMF sector tracker with current electrical sector
     //    Use the sector we just got from SpeedMeasurement (Hall path)
-    SpeedMeas_bemfAlign(est.sector, dir);
+    SpeedMeas_bemfAlign(h->speed, est.sector, dir);
 
     // 2) Switch SpeedMeas to use BEMF as the source
-    SpeedMeas_setMode(SPEED_SRC_BEMF);
+    SpeedMeas_setMode(h->speed, SPEED_SRC_BEMF);
 
     // 3) Switch position estimator mode
-    PosEst_setMode(POS_MODE_BEMF);
+    PosEst_setMode(h->pos, POS_MODE_BEMF);
 
     h->done = true;
     return true;
@@ -3,186 +3,222 @@
 #include "speed_measurement.h"
 #include "motor_config.h"
 #include "hall_commutator.h"
+#include "motor_config_runtime.h"   // g_motor_cfg
 
 #include <string.h>   // memset
 #include <stdio.h>
 
 #define SECTORS_PER_ELEC_REV        6.0f
-#define MIN_PERIOD_S                1e-5f
-#define STANDSTILL_TIMEOUT_S        0.5f    // after 0.5 s without edge -> invalid
+#define MIN_PERIOD_NS               (10 * TIME_NS_PER_US)
+#define STANDSTILL_TIMEOUT_NS       (500 * TIME_NS_PER_MS)  // after 0.5 s without edge -> invalid
 
-static SpeedEstimate_t  s_est;
-static SpeedSource_t    s_mode        = SPEED_SRC_HALL;
+// Log every Hall pattern change to stderr (bring-up aid; floods at speed)
+#ifndef SPEED_MEAS_HALL_DEBUG
+#define SPEED_MEAS_HALL_DEBUG       0
+#endif
 
-static HallHandle_t    *s_hall        = NULL;
+void SpeedMeas_init(SpeedMeas_t *sm)
+{
+    if (!sm) return;
+    memset(sm, 0, sizeof(*sm));
 
-// BEMF sensorless backend
-static BemfHandle_t    *s_bemf        = NULL;
-static BemfSectorState_t s_bemf_state;
+    sm->est.valid   = false;
+    sm->est.sector  = 0xFF;
 
-// Hall-only internal state
-static uint8_t  s_last_sector  = 0xFF;
-static float    s_last_edge_ts = 0.0f;
-static int      s_have_edge    = 0;
+    sm->mode        = SPEED_SRC_HALL;
+    sm->hall        = NULL;
+    sm->hall_map    = g_motor_cfg.hall_map;
 
-void SpeedMeas_init(void)
-{
-    memset(&s_est, 0, sizeof(s_est));
-    s_est.valid   = false;
-    s_est.sector  = 0xFF;
+    sm->bemf        = NULL;
+    BemfSector_init(&sm->bemf_state, 0, BEMF_DIR_FWD);
 
-    s_mode        = SPEED_SRC_HALL;
-    s_hall        = NULL;
+    sm->last_sector  = 0xFF;
+    sm->last_edge_ns = 0;
+    sm->have_edge    = false;
 
-    s_bemf        = NULL;
-    BemfSector_init(&s_bemf_state, 0, BEMF_DIR_FWD);
+    HallTimingConfig_t tc = {
+        .pole_pairs = MOTOR_POLE_PAIRS,
+        .gain       = HALL_TIMING_GAIN,
+        .steady_tol = HALL_TIMING_STEADY_TOL,
+    };
+    HallTiming_init(&sm->timing, &tc);
 
-    s_last_sector  = 0xFF;
-    s_last_edge_ts = 0.0f;
-    s_have_edge    = 0;
+    sm->dbg_last_sector = 0xFF;
+    sm->dbg_last_bits   = 0xFF;
 }
 
-void SpeedMeas_setMode(SpeedSource_t src)
+void SpeedMeas_setMode(SpeedMeas_t *sm, SpeedSource_t src)
 {
-    s_mode = src;
+    if (!sm) return;
+    sm->mode = src;
     // Reset estimates when switching source
-    s_est.rpm_mech      = 0.0f;
-    s_est.rpm_elec      = 0.0f;
-    s_est.last_period_s = 0.0f;
-    s_est.sector        = 0xFF;
-    s_est.valid         = false;
+    sm->est.rpm_mech      = 0.0f;
+    sm->est.rpm_elec      = 0.0f;
+    sm->est.last_period_ns = 0;
+    sm->est.sector        = 0xFF;
+    sm->est.valid         = false;
 
     // Reset hall-side timing
-    s_last_sector  = 0xFF;
-    s_last_edge_ts = 0.0f;
-    s_have_edge    = 0;
+    sm->last_sector  = 0xFF;
+    sm->last_edge_ns = 0;
+    sm->have_edge    = false;
+    HallTiming_forget(&sm->timing);   // sectors not followed meanwhile
 
     // Reset BEMF state (sector will be re-aligned with SpeedMeas_bemfAlign)
-    BemfSector_init(&s_bemf_state, 0, BEMF_DIR_FWD);
+    BemfSector_init(&sm->bemf_state, 0, BEMF_DIR_FWD);
+}
+
+void SpeedMeas_setHallHandle(SpeedMeas_t *sm, HallHandle_t *hh)
+{
+    if (!sm) return;
+    sm->hall = hh;
 }
 
-void SpeedMeas_setHallHandle(HallHandle_t *hh)
+void SpeedMeas_setHallMap(SpeedMeas_t *sm, const HallMap_t *hm)
 {
-    s_hall = hh;
+    if (!sm || !hm) return;
+    sm->hall_map = *hm;
+
+    // Sectors decoded before mean something else now
+    sm->last_sector  = 0xFF;
+    sm->last_edge_ns = 0;
+    sm->have_edge    = false;
+    HallTiming_forget(&sm->timing);
 }
 
-void SpeedMeas_setBemfHandle(BemfHandle_t *bh)
+void SpeedMeas_setBemfHandle(SpeedMeas_t *sm, BemfHandle_t *bh)
 {
-    s_bemf = bh;
+    if (!sm) return;
+    sm->bemf = bh;
 }
 
-void SpeedMeas_bemfAlign(uint8_t start_sector, BemfDir_t dir)
+void SpeedMeas_bemfAlign(SpeedMeas_t *sm, uint8_t start_sector, BemfDir_t dir)
 {
-    BemfSector_init(&s_bemf_state, start_sector, dir);
+    if (!sm) return;
+    BemfSector_init(&sm->bemf_state, start_sector, dir);
 }
 
-static void update_hall(float now_s)
+static void update_hall(SpeedMeas_t *sm, TimeNs_t now_ns)
 {
-    if (!s_hall) {
-        s_est.valid  = false;
-        s_est.sector = 0xFF;
+    if (!sm->hall) {
+        sm->est.valid  = false;
+        sm->est.sector = 0xFF;
         return;
     }
 
     // 1) Read hall bits and convert to sector
-    uint8_t hall_bits = Hall_readBits(s_hall);
-    uint8_t sector    = HallComm_hallToSector(hall_bits);
-
-    static uint8_t last_print_sector = 0xFF;
-    static uint8_t last_print_bits   = 0xFF;
-    if (sector != last_print_sector || hall_bits != last_print_bits) {
-        last_print_sector = sector;
-        last_print_bits   = hall_bits;
+    uint8_t hall_bits = Hall_readBits(sm->hall);
+    uint8_t sector    = HallComm_hallToSector(&sm->hall_map, hall_bits);
+
+#if SPEED_MEAS_HALL_DEBUG
+    if (sector != sm->dbg_last_sector || hall_bits != sm->dbg_last_bits) {
+        sm->dbg_last_sector = sector;
+        sm->dbg_last_bits   = hall_bits;
         fprintf(stderr, "HALL DBG: bits=0x%02X sector=%d t=%.3f\n",
-                hall_bits, sector, now_s);
+                hall_bits, sector, (double)now_ns * 1e-9);
     }
+#endif
 
     if (sector == 0xFF) {
         // Invalid hall pattern -> invalidate
-        s_est.valid  = false;
-        s_est.sector = 0xFF;
+        sm->est.valid  = false;
+        sm->est.sector = 0xFF;
         return;
     }
 
     // 2) Standstill / timeout check
-    if (s_have_edge && (now_s - s_last_edge_ts) > STANDSTILL_TIMEOUT_S) {
-        s_est.rpm_mech      = 0.0f;
-        s_est.rpm_elec      = 0.0f;
-        s_est.last_period_s = 0.0f;
-        s_est.valid         = false;
+    if (sm->have_edge && (now_ns - sm->last_edge_ns) > STANDSTILL_TIMEOUT_NS) {
+        sm->est.rpm_mech       = 0.0f;
+        sm->est.rpm_elec       = 0.0f;
+        sm->est.last_period_ns = 0;
+        sm->est.valid         = false;
+        HallTiming_stop(&sm->timing);
         // keep sector as-is
     }
 
-    if (!s_have_edge) {
+    if (!sm->have_edge) {
         // First valid sector
-        s_last_sector   = sector;
-        s_last_edge_ts  = now_s;
-        s_have_edge     = 1;
-        s_est.valid     = false;
-        s_est.sector    = sector;
+        sm->last_sector   = sector;
+        sm->last_edge_ns  = now_ns;
+        sm->have_edge     = true;
+        sm->est.valid     = false;
+        sm->est.sector    = sector;
+        (void)HallTiming_edge(&sm->timing, sector, 0.0f);
         return;
     }
 
     // 3) On sector change -> edge
-    if (sector != s_last_sector) {
-        float dt = now_s - s_last_edge_ts;
-        if (dt > MIN_PERIOD_S) {
-            s_last_edge_ts      = now_s;
-            s_last_sector       = sector;
-            s_est.last_period_s = dt;
-            s_est.sector        = sector;
-
-            float T_elec = dt * SECTORS_PER_ELEC_REV;
-            if (T_elec > MIN_PERIOD_S) {
-                float f_elec   = 1.0f / T_elec;
-                float rpm_elec = f_elec * 60.0f;
-
-                s_est.rpm_elec = rpm_elec;
-                s_est.rpm_mech = rpm_elec / (float)MOTOR_POLE_PAIRS;
-                s_est.valid    = true;
-            } else {
-                s_est.valid = false;
-            }
+    if (sector != sm->last_sector) {
+        // Edge interval in integer ns; only the interval becomes a float
+        TimeNs_t dt_ns = now_ns - sm->last_edge_ns;
+        if (dt_ns > MIN_PERIOD_NS) {
+            sm->last_edge_ns       = now_ns;
+            sm->last_sector        = sector;
+            sm->est.last_period_ns = dt_ns;
+            sm->est.sector         = sector;
+
+            // The sector just left was `width` x 60 deg wide
+            float width = HallTiming_edge(&sm->timing, sector, time_ns_to_s(dt_ns));
+            if (!g_motor_cfg.hall_timing_comp) width = 1.0f;
+
+            float T_elec   = time_ns_to_s(dt_ns) * SECTORS_PER_ELEC_REV / width;
+            float f_elec   = 1.0f / T_elec;
+            float rpm_elec = f_elec * 60.0f;
+
+            sm->est.rpm_elec = rpm_elec;
+            sm->est.rpm_mech = rpm_elec / (float)MOTOR_POLE_PAIRS;
+            sm->est.valid    = true;
         }
     } else {
-        s_est.sector = sector;
+        sm->est.sector = sector;
     }
 }
 
-static void update_bemf(float now_s)
+static void update_bemf(SpeedMeas_t *sm, TimeNs_t now_ns)
 {
-    if (!s_bemf) {
-        s_est.valid  = false;
-        s_est.sector = 0xFF;
+    if (!sm->bemf) {
+        sm->est.valid  = false;
+        sm->est.sector = 0xFF;
         return;
     }
 
     // Bemf_update() should already have been called before this in the loop.
-    BemfSector_update(&s_bemf_state, s_bemf, now_s);
+    BemfSector_update(&sm->bemf_state, sm->bemf, now_ns);
 
-    BemfSectorState_t bs = BemfSector_get(&s_bemf_state);
+    BemfSectorState_t bs = BemfSector_get(&sm->bemf_state);
 
-    s_est.rpm_elec      = bs.rpm_elec;
-    s_est.rpm_mech      = bs.rpm_mech;
-    s_est.last_period_s = bs.last_period_s;
-    s_est.sector        = bs.valid ? bs.sector : 0xFF;
-    s_est.valid         = bs.valid;
+    sm->est.rpm_elec      = bs.rpm_elec;
+    sm->est.rpm_mech      = bs.rpm_mech;
+    sm->est.last_period_ns = bs.last_period_ns;
+    sm->est.sector        = bs.valid ? bs.sector : 0xFF;
+    sm->est.valid         = bs.valid;
 }
 
-void SpeedMeas_update(float now_s)
+void SpeedMeas_update(SpeedMeas_t *sm, TimeNs_t now_ns)
 {
-    switch (s_mode) {
+    if (!sm) return;
+
+    switch (sm->mode) {
         case SPEED_SRC_BEMF:
-            update_bemf(now_s);
+            update_bemf(sm, now_ns);
             break;
         case SPEED_SRC_HALL:
         default:
-            update_hall(now_s);
+            update_hall(sm, now_ns);
             break;
     }
 }
 
-SpeedEstimate_t SpeedMeas_get(void)
+void SpeedMeas_sectorScale(const SpeedMeas_t *sm, float scale[6])
+{
+    if (!sm || sm->mode != SPEED_SRC_HALL || !g_motor_cfg.hall_timing_comp) {
+        HallTiming_sectorScale(NULL, scale);
+        return;
+    }
+    HallTiming_sectorScale(&sm->timing, scale);
+}
+
+SpeedEstimate_t SpeedMeas_get(const SpeedMeas_t *sm)
 {
-    return s_est;
+    return sm->est;
 }
\ No newline at end of file
@@ -0,0 +1,186 @@
+// bldc_plant.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "timer.h"         // TimeNs_t
+#include "pwm_pattern.h"   // PWM_PATTERN_CHANNELS
+
+// ---------------------------------------------------------
+// Three-phase BLDC plant model (star connected, trapezoidal or sine BEMF)
+// ---------------------------------------------------------
+//
+// Electrical: per phase  v_x - v_n = R i_x + L di_x/dt + e_x
+//             e_x = ke_phase * w_mech * f(theta_e - x*120deg)
+//             f = trapezoid, flat +1 on [30,150] deg, -1 on [210,330] deg,
+//                 or (bemf_sine) 2/sqrt(3) * sin: same line-line peak
+// Mechanical: J dw/dt = T_e - B w - Tc sgn(w) - T_load
+//             T_e = ke_phase * sum(f_x * i_x)
+//
+// The inverter is simulated at switch level: each of the six channels is
+// an edge-aligned PWM (on for duty*T at the start of every period, the
+// same way the sysfs PWM outputs behave), or on for the last duty*T if
+// the channel is late-aligned (inversed polarity). A phase with both
+// switches off conducts through the body diodes while its current is
+// non-zero, and is open (i = 0, terminal = v_n + e_x) once the current
+// has decayed.
+//
+// Switching is ideal; the energy bookkeeping in the state adds an
+// estimate of the hard-switching loss (0.5 * dV * |i| * switch_time per
+// terminal swing at a gate edge) next to the copper and diode losses, so
+// modulation schemes can be compared for efficiency. It also tracks how
+// clean the BEMF of the floating phase is (see float_* below).
+//
+// The shunt amplifier outputs go through an RC filter before the ADC (as
+// on the board): the ADC reads are not synchronized to the PWM, so a
+// sample stands for the recent average current rather than a random
+// point on the ripple.
+//
+// Time comes from the caller: every accessor first integrates the model
+// up to `now_ns` with the gate pattern that was in force, then acts. This
+// makes the plant follow whatever clock the control stack uses (real
+// CLOCK_MONOTONIC or a VirtualClock_t).
+
+typedef struct {
+    // Electrical (from MotorRuntimeConfig by default)
+    float    pole_pairs;
+    float    kv_rpm_per_v;       // line-line Kv
+    float    r_phase_ohm;
+    float    l_phase_h;
+
+    // Mechanical
+    float    inertia_kgm2;
+    float    viscous_nm_per_rad_s;
+    float    coulomb_nm;         // dry friction (also holds at standstill)
+    float    load_nm;            // constant load, opposes forward rotation
+    bool     bemf_sine;          // sinusoidal BEMF (PMSM-like) instead of trapezoidal
+
+    // Supply / inverter
+    float    vbus_v;
+    float    pwm_freq_hz;
+    float    diode_drop_v;
+    float    switch_time_s;      // rise/fall time of a switch edge (loss estimate)
+
+    // Sensors
+    float    hall_offset_deg;    // electrical mounting error of the Hall edges
+    float    hall_sensor_err_deg[3]; // ... and of each sensor (bits 0..2) on top:
+                                     // sectors of unequal width
+    float    adc_noise_counts;   // uniform +/- noise on each ADC read
+    float    isense_offset_v;    // shunt amp output error at zero current (V)
+    float    isense_filter_s;    // RC filter on the shunt amp outputs (0 = none)
+    uint32_t seed;
+
+    // Integration step (must divide the PWM period reasonably finely)
+    TimeNs_t substep_ns;
+} BldcPlantParams_t;
+
+typedef struct {
+    TimeNs_t t_ns;               // plant time (last integrated instant)
+    float    theta_mech_rad;     // [0, 2pi)
+    float    omega_mech_rad_s;
+    float    theta_elec_deg;     // [0, 360)
+    float    i_phase_a[3];
+    float    i_sense_a[2];       // phase U/V current behind the sense filter
+    float    e_phase_v[3];
+    float    v_term_v[3];        // terminal voltages to ground
+    float    v_neutral_v;
+    float    torque_nm;          // electromagnetic torque
+    float    p_elec_w;           // power drawn from the bus (avg over last step)
+    uint32_t shoot_through;      // substeps with both switches of a leg on
+
+    // Energy since init (J)
+    double   e_bus_j;            // drawn from the bus
+    double   e_mech_j;           // electromagnetic work on the rotor
+    double   e_copper_j;
+    double   e_diode_j;
+    double   e_switch_j;         // hard-switching estimate, not part of e_bus_j
+
+    // Floating phase (both its switches commanded off). float_clamped_s
+    // is the time it still conducts (freewheeling through a diode), when
+    // the terminal shows a rail instead of the BEMF. While it is open, a
+    // zero-cross detector reading v_term - Vbus/2 expects e_x: float_err2
+    // integrates the squared difference. float_err2_mid does the same for
+    // a detector referenced to the midpoint of the two driven terminals
+    // (expecting e_x - (e_a + e_b)/2), which follows the neutral through
+    // the off-time.
+    double   float_s;
+    double   float_clamped_s;
+    double   float_err2_v2s;
+    double   float_err2_mid_v2s;
+} BldcPlantState_t;
+
+typedef struct {
+    BldcPlantParams_t p;
+    BldcPlantState_t  x;
+
+    // Derived
+    float    ke_phase;           // V per mech rad/s (phase, flat top)
+    TimeNs_t pwm_period_ns;
+
+    // Gate command in force
+    float    gate_duty[PWM_PATTERN_CHANNELS];
+    bool     gate_late[PWM_PATTERN_CHANNELS];
+    bool     gate_enable;
+    bool     gate_on_prev[PWM_PATTERN_CHANNELS];   // switch states of the last substep
+
+    bool     time_valid;         // x.t_ns has been anchored to the caller's clock
+    uint32_t rng;
+
+    pthread_mutex_t lock;
+} BldcPlant_t;
+
+/**
+ * @brief Fill params: motor constants from g_motor_cfg, the rest from
+ *        the SIM_* defaults in bldc_plant.c.
+ */
+void BldcPlant_defaultParams(BldcPlantParams_t *p);
+
+/**
+ * @brief Initialize plant at standstill, rotor at theta_elec = 0.
+ */
+void BldcPlant_init(BldcPlant_t *pl, const BldcPlantParams_t *p);
+
+void BldcPlant_destroy(BldcPlant_t *pl);
+
+/**
+ * @brief Integrate up to now_ns with the current gate pattern.
+ */
+void BldcPlant_advance(BldcPlant_t *pl, TimeNs_t now_ns);
+
+/**
+ * @brief Apply a new six-channel gate pattern from now_ns on.
+ *
+ * @param gates   per-channel duty and alignment (PwmMotor_t channel
+ *                order), NULL = all duties 0
+ * @param enable  false = all switches off regardless of duty
+ */
+void BldcPlant_setGates(BldcPlant_t *pl,
+                        const PwmGates_t *gates,
+                        bool enable,
+                        TimeNs_t now_ns);
+
+/**
+ * @brief Hall bits at now_ns (b0 = A, b1 = B, b2 = C, as Hall_readBits()).
+ */
+uint8_t BldcPlant_readHall(BldcPlant_t *pl, TimeNs_t now_ns);
+
+/**
+ * @brief Raw MCP3208 counts for an ADC channel at now_ns.
+ *
+ * BEMF_CH_U/V/W = attenuated terminal voltages, BEMF_CH_VBUS = bus,
+ * ISENSE_CH_U/V = shunt amplifier outputs of phases U/V.
+ * Unused channels read 0.
+ */
+int BldcPlant_readAdc(BldcPlant_t *pl, int channel, TimeNs_t now_ns);
+
+/**
+ * @brief Copy of the plant state (advanced to now_ns first).
+ */
+BldcPlantState_t BldcPlant_getState(BldcPlant_t *pl, TimeNs_t now_ns);
+
+// Scenario knobs (take effect immediately)
+void BldcPlant_setLoad(BldcPlant_t *pl, float load_nm);
+void BldcPlant_setVbus(BldcPlant_t *pl, float vbus_v);
+void BldcPlant_setRotor(BldcPlant_t *pl, float theta_elec_deg, float omega_mech_rad_s);
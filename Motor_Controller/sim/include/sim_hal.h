@@ -0,0 +1,29 @@
+// sim_hal.h
+#pragma once
+
+#include "bldc_plant.h"
+
+// ---------------------------------------------------------
+// Simulated HAL backend
+// ---------------------------------------------------------
+// sim_hal.c provides the adc_*, gpio_*, Hall_* and PwmMotor_* functions
+// of hal/ on top of a BldcPlant_t, so the unmodified motor/ and app/ code
+// links against it instead of the hardware drivers (see sim/CMakeLists.txt).
+//
+// Each handle is bound to a plant when its *_init() runs: to the plant
+// selected with SimHal_setPlant(), or to a built-in default plant created
+// from g_motor_cfg on first use. All time stamps come from Clock_nowNs(),
+// so the plant runs in real time or in virtual time with the rest of the
+// stack.
+
+#define SIM_HAL_MAX_BINDINGS   128   // Hall + PWM handle per axis, 64 axes
+
+/**
+ * @brief Plant that subsequent *_init() calls bind to (NULL = default plant).
+ */
+void SimHal_setPlant(BldcPlant_t *pl);
+
+/**
+ * @brief The built-in default plant (created on first call).
+ */
+BldcPlant_t *SimHal_getDefaultPlant(void);
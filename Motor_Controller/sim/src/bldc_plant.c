@@ -0,0 +1,532 @@
+// bldc_plant.c
+#include "bldc_plant.h"
+#include "motor_config.h"          // BEMF_CH_*, ISENSE_CH_*, ADC_REF_V
+#include "motor_config_runtime.h"  // g_motor_cfg
+
+#include <math.h>
+#include <string.h>
+
+// ---------------- Simulation defaults ----------------
+// Motor constants come from g_motor_cfg; these cover what the runtime
+// config does not describe (mechanics, supply, sensors).
+
+#define SIM_INERTIA_KGM2         2.0e-5f   // small outrunner + hub
+#define SIM_VISCOUS_NM_PER_RADS  1.0e-6f
+#define SIM_COULOMB_NM           2.0e-3f
+#define SIM_VBUS_V               12.0f
+#define SIM_DIODE_DROP_V         0.7f
+#define SIM_SWITCH_TIME_S        50.0e-9f  // MOSFET edge with the DRV8302 gate drive
+#define SIM_ADC_NOISE_COUNTS     2.0f
+#define SIM_ISENSE_OFFSET_V      0.0f      // shunt amp output error at zero current
+#define SIM_ISENSE_FILTER_S      50.0e-6f  // shunt amp RC filter (one PWM period)
+#define SIM_SUBSTEP_NS           500       // 100 substeps per 20 kHz period
+
+// Catch-up guard: if the caller's clock jumps (e.g. a stalled real-time
+// process), only integrate the last slice and hold the rest.
+#define SIM_MAX_CATCHUP_NS       (100 * TIME_NS_PER_MS)
+
+// Current below which a diode-conducting phase is considered open
+#define SIM_I_EPS_A              1.0e-4f
+
+// Board sense scaling (same as bemf.c, inverted): EMF/VPD pins see the
+// phase/bus voltage * 5.1/73.1, MCP3208 full scale is 2 * ADC_REF_V.
+#define SIM_SENSE_ATTEN          (5.1f / 73.1f)
+#define SIM_ADC_FULL_SCALE_V     (ADC_REF_V * 2.0f)
+#define SIM_ADC_MAX_COUNTS       4095
+
+// Shunt amplifiers (SO1/SO2): ADC_REF_V at zero current, gain * shunt V/A
+#define SIM_ISENSE_V_PER_A       (CURRENT_SENSE_GAIN * CURRENT_SHUNT_OHM)
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define TWO_PI_F  ((float)(2.0 * M_PI))
+
+// ---------------- Helpers ----------------
+
+static float wrap_deg(float d)
+{
+    d = fmodf(d, 360.0f);
+    if (d < 0.0f) d += 360.0f;
+    return d;
+}
+
+// Trapezoidal BEMF shape, 120 deg flat top
+static float trap(float deg)
+{
+    float d = wrap_deg(deg);
+    if (d < 30.0f)  return d / 30.0f;
+    if (d < 150.0f) return 1.0f;
+    if (d < 210.0f) return 1.0f - (d - 150.0f) / 30.0f;
+    if (d < 330.0f) return -1.0f;
+    return -1.0f + (d - 330.0f) / 30.0f;
+}
+
+// Sinusoidal BEMF shape with the trapezoid's line-line peak (2 * flat top)
+static float sine_shape(float deg)
+{
+    return 1.15470054f * sinf(deg * (float)(M_PI / 180.0));
+}
+
+static uint32_t xorshift32(uint32_t *s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *s = x;
+    return x;
+}
+
+// Uniform in [-1, 1]
+static float rand_unit(uint32_t *s)
+{
+    return (float)(xorshift32(s) >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+// BEMF shape per phase at the present rotor angle -> shape[], e_phase_v[]
+static void update_bemf(BldcPlant_t *pl, float shape[3])
+{
+    BldcPlantState_t *x = &pl->x;
+    for (int ph = 0; ph < 3; ++ph) {
+        float deg = x->theta_elec_deg - 120.0f * (float)ph;
+        shape[ph] = pl->p.bemf_sine ? sine_shape(deg) : trap(deg);
+        x->e_phase_v[ph] = pl->ke_phase * x->omega_mech_rad_s * shape[ph];
+    }
+}
+
+// Gate state of the six channels at absolute time t (edge- or late-aligned PWM)
+static void gates_at(const BldcPlant_t *pl, TimeNs_t t, bool on[PWM_PATTERN_CHANNELS])
+{
+    TimeNs_t phase = t % pl->pwm_period_ns;
+    for (int i = 0; i < PWM_PATTERN_CHANNELS; ++i) {
+        TimeNs_t on_ns = (TimeNs_t)(pl->gate_duty[i] * (float)pl->pwm_period_ns);
+        bool     in    = pl->gate_late[i] ? (phase >= pl->pwm_period_ns - on_ns)
+                                          : (phase < on_ns);
+        on[i] = pl->gate_enable && in;
+    }
+}
+
+// Solve terminal and neutral voltages for the present currents/gates.
+// cond[ph] = phase carries current (switch or diode).
+static void solve_network(BldcPlant_t *pl, const bool on[PWM_PATTERN_CHANNELS],
+                          bool cond[3])
+{
+    BldcPlantState_t *x = &pl->x;
+    const float vbus = pl->p.vbus_v;
+    const float vd   = pl->p.diode_drop_v;
+
+    int   n_cond = 0;
+    float sum    = 0.0f;
+
+    for (int ph = 0; ph < 3; ++ph) {
+        bool hs = on[2 * ph];
+        bool ls = on[2 * ph + 1];
+
+        cond[ph] = true;
+        if (hs && ls) {
+            // Shoot-through: the bus is shorted through this leg. Count it
+            // and treat the leg as pulled low so the model stays bounded.
+            x->shoot_through++;
+            x->v_term_v[ph] = 0.0f;
+        } else if (hs) {
+            x->v_term_v[ph] = vbus;
+        } else if (ls) {
+            x->v_term_v[ph] = 0.0f;
+        } else if (x->i_phase_a[ph] > SIM_I_EPS_A) {
+            x->v_term_v[ph] = -vd;            // low-side diode
+        } else if (x->i_phase_a[ph] < -SIM_I_EPS_A) {
+            x->v_term_v[ph] = vbus + vd;      // high-side diode
+        } else {
+            cond[ph] = false;
+        }
+
+        if (cond[ph]) {
+            n_cond++;
+            sum += x->v_term_v[ph] - x->e_phase_v[ph];
+        }
+    }
+
+    if (n_cond >= 2) {
+        // Equal R/L and sum(i) = 0 over the conducting phases
+        x->v_neutral_v = sum / (float)n_cond;
+    } else {
+        // Nothing can flow: the sense dividers pull the terminals so
+        // that they average to ground.
+        x->v_neutral_v = -(x->e_phase_v[0] + x->e_phase_v[1] + x->e_phase_v[2]) / 3.0f;
+        for (int ph = 0; ph < 3; ++ph) {
+            cond[ph] = false;
+        }
+    }
+
+    for (int ph = 0; ph < 3; ++ph) {
+        if (!cond[ph]) {
+            float v = x->v_neutral_v + x->e_phase_v[ph];
+            if (v < -vd)        v = -vd;
+            if (v > vbus + vd)  v = vbus + vd;
+            x->v_term_v[ph] = v;
+        }
+    }
+}
+
+static void substep(BldcPlant_t *pl, TimeNs_t dt_ns, double *energy_j)
+{
+    BldcPlantState_t *x = &pl->x;
+    const float dt = (float)dt_ns * 1e-9f;
+
+    bool on[PWM_PATTERN_CHANNELS];
+    gates_at(pl, x->t_ns + dt_ns / 2, on);
+
+    float shape[3];
+    update_bemf(pl, shape);
+
+    float v_prev[3];
+    memcpy(v_prev, x->v_term_v, sizeof(v_prev));
+
+    bool cond[3];
+    solve_network(pl, on, cond);
+
+    // --- Losses and floating-phase BEMF (with the currents entering the step) ---
+    for (int ph = 0; ph < 3; ++ph) {
+        float i_abs = fabsf(x->i_phase_a[ph]);
+        bool  hs    = on[2 * ph];
+        bool  ls    = on[2 * ph + 1];
+
+        if (hs != pl->gate_on_prev[2 * ph] || ls != pl->gate_on_prev[2 * ph + 1]) {
+            x->e_switch_j += 0.5 * fabs((double)(x->v_term_v[ph] - v_prev[ph]))
+                         * (double)i_abs * (double)pl->p.switch_time_s;
+        }
+        if (cond[ph] && !hs && !ls) {
+            x->e_diode_j += (double)(pl->p.diode_drop_v * i_abs * dt);
+        }
+
+        if (pl->gate_enable &&
+            pl->gate_duty[2 * ph] == 0.0f && pl->gate_duty[2 * ph + 1] == 0.0f) {
+            x->float_s += (double)dt;
+            if (cond[ph]) {
+                x->float_clamped_s += (double)dt;
+            } else {
+                int   a     = (ph + 1) % 3;
+                int   b     = (ph + 2) % 3;
+                float v_mid = 0.5f * (x->v_term_v[a] + x->v_term_v[b]);
+                float e_mid = 0.5f * (x->e_phase_v[a] + x->e_phase_v[b]);
+                float err   = x->v_term_v[ph] - 0.5f * pl->p.vbus_v - x->e_phase_v[ph];
+                float err_m = (x->v_term_v[ph] - v_mid) - (x->e_phase_v[ph] - e_mid);
+                x->float_err2_v2s     += (double)(err * err * dt);
+                x->float_err2_mid_v2s += (double)(err_m * err_m * dt);
+            }
+        }
+    }
+    memcpy(pl->gate_on_prev, on, sizeof(pl->gate_on_prev));
+
+    // --- Electrical ---
+    bool driven[3];
+    for (int ph = 0; ph < 3; ++ph) {
+        driven[ph] = on[2 * ph] || on[2 * ph + 1];
+    }
+
+    int n_live = 0;
+    for (int ph = 0; ph < 3; ++ph) {
+        if (!cond[ph]) {
+            x->i_phase_a[ph] = 0.0f;
+            continue;
+        }
+        float i_old = x->i_phase_a[ph];
+        float di    = (x->v_term_v[ph] - x->e_phase_v[ph] - x->v_neutral_v
+                       - pl->p.r_phase_ohm * i_old) / pl->p.l_phase_h * dt;
+        float i_new = i_old + di;
+
+        // A diode cannot reverse its current: it just turns off (and
+        // stays out of the Kirchhoff correction below)
+        if (!driven[ph] && (i_old * i_new) <= 0.0f) {
+            i_new    = 0.0f;
+            cond[ph] = false;
+        }
+        x->i_phase_a[ph] = i_new;
+        if (fabsf(i_new) > SIM_I_EPS_A) n_live++;
+    }
+
+    if (n_live < 2) {
+        x->i_phase_a[0] = x->i_phase_a[1] = x->i_phase_a[2] = 0.0f;
+    } else {
+        // Keep Kirchhoff exact despite the diode clamping above
+        float sum    = 0.0f;
+        int   n_cond = 0;
+        for (int ph = 0; ph < 3; ++ph) {
+            if (cond[ph]) {
+                sum += x->i_phase_a[ph];
+                n_cond++;
+            }
+        }
+        for (int ph = 0; ph < 3; ++ph) {
+            if (cond[ph]) x->i_phase_a[ph] -= sum / (float)n_cond;
+        }
+    }
+
+    // Bus current = current leaving the +rail into phases tied to it
+    float i_bus = 0.0f;
+    for (int ph = 0; ph < 3; ++ph) {
+        if (cond[ph] && x->v_term_v[ph] >= pl->p.vbus_v) {
+            i_bus += x->i_phase_a[ph];
+        }
+    }
+    *energy_j   += (double)(pl->p.vbus_v * i_bus * dt);
+    x->e_bus_j  += (double)(pl->p.vbus_v * i_bus * dt);
+    for (int ph = 0; ph < 3; ++ph) {
+        x->e_copper_j += (double)(pl->p.r_phase_ohm * x->i_phase_a[ph] * x->i_phase_a[ph] * dt);
+    }
+
+    // Shunt amp RC filter
+    float a = (pl->p.isense_filter_s > 0.0f) ? dt / (pl->p.isense_filter_s + dt) : 1.0f;
+    for (int ph = 0; ph < 2; ++ph) {
+        x->i_sense_a[ph] += a * (x->i_phase_a[ph] - x->i_sense_a[ph]);
+    }
+
+    // --- Mechanical ---
+    float te = 0.0f;
+    for (int ph = 0; ph < 3; ++ph) {
+        te += shape[ph] * x->i_phase_a[ph];
+    }
+    te *= pl->ke_phase;
+    x->torque_nm = te;
+    x->e_mech_j += (double)(te * x->omega_mech_rad_s * dt);
+
+    float w       = x->omega_mech_rad_s;
+    float t_drive = te - pl->p.load_nm - pl->p.viscous_nm_per_rad_s * w;
+
+    if (w == 0.0f && fabsf(t_drive) <= pl->p.coulomb_nm) {
+        // Stiction holds the rotor
+    } else {
+        float t_fric = (w > 0.0f) ? pl->p.coulomb_nm
+                     : (w < 0.0f) ? -pl->p.coulomb_nm
+                     : (t_drive > 0.0f ? pl->p.coulomb_nm : -pl->p.coulomb_nm);
+        float w_new = w + (t_drive - t_fric) / pl->p.inertia_kgm2 * dt;
+
+        // Friction stops the rotor; it does not push it backwards
+        if (w != 0.0f && (w * w_new) < 0.0f && fabsf(t_drive) <= pl->p.coulomb_nm) {
+            w_new = 0.0f;
+        }
+        x->omega_mech_rad_s = w_new;
+    }
+
+    x->theta_mech_rad += x->omega_mech_rad_s * dt;
+    x->theta_mech_rad  = fmodf(x->theta_mech_rad, TWO_PI_F);
+    if (x->theta_mech_rad < 0.0f) x->theta_mech_rad += TWO_PI_F;
+
+    x->theta_elec_deg = wrap_deg(x->theta_mech_rad * pl->p.pole_pairs * (float)(180.0 / M_PI));
+
+    x->t_ns += dt_ns;
+}
+
+static void advance_locked(BldcPlant_t *pl, TimeNs_t now_ns)
+{
+    if (!pl->time_valid) {
+        pl->x.t_ns      = now_ns;
+        pl->time_valid  = true;
+        return;
+    }
+    if (now_ns <= pl->x.t_ns) {
+        return;
+    }
+    if (now_ns - pl->x.t_ns > SIM_MAX_CATCHUP_NS) {
+        pl->x.t_ns = now_ns - SIM_MAX_CATCHUP_NS;
+    }
+
+    TimeNs_t t0      = pl->x.t_ns;
+    double   energy  = 0.0;
+
+    while (pl->x.t_ns < now_ns) {
+        TimeNs_t dt = now_ns - pl->x.t_ns;
+        if (dt > pl->p.substep_ns) dt = pl->p.substep_ns;
+        substep(pl, dt, &energy);
+    }
+
+    pl->x.p_elec_w = (float)(energy / ((double)(now_ns - t0) * 1e-9));
+
+    // Leave terminals/BEMF consistent with the final instant for sampling
+    bool  on[PWM_PATTERN_CHANNELS];
+    bool  cond[3];
+    float shape[3];
+    gates_at(pl, pl->x.t_ns, on);
+    update_bemf(pl, shape);
+    solve_network(pl, on, cond);
+}
+
+// ---------------- Public API ----------------
+
+void BldcPlant_defaultParams(BldcPlantParams_t *p)
+{
+    if (!p) return;
+    memset(p, 0, sizeof(*p));
+
+    p->pole_pairs           = g_motor_cfg.pole_pairs;
+    p->kv_rpm_per_v         = g_motor_cfg.kv_rpm_per_v;
+    p->r_phase_ohm          = g_motor_cfg.r_phase_ohm;
+    p->l_phase_h            = g_motor_cfg.l_phase_h;
+    p->pwm_freq_hz          = g_motor_cfg.pwm_freq_hz;
+
+    p->inertia_kgm2         = SIM_INERTIA_KGM2;
+    p->viscous_nm_per_rad_s = SIM_VISCOUS_NM_PER_RADS;
+    p->coulomb_nm           = SIM_COULOMB_NM;
+    p->load_nm              = 0.0f;
+    p->bemf_sine            = false;
+
+    p->vbus_v               = SIM_VBUS_V;
+    p->diode_drop_v         = SIM_DIODE_DROP_V;
+    p->switch_time_s        = SIM_SWITCH_TIME_S;
+
+    p->hall_offset_deg      = 0.0f;
+    p->hall_sensor_err_deg[0] = p->hall_sensor_err_deg[1] = p->hall_sensor_err_deg[2] = 0.0f;
+    p->adc_noise_counts     = SIM_ADC_NOISE_COUNTS;
+    p->isense_offset_v      = SIM_ISENSE_OFFSET_V;
+    p->isense_filter_s      = SIM_ISENSE_FILTER_S;
+    p->seed                 = 1u;
+    p->substep_ns           = SIM_SUBSTEP_NS;
+}
+
+void BldcPlant_init(BldcPlant_t *pl, const BldcPlantParams_t *p)
+{
+    if (!pl || !p) return;
+    memset(pl, 0, sizeof(*pl));
+    pl->p = *p;
+
+    if (pl->p.substep_ns <= 0) pl->p.substep_ns = SIM_SUBSTEP_NS;
+    if (pl->p.pwm_freq_hz <= 0.0f) pl->p.pwm_freq_hz = (float)PWM_FREQUENCY_HZ;
+
+    // Kv is line-line: V_ll = w_mech / (2pi/60 * Kv); phase flat top is half
+    pl->ke_phase      = 0.5f * 60.0f / (TWO_PI_F * pl->p.kv_rpm_per_v);
+    pl->pwm_period_ns = (TimeNs_t)(1e9 / (double)pl->p.pwm_freq_hz);
+    pl->rng           = pl->p.seed ? pl->p.seed : 1u;
+
+    pthread_mutex_init(&pl->lock, NULL);
+}
+
+void BldcPlant_destroy(BldcPlant_t *pl)
+{
+    if (!pl) return;
+    pthread_mutex_destroy(&pl->lock);
+}
+
+void BldcPlant_advance(BldcPlant_t *pl, TimeNs_t now_ns)
+{
+    if (!pl) return;
+    pthread_mutex_lock(&pl->lock);
+    advance_locked(pl, now_ns);
+    pthread_mutex_unlock(&pl->lock);
+}
+
+void BldcPlant_setGates(BldcPlant_t *pl,
+                        const PwmGates_t *gates,
+                        bool enable,
+                        TimeNs_t now_ns)
+{
+    if (!pl) return;
+    pthread_mutex_lock(&pl->lock);
+    advance_locked(pl, now_ns);
+    for (int i = 0; i < PWM_PATTERN_CHANNELS; ++i) {
+        float d = gates ? gates->duty[i] : 0.0f;
+        if (d < 0.0f) d = 0.0f;
+        if (d > 1.0f) d = 1.0f;
+        pl->gate_duty[i] = d;
+        pl->gate_late[i] = gates ? gates->late[i] : false;
+    }
+    pl->gate_enable = enable;
+    pthread_mutex_unlock(&pl->lock);
+}
+
+uint8_t BldcPlant_readHall(BldcPlant_t *pl, TimeNs_t now_ns)
+{
+    // Sector k spans [30 + 60k, 90 + 60k) electrical degrees; bit pattern
+    // is the inverse of the HallComm_hallToSector() table
+    // ({ 0x1, 0x3, 0x2, 0x6, 0x4, 0x5 }): bit b is high for the 180 degrees
+    // centred on sector 2b, 30 + 120 b into the Hall frame.
+    if (!pl) return 0;
+    pthread_mutex_lock(&pl->lock);
+    advance_locked(pl, now_ns);
+    uint8_t bits = 0;
+    for (int b = 0; b < 3; b++) {
+        float d = wrap_deg(pl->x.theta_elec_deg - 30.0f - pl->p.hall_offset_deg -
+                           pl->p.hall_sensor_err_deg[b] - (30.0f + 120.0f * (float)b) + 90.0f);
+        if (d < 180.0f) bits |= (uint8_t)(1u << b);
+    }
+    pthread_mutex_unlock(&pl->lock);
+    return bits;
+}
+
+int BldcPlant_readAdc(BldcPlant_t *pl, int channel, TimeNs_t now_ns)
+{
+    if (!pl) return -1;
+    pthread_mutex_lock(&pl->lock);
+    advance_locked(pl, now_ns);
+
+    // Voltage at the ADC pin
+    float v;
+    switch (channel) {
+    case BEMF_CH_U:    v = pl->x.v_term_v[0] * SIM_SENSE_ATTEN; break;
+    case BEMF_CH_V:    v = pl->x.v_term_v[1] * SIM_SENSE_ATTEN; break;
+    case BEMF_CH_W:    v = pl->x.v_term_v[2] * SIM_SENSE_ATTEN; break;
+    case BEMF_CH_VBUS: v = pl->p.vbus_v * SIM_SENSE_ATTEN;      break;
+    case ISENSE_CH_U:
+        v = ADC_REF_V + pl->p.isense_offset_v + pl->x.i_sense_a[0] * SIM_ISENSE_V_PER_A;
+        break;
+    case ISENSE_CH_V:
+        v = ADC_REF_V + pl->p.isense_offset_v + pl->x.i_sense_a[1] * SIM_ISENSE_V_PER_A;
+        break;
+    default:           v = 0.0f;                                 break;
+    }
+
+    float counts = v / SIM_ADC_FULL_SCALE_V * (float)SIM_ADC_MAX_COUNTS;
+    if (pl->p.adc_noise_counts > 0.0f) {
+        counts += pl->p.adc_noise_counts * rand_unit(&pl->rng);
+    }
+    pthread_mutex_unlock(&pl->lock);
+
+    int c = (int)lrintf(counts);
+    if (c < 0) c = 0;
+    if (c > SIM_ADC_MAX_COUNTS) c = SIM_ADC_MAX_COUNTS;
+    return c;
+}
+
+BldcPlantState_t BldcPlant_getState(BldcPlant_t *pl, TimeNs_t now_ns)
+{
+    BldcPlantState_t s;
+    memset(&s, 0, sizeof(s));
+    if (!pl) return s;
+
+    pthread_mutex_lock(&pl->lock);
+    advance_locked(pl, now_ns);
+    s = pl->x;
+    pthread_mutex_unlock(&pl->lock);
+    return s;
+}
+
+void BldcPlant_setLoad(BldcPlant_t *pl, float load_nm)
+{
+    if (!pl) return;
+    pthread_mutex_lock(&pl->lock);
+    pl->p.load_nm = load_nm;
+    pthread_mutex_unlock(&pl->lock);
+}
+
+void BldcPlant_setVbus(BldcPlant_t *pl, float vbus_v)
+{
+    if (!pl) return;
+    pthread_mutex_lock(&pl->lock);
+    pl->p.vbus_v = vbus_v;
+    pthread_mutex_unlock(&pl->lock);
+}
+
+void BldcPlant_setRotor(BldcPlant_t *pl, float theta_elec_deg, float omega_mech_rad_s)
+{
+    if (!pl) return;
+    pthread_mutex_lock(&pl->lock);
+    float pp = (pl->p.pole_pairs > 0.0f) ? pl->p.pole_pairs : 1.0f;
+    pl->x.theta_elec_deg   = wrap_deg(theta_elec_deg);
+    pl->x.theta_mech_rad   = pl->x.theta_elec_deg * (float)(M_PI / 180.0) / pp;
+    pl->x.omega_mech_rad_s = omega_mech_rad_s;
+
+    float shape[3];
+    update_bemf(pl, shape);
+    pthread_mutex_unlock(&pl->lock);
+}
@@ -0,0 +1,2841 @@
+// sim_bench.c
+//
+// Closed-loop benchmarks of the motor control stack against the BLDC
+// plant model. step / ripple / handover run on a VirtualClock_t in a
+// single thread: one iteration = one fast-loop period, with the slow loop
+// every FAST_LOOP_HZ / SLOW_LOOP_HZ iterations, in the same order as the
+// executive (motor_exec.c).
+//
+// "instances" runs in real time instead: N axes, each on its own plant,
+// on one MotorExec_t worker pinned to CPU 0, and reports how the fast-loop
+// work per tick grows with N (how many motors one core can drive).
+//
+// "sharing" runs one axis in real time with its fast loop on CPU 0 and
+// telemetry readers / a command poster on CPU 1, and reports the fast
+// loop's cost and cache misses per tick (perf counters), i.e. how much the
+// other threads disturb it through shared cache lines. Then the poster
+// cycles enable / fault / clear instead, and it fails (exit 1) if any
+// snapshot the readers took broke the fault invariants (FAULT state
+// exactly when a fault is set, never enabled in FAULT).
+//
+// "alloc" runs one axis in real time for a few seconds with the malloc
+// interposer linked in, and fails (exit 1) if the loop threads touched
+// the heap.
+//
+// "current" checks the current sensing: offset calibration against an
+// amplifier offset injected in the plant, peak phase current during a
+// step (cycle-by-cycle limit), and the overcurrent trip time; it fails
+// (exit 1) if any of them is off.
+//
+// "loadstep" applies a load torque step at constant speed command, with
+// the speed PI driving the duty directly and through the inner current
+// loop, the latter with the load observer off and on, at a speed where
+// the Hall speed estimate is fine-grained and at one where it is coarse.
+// It reports the speed dip, recovery time and peak phase current, the
+// speed's standard deviation once loaded (what the observer adds in
+// noise) and the observer's estimate of the load (friction excluded); it
+// fails (exit 1) if the observer does not shorten the recovery.
+//
+// "modulation" holds a constant speed under a light and a heavier load
+// with each six-step modulation scheme, and reports the drive efficiency
+// with its loss breakdown (copper, diodes, estimated switching) and how
+// usable the floating-phase BEMF is: the share of floating time the phase
+// still freewheels through a diode, and while it is open the RMS error of
+// the sensed BEMF, referenced to Vbus/2 (the present zero-cross detector)
+// and to the midpoint of the two driven terminals.
+//
+// "sine" holds a constant speed and load with six-step, sinusoidal and
+// FOC commutation, on a motor with trapezoidal and one with sinusoidal
+// BEMF, and reports the torque ripple (torque averaged over each
+// fast-loop tick, so PWM ripple is left out), the speed ripple and the
+// efficiency of each. The commutation ripple is the torque's 6th
+// harmonic of the electrical angle; six-step's total ripple also holds
+// the speed loop's reaction to the 1 kHz-polled Hall speed, which sine
+// and FOC replace with a revolution of edges timed at the fast rate.
+// It also times MotorControl_stepFast() on a copy of the controller with
+// no driver attached (control work only, no PWM writes).
+//
+// "angle" checks the table sine / cosine of elec_angle.h against libm:
+// worst error over every angle code and over random float angles
+// (conversion included), and the cost of one sin + cos pair from float
+// radians, in ns and, where perf counters are available, cycles.
+//
+// "sched" repeats the duty-mode step (with feedforward) to a low, middle
+// and high speed with the fixed speed PI gains and with the configured
+// gain schedule, at the nominal and at twice the bus voltage, and reports
+// the step figures plus the speed's standard deviation once settled
+// (hunting).
+//
+// "autotune" brings the motor to a speed, runs the relay autotuner there
+// with each rule, in duty mode and with the current loop, and reports the
+// measured ultimate gain / period, the gains and how long the run took.
+// It fails (exit 1) if a finished run changes the speed PI's gains before
+// "autotune apply"; after the apply, a speed step with the tuned gains,
+// against the same step on the untouched gains.
+//
+// "fra" runs the onboard frequency-response analyzer at a constant speed,
+// loaded, in duty mode (fixed gains, Kv feedforward without the IR term)
+// and with the current loop:
+// a multisine at the speed command (closed loop T), and a multisine and
+// a chirp at the speed-loop output (plant P). T is then predicted from P
+// and the speed PI, T = C P / (1 + C P), and compared with the measured
+// one; the chirp's P against the multisine's. Bins marked * failed the
+// analyzer's coherence check and are left out of both comparisons; it
+// fails (exit 1) if chirp and multisine disagree on a bin both passed.
+//
+// "traj" steps the speed command up from a speed the motor already runs
+// at, in duty mode (with the Kv feedforward) and with the current loop:
+// on the old constant-rate ramp without acceleration feedforward, on a
+// ramp at the configured acceleration with it, and on the jerk-limited
+// trajectory with it. It reports the transition time, overshoot, RMS
+// error against the trajectory's rpm_cmd while it moves, and the peak
+// and largest step of the speed-loop output (averaged over short
+// windows: the torque steps at the ends of a ramp).
+//
+// "ident" starts the motor parameter identification with the runtime
+// config's Kv, R, L, inertia and friction set wrong (the plant keeps the
+// true ones), on complementary modulation: standstill R / L, spin,
+// coast. It reports each identified value against the plant's (friction:
+// at the test speed), then saves them to a scratch config file and loads
+// that back.
+//
+// "hall" runs the Hall commissioning on a plant whose Hall edges are
+// mounted BENCH_HALL_OFFSET_DEG off, from a config with no Hall map. It
+// reports the learned codes against the plant's wiring and each edge
+// offset against the mounting error, then saves them to a scratch config
+// file and loads that back.
+//
+// "halltiming" runs sinusoidal commutation at a constant speed on a plant
+// whose three Hall sensors are placed BENCH_HT_SENSOR_ERR_DEG off each,
+// so the sectors alternate wide and narrow. After the edge timing table
+// has learned, it compares two windows, compensation on and off: the
+// Hall speed per sector against the true speed (averaged per sector, so
+// the edge sampling quantization drops out), and the interpolated angle
+// against the plant's (RMS about its mean lag). It also reports the
+// largest error of the learned widths against the plant's.
+//
+// "uptime" holds BENCH_UPTIME_RPM with the Hall estimator, and with the
+// BEMF one after a handover, on a virtual clock started at 0, 1, 7 and
+// 30 days of uptime. It reports each estimator's speed error against the
+// plant per slow tick (sector periods are sampled at the slow-loop rate,
+// so this is mostly that quantization), the resolution of its sector
+// periods, the speed over all edges in the window and the worst sector
+// period against the plant's. Beside it, the period the same edges give
+// from float-second timestamps (the old timebase: 7 ms off at 1 day,
+// 250 ms at 30). It fails (exit 1) if the results are not the same at
+// every start, or if the Hall speed over the edges is more than
+// BENCH_UPTIME_SPEED_PCT off or a period more than one poll and one fast
+// tick off. The BEMF estimator is not held to the plant: after the
+// handover it loses this plant's rotor (see "handover").
+//
+// Usage: Motor_Sim_Bench [step|ripple|handover|instances|sharing|alloc|current|loadstep|modulation|sine|angle|sched|autotune|fra|traj|ident|hall|halltiming|uptime|all] [-n trials] [-c config]
+
+#define _GNU_SOURCE   // pthread_setaffinity_np
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "motor_config.h"
+#include "motor_config_runtime.h"
+#include "motor_control.h"
+#include "motor_axis.h"
+#include "motor_exec.h"
+#include "hall_commutator.h"
+#include "perf_counters.h"
+#include "rt_alloc_guard.h"
+#include "clock_source.h"
+#include "adc.h"
+#include "bemf.h"
+#include "current_sense.h"
+#include "hall.h"
+#include "pwm_motor.h"
+#include "elec_angle.h"
+
+#include "bldc_plant.h"
+#include "sim_hal.h"
+
+// ---------------- Bench settings ----------------
+
+// Virtual clock starts after 30 days of uptime, so the integer-ns
+// timebase is exercised the way a long-running controller sees it.
+#define BENCH_START_NS          (30LL * 24 * 3600 * TIME_NS_PER_S)
+
+#define BENCH_STEP_RPM          1500.0f
+
+#define BENCH_UPTIME_RPM        1500.0f
+#define BENCH_UPTIME_SETTLE_S   2.5f      // Hall: past the startup; BEMF: after handover
+#define BENCH_UPTIME_WINDOW_S   1.0f
+#define BENCH_UPTIME_TOL_RPM    0.05f     // same error: within this
+#define BENCH_UPTIME_SPEED_PCT  0.5f      // Hall speed over the window's edges vs plant
+#define BENCH_UPTIME_PERIOD_MS  (1e3f / SLOW_LOOP_HZ + 1e3f / FAST_LOOP_HZ)  // one poll + one tick
+#define BENCH_STEP_RUN_S        3.0f
+#define BENCH_STEP_BAND         0.05f     // settling band (+/- of target)
+#define BENCH_STEP_DUTY_RUN_S   8.0f      // duty mode without feedforward settles slowly
+
+#define BENCH_RIPPLE_RPM        2000.0f
+#define BENCH_RIPPLE_LOAD_NM    0.005f
+#define BENCH_RIPPLE_SETTLE_S   3.0f      // past the startup ramp (slew rate)
+#define BENCH_RIPPLE_WINDOW_S   1.0f
+
+#define BENCH_HO_RPM            1500.0f
+#define BENCH_HO_TIMEOUT_S      4.0f      // handover must happen by then
+#define BENCH_HO_HOLD_S         1.0f      // ...and the motor keep running after
+#define BENCH_HO_TOL            0.20f     // |rpm - cmd| tolerance while holding
+#define BENCH_HO_TRIALS         20
+
+#define BENCH_INST_RPM          1500.0f
+#define BENCH_INST_RUN_S        2.5f      // past the open-loop startup
+#define BENCH_INST_MAX_AXES     MOTOR_EXEC_MAX_AXES_PER_WORKER
+#define BENCH_INST_MAX_OVR_PCT  1.0       // "sustained" = fewer overruns than this
+#define BENCH_INST_SAT_OVR_PCT  50.0      // stop the sweep once the core is saturated
+
+#define BENCH_SHARE_RUN_S       3.0f
+#define BENCH_SHARE_READERS     2         // status / UDP-like pollers
+#define BENCH_SHARE_POST_US     1000      // command post period
+#define BENCH_SHARE_CYCLE_S     2.0f      // enable / fault / clear cycling
+#define BENCH_SHARE_CYCLE_US    3000      // ... one step per this
+
+#define BENCH_ALLOC_RUN_S       5.0f
+
+#define BENCH_CUR_OFFSET_V      0.040f    // injected shunt amp offset (~0.33 A)
+#define BENCH_CUR_RESID_A       0.05f     // max |i| at standstill once calibrated
+#define BENCH_CUR_RUN_S         3.0f
+
+#define BENCH_LS_RPM            1500.0f
+#define BENCH_LS_RPM_LO         800.0f    // Hall speed still fine-grained here
+#define BENCH_LS_SETTLE_S       3.0f      // past startup and the speed step
+#define BENCH_LS_LOAD_NM        0.010f    // ~1 A of torque current
+#define BENCH_LS_HOLD_S         1.0f
+#define BENCH_LS_BAND           0.02f     // recovered = back within +/- this
+#define BENCH_LS_REF_S          0.5f      // pre-step speed = mean over this window
+
+#define BENCH_MOD_RPM           1500.0f
+#define BENCH_MOD_LOAD_LO_NM    0.002f    // light: discontinuous current
+#define BENCH_MOD_LOAD_HI_NM    0.010f
+#define BENCH_MOD_LOAD_AT_S     2.5f      // at speed (the startup is not compared)
+#define BENCH_MOD_SETTLE_S      3.5f
+#define BENCH_MOD_WINDOW_S      1.0f
+
+#define BENCH_SINE_RPM          1500.0f
+#define BENCH_SINE_LOAD_NM      0.005f
+#define BENCH_SINE_LOAD_AT_S    2.5f      // at speed
+#define BENCH_SINE_SETTLE_S     3.5f
+#define BENCH_SINE_WINDOW_S     1.0f
+#define BENCH_SINE_COST_REPS    64        // stepFast() calls per timing sample
+
+#define BENCH_ANGLE_N           4096      // random angles per pass
+#define BENCH_ANGLE_PASSES      1024
+#define BENCH_ANGLE_SPAN_RAD    50.0f     // angles drawn from +/- this
+#define BENCH_ANGLE_MAX_ERR     2e-4      // table error limit (sin / cos)
+
+#define BENCH_SCHED_N_RPM       3
+#define BENCH_SCHED_RUN_S       5.0f
+
+#define BENCH_AT_RPM            800.0f    // tuned here (fine-grained Hall speed)
+#define BENCH_AT_STEP_RPM       1100.0f   // then stepped to this
+#define BENCH_AT_SETTLE_S       3.0f      // at speed before the tune starts
+#define BENCH_AT_STEP_S         2.0f      // step response window
+#define BENCH_AT_RUN_S          (BENCH_AT_SETTLE_S + AUTOTUNE_TIMEOUT_S + 0.5f + BENCH_AT_STEP_S)
+
+#define BENCH_FRA_RPM           800.0f
+#define BENCH_FRA_LOAD_NM       0.010f    // ~1 A: the current excitation stays off zero
+#define BENCH_FRA_LOAD_AT_S     2.0f      // at speed
+#define BENCH_FRA_SETTLE_S      3.0f      // loaded, before the analysis starts
+#define BENCH_FRA_RUN_S         (BENCH_FRA_SETTLE_S + \
+                                 (float)(FRA_SETTLE_SAMPLES + FRA_PERIODS * FRA_SAMPLES) / SPEED_LOOP_HZ + 1.0f)
+#define BENCH_FRA_MIN_U_FRAC    0.02f     // bins with less excitation left out of the errors
+#define BENCH_FRA_AGREE_DB      3.0f      // chirp vs multisine on bins both pass coherence
+#define BENCH_FRA_AGREE_DEG     30.0f
+
+#define BENCH_TRAJ_RPM_LO       600.0f
+#define BENCH_TRAJ_RPM_HI       1400.0f   // below where the Hall speed gets coarse
+#define BENCH_TRAJ_SETTLE_S     3.0f      // at RPM_LO before the step
+#define BENCH_TRAJ_STEP_S       1.5f
+#define BENCH_TRAJ_WIN_S        0.01f     // output averaged over this for the torque step
+#define BENCH_TRAJ_OLD_ACCEL    2000.0f   // the former fixed slew rate (rpm/s)
+
+#define BENCH_IDENT_WRONG       1.5f      // config Kv / R / L / J start off by this factor
+#define BENCH_IDENT_MAX_S       20.0f
+#define BENCH_IDENT_CFG_PATH    "/tmp/motor_sim_bench_ident.cfg"
+
+#define BENCH_HALL_OFFSET_DEG   8.0f      // plant Hall mounting error (electrical)
+#define BENCH_HALL_MAX_S        20.0f
+#define BENCH_HALL_CFG_PATH     "/tmp/motor_sim_bench_hall.cfg"
+
+#define BENCH_HT_RPM            1000.0f
+#define BENCH_HT_LEARN_S        10.0f     // spin up + learning, before the windows
+#define BENCH_HT_SETTLE_S       0.2f      // after switching the compensation
+#define BENCH_HT_WINDOW_S       2.0f
+static const float s_ht_sensor_err_deg[3] = { 6.0f, -4.0f, 0.0f };
+
+#define RAD_S_TO_RPM            (60.0f / (2.0f * 3.14159265f))
+
+typedef enum {
+    RIG_SENSOR_HALL = 0,
+    RIG_SENSOR_AUTO              // Hall start, handover to BEMF
+} RigSensor_t;
+
+typedef struct {
+    VirtualClock_t       clock;
+    BldcPlant_t          plant;
+    PwmMotor_t           pwm;
+    HallHandle_t         hall;
+    BemfHandle_t         bemf;
+    CurrentSenseHandle_t isense;
+    int                  adc_fd;
+    MotorAxis_t          axis;
+    uint32_t             tick;
+    TimeNs_t             t0_ns;
+} SimRig_t;
+
+static const TimeNs_t FAST_TS_NS   = TIME_NS_PER_S / FAST_LOOP_HZ;
+static const uint32_t SLOW_DIVIDER = FAST_LOOP_HZ / SLOW_LOOP_HZ;
+
+// ---------------- Rig ----------------
+
+// Rig on a virtual clock that starts at start_ns
+static bool rig_init_at(SimRig_t *r, const BldcPlantParams_t *p, RigSensor_t sensor,
+                        TimeNs_t start_ns)
+{
+    memset(r, 0, sizeof(*r));
+
+    VirtualClock_init(&r->clock, start_ns, false);
+    Clock_setSource(&r->clock.base);
+    r->t0_ns = start_ns;
+
+    BldcPlant_init(&r->plant, p);
+    SimHal_setPlant(&r->plant);
+
+    r->adc_fd = adc_init("sim");
+    if (r->adc_fd < 0 || !Bemf_initDefault(&r->bemf, r->adc_fd)) return false;
+    if (!PwmMotor_init(&r->pwm, "sim", INH_A_OFFSET, INL_A_OFFSET,
+                       INH_B_OFFSET, INL_B_OFFSET, INH_C_OFFSET, INL_C_OFFSET)) {
+        return false;
+    }
+    if (!Hall_init(&r->hall, "sim", HALL_A_OFFSET, HALL_B_OFFSET, HALL_C_OFFSET)) {
+        return false;
+    }
+    if (!CurrentSense_initDefault(&r->isense, r->adc_fd)) return false;
+    (void)CurrentSense_calibrate(&r->isense, ISENSE_CAL_SAMPLES);
+
+    MotorAxis_init(&r->axis, &r->pwm, &r->hall, &r->bemf, &r->isense);
+
+    // Handover thresholds from the runtime config (-c)
+    SensorlessHandover_init(&r->axis.handover,
+                            &r->axis.speed,
+                            &r->axis.pos,
+                            g_motor_cfg.sensorless_min_rpm_mech,
+                            g_motor_cfg.sensorless_stable_samples);
+    MotorAxis_setSensorMode(&r->axis, (sensor == RIG_SENSOR_AUTO)
+                                      ? SENSOR_MODE_AUTO : SENSOR_MODE_HALL_ONLY);
+
+    return true;
+}
+
+static bool rig_init(SimRig_t *r, const BldcPlantParams_t *p, RigSensor_t sensor)
+{
+    return rig_init_at(r, p, sensor, BENCH_START_NS);
+}
+
+static void rig_deinit(SimRig_t *r)
+{
+    MotorControl_setEnable(&r->axis.ctrl, false);
+    PwmMotor_deinit(&r->pwm);
+    Hall_close(&r->hall);
+    adc_close(r->adc_fd);
+
+    SimHal_setPlant(NULL);
+    Clock_setSource(NULL);
+    BldcPlant_destroy(&r->plant);
+    VirtualClock_destroy(&r->clock);
+}
+
+// One fast-loop period
+static void rig_tick(SimRig_t *r)
+{
+    VirtualClock_step(&r->clock, FAST_TS_NS);
+
+    if ((r->tick % SLOW_DIVIDER) == 0) {
+        MotorAxis_stepSlow(&r->axis, Clock_nowNs());
+    }
+    MotorAxis_stepFast(&r->axis);
+    r->tick++;
+}
+
+static float rig_time_s(const SimRig_t *r)
+{
+    return time_ns_to_s(Clock_nowNs() - r->t0_ns);
+}
+
+static float rig_true_rpm(SimRig_t *r)
+{
+    BldcPlantState_t x = BldcPlant_getState(&r->plant, Clock_nowNs());
+    return x.omega_mech_rad_s * RAD_S_TO_RPM;
+}
+
+// ---------------- Scenario: step response ----------------
+
+typedef struct {
+    float t_run_s;        // time until state RUN (open-loop startup done)
+    float t_rise_s;       // 10% -> 90% of target
+    float overshoot_pct;
+    float t_settle_s;     // last exit from the +/- band
+    float ss_err_rpm;     // mean error over the last 0.5 s
+    float ss_std_rpm;     // speed std over the last 0.5 s (hunting)
+    bool  faulted;
+} StepResult_t;
+
+// Speed loop variants compared by "step"
+typedef enum {
+    STEP_CURRENT = 0,     // cascade through the inner current loop (default)
+    STEP_DUTY,            // speed PI drives the duty, no feedforward
+    STEP_DUTY_FF          // same, with the Kv duty feedforward
+} StepMode_t;
+
+static bool bench_step(const BldcPlantParams_t *p, StepMode_t mode, float target,
+                       float run_s, StepResult_t *res)
+{
+    SimRig_t r;
+    if (!rig_init(&r, p, RIG_SENSOR_HALL)) return false;
+
+    int ff_saved = g_motor_cfg.speed_ff;
+    g_motor_cfg.speed_ff = (mode == STEP_DUTY_FF);
+    if (mode != STEP_CURRENT) {
+        MotorControl_setCurrentLoop(&r.axis.ctrl, false);
+    }
+
+    memset(res, 0, sizeof(*res));
+    res->t_run_s = -1.0f;
+
+    float t10 = -1.0f, t90 = -1.0f, peak = 0.0f, t_out = 0.0f;
+    double err_sum = 0.0, err_sq = 0.0;
+    int    err_n   = 0;
+
+    MotorControl_setEnable(&r.axis.ctrl, true);
+    MotorControl_setSpeedCmd(&r.axis.ctrl, target, false);
+
+    while (rig_time_s(&r) < run_s) {
+        rig_tick(&r);
+        if ((r.tick % SLOW_DIVIDER) != 0) continue;
+
+        float t   = rig_time_s(&r);
+        float rpm = rig_true_rpm(&r);
+        MotorContext_t ctx = MotorControl_getContext(&r.axis.ctrl);
+
+        if (ctx.state == MOTOR_STATE_FAULT) {
+            res->faulted = true;
+            break;
+        }
+        if (res->t_run_s < 0.0f && ctx.state == MOTOR_STATE_RUN) {
+            res->t_run_s = t;
+        }
+        if (t10 < 0.0f && rpm >= 0.1f * target) t10 = t;
+        if (t90 < 0.0f && rpm >= 0.9f * target) t90 = t;
+        if (rpm > peak) peak = rpm;
+        if (fabsf(rpm - target) > BENCH_STEP_BAND * target) t_out = t;
+        if (t > run_s - 0.5f) {
+            err_sum += (double)(target - rpm);
+            err_sq  += (double)(target - rpm) * (double)(target - rpm);
+            err_n++;
+        }
+    }
+
+    res->t_rise_s      = (t10 >= 0.0f && t90 >= 0.0f) ? (t90 - t10) : -1.0f;
+    res->overshoot_pct = (peak > target) ? 100.0f * (peak - target) / target : 0.0f;
+    res->t_settle_s    = t_out;
+    res->ss_err_rpm    = err_n ? (float)(err_sum / err_n) : 0.0f;
+    res->ss_std_rpm    = err_n ? (float)sqrt(fmax(err_sq / err_n - (err_sum / err_n) * (err_sum / err_n), 0.0)) : 0.0f;
+
+    g_motor_cfg.speed_ff = ff_saved;
+    rig_deinit(&r);
+    return true;
+}
+
+// ---------------- Scenario: speed ripple ----------------
+
+typedef struct {
+    float mean_rpm;
+    float std_rpm;
+    float p2p_rpm;
+    float ripple_pct;     // peak-to-peak / mean
+    float est_err_rms;    // controller's rpm estimate vs plant
+    bool  faulted;
+} RippleResult_t;
+
+static bool bench_ripple(const BldcPlantParams_t *p, RippleResult_t *res)
+{
+    SimRig_t r;
+    if (!rig_init(&r, p, RIG_SENSOR_HALL)) return false;
+
+    memset(res, 0, sizeof(*res));
+    BldcPlant_setLoad(&r.plant, BENCH_RIPPLE_LOAD_NM);
+
+    MotorControl_setEnable(&r.axis.ctrl, true);
+    MotorControl_setSpeedCmd(&r.axis.ctrl, BENCH_RIPPLE_RPM, false);
+
+    double sum = 0.0, sum2 = 0.0, est_err2 = 0.0;
+    float  lo = 1e9f, hi = -1e9f;
+    int    n = 0;
+
+    const float t_end = BENCH_RIPPLE_SETTLE_S + BENCH_RIPPLE_WINDOW_S;
+    while (rig_time_s(&r) < t_end) {
+        rig_tick(&r);
+
+        MotorContext_t ctx = MotorControl_getContext(&r.axis.ctrl);
+        if (ctx.state == MOTOR_STATE_FAULT) {
+            res->faulted = true;
+            break;
+        }
+        if (rig_time_s(&r) < BENCH_RIPPLE_SETTLE_S) continue;
+
+        // Sample the true speed every fast tick (ripple is at sector rate)
+        float rpm = rig_true_rpm(&r);
+        sum  += rpm;
+        sum2 += (double)rpm * rpm;
+        if (rpm < lo) lo = rpm;
+        if (rpm > hi) hi = rpm;
+
+        float e = ctx.meas.rpm_mech - rpm;
+        est_err2 += (double)e * e;
+        n++;
+    }
+
+    if (n > 0) {
+        double mean = sum / n;
+        double var  = sum2 / n - mean * mean;
+        res->mean_rpm    = (float)mean;
+        res->std_rpm     = (float)sqrt(var > 0.0 ? var : 0.0);
+        res->p2p_rpm     = hi - lo;
+        res->ripple_pct  = (mean > 1.0) ? (float)(100.0 * (hi - lo) / mean) : 0.0f;
+        res->est_err_rms = (float)sqrt(est_err2 / n);
+    }
+
+    rig_deinit(&r);
+    return true;
+}
+
+// ---------------- Scenario: sensorless handover ----------------
+
+typedef struct {
+    int   trials;
+    int   handed_over;
+    int   succeeded;      // handed over AND kept running in tolerance
+    float mean_t_ho_s;    // over trials that handed over
+} HandoverResult_t;
+
+static bool bench_handover_trial(const BldcPlantParams_t *p, int trial,
+                                 bool *ho, bool *ok, float *t_ho)
+{
+    BldcPlantParams_t tp = *p;
+    tp.seed = p->seed + (uint32_t)trial * 7919u;
+
+    SimRig_t r;
+    if (!rig_init(&r, &tp, RIG_SENSOR_AUTO)) return false;
+
+    // Spread the starting rotor angle over one electrical revolution
+    float theta0 = fmodf(37.0f * (float)trial + 11.0f, 360.0f);
+    BldcPlant_setRotor(&r.plant, theta0, 0.0f);
+
+    MotorControl_setEnable(&r.axis.ctrl, true);
+    MotorControl_setSpeedCmd(&r.axis.ctrl, BENCH_HO_RPM, false);
+
+    *ho   = false;
+    *ok   = false;
+    *t_ho = 0.0f;
+
+    float t_hold_end = 0.0f;
+    bool  in_tol     = true;
+
+    while (1) {
+        rig_tick(&r);
+        if ((r.tick % SLOW_DIVIDER) != 0) continue;
+
+        float t = rig_time_s(&r);
+        MotorContext_t ctx = MotorControl_getContext(&r.axis.ctrl);
+
+        if (!*ho) {
+            if (r.axis.handover.done) {
+                *ho        = true;
+                *t_ho      = t;
+                t_hold_end = t + BENCH_HO_HOLD_S;
+            } else if (t > BENCH_HO_TIMEOUT_S || ctx.state == MOTOR_STATE_FAULT) {
+                break;
+            }
+            continue;
+        }
+
+        float rpm = rig_true_rpm(&r);
+        if (ctx.state != MOTOR_STATE_RUN ||
+            fabsf(rpm - BENCH_HO_RPM) > BENCH_HO_TOL * BENCH_HO_RPM) {
+            in_tol = false;
+            break;
+        }
+        if (t >= t_hold_end) {
+            break;
+        }
+    }
+
+    *ok = *ho && in_tol;
+    rig_deinit(&r);
+    return true;
+}
+
+static bool bench_handover(const BldcPlantParams_t *p, int trials, HandoverResult_t *res)
+{
+    memset(res, 0, sizeof(*res));
+    double t_sum = 0.0;
+
+    for (int i = 0; i < trials; ++i) {
+        bool ho, ok;
+        float t_ho;
+        if (!bench_handover_trial(p, i, &ho, &ok, &t_ho)) return false;
+
+        res->trials++;
+        if (ho) {
+            res->handed_over++;
+            t_sum += t_ho;
+        }
+        if (ok) res->succeeded++;
+    }
+    res->mean_t_ho_s = res->handed_over ? (float)(t_sum / res->handed_over) : 0.0f;
+    return true;
+}
+
+// ---------------- Scenario: axes per core ----------------
+
+typedef struct {
+    BldcPlant_t  plant;
+    PwmMotor_t   pwm;
+    HallHandle_t hall;
+    BemfHandle_t bemf;
+    CurrentSenseHandle_t isense;
+    int          adc_fd;
+    MotorAxis_t  axis;
+} InstAxis_t;
+
+typedef struct {
+    int    num_axes;
+    int    running;       // axes in RUN at the end
+    double work_mean_us;  // fast-loop work per tick (all axes)
+    double work_max_us;
+    double overrun_pct;
+} InstResult_t;
+
+static InstAxis_t s_inst[BENCH_INST_MAX_AXES];
+
+static bool inst_axis_init(InstAxis_t *a, const BldcPlantParams_t *p, int idx)
+{
+    memset(a, 0, sizeof(*a));
+
+    BldcPlantParams_t ap = *p;
+    ap.seed = p->seed + (uint32_t)idx * 104729u;
+    BldcPlant_init(&a->plant, &ap);
+
+    // Handles opened below bind to this axis' plant
+    SimHal_setPlant(&a->plant);
+
+    a->adc_fd = adc_init("sim");
+    if (a->adc_fd < 0 || !Bemf_initDefault(&a->bemf, a->adc_fd)) return false;
+    if (!PwmMotor_init(&a->pwm, "sim", INH_A_OFFSET, INL_A_OFFSET,
+                       INH_B_OFFSET, INL_B_OFFSET, INH_C_OFFSET, INL_C_OFFSET)) {
+        return false;
+    }
+    if (!Hall_init(&a->hall, "sim", HALL_A_OFFSET, HALL_B_OFFSET, HALL_C_OFFSET)) {
+        return false;
+    }
+    if (!CurrentSense_initDefault(&a->isense, a->adc_fd)) return false;
+    (void)CurrentSense_calibrate(&a->isense, ISENSE_CAL_SAMPLES);
+
+    MotorAxis_init(&a->axis, &a->pwm, &a->hall, &a->bemf, &a->isense);
+    return true;
+}
+
+static void inst_axis_deinit(InstAxis_t *a)
+{
+    PwmMotor_deinit(&a->pwm);
+    Hall_close(&a->hall);
+    adc_close(a->adc_fd);
+    BldcPlant_destroy(&a->plant);
+}
+
+static bool bench_instances_run(const BldcPlantParams_t *p, int n, InstResult_t *res)
+{
+    memset(res, 0, sizeof(*res));
+    res->num_axes = n;
+
+    // Real monotonic clock: the loops run at their true rates
+    Clock_setSource(NULL);
+
+    for (int i = 0; i < n; ++i) {
+        if (!inst_axis_init(&s_inst[i], p, i)) return false;
+    }
+    SimHal_setPlant(NULL);
+
+    const int cpu = 0;
+    MotorExec_t ex;
+    if (!MotorExec_init(&ex, 1, &cpu, NULL)) return false;
+    for (int i = 0; i < n; ++i) {
+        if (MotorExec_addAxis(&ex, &s_inst[i].axis) < 0) return false;
+        MotorControl_setEnable(&s_inst[i].axis.ctrl, true);
+        MotorControl_setSpeedCmd(&s_inst[i].axis.ctrl, BENCH_INST_RPM, false);
+    }
+
+    if (!MotorExec_start(&ex)) return false;
+    Clock_sleepUntilNs(Clock_nowNs() + (TimeNs_t)(BENCH_INST_RUN_S * (float)TIME_NS_PER_S));
+    MotorExec_stop(&ex);
+
+    MotorExecStats_t st = MotorExec_getStats(&ex, 0);
+    res->work_mean_us = st.work_mean_s * 1e6;
+    res->work_max_us  = st.work_max_s * 1e6;
+    res->overrun_pct  = st.ticks ? 100.0 * (double)st.overruns / (double)st.ticks : 0.0;
+
+    for (int i = 0; i < n; ++i) {
+        MotorContext_t ctx = MotorControl_getContext(&s_inst[i].axis.ctrl);
+        if (ctx.state == MOTOR_STATE_RUN) res->running++;
+        MotorControl_setEnable(&s_inst[i].axis.ctrl, false);
+        inst_axis_deinit(&s_inst[i]);
+    }
+    return true;
+}
+
+static bool bench_instances(const BldcPlantParams_t *p, double *sim_s)
+{
+    static const int counts[] = { 1, 2, 4, 8, 12, 16, 24, 32 };
+    const double budget_us = 1e6 / (double)FAST_LOOP_HZ;
+    int max_ok = 0;
+
+    for (size_t k = 0; k < sizeof(counts) / sizeof(counts[0]); ++k) {
+        int n = counts[k];
+        if (n > BENCH_INST_MAX_AXES) break;
+
+        InstResult_t ir;
+        if (!bench_instances_run(p, n, &ir)) return false;
+        *sim_s += BENCH_INST_RUN_S;
+
+        printf("INSTANCES %2d axes @ %d Hz on CPU 0: work mean=%.2f us (%.2f us/axis, "
+               "%.0f%% of %.0f us)  max=%.1f us  overruns=%.2f%%  running=%d/%d\n",
+               n, FAST_LOOP_HZ, ir.work_mean_us, ir.work_mean_us / (double)n,
+               100.0 * ir.work_mean_us / budget_us, budget_us, ir.work_max_us,
+               ir.overrun_pct, ir.running, n);
+
+        if (ir.overrun_pct < BENCH_INST_MAX_OVR_PCT) max_ok = n;
+        if (ir.overrun_pct > BENCH_INST_SAT_OVR_PCT) break;
+    }
+
+    printf("INSTANCES sustained %d kHz with up to %d axes per core (overruns < %.0f%%)\n",
+           FAST_LOOP_HZ / 1000, max_ok, BENCH_INST_MAX_OVR_PCT);
+    return true;
+}
+
+// ---------------- Scenario: cross-thread sharing ----------------
+
+typedef enum {
+    SHARE_READER = 0,             // poll snapshots, check the invariants
+    SHARE_POSTER,                 // post speed commands
+    SHARE_CYCLER                  // enable, fault, clear, over and over
+} ShareRole_t;
+
+typedef struct {
+    MotorControl_t *mc;
+    int             cpu;          // -1 = not pinned
+    ShareRole_t     role;
+    atomic_bool    *stop;
+    uint64_t        ops;
+    uint64_t        faulted;      // snapshots in FAULT (readers)
+    uint64_t        violations;   // snapshots breaking the invariants
+} ShareThread_t;
+
+typedef struct {
+    uint64_t reads;
+    uint64_t faulted;
+    uint64_t violations;
+    uint64_t writes;              // commands / cycle steps of the writer
+} ShareRun_t;
+
+static PerfCounters_t s_share_perf;
+
+static void share_fast_start(int worker, void *user)
+{
+    (void)worker;
+    (void)user;
+    (void)PerfCounters_open(&s_share_perf, FAST_LOOP_PERF_SAMPLE_ITERS);
+}
+
+static void share_fast_tick(int worker, void *user)
+{
+    (void)worker;
+    (void)user;
+    PerfCounters_tick(&s_share_perf);
+}
+
+static void share_fast_exit(int worker, void *user)
+{
+    (void)worker;
+    (void)user;
+    PerfCounters_close(&s_share_perf);
+}
+
+static void *share_thread_func(void *arg)
+{
+    ShareThread_t *t = (ShareThread_t *)arg;
+
+    if (t->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(t->cpu, &set);
+        (void)pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    float rpm = BENCH_INST_RPM;
+    while (!atomic_load_explicit(t->stop, memory_order_relaxed)) {
+        if (t->role == SHARE_POSTER) {
+            // Small alternating speed changes, like a host nudging the setpoint
+            rpm = (rpm > BENCH_INST_RPM) ? BENCH_INST_RPM - 50.0f : BENCH_INST_RPM + 50.0f;
+            (void)MotorControl_setSpeedCmd(t->mc, rpm, false);
+            Clock_sleepUntilNs(Clock_nowNs() + BENCH_SHARE_POST_US * TIME_NS_PER_US);
+        } else if (t->role == SHARE_CYCLER) {
+            // Host enables, the watchdog faults it, the host clears
+            switch (t->ops % 3) {
+            case 0:
+                (void)MotorControl_setEnable(t->mc, true);
+                (void)MotorControl_setSpeedCmd(t->mc, BENCH_INST_RPM, false);
+                break;
+            case 1:
+                MotorControl_requestFault(t->mc, MOTOR_FAULT_TIMING);
+                break;
+            default:
+                (void)MotorControl_clearFault(t->mc);
+                break;
+            }
+            Clock_sleepUntilNs(Clock_nowNs() + BENCH_SHARE_CYCLE_US * TIME_NS_PER_US);
+        } else {
+            // Pollers as fast as they can go (worst case for sharing)
+            MotorContext_t  ctx = MotorControl_getContext(t->mc);
+            MotorCmdStats_t cs  = MotorControl_getCmdStats(t->mc);
+            (void)cs;
+
+            bool in_fault = (ctx.state == MOTOR_STATE_FAULT);
+            if (in_fault) t->faulted++;
+            if (in_fault != (ctx.fault != MOTOR_FAULT_NONE) ||
+                (in_fault && ctx.cmd.enable)) {
+                t->violations++;
+            }
+        }
+        t->ops++;
+    }
+    return NULL;
+}
+
+// BENCH_SHARE_READERS readers plus one writer on `cpu` for run_s seconds
+static bool share_run(MotorControl_t *mc, int cpu, ShareRole_t writer, float run_s,
+                      ShareRun_t *res)
+{
+    atomic_bool   stop;
+    atomic_init(&stop, false);
+    ShareThread_t th[BENCH_SHARE_READERS + 1];
+    pthread_t     tid[BENCH_SHARE_READERS + 1];
+    memset(th, 0, sizeof(th));
+    memset(res, 0, sizeof(*res));
+
+    for (int i = 0; i <= BENCH_SHARE_READERS; ++i) {
+        th[i].mc   = mc;
+        th[i].cpu  = cpu;
+        th[i].role = (i == BENCH_SHARE_READERS) ? writer : SHARE_READER;
+        th[i].stop = &stop;
+        if (pthread_create(&tid[i], NULL, share_thread_func, &th[i]) != 0) {
+            atomic_store(&stop, true);
+            for (int j = 0; j < i; ++j) pthread_join(tid[j], NULL);
+            return false;
+        }
+    }
+
+    Clock_sleepUntilNs(Clock_nowNs() + (TimeNs_t)(run_s * (float)TIME_NS_PER_S));
+
+    atomic_store(&stop, true);
+    for (int i = 0; i <= BENCH_SHARE_READERS; ++i) {
+        pthread_join(tid[i], NULL);
+        if (th[i].role == SHARE_READER) {
+            res->reads      += th[i].ops;
+            res->faulted    += th[i].faulted;
+            res->violations += th[i].violations;
+        } else {
+            res->writes = th[i].ops;
+        }
+    }
+    return true;
+}
+
+// Returns false only if the rig could not be set up; *pass says whether
+// the fault invariants held throughout
+static bool bench_sharing(const BldcPlantParams_t *p, bool *pass)
+{
+    Clock_setSource(NULL);
+
+    InstAxis_t *a = &s_inst[0];
+    if (!inst_axis_init(a, p, 0)) return false;
+    SimHal_setPlant(NULL);
+
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    const int fast_cpu  = 0;
+    const int other_cpu = (ncpu >= 2) ? 1 : -1;
+
+    const MotorExecHooks_t hooks = {
+        .fast_start = share_fast_start,
+        .fast_tick  = share_fast_tick,
+        .fast_exit  = share_fast_exit,
+    };
+    MotorExec_t ex;
+    if (!MotorExec_init(&ex, 1, &fast_cpu, &hooks) ||
+        MotorExec_addAxis(&ex, &a->axis) < 0) {
+        return false;
+    }
+    MotorControl_setEnable(&a->axis.ctrl, true);
+    MotorControl_setSpeedCmd(&a->axis.ctrl, BENCH_INST_RPM, false);
+
+    if (!MotorExec_start(&ex)) return false;
+
+    // Steady running with a host nudging the speed
+    ShareRun_t run;
+    if (!share_run(&a->axis.ctrl, other_cpu, SHARE_POSTER, BENCH_SHARE_RUN_S, &run)) {
+        MotorExec_stop(&ex);
+        inst_axis_deinit(a);
+        return false;
+    }
+
+    // Read the summary before the fast thread closes the counters (and
+    // the stats before the cycling below changes the fast loop's work)
+    PerfSummary_t    ps = PerfCounters_getSummary(&s_share_perf);
+    MotorExecStats_t st = MotorExec_getStats(&ex, 0);
+    MotorCmdStats_t  cs = MotorControl_getCmdStats(&a->axis.ctrl);
+
+    // Faults raised and cleared under the readers
+    ShareRun_t cyc;
+    bool cyc_ok = share_run(&a->axis.ctrl, other_cpu, SHARE_CYCLER, BENCH_SHARE_CYCLE_S, &cyc);
+    MotorExec_stop(&ex);
+
+    MotorControl_setEnable(&a->axis.ctrl, false);
+    inst_axis_deinit(a);
+    if (!cyc_ok) return false;
+
+    printf("SHARING fast loop on CPU 0, %d readers + poster on %s: "
+           "work mean=%.2f us  max=%.1f us  overruns=%.2f%%\n",
+           BENCH_SHARE_READERS, (other_cpu >= 0) ? "CPU 1" : "any CPU (1 online)",
+           st.work_mean_s * 1e6, st.work_max_s * 1e6,
+           st.ticks ? 100.0 * (double)st.overruns / (double)st.ticks : 0.0);
+    if (ps.available && (ps.counter_mask & (1u << PERF_CNT_CACHE_MISSES))) {
+        printf("SHARING perf: cache-misses/tick=%.2f  cycles/tick=%.0f  IPC=%.2f  "
+               "(%u samples)\n",
+               (double)ps.misses_per_iter, (double)ps.cycles_per_iter,
+               (double)ps.ipc, ps.samples);
+    } else {
+        printf("SHARING perf: counters unavailable on this host\n");
+    }
+    printf("SHARING readers: %.2f M snapshots/s, %u commands applied "
+           "(mean latency %.1f us)\n",
+           (double)run.reads / BENCH_SHARE_RUN_S / 1e6, cs.applied,
+           cs.mean_latency_s * 1e6);
+
+    // Both runs count: the invariants hold whatever the writer does
+    uint64_t violations = run.violations + cyc.violations;
+    *pass = violations == 0 && cyc.faulted > 0;
+    printf("SHARING invariants: %llu enable/fault/clear steps, %llu snapshots "
+           "(%llu in FAULT), %llu violations -> %s\n",
+           (unsigned long long)cyc.writes, (unsigned long long)(run.reads + cyc.reads),
+           (unsigned long long)cyc.faulted, (unsigned long long)violations,
+           *pass ? "PASS" : "FAIL");
+    return true;
+}
+
+// ---------------- Scenario: allocation-free loops ----------------
+
+// Returns false only if the rig could not be set up; *pass says whether
+// the loop threads stayed off the heap.
+static bool bench_alloc(const BldcPlantParams_t *p, bool *pass)
+{
+    *pass = false;
+    RtAllocGuard_setAbort(false);
+
+    // The guard must see an allocation from a marked thread, or a clean
+    // run below proves nothing
+    RtAllocGuard_resetStats();
+    RtAllocGuard_enterRt();
+    void *volatile probe = malloc(16);
+    free(probe);
+    RtAllocGuard_leaveRt();
+    RtAllocStats_t self = RtAllocGuard_getStats();
+    if (!self.hooked || self.allocs == 0 || self.frees == 0) {
+        printf("ALLOC   guard self-test failed (hooked=%d allocs=%llu frees=%llu)\n",
+               (int)self.hooked, (unsigned long long)self.allocs,
+               (unsigned long long)self.frees);
+        return true;
+    }
+
+    Clock_setSource(NULL);
+
+    InstAxis_t *a = &s_inst[0];
+    if (!inst_axis_init(a, p, 0)) return false;
+    SimHal_setPlant(NULL);
+
+    MotorExec_t ex;
+    if (!MotorExec_init(&ex, 1, NULL, NULL) ||
+        MotorExec_addAxis(&ex, &a->axis) < 0) {
+        return false;
+    }
+    MotorControl_setEnable(&a->axis.ctrl, true);
+    MotorControl_setSpeedCmd(&a->axis.ctrl, BENCH_INST_RPM, false);
+
+    RtAllocGuard_resetStats();
+    if (!MotorExec_start(&ex)) return false;
+
+    // Exercise the API from this (non-RT) thread meanwhile: commands
+    // through the mailbox, snapshot reads like the telemetry threads
+    const TimeNs_t t_end = Clock_nowNs() + (TimeNs_t)(BENCH_ALLOC_RUN_S * (float)TIME_NS_PER_S);
+    uint32_t cmds = 0;
+    while (Clock_nowNs() < t_end) {
+        float rpm = (cmds & 1u) ? BENCH_INST_RPM + 100.0f : BENCH_INST_RPM;
+        if (MotorControl_setSpeedCmd(&a->axis.ctrl, rpm, false) != 0) cmds++;
+        (void)MotorControl_getContext(&a->axis.ctrl);
+        Clock_sleepUntilNs(Clock_nowNs() + 10 * TIME_NS_PER_MS);
+    }
+
+    MotorExec_stop(&ex);
+    RtAllocStats_t st = RtAllocGuard_getStats();
+    MotorContext_t ctx = MotorControl_getContext(&a->axis.ctrl);
+
+    MotorControl_setEnable(&a->axis.ctrl, false);
+    inst_axis_deinit(a);
+
+    MotorExecStats_t es = MotorExec_getStats(&ex, 0);
+    *pass = (st.allocs == 0 && st.frees == 0);
+
+    printf("ALLOC   %.1f s, %llu fast ticks, %u commands, state=%d: "
+           "%llu allocations (%llu bytes, first %zu), %llu frees from RT threads -> %s\n",
+           (double)BENCH_ALLOC_RUN_S, (unsigned long long)es.ticks, cmds, (int)ctx.state,
+           (unsigned long long)st.allocs, (unsigned long long)st.bytes, st.first_size,
+           (unsigned long long)st.frees, *pass ? "PASS" : "FAIL");
+    return true;
+}
+
+// ---------------- Scenario: current sense / overcurrent ----------------
+
+// Returns false only if the rig could not be set up; *pass says whether
+// calibration, current limit and trip all behaved.
+static bool bench_current(const BldcPlantParams_t *p, bool *pass)
+{
+    *pass = false;
+
+    // 1) Calibration: the rig calibrates at init, with the rotor at rest
+    BldcPlantParams_t cp = *p;
+    cp.isense_offset_v = BENCH_CUR_OFFSET_V;
+
+    SimRig_t r;
+    if (!rig_init(&r, &cp, RIG_SENSOR_HALL)) return false;
+
+    float  off_err = r.isense.offset_u_v - (ADC_REF_V + BENCH_CUR_OFFSET_V);
+    double resid   = 0.0;
+    for (int i = 0; i < 1000; ++i) {
+        rig_tick(&r);
+        resid += fabsf(r.isense.i_u) + fabsf(r.isense.i_v);
+    }
+    resid /= 2000.0;
+    bool cal_ok = r.isense.calibrated && resid < BENCH_CUR_RESID_A;
+
+    // 2) Step 0 -> BENCH_STEP_RPM: the cycle-by-cycle limit must hold the
+    //    true phase current below the trip level, without tripping
+    MotorControl_setEnable(&r.axis.ctrl, true);
+    MotorControl_setSpeedCmd(&r.axis.ctrl, BENCH_STEP_RPM, false);
+
+    float    i_peak = 0.0f;
+    uint32_t ticks  = 0;
+    bool     faulted = false;
+    while (rig_time_s(&r) < BENCH_CUR_RUN_S) {
+        rig_tick(&r);
+        ticks++;
+        BldcPlantState_t x = BldcPlant_getState(&r.plant, Clock_nowNs());
+        for (int ph = 0; ph < 3; ++ph) {
+            if (fabsf(x.i_phase_a[ph]) > i_peak) i_peak = fabsf(x.i_phase_a[ph]);
+        }
+        if ((r.tick % SLOW_DIVIDER) == 0 &&
+            MotorControl_getContext(&r.axis.ctrl).state == MOTOR_STATE_FAULT) {
+            faulted = true;
+            break;
+        }
+    }
+    MotorControl_t *mc = &r.axis.ctrl;
+    float chop_pct = ticks ? 100.0f * (float)mc->chop_ticks / (float)ticks : 0.0f;
+    bool  lim_ok   = !faulted && i_peak < mc->i_max_a;
+
+    rig_deinit(&r);
+
+    // 3) Trip: a one-tick spike must not trip, a sustained excess must
+    //    trip after exactly oc_trip_ticks fast ticks
+    if (!rig_init(&r, p, RIG_SENSOR_HALL)) return false;
+    mc = &r.axis.ctrl;
+    const float i_hi = 1.5f * mc->i_max_a;
+
+    MotorControl_updateCurrents(mc, i_hi, -i_hi);
+    MotorControl_updateCurrents(mc, 0.0f, 0.0f);
+    bool spike_ok = atomic_load(&mc->pending_fault) == MOTOR_FAULT_NONE;
+
+    uint32_t trip_ticks = 0;
+    while (atomic_load(&mc->pending_fault) == MOTOR_FAULT_NONE && trip_ticks < 1000) {
+        MotorControl_updateCurrents(mc, i_hi, -i_hi);
+        trip_ticks++;
+    }
+    MotorControl_stepSlow(mc);
+    MotorContext_t ctx = MotorControl_getContext(mc);
+    bool trip_ok = spike_ok &&
+                   trip_ticks == mc->oc_trip_ticks &&
+                   ctx.state == MOTOR_STATE_FAULT &&
+                   ctx.fault == MOTOR_FAULT_OVERCURRENT;
+    float trip_us = (float)trip_ticks * 1e6f / (float)FAST_LOOP_HZ;
+    float i_max   = mc->i_max_a;
+
+    rig_deinit(&r);
+
+    *pass = cal_ok && lim_ok && trip_ok;
+
+    printf("CURRENT cal: %.0f mV injected, offset err %.1f mV, standstill |i| %.3f A -> %s\n",
+           (double)(BENCH_CUR_OFFSET_V * 1e3f), (double)(off_err * 1e3f), resid,
+           cal_ok ? "ok" : "BAD");
+    printf("CURRENT step 0->%.0f rpm: peak |i| %.2f A (limit %.1f, trip %.1f), "
+           "chopped %.2f%% of ticks%s -> %s\n",
+           (double)BENCH_STEP_RPM, (double)i_peak,
+           (double)(i_max * MOTOR_I_LIMIT_FRAC), (double)i_max,
+           (double)chop_pct, faulted ? ", FAULT" : "", lim_ok ? "ok" : "BAD");
+    printf("CURRENT trip at %.1f A: spike %s, tripped after %u ticks (%.0f us), fault=%d -> %s\n",
+           (double)i_hi, spike_ok ? "ignored" : "TRIPPED", trip_ticks, (double)trip_us,
+           (int)ctx.fault, trip_ok ? "ok" : "BAD");
+    printf("CURRENT -> %s\n", *pass ? "PASS" : "FAIL");
+    return true;
+}
+
+// ---------------- Scenario: load step ----------------
+
+// Measured against the true speed just before the step, not the command:
+// the Hall estimate (polled at the slow-loop rate) leaves a steady offset
+// of its own that has nothing to do with load rejection.
+typedef struct {
+    float rpm_pre;        // mean true speed before the step
+    float dip_rpm;        // largest drop below rpm_pre after the step
+    float t_recover_s;    // step -> last exit from the +/- band around rpm_pre
+    float i_peak_a;       // largest true |i_phase| after the step
+    float chop_pct;       // fast ticks cut by the cycle-by-cycle limit
+    float rpm_std;        // true speed std over the last BENCH_LS_REF_S
+    float est_nm;         // load observer estimate, mean over the same
+    float est_std_nm;     // ... and its std
+    bool  faulted;
+} LoadStepResult_t;
+
+// obs: load observer as configured, else off
+static bool bench_loadstep(const BldcPlantParams_t *p, float rpm_cmd, bool cur_loop, bool obs,
+                           LoadStepResult_t *res)
+{
+    float bw_saved = g_motor_cfg.load_obs_bw_hz;
+    if (!obs) g_motor_cfg.load_obs_bw_hz = 0.0f;
+
+    SimRig_t r;
+    bool ok = rig_init(&r, p, RIG_SENSOR_HALL);
+    g_motor_cfg.load_obs_bw_hz = bw_saved;
+    if (!ok) return false;
+    MotorControl_setCurrentLoop(&r.axis.ctrl, cur_loop);
+
+    memset(res, 0, sizeof(*res));
+
+    MotorControl_setEnable(&r.axis.ctrl, true);
+    MotorControl_setSpeedCmd(&r.axis.ctrl, rpm_cmd, false);
+
+    double sum = 0.0;
+    int    n   = 0;
+    while (rig_time_s(&r) < BENCH_LS_SETTLE_S) {
+        rig_tick(&r);
+        if (rig_time_s(&r) >= BENCH_LS_SETTLE_S - BENCH_LS_REF_S) {
+            sum += rig_true_rpm(&r);
+            n++;
+        }
+    }
+    res->rpm_pre = n ? (float)(sum / n) : 0.0f;
+    BldcPlant_setLoad(&r.plant, BENCH_LS_LOAD_NM);
+
+    const float    t_step = rig_time_s(&r);
+    const float    band   = BENCH_LS_BAND * res->rpm_pre;
+    const uint32_t chop0  = r.axis.ctrl.chop_ticks;
+    uint32_t       ticks  = 0;
+    float          t_out  = t_step;
+    double         w_sum = 0.0, w_sq = 0.0, e_sum = 0.0, e_sq = 0.0;
+    int            w_n   = 0,   e_n  = 0;
+
+    while (rig_time_s(&r) < BENCH_LS_SETTLE_S + BENCH_LS_HOLD_S) {
+        rig_tick(&r);
+        ticks++;
+
+        BldcPlantState_t x = BldcPlant_getState(&r.plant, Clock_nowNs());
+        float rpm = x.omega_mech_rad_s * RAD_S_TO_RPM;
+        if (res->rpm_pre - rpm > res->dip_rpm) res->dip_rpm = res->rpm_pre - rpm;
+        if (fabsf(rpm - res->rpm_pre) > band) t_out = rig_time_s(&r);
+        for (int ph = 0; ph < 3; ++ph) {
+            if (fabsf(x.i_phase_a[ph]) > res->i_peak_a) res->i_peak_a = fabsf(x.i_phase_a[ph]);
+        }
+
+        bool tail = rig_time_s(&r) >= BENCH_LS_SETTLE_S + BENCH_LS_HOLD_S - BENCH_LS_REF_S;
+        if (tail) {
+            w_sum += rpm;
+            w_sq  += (double)rpm * rpm;
+            w_n++;
+        }
+
+        if ((r.tick % SLOW_DIVIDER) == 0) {
+            MotorContext_t ctx = MotorControl_getContext(&r.axis.ctrl);
+            if (ctx.state == MOTOR_STATE_FAULT) {
+                res->faulted = true;
+                break;
+            }
+            if (tail) {
+                e_sum += ctx.meas.load_nm;
+                e_sq  += (double)ctx.meas.load_nm * ctx.meas.load_nm;
+                e_n++;
+            }
+        }
+    }
+
+    res->t_recover_s = t_out - t_step;
+    res->rpm_std     = w_n ? (float)sqrt(fmax(w_sq / w_n - (w_sum / w_n) * (w_sum / w_n), 0.0)) : 0.0f;
+    res->est_nm      = e_n ? (float)(e_sum / e_n) : 0.0f;
+    res->est_std_nm  = e_n ? (float)sqrt(fmax(e_sq / e_n - (e_sum / e_n) * (e_sum / e_n), 0.0)) : 0.0f;
+    res->chop_pct    = ticks ? 100.0f * (float)(r.axis.ctrl.chop_ticks - chop0) / (float)ticks
+                             : 0.0f;
+
+    rig_deinit(&r);
+    return true;
+}
+
+// ---------------- Scenario: modulation schemes ----------------
+
+typedef struct {
+    float    rpm;              // mean true speed over the window
+    float    p_in_w;           // from the bus, plus the switching estimate
+    float    p_em_w;           // electromagnetic (to the rotor)
+    float    p_cu_w;
+    float    p_diode_w;
+    float    p_sw_w;
+    float    eff_pct;          // p_em / p_in
+    float    float_clamped_pct;
+    float    float_err_rms_v;      // against Vbus/2
+    float    float_err_mid_rms_v;  // against the driven pair's midpoint
+    uint32_t shoot_through;
+    bool     faulted;
+} ModResult_t;
+
+static bool bench_modulation(const BldcPlantParams_t *p, PwmModulation_t mod,
+                             float load_nm, ModResult_t *res)
+{
+    SimRig_t r;
+    if (!rig_init(&r, p, RIG_SENSOR_HALL)) return false;
+    if (!PwmMotor_setModulation(&r.pwm, mod, g_motor_cfg.pwm_dead_time_ns)) {
+        rig_deinit(&r);
+        return false;
+    }
+
+    memset(res, 0, sizeof(*res));
+
+    MotorControl_setEnable(&r.axis.ctrl, true);
+    MotorControl_setSpeedCmd(&r.axis.ctrl, BENCH_MOD_RPM, false);
+
+    while (rig_time_s(&r) < BENCH_MOD_LOAD_AT_S) {
+        rig_tick(&r);
+    }
+    BldcPlant_setLoad(&r.plant, load_nm);
+    while (rig_time_s(&r) < BENCH_MOD_SETTLE_S) {
+        rig_tick(&r);
+    }
+    BldcPlantState_t a = BldcPlant_getState(&r.plant, Clock_nowNs());
+
+    double sum = 0.0;
+    int    n   = 0;
+    while (rig_time_s(&r) < BENCH_MOD_SETTLE_S + BENCH_MOD_WINDOW_S) {
+        rig_tick(&r);
+        sum += rig_true_rpm(&r);
+        n++;
+        if ((r.tick % SLOW_DIVIDER) == 0 &&
+            MotorControl_getContext(&r.axis.ctrl).state == MOTOR_STATE_FAULT) {
+            res->faulted = true;
+            break;
+        }
+    }
+    BldcPlantState_t b = BldcPlant_getState(&r.plant, Clock_nowNs());
+
+    const double t = time_ns_to_s(b.t_ns - a.t_ns);
+    if (t > 0.0) {
+        res->rpm       = n ? (float)(sum / n) : 0.0f;
+        res->p_sw_w    = (float)((b.e_switch_j - a.e_switch_j) / t);
+        res->p_in_w    = (float)((b.e_bus_j - a.e_bus_j) / t) + res->p_sw_w;
+        res->p_em_w    = (float)((b.e_mech_j - a.e_mech_j) / t);
+        res->p_cu_w    = (float)((b.e_copper_j - a.e_copper_j) / t);
+        res->p_diode_w = (float)((b.e_diode_j - a.e_diode_j) / t);
+        res->eff_pct   = (res->p_in_w > 0.0f) ? 100.0f * res->p_em_w / res->p_in_w : 0.0f;
+
+        double fl   = b.float_s - a.float_s;
+        double clmp = b.float_clamped_s - a.float_clamped_s;
+        if (fl > 0.0) {
+            res->float_clamped_pct = (float)(100.0 * clmp / fl);
+        }
+        if (fl - clmp > 0.0) {
+            res->float_err_rms_v = (float)sqrt((b.float_err2_v2s - a.float_err2_v2s) / (fl - clmp));
+            res->float_err_mid_rms_v =
+                (float)sqrt((b.float_err2_mid_v2s - a.float_err2_mid_v2s) / (fl - clmp));
+        }
+    }
+    res->shoot_through = b.shoot_through;
+
+    rig_deinit(&r);
+    return true;
+}
+
+// ---------------- Scenario: sinusoidal / FOC vs six-step commutation ----------------
+
+typedef struct {
+    float    rpm;              // mean true speed over the window
+    float    rpm_std;
+    float    torque_nm;        // mean electromagnetic torque
+    float    torque_std_pct;   // of the mean
+    float    torque_p2p_pct;
+    float    torque_h6_pct;    // 6th electrical harmonic (commutation ripple), peak
+    float    eff_pct;
+    float    angle_pct;        // ticks with a valid interpolated angle (sine / FOC)
+    float    step_ns;          // MotorControl_stepFast() without PWM writes
+    uint32_t shoot_through;
+    bool     faulted;
+} SineResult_t;
+
+// Mean cost of one stepFast() on a copy of the controller in its present
+// state, with the driver detached so only the control work is timed
+static double step_fast_ns(const MotorControl_t *mc)
+{
+    static MotorControl_t scratch;
+    memcpy(&scratch, mc, sizeof(scratch));
+    scratch.pwm = NULL;
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < BENCH_SINE_COST_REPS; ++i) {
+        MotorControl_stepFast(&scratch);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double ns = (double)(t1.tv_sec - t0.tv_sec) * 1e9 + (double)(t1.tv_nsec - t0.tv_nsec);
+    return ns / BENCH_SINE_COST_REPS;
+}
+
+static bool bench_sine(const BldcPlantParams_t *p, MotorCommutation_t comm, SineResult_t *res)
+{
+    SimRig_t r;
+    if (!rig_init(&r, p, RIG_SENSOR_HALL)) return false;
+
+    memset(res, 0, sizeof(*res));
+
+    MotorControl_setCommutation(&r.axis.ctrl, comm);
+    MotorControl_setEnable(&r.axis.ctrl, true);
+    MotorControl_setSpeedCmd(&r.axis.ctrl, BENCH_SINE_RPM, false);
+
+    while (rig_time_s(&r) < BENCH_SINE_LOAD_AT_S) {
+        rig_tick(&r);
+    }
+    BldcPlant_setLoad(&r.plant, BENCH_SINE_LOAD_NM);
+    while (rig_time_s(&r) < BENCH_SINE_SETTLE_S) {
+        rig_tick(&r);
+    }
+
+    BldcPlantState_t a    = BldcPlant_getState(&r.plant, Clock_nowNs());
+    BldcPlantState_t prev = a;
+    double w_sum = 0.0, w_sum2 = 0.0, t_sum = 0.0, t_sum2 = 0.0, h6_re = 0.0, h6_im = 0.0;
+    double cost_sum = 0.0;
+    float  t_lo = 1e9f, t_hi = -1e9f;
+    int    n = 0, n_angle = 0, n_cost = 0;
+
+    while (rig_time_s(&r) < BENCH_SINE_SETTLE_S + BENCH_SINE_WINDOW_S) {
+        rig_tick(&r);
+        BldcPlantState_t x = BldcPlant_getState(&r.plant, Clock_nowNs());
+
+        // Mean torque over the tick = work / angle turned
+        double dth = 0.5 * (double)(x.omega_mech_rad_s + prev.omega_mech_rad_s)
+                   * time_ns_to_s(x.t_ns - prev.t_ns);
+        if (dth > 0.0) {
+            float te  = (float)((x.e_mech_j - prev.e_mech_j) / dth);
+            float rpm = x.omega_mech_rad_s * RAD_S_TO_RPM;
+            w_sum  += rpm;
+            w_sum2 += (double)rpm * rpm;
+            t_sum  += te;
+            t_sum2 += (double)te * te;
+            double th6 = 6.0 * (double)x.theta_elec_deg * (M_PI / 180.0);
+            h6_re += te * cos(th6);
+            h6_im += te * sin(th6);
+            if (te < t_lo) t_lo = te;
+            if (te > t_hi) t_hi = te;
+            n++;
+            if (comm != MOTOR_COMM_SIX_STEP && r.axis.interp.valid) n_angle++;
+        }
+        prev = x;
+
+        if ((r.tick % SLOW_DIVIDER) == 1) {
+            cost_sum += step_fast_ns(&r.axis.ctrl);
+            n_cost++;
+        }
+
+        if ((r.tick % SLOW_DIVIDER) == 0 &&
+            MotorControl_getContext(&r.axis.ctrl).state == MOTOR_STATE_FAULT) {
+            res->faulted = true;
+            break;
+        }
+    }
+
+    if (n > 0) {
+        double w_mean = w_sum / n;
+        double t_mean = t_sum / n;
+        double w_var  = w_sum2 / n - w_mean * w_mean;
+        double t_var  = t_sum2 / n - t_mean * t_mean;
+        res->rpm       = (float)w_mean;
+        res->rpm_std   = (float)sqrt(w_var > 0.0 ? w_var : 0.0);
+        res->torque_nm = (float)t_mean;
+        if (t_mean > 0.0) {
+            res->torque_std_pct = (float)(100.0 * sqrt(t_var > 0.0 ? t_var : 0.0) / t_mean);
+            res->torque_p2p_pct = (float)(100.0 * (t_hi - t_lo) / t_mean);
+            res->torque_h6_pct  = (float)(100.0 * 2.0 * hypot(h6_re, h6_im) / t_sum);
+        }
+        res->angle_pct = 100.0f * (float)n_angle / (float)n;
+    }
+    if (n_cost > 0) {
+        res->step_ns = (float)(cost_sum / n_cost);
+    }
+    double e_in = (prev.e_bus_j - a.e_bus_j) + (prev.e_switch_j - a.e_switch_j);
+    if (e_in > 0.0) {
+        res->eff_pct = (float)(100.0 * (prev.e_mech_j - a.e_mech_j) / e_in);
+    }
+    res->shoot_through = prev.shoot_through;
+
+    rig_deinit(&r);
+    return true;
+}
+
+// ---------------- Scenario: table sine vs libm ----------------
+
+typedef struct {
+    double code_err_max;     // sin / cos of every ElecAngle_t vs sin(double)
+    double rad_err_max;      // from random float radians, conversion included
+    double lut_ns;           // one sin + cos pair from float radians
+    double libm_ns;
+    double lut_cycles;       // < 0: no cycle counter
+    double libm_cycles;
+} AngleResult_t;
+
+static float s_angle_in[BENCH_ANGLE_N];
+static PerfCounters_t s_angle_perf;
+
+// Cost of one pair: ns from the wall clock, cycles from perf counters
+// (one sample = all passes)
+static void time_sincos(bool table, double *ns, double *cycles)
+{
+    volatile float sink = 0.0f;
+    bool perf = PerfCounters_open(&s_angle_perf, BENCH_ANGLE_PASSES);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int p = 0; p < BENCH_ANGLE_PASSES; ++p) {
+        float acc = 0.0f;
+        if (table) {
+            for (int i = 0; i < BENCH_ANGLE_N; ++i) {
+                float s, c;
+                ElecAngle_sinCos(ElecAngle_fromRad(s_angle_in[i]), &s, &c);
+                acc += s + c;
+            }
+        } else {
+            for (int i = 0; i < BENCH_ANGLE_N; ++i) {
+                acc += sinf(s_angle_in[i]) + cosf(s_angle_in[i]);
+            }
+        }
+        sink += acc;
+        PerfCounters_tick(&s_angle_perf);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    (void)sink;
+
+    double pairs = (double)BENCH_ANGLE_N * BENCH_ANGLE_PASSES;
+    *ns = ((double)(t1.tv_sec - t0.tv_sec) * 1e9 + (double)(t1.tv_nsec - t0.tv_nsec)) / pairs;
+
+    PerfSummary_t ps = PerfCounters_getSummary(&s_angle_perf);
+    *cycles = (perf && (ps.counter_mask & (1u << PERF_CNT_CYCLES)) && ps.samples > 0)
+            ? (double)ps.cycles_per_iter / BENCH_ANGLE_N : -1.0;
+    PerfCounters_close(&s_angle_perf);
+}
+
+static void bench_angle(AngleResult_t *res)
+{
+    memset(res, 0, sizeof(*res));
+
+    for (uint32_t a = 0; a < 65536u; ++a) {
+        double th = (double)a * (2.0 * M_PI / 65536.0);
+        double es = fabs((double)ElecAngle_sin((ElecAngle_t)a) - sin(th));
+        double ec = fabs((double)ElecAngle_cos((ElecAngle_t)a) - cos(th));
+        if (es > res->code_err_max) res->code_err_max = es;
+        if (ec > res->code_err_max) res->code_err_max = ec;
+    }
+
+    srand(1);
+    for (int i = 0; i < BENCH_ANGLE_N; ++i) {
+        float u = (float)rand() / (float)RAND_MAX;
+        s_angle_in[i] = (2.0f * u - 1.0f) * BENCH_ANGLE_SPAN_RAD;
+
+        float  s, c;
+        ElecAngle_sinCos(ElecAngle_fromRad(s_angle_in[i]), &s, &c);
+        double es = fabs((double)s - sin((double)s_angle_in[i]));
+        double ec = fabs((double)c - cos((double)s_angle_in[i]));
+        if (es > res->rad_err_max) res->rad_err_max = es;
+        if (ec > res->rad_err_max) res->rad_err_max = ec;
+    }
+
+    time_sincos(true,  &res->lut_ns,  &res->lut_cycles);
+    time_sincos(false, &res->libm_ns, &res->libm_cycles);
+}
+
+// ---------------- Scenario: speed PI gain schedule ----------------
+
+static const float s_sched_rpm[BENCH_SCHED_N_RPM] = { 300.0f, 800.0f, 1500.0f };
+
+// Duty-mode step with feedforward, on the configured duty schedule or
+// with it cleared (fixed gains)
+static bool bench_sched(const BldcPlantParams_t *p, bool sched, float target,
+                        StepResult_t *res)
+{
+    SpeedGainTable_t saved = g_motor_cfg.speed_sched_duty;
+    if (!sched) {
+        g_motor_cfg.speed_sched_duty.n = 0;
+    }
+    bool ok = bench_step(p, STEP_DUTY_FF, target, BENCH_SCHED_RUN_S, res);
+    g_motor_cfg.speed_sched_duty = saved;
+    return ok;
+}
+
+// ---------------- Scenario: relay autotune ----------------
+
+typedef struct {
+    int   state;          // RelayTuneState_t at the end of the run
+    int   abort;
+    float tune_s;         // start -> result
+    float ku, pu_s, kp, ki;
+    float overshoot_pct;  // BENCH_AT_RPM -> BENCH_AT_STEP_RPM afterwards
+    float t_settle_s;     // from the step
+    float std_rpm;        // over the last 0.5 s
+    bool  kept;           // gains untouched when the result came
+    bool  applied;        // result in use for the step
+    bool  faulted;
+} AutotuneResult_t;
+
+// tune = false: the same step on the gains in force (reference)
+static bool bench_autotune(const BldcPlantParams_t *p, bool cur_loop, bool tune,
+                           RelayTuneRule_t rule, AutotuneResult_t *res)
+{
+    SimRig_t r;
+    if (!rig_init(&r, p, RIG_SENSOR_HALL)) return false;
+    if (!cur_loop) {
+        MotorControl_setCurrentLoop(&r.axis.ctrl, false);
+    }
+
+    memset(res, 0, sizeof(*res));
+
+    MotorControl_setEnable(&r.axis.ctrl, true);
+    MotorControl_setSpeedCmd(&r.axis.ctrl, BENCH_AT_RPM, false);
+
+    // Settle at speed, tune (or not), let the gains take over, step
+    enum { AT_SETTLE, AT_TUNE, AT_HOLD, AT_STEP } phase = AT_SETTLE;
+    const float target = BENCH_AT_STEP_RPM;
+    const PI_Controller_t *pi = &r.axis.ctrl.speed_pi;
+    const PI_Schedule_t *sched0 = NULL;
+    float  kp0 = 0.0f, ki0 = 0.0f;
+    float  t_phase = 0.0f, peak = 0.0f, t_out = 0.0f;
+    double sum = 0.0, sq = 0.0;
+    int    n   = 0;
+
+    while (rig_time_s(&r) < BENCH_AT_RUN_S) {
+        rig_tick(&r);
+        if ((r.tick % SLOW_DIVIDER) != 0) continue;
+
+        float t   = rig_time_s(&r);
+        float rpm = rig_true_rpm(&r);
+        MotorContext_t ctx = MotorControl_getContext(&r.axis.ctrl);
+
+        if (ctx.state == MOTOR_STATE_FAULT) {
+            res->faulted = true;
+            break;
+        }
+
+        if (phase == AT_SETTLE) {
+            if (t < BENCH_AT_SETTLE_S) continue;
+            sched0 = pi->sched;
+            kp0    = pi->kp;
+            ki0    = pi->ki;
+            if (tune) MotorControl_startAutotune(&r.axis.ctrl, BENCH_AT_RPM, rule);
+            phase   = tune ? AT_TUNE : AT_HOLD;
+            t_phase = t;
+        } else if (phase == AT_TUNE) {
+            // Result published once the command has been applied
+            if (ctx.tune.state == RELAY_TUNE_IDLE || ctx.tune.state == RELAY_TUNE_RUNNING) continue;
+            res->state  = ctx.tune.state;
+            res->abort  = ctx.tune.abort;
+            res->tune_s = t - t_phase;
+            res->ku = ctx.tune.ku;  res->pu_s = ctx.tune.pu_s;
+            res->kp = ctx.tune.kp;  res->ki   = ctx.tune.ki;
+            // Scheduled gains move with the speed; fixed ones must not
+            res->kept = !ctx.tune.applied && pi->sched == sched0 &&
+                        (sched0 || (pi->kp == kp0 && pi->ki == ki0));
+            if (ctx.tune.state == RELAY_TUNE_DONE) {
+                MotorControl_applyAutotune(&r.axis.ctrl);
+            }
+            phase   = AT_HOLD;
+            t_phase = t;
+        } else if (phase == AT_HOLD) {
+            if (t - t_phase < 0.5f) continue;
+            res->applied = ctx.tune.applied;
+            MotorControl_setSpeedCmd(&r.axis.ctrl, target, false);
+            phase   = AT_STEP;
+            t_phase = t;
+        } else {
+            float ts = t - t_phase;
+            if (ts > BENCH_AT_STEP_S) break;
+            if (rpm > peak) peak = rpm;
+            if (fabsf(rpm - target) > BENCH_STEP_BAND * target) t_out = ts;
+            if (ts > BENCH_AT_STEP_S - 0.5f) {
+                sum += rpm;
+                sq  += (double)rpm * rpm;
+                n++;
+            }
+        }
+    }
+
+    res->overshoot_pct = (peak > target) ? 100.0f * (peak - target) / target : 0.0f;
+    res->t_settle_s    = t_out;
+    res->std_rpm       = n ? (float)sqrt(fmax(sq / n - (sum / n) * (sum / n), 0.0)) : 0.0f;
+
+    rig_deinit(&r);
+    return true;
+}
+
+// ---------------- Scenario: frequency response ----------------
+
+typedef struct {
+    int      state;           // FraState_t at the end of the run
+    int      nbins;
+    FraBin_t bin[FRA_MAX_BINS];
+    float    amplitude;
+    float    kp, ki;          // speed PI gains during the run
+    bool     faulted;
+} FraRunResult_t;
+
+static bool bench_fra(const BldcPlantParams_t *p, bool cur_loop, MotorFraPoint_t point,
+                      FraExcitation_t exc, FraRunResult_t *res)
+{
+    // Duty mode with fixed gains, and the Kv feedforward without its IR
+    // term (a constant at a constant command): the prediction from P
+    // assumes the loop is the PI alone
+    float            ir_saved    = g_motor_cfg.speed_ff_ir_gain;
+    SpeedGainTable_t sched_saved = g_motor_cfg.speed_sched_duty;
+    g_motor_cfg.speed_ff_ir_gain   = 0.0f;
+    g_motor_cfg.speed_sched_duty.n = 0;
+
+    SimRig_t r;
+    bool ok = rig_init(&r, p, RIG_SENSOR_HALL);
+    if (ok) {
+        MotorControl_setCurrentLoop(&r.axis.ctrl, cur_loop);
+        memset(res, 0, sizeof(*res));
+
+        FraConfig_t cfg = {
+            .exc       = exc,
+            .amplitude = (point == MOTOR_FRA_SPEED_REF) ? FRA_AMP_RPM
+                       : cur_loop                       ? FRA_AMP_A : FRA_AMP_DUTY,
+            .f_min_hz  = FRA_F_MIN_HZ,
+            .f_max_hz  = FRA_F_MAX_HZ,
+            .bins      = FRA_BINS,
+            .samples   = FRA_SAMPLES,
+            .periods   = FRA_PERIODS,
+            .settle    = FRA_SETTLE_SAMPLES,
+            .coherence_min = FRA_COHERENCE_MIN,
+        };
+        res->amplitude = cfg.amplitude;
+
+        MotorControl_setEnable(&r.axis.ctrl, true);
+        MotorControl_setSpeedCmd(&r.axis.ctrl, BENCH_FRA_RPM, false);
+
+        bool started = false, loaded = false;
+        while (rig_time_s(&r) < BENCH_FRA_RUN_S) {
+            rig_tick(&r);
+            if ((r.tick % SLOW_DIVIDER) != 0) continue;
+
+            MotorContext_t ctx = MotorControl_getContext(&r.axis.ctrl);
+            if (ctx.state == MOTOR_STATE_FAULT) {
+                res->faulted = true;
+                break;
+            }
+            if (!loaded && rig_time_s(&r) >= BENCH_FRA_LOAD_AT_S) {
+                BldcPlant_setLoad(&r.plant, BENCH_FRA_LOAD_NM);
+                loaded = true;
+            }
+            if (!started) {
+                if (rig_time_s(&r) < BENCH_FRA_SETTLE_S) continue;
+                started = MotorControl_startFra(&r.axis.ctrl, &cfg, point,
+                                                MOTOR_FRA_RESP_SPEED) != 0;
+                if (!started) break;
+                continue;
+            }
+            res->kp    = ctx.cmd.speed_kp;
+            res->ki    = ctx.cmd.speed_ki;
+            res->state = ctx.fra.state;
+            if (ctx.fra.state == FRA_DONE || ctx.fra.state == FRA_ABORTED) break;
+        }
+
+        int n = MotorControl_getFraResult(&r.axis.ctrl, res->bin, FRA_MAX_BINS);
+        res->nbins = (n > 0) ? n : 0;
+        rig_deinit(&r);
+    }
+
+    g_motor_cfg.speed_ff_ir_gain = ir_saved;
+    g_motor_cfg.speed_sched_duty = sched_saved;
+    return ok;
+}
+
+// Closed loop from the plant and the speed PI at one bin:
+// C(z) = kp + ki Ts / (1 - z^-1), T = C P / (1 + C P)
+static void fra_predict(const FraBin_t *plant, float kp, float ki,
+                        float *gain, float *phase_deg)
+{
+    const double ts = 1.0 / SPEED_LOOP_HZ;
+    double w   = 2.0 * M_PI * plant->f_hz * ts;
+    double ph  = plant->phase_deg * M_PI / 180.0;
+    double pre = plant->gain * cos(ph), pim = plant->gain * sin(ph);
+
+    // 1 / (1 - z^-1) with z^-1 = cos w - j sin w
+    double dre = 1.0 - cos(w), dim = sin(w);
+    double d2  = dre * dre + dim * dim;
+    double cre = kp + ki * ts * dre / d2;
+    double cim = -ki * ts * dim / d2;
+
+    double lre = cre * pre - cim * pim;      // L = C P
+    double lim = cre * pim + cim * pre;
+    double nre = 1.0 + lre, nim = lim;       // T = L / (1 + L)
+    double n2  = nre * nre + nim * nim;
+    double tre = (lre * nre + lim * nim) / n2;
+    double tim = (lim * nre - lre * nim) / n2;
+
+    *gain      = (float)sqrt(tre * tre + tim * tim);
+    *phase_deg = (float)(atan2(tim, tre) * 180.0 / M_PI);
+}
+
+static float fra_db(float gain)
+{
+    return (gain > 0.0f) ? 20.0f * log10f(gain) : -999.0f;
+}
+
+static float fra_deg_diff(float a, float b)
+{
+    float d = a - b;
+    while (d >  180.0f) d -= 360.0f;
+    while (d < -180.0f) d += 360.0f;
+    return d;
+}
+
+// ---------------- Scenario: speed trajectory ----------------
+
+typedef struct {
+    float t_settle_s;     // command change -> last exit from the +/- band
+    float overshoot_pct;  // past RPM_HI, % of the change
+    float track_rms_rpm;  // true speed vs rpm_cmd while rpm_cmd moves
+    float out_peak;       // largest speed-loop output (duty, or A)
+    float out_step_max;   // largest change of the windowed output mean
+    bool  faulted;
+} TrajResult_t;
+
+// Reference variants compared by "traj"
+typedef enum {
+    TRAJ_OLD_RAMP = 0,    // the former fixed slew rate, no acceleration feedforward
+    TRAJ_RAMP_FF,         // configured acceleration, no jerk limit, feedforward
+    TRAJ_SCURVE_FF,       // configured trajectory and feedforward
+    TRAJ_MODE_COUNT
+} TrajMode_t;
+
+// RPM_LO -> RPM_HI. Only up: the drive has no braking torque (the
+// speed-loop output stops at 0), so a step down coasts whatever the
+// reference does. The output is averaged over BENCH_TRAJ_WIN_S windows
+// for the torque step, so the speed PI's reaction to the Hall speed's
+// quantization does not swamp it.
+static bool bench_traj(const BldcPlantParams_t *p, bool cur_loop, TrajMode_t mode, TrajResult_t *res)
+{
+    SimRig_t r;
+    if (!rig_init(&r, p, RIG_SENSOR_HALL)) return false;
+    MotorControl_setCurrentLoop(&r.axis.ctrl, cur_loop);
+
+    float accel_saved = g_motor_cfg.traj_accel_max;
+    float jerk_saved  = g_motor_cfg.traj_jerk_max;
+    int   aff_saved   = g_motor_cfg.traj_accel_ff;
+    int   ff_saved    = g_motor_cfg.speed_ff;
+    if (mode == TRAJ_OLD_RAMP) {
+        g_motor_cfg.traj_accel_max = BENCH_TRAJ_OLD_ACCEL;
+        g_motor_cfg.traj_accel_ff  = 0;
+    }
+    if (mode != TRAJ_SCURVE_FF) {
+        g_motor_cfg.traj_jerk_max  = 0.0f;
+    }
+    g_motor_cfg.speed_ff = 1;
+
+    memset(res, 0, sizeof(*res));
+
+    const float    target = BENCH_TRAJ_RPM_HI;
+    const float    span   = BENCH_TRAJ_RPM_HI - BENCH_TRAJ_RPM_LO;
+    const uint32_t win    = (uint32_t)(BENCH_TRAJ_WIN_S * (float)SLOW_LOOP_HZ);
+
+    MotorControl_setEnable(&r.axis.ctrl, true);
+    MotorControl_setSpeedCmd(&r.axis.ctrl, BENCH_TRAJ_RPM_LO, false);
+
+    float    t_step = -1.0f, t_out = 0.0f, peak = 0.0f, win_last = 0.0f;
+    double   sq = 0.0, win_sum = 0.0;
+    int      n  = 0;
+    uint32_t win_n = 0;
+
+    while (rig_time_s(&r) < BENCH_TRAJ_SETTLE_S + BENCH_TRAJ_STEP_S) {
+        rig_tick(&r);
+        if ((r.tick % SLOW_DIVIDER) != 0) continue;
+
+        float t   = rig_time_s(&r);
+        float rpm = rig_true_rpm(&r);
+        MotorContext_t ctx = MotorControl_getContext(&r.axis.ctrl);
+
+        if (ctx.state == MOTOR_STATE_FAULT) {
+            res->faulted = true;
+            break;
+        }
+
+        // Last window before the step is the reference
+        if (t >= BENCH_TRAJ_SETTLE_S - BENCH_TRAJ_WIN_S) {
+            win_sum += ctx.cmd.torque_cmd;
+            if (++win_n == win) {
+                float m = (float)(win_sum / win);
+                if (t_step >= 0.0f && fabsf(m - win_last) > res->out_step_max) {
+                    res->out_step_max = fabsf(m - win_last);
+                }
+                win_last = m;
+                win_sum  = 0.0;
+                win_n    = 0;
+            }
+        }
+
+        if (t_step < 0.0f) {
+            if (t < BENCH_TRAJ_SETTLE_S) continue;
+            MotorControl_setSpeedCmd(&r.axis.ctrl, target, false);
+            t_step = t;
+            t_out  = t;
+            continue;
+        }
+
+        if (rpm > peak) peak = rpm;
+        if (fabsf(rpm - target) > BENCH_STEP_BAND * span) t_out = t;
+        if (ctx.cmd.torque_cmd > res->out_peak) res->out_peak = ctx.cmd.torque_cmd;
+
+        // Tracking while the reference moves
+        if (ctx.cmd.rpm_cmd != target) {
+            float e = rpm - ctx.cmd.rpm_cmd;
+            sq += (double)e * e;
+            n++;
+        }
+    }
+
+    res->t_settle_s    = (t_step >= 0.0f) ? t_out - t_step : -1.0f;
+    res->overshoot_pct = (peak > target) ? 100.0f * (peak - target) / span : 0.0f;
+    res->track_rms_rpm = n ? (float)sqrt(sq / n) : 0.0f;
+
+    g_motor_cfg.traj_accel_max = accel_saved;
+    g_motor_cfg.traj_jerk_max  = jerk_saved;
+    g_motor_cfg.traj_accel_ff  = aff_saved;
+    g_motor_cfg.speed_ff       = ff_saved;
+    rig_deinit(&r);
+    return true;
+}
+
+typedef struct {
+    MotorIdentStatus_t id;
+    float t_s;            // start to DONE / ABORTED
+    bool  saved;          // written and read back unchanged
+    bool  cfg_kept;       // g_motor_cfg left as it was
+} IdentResult_t;
+
+// Identification from a config that is wrong in every motor constant.
+// The config it leaves behind is the bench's again afterwards.
+static bool bench_ident(const BldcPlantParams_t *p, IdentResult_t *res)
+{
+    MotorRuntimeConfig cfg_saved = g_motor_cfg;
+    g_motor_cfg.kv_rpm_per_v *= BENCH_IDENT_WRONG;
+    g_motor_cfg.r_phase_ohm  *= BENCH_IDENT_WRONG;
+    g_motor_cfg.l_phase_h    *= BENCH_IDENT_WRONG;
+    g_motor_cfg.inertia_kgm2 *= BENCH_IDENT_WRONG;
+    g_motor_cfg.friction_nm  *= BENCH_IDENT_WRONG;
+    g_motor_cfg.pwm_modulation = PWM_MOD_COMPLEMENTARY;
+
+    SimRig_t r;
+    if (!rig_init(&r, p, RIG_SENSOR_HALL)) {
+        g_motor_cfg = cfg_saved;
+        return false;
+    }
+    MotorControl_setCurrentLoop(&r.axis.ctrl, true);
+
+    memset(res, 0, sizeof(*res));
+    res->t_s = -1.0f;
+
+    bool started = false;
+    while (rig_time_s(&r) < BENCH_IDENT_MAX_S) {
+        rig_tick(&r);
+        if ((r.tick % SLOW_DIVIDER) != 0) continue;
+
+        // One slow tick in, so the controller has seen the bus voltage
+        if (!started) {
+            MotorControl_startIdent(&r.axis.ctrl, IDENT_RPM);
+            started = true;
+            continue;
+        }
+
+        MotorContext_t ctx = MotorControl_getContext(&r.axis.ctrl);
+        if (ctx.ident.phase == PARAM_IDENT_DONE || ctx.ident.phase == PARAM_IDENT_ABORTED) {
+            res->id  = ctx.ident;
+            res->t_s = rig_time_s(&r);
+            break;
+        }
+    }
+    rig_deinit(&r);
+
+    // The results are the controller's own; the shared config keeps the
+    // wrong constants it started from
+    MotorParams_t cfg_mp;
+    MotorConfig_getMotorParams(&cfg_mp);
+    res->cfg_kept = cfg_mp.kv_rpm_per_v == cfg_saved.kv_rpm_per_v * BENCH_IDENT_WRONG &&
+                    cfg_mp.r_phase_ohm  == cfg_saved.r_phase_ohm  * BENCH_IDENT_WRONG &&
+                    cfg_mp.l_phase_h    == cfg_saved.l_phase_h    * BENCH_IDENT_WRONG &&
+                    cfg_mp.inertia_kgm2 == cfg_saved.inertia_kgm2 * BENCH_IDENT_WRONG &&
+                    cfg_mp.friction_nm  == cfg_saved.friction_nm  * BENCH_IDENT_WRONG;
+
+    // Persisted and read back
+    if (res->id.phase == PARAM_IDENT_DONE) {
+        remove(BENCH_IDENT_CFG_PATH);
+        MotorParams_t mp = {
+            .kv_rpm_per_v = res->id.kv_rpm_per_v, .r_phase_ohm  = res->id.r_phase_ohm,
+            .l_phase_h    = res->id.l_phase_h,    .inertia_kgm2 = res->id.inertia_kgm2,
+            .friction_nm  = res->id.friction_nm,
+        };
+        if (MotorConfig_saveMotorParams(BENCH_IDENT_CFG_PATH, &mp, NULL) == 0) {
+            MotorConfig_initDefaults();
+            if (MotorConfig_loadFromFile(BENCH_IDENT_CFG_PATH) == 0) {
+                // Written with 6 significant digits
+                res->saved = fabsf(g_motor_cfg.kv_rpm_per_v / mp.kv_rpm_per_v - 1.0f) < 1e-5f &&
+                             fabsf(g_motor_cfg.r_phase_ohm  / mp.r_phase_ohm  - 1.0f) < 1e-5f &&
+                             fabsf(g_motor_cfg.l_phase_h    / mp.l_phase_h    - 1.0f) < 1e-5f &&
+                             fabsf(g_motor_cfg.inertia_kgm2 / mp.inertia_kgm2 - 1.0f) < 1e-5f &&
+                             fabsf(g_motor_cfg.friction_nm  / mp.friction_nm  - 1.0f) < 1e-5f;
+            }
+        }
+        remove(BENCH_IDENT_CFG_PATH);
+    }
+
+    g_motor_cfg = cfg_saved;
+    return true;
+}
+
+typedef struct {
+    MotorHallLearnStatus_t hall;
+    float t_s;            // start to DONE / FAILED
+    bool  saved;          // written and read back unchanged
+    bool  axis_map;       // the axis' estimators decode with the result
+    bool  cfg_kept;       // g_motor_cfg left as it was
+} HallResult_t;
+
+// Hall commissioning on a plant with misplaced Hall edges. The config it
+// leaves behind is the bench's again afterwards.
+static bool bench_hall(const BldcPlantParams_t *p, HallResult_t *res)
+{
+    MotorRuntimeConfig cfg_saved = g_motor_cfg;
+    BldcPlantParams_t  pp        = *p;
+    pp.hall_offset_deg = BENCH_HALL_OFFSET_DEG;
+
+    SimRig_t r;
+    if (!rig_init(&r, &pp, RIG_SENSOR_HALL)) {
+        g_motor_cfg = cfg_saved;
+        return false;
+    }
+
+    memset(res, 0, sizeof(*res));
+    res->t_s = -1.0f;
+
+    bool started = false;
+    while (rig_time_s(&r) < BENCH_HALL_MAX_S) {
+        rig_tick(&r);
+        if ((r.tick % SLOW_DIVIDER) != 0) continue;
+
+        // One slow tick in, so the controller has seen the bus voltage
+        if (!started) {
+            MotorControl_startHallLearn(&r.axis.ctrl);
+            started = true;
+            continue;
+        }
+
+        MotorContext_t ctx = MotorControl_getContext(&r.axis.ctrl);
+        if (ctx.hall.state == HALL_LEARN_DONE || ctx.hall.state == HALL_LEARN_FAILED) {
+            res->hall = ctx.hall;
+            res->t_s  = rig_time_s(&r);
+            break;
+        }
+    }
+    // One more slow tick hands the result to the estimators
+    for (uint32_t i = 0; i < SLOW_DIVIDER; i++) rig_tick(&r);
+    const HallMap_t *hm = &res->hall.map;
+    HallMap_t        interp_map;
+    interp_map.set = 1;
+    for (int bits = 0; bits < 8; bits++) {
+        interp_map.map[bits] = (uint8_t)(atomic_load(&r.axis.interp.map) >> (8 * bits));
+    }
+    res->axis_map = hm->set && r.axis.speed.hall_map.set &&
+                    memcmp(r.axis.speed.hall_map.map, hm->map, sizeof(hm->map)) == 0 &&
+                    memcmp(r.axis.speed.hall_map.edge_offset_deg, hm->edge_offset_deg,
+                           sizeof(hm->edge_offset_deg)) == 0 &&
+                    memcmp(interp_map.map, hm->map, sizeof(hm->map)) == 0;
+    rig_deinit(&r);
+
+    res->cfg_kept = memcmp(&g_motor_cfg.hall_map, &cfg_saved.hall_map, sizeof(cfg_saved.hall_map)) == 0;
+
+    // Persisted and read back
+    if (res->hall.state == HALL_LEARN_DONE) {
+        remove(BENCH_HALL_CFG_PATH);
+        MotorParams_t mp;
+        MotorConfig_getMotorParams(&mp);
+        if (MotorConfig_saveMotorParams(BENCH_HALL_CFG_PATH, &mp, hm) == 0) {
+            MotorConfig_initDefaults();
+            if (MotorConfig_loadFromFile(BENCH_HALL_CFG_PATH) == 0) {
+                // Offsets written with 2 decimals
+                bool ok = g_motor_cfg.hall_map.set &&
+                          memcmp(g_motor_cfg.hall_map.map, hm->map, sizeof(hm->map)) == 0;
+                for (int s = 0; s < 6; s++) {
+                    ok = ok && fabsf(g_motor_cfg.hall_map.edge_offset_deg[s] -
+                                     hm->edge_offset_deg[s]) < 0.01f;
+                }
+                res->saved = ok;
+            }
+        }
+        remove(BENCH_HALL_CFG_PATH);
+    }
+
+    g_motor_cfg = cfg_saved;
+    return true;
+}
+
+typedef struct {
+    float rpm_sector_err_pct;   // largest per-sector mean Hall speed error
+    float angle_rms_deg;        // interpolated angle about its mean error
+    float angle_pct;            // ticks with a valid angle
+} HallTimingWin_t;
+
+typedef struct {
+    HallTimingWin_t on, off;
+    float    width_err_max;     // learned vs plant sector widths
+    uint32_t learned;           // intervals learned
+    bool     faulted;
+} HallTimingResult_t;
+
+static float wrap180_deg(float d)
+{
+    d = fmodf(d + 180.0f, 360.0f);
+    if (d < 0.0f) d += 360.0f;
+    return d - 180.0f;
+}
+
+// Width of each Hall sector on the plant, relative to 60 deg: the edge
+// into sector s moves with the sensor that switches there
+static void plant_sector_widths(const BldcPlantParams_t *p, float w[6])
+{
+    static const uint8_t sector_to_bits[6] = { 0x1, 0x3, 0x2, 0x6, 0x4, 0x5 };
+    float shift[6];
+    for (int s = 0; s < 6; s++) {
+        uint8_t x = sector_to_bits[s] ^ sector_to_bits[(s + 5) % 6];
+        int     b = (x == 0x1) ? 0 : (x == 0x2) ? 1 : 2;
+        shift[s]  = p->hall_sensor_err_deg[b];
+    }
+    for (int s = 0; s < 6; s++) {
+        w[s] = (60.0f + shift[(s + 1) % 6] - shift[s]) / 60.0f;
+    }
+}
+
+static bool bench_halltiming_window(SimRig_t *r, HallTimingWin_t *win)
+{
+    double   rpm_err[6] = { 0 };
+    int      rpm_n[6]   = { 0 };
+    double   a_sum = 0.0, a_sum2 = 0.0;
+    int      n = 0, n_angle = 0;
+    TimeNs_t last_edge = 0;
+    float    t_end = rig_time_s(r) + BENCH_HT_WINDOW_S;
+
+    memset(win, 0, sizeof(*win));
+    while (rig_time_s(r) < t_end) {
+        rig_tick(r);
+        BldcPlantState_t x = BldcPlant_getState(&r->plant, Clock_nowNs());
+
+        n++;
+        if (r->axis.interp.valid) {
+            float truth = x.theta_elec_deg - 30.0f;
+            float e     = wrap180_deg(r->axis.interp.angle_rad * (180.0f / 3.14159265f) - truth);
+            a_sum  += e;
+            a_sum2 += (double)e * e;
+            n_angle++;
+        }
+
+        if ((r->tick % SLOW_DIVIDER) != 1) continue;
+        if (MotorControl_getContext(&r->axis.ctrl).state == MOTOR_STATE_FAULT) return false;
+
+        // Each new Hall speed, by the sector its interval timed
+        const SpeedMeas_t *sm = &r->axis.speed;
+        if (sm->last_edge_ns != last_edge && sm->est.valid && sm->timing.dir > 0) {
+            uint8_t timed = (uint8_t)((sm->est.sector + 5) % 6);
+            float   truth = x.omega_mech_rad_s * RAD_S_TO_RPM;
+            rpm_err[timed] += sm->est.rpm_mech - truth;
+            rpm_n[timed]++;
+        }
+        last_edge = sm->last_edge_ns;
+    }
+
+    for (int s = 0; s < 6; s++) {
+        if (rpm_n[s] == 0) continue;
+        float e = fabsf((float)(100.0 * rpm_err[s] / rpm_n[s]) / BENCH_HT_RPM);
+        if (e > win->rpm_sector_err_pct) win->rpm_sector_err_pct = e;
+    }
+    if (n_angle > 0) {
+        double mean = a_sum / n_angle;
+        double var  = a_sum2 / n_angle - mean * mean;
+        win->angle_rms_deg = (float)sqrt(var > 0.0 ? var : 0.0);
+    }
+    win->angle_pct = n ? 100.0f * (float)n_angle / (float)n : 0.0f;
+    return true;
+}
+
+// Per-edge timing compensation on unevenly placed Hall sensors. The
+// config it leaves behind is the bench's again afterwards.
+static bool bench_halltiming(const BldcPlantParams_t *p, HallTimingResult_t *res)
+{
+    MotorRuntimeConfig cfg_saved = g_motor_cfg;
+    BldcPlantParams_t  pp        = *p;
+    for (int b = 0; b < 3; b++) pp.hall_sensor_err_deg[b] = s_ht_sensor_err_deg[b];
+    g_motor_cfg.hall_timing_comp = 1;
+
+    SimRig_t r;
+    if (!rig_init(&r, &pp, RIG_SENSOR_HALL)) {
+        g_motor_cfg = cfg_saved;
+        return false;
+    }
+    memset(res, 0, sizeof(*res));
+
+    MotorControl_setCommutation(&r.axis.ctrl, MOTOR_COMM_SINE);
+    MotorControl_setEnable(&r.axis.ctrl, true);
+    MotorControl_setSpeedCmd(&r.axis.ctrl, BENCH_HT_RPM, false);
+    while (rig_time_s(&r) < BENCH_HT_LEARN_S) {
+        rig_tick(&r);
+    }
+
+    // Learned widths against the plant's
+    const HallTiming_t *ht = &r.axis.speed.timing;
+    float w_true[6];
+    plant_sector_widths(&pp, w_true);
+    for (int i = 0; i < ht->n; i++) {
+        float e = fabsf(ht->width[i] - w_true[i % 6]);
+        if (e > res->width_err_max) res->width_err_max = e;
+    }
+    res->learned = ht->learned;
+
+    bool ok = bench_halltiming_window(&r, &res->on);
+    if (ok) {
+        g_motor_cfg.hall_timing_comp = 0;
+        float t_settle = rig_time_s(&r) + BENCH_HT_SETTLE_S;
+        while (rig_time_s(&r) < t_settle) {
+            rig_tick(&r);
+        }
+        ok = bench_halltiming_window(&r, &res->off);
+    }
+    res->faulted = !ok;
+
+    rig_deinit(&r);
+    g_motor_cfg = cfg_saved;
+    return true;
+}
+
+// ---------------- Scenario: long uptime ----------------
+
+static const int s_uptime_days[] = { 0, 1, 7, 30 };
+#define BENCH_UPTIME_STARTS  ((int)(sizeof(s_uptime_days) / sizeof(s_uptime_days[0])))
+
+typedef struct {
+    bool     ok;              // estimator running the whole window
+    float    rpm_err_mean;    // estimate - plant (rpm)
+    float    rpm_err_rms;
+    TimeNs_t period_res_ns;   // smallest step between sector periods
+    int      edges;           // sector changes in the window
+    float    rev_err_pct;     // speed over all of them vs the plant's mean
+    float    period_err_ms;   // worst sector period vs the plant's
+    float    float_err_ms;    // same, from float-second timestamps (old timebase)
+} UptimeWin_t;
+
+// One estimator at one uptime: Hall (RIG_SENSOR_HALL) or BEMF (AUTO,
+// measured once handed over)
+static bool bench_uptime_run(const BldcPlantParams_t *p, RigSensor_t sensor, int days,
+                             UptimeWin_t *win)
+{
+    SimRig_t r;
+    if (!rig_init_at(&r, p, sensor, (TimeNs_t)days * 24 * 3600 * TIME_NS_PER_S)) return false;
+    memset(win, 0, sizeof(*win));
+
+    MotorControl_setEnable(&r.axis.ctrl, true);
+    MotorControl_setSpeedCmd(&r.axis.ctrl, BENCH_UPTIME_RPM, false);
+
+    // Settle (after the handover for BEMF)
+    float t_start = BENCH_UPTIME_SETTLE_S;
+    if (sensor == RIG_SENSOR_AUTO) {
+        while (!r.axis.handover.done && rig_time_s(&r) < BENCH_HO_TIMEOUT_S) {
+            rig_tick(&r);
+        }
+        if (!r.axis.handover.done) {
+            rig_deinit(&r);
+            return true;
+        }
+        t_start = rig_time_s(&r) + BENCH_UPTIME_SETTLE_S;
+    }
+    while (rig_time_s(&r) < t_start) {
+        rig_tick(&r);
+    }
+
+    SpeedSource_t src  = (sensor == RIG_SENSOR_AUTO) ? SPEED_SRC_BEMF : SPEED_SRC_HALL;
+    double        sum  = 0.0, sum2 = 0.0;
+    int           n    = 0;
+    TimeNs_t      last = 0;
+    uint8_t       sector  = 0xFF;
+    float         edge_s  = -1.0f;     // last edge, float seconds
+    double        est_sum = 0.0, true_sum = 0.0;
+    win->ok = true;
+    while (rig_time_s(&r) < t_start + BENCH_UPTIME_WINDOW_S) {
+        rig_tick(&r);
+        if ((r.tick % SLOW_DIVIDER) != 0) continue;
+
+        SpeedEstimate_t e = SpeedMeas_get(&r.axis.speed);
+        if (r.axis.speed.mode != src || !e.valid) {
+            win->ok = false;
+            break;
+        }
+        float rpm_true = rig_true_rpm(&r);
+        float d = e.rpm_mech - rpm_true;
+        sum  += d;
+        sum2 += (double)d * d;
+        n++;
+
+        // Edge: its sector period against the plant's, and against what
+        // the same edge times give in float seconds
+        float now_s = (float)((double)Clock_nowNs() * 1e-9);
+        if (e.sector != sector && sector != 0xFF && e.last_period_ns > 0 && rpm_true > 0.0f) {
+            double t_true = 60.0 / ((double)rpm_true * p->pole_pairs * 6.0);
+            double t_est  = (double)e.last_period_ns * 1e-9;
+            est_sum  += t_est;
+            true_sum += t_true;
+            win->edges++;
+            win->period_err_ms = fmaxf(win->period_err_ms, (float)(fabs(t_est - t_true) * 1e3));
+            if (edge_s >= 0.0f) {
+                win->float_err_ms = fmaxf(win->float_err_ms,
+                                          (float)(fabs((double)(now_s - edge_s) - t_est) * 1e3));
+            }
+        }
+        if (e.sector != sector) {
+            if (sector != 0xFF) edge_s = now_s;
+            sector = e.sector;
+        }
+
+        if (e.last_period_ns > 0 && last > 0 && e.last_period_ns != last) {
+            TimeNs_t step = (e.last_period_ns > last) ? e.last_period_ns - last
+                                                      : last - e.last_period_ns;
+            if (win->period_res_ns == 0 || step < win->period_res_ns) win->period_res_ns = step;
+        }
+        if (e.last_period_ns > 0) last = e.last_period_ns;
+    }
+    if (n > 0) {
+        win->rpm_err_mean = (float)(sum / n);
+        win->rpm_err_rms  = (float)sqrt(sum2 / n);
+    }
+    if (est_sum > 0.0) {
+        win->rev_err_pct = (float)(100.0 * (true_sum / est_sum - 1.0));
+    }
+    win->ok = win->ok && n > 0;
+
+    rig_deinit(&r);
+    return true;
+}
+
+// ---------------- main ----------------
+
+static double wall_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void print_usage(const char *argv0)
+{
+    printf("Usage: %s [step|ripple|handover|instances|sharing|alloc|current|loadstep|modulation|sine|angle|sched|autotune|fra|traj|ident|hall|halltiming|uptime|all] [-n trials] [-c config]\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+    const char *which      = "all";
+    const char *cfg_path   = NULL;
+    int         trials     = BENCH_HO_TRIALS;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            trials = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            cfg_path = argv[++i];
+        } else if (argv[i][0] != '-') {
+            which = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (trials < 1) trials = 1;
+
+    MotorConfig_initDefaults();
+    if (cfg_path && MotorConfig_loadFromFile(cfg_path) != 0) {
+        return 1;
+    }
+    if (!MotorConfig_sanityCheck()) {
+        return 1;
+    }
+
+    BldcPlantParams_t p;
+    BldcPlant_defaultParams(&p);
+
+    printf("Plant: Kv=%.0f rpm/V R=%.3f ohm L=%.1f uH pp=%.0f J=%.2e kgm2 Vbus=%.1f V\n",
+           (double)p.kv_rpm_per_v, (double)p.r_phase_ohm, (double)(p.l_phase_h * 1e6f),
+           (double)p.pole_pairs, (double)p.inertia_kgm2, (double)p.vbus_v);
+
+    bool all = (strcmp(which, "all") == 0);
+    bool ran = false;
+    double w0 = wall_s();
+    double sim_s = 0.0;
+
+    if (all || strcmp(which, "step") == 0) {
+        static const char *const names[] = { "", " duty", " duty+ff" };
+        for (int m = STEP_CURRENT; m <= STEP_DUTY_FF; ++m) {
+            float run_s = (m == STEP_CURRENT) ? BENCH_STEP_RUN_S : BENCH_STEP_DUTY_RUN_S;
+            StepResult_t s;
+            if (!bench_step(&p, (StepMode_t)m, BENCH_STEP_RPM, run_s, &s)) {
+                fprintf(stderr, "step: rig init failed\n");
+                return 1;
+            }
+            printf("STEP    0->%.0f rpm%s: run@%.3f s  rise=%.3f s  overshoot=%.1f%%  "
+                   "settle(%.0f%%)=%.3f s  ss_err=%.1f rpm%s\n",
+                   (double)BENCH_STEP_RPM, names[m], (double)s.t_run_s, (double)s.t_rise_s,
+                   (double)s.overshoot_pct, (double)(BENCH_STEP_BAND * 100.0f),
+                   (double)s.t_settle_s, (double)s.ss_err_rpm,
+                   s.faulted ? "  FAULT" : "");
+            sim_s += run_s;
+        }
+        ran = true;
+    }
+
+    if (all || strcmp(which, "ripple") == 0) {
+        RippleResult_t rr;
+        if (!bench_ripple(&p, &rr)) {
+            fprintf(stderr, "ripple: rig init failed\n");
+            return 1;
+        }
+        printf("RIPPLE  %.0f rpm, %.1f mNm: mean=%.1f  std=%.1f  p2p=%.1f rpm (%.2f%%)  "
+               "est_err_rms=%.1f rpm%s\n",
+               (double)BENCH_RIPPLE_RPM, (double)(BENCH_RIPPLE_LOAD_NM * 1e3f),
+               (double)rr.mean_rpm, (double)rr.std_rpm, (double)rr.p2p_rpm,
+               (double)rr.ripple_pct, (double)rr.est_err_rms,
+               rr.faulted ? "  FAULT" : "");
+        sim_s += BENCH_RIPPLE_SETTLE_S + BENCH_RIPPLE_WINDOW_S;
+        ran = true;
+    }
+
+    if (all || strcmp(which, "handover") == 0) {
+        HandoverResult_t hr;
+        if (!bench_handover(&p, trials, &hr)) {
+            fprintf(stderr, "handover: rig init failed\n");
+            return 1;
+        }
+        printf("HANDOVER %.0f rpm: %d/%d handed over (mean %.3f s), "
+               "%d/%d held +/-%.0f%% for %.1f s -> success %.0f%%\n",
+               (double)BENCH_HO_RPM, hr.handed_over, hr.trials, (double)hr.mean_t_ho_s,
+               hr.succeeded, hr.trials, (double)(BENCH_HO_TOL * 100.0f),
+               (double)BENCH_HO_HOLD_S,
+               100.0 * (double)hr.succeeded / (double)hr.trials);
+        sim_s += (double)hr.trials * (BENCH_HO_TIMEOUT_S + BENCH_HO_HOLD_S);
+        ran = true;
+    }
+
+    if (all || strcmp(which, "instances") == 0) {
+        if (!bench_instances(&p, &sim_s)) {
+            fprintf(stderr, "instances: axis init failed\n");
+            return 1;
+        }
+        ran = true;
+    }
+
+    bool failed = false;
+    if (all || strcmp(which, "sharing") == 0) {
+        bool pass = false;
+        if (!bench_sharing(&p, &pass)) {
+            fprintf(stderr, "sharing: axis init failed\n");
+            return 1;
+        }
+        failed |= !pass;
+        sim_s += BENCH_SHARE_RUN_S + BENCH_SHARE_CYCLE_S;
+        ran = true;
+    }
+
+    if (all || strcmp(which, "alloc") == 0) {
+        bool pass;
+        if (!bench_alloc(&p, &pass)) {
+            fprintf(stderr, "alloc: axis init failed\n");
+            return 1;
+        }
+        failed |= !pass;
+        sim_s += BENCH_ALLOC_RUN_S;
+        ran = true;
+    }
+
+    if (all || strcmp(which, "current") == 0) {
+        bool pass;
+        if (!bench_current(&p, &pass)) {
+            fprintf(stderr, "current: rig init failed\n");
+            return 1;
+        }
+        failed |= !pass;
+        sim_s += BENCH_CUR_RUN_S;
+        ran = true;
+    }
+
+    if (all || strcmp(which, "loadstep") == 0) {
+        const float speeds[2] = { BENCH_LS_RPM_LO, BENCH_LS_RPM };
+        for (int v = 0; v < 2; ++v) {
+            for (int m = 0; m < 2; ++m) {
+                float t_off = 0.0f;
+                // The observer runs with the current loop only
+                for (int o = 0; o < 1 + m; ++o) {
+                    LoadStepResult_t ls;
+                    if (!bench_loadstep(&p, speeds[v], m == 1, o == 1, &ls)) {
+                        fprintf(stderr, "loadstep: rig init failed\n");
+                        return 1;
+                    }
+                    printf("LOADSTEP %4.0f rpm, 0->%.1f mNm, %-7s observer %-3s: at %.0f rpm  "
+                           "dip=%.1f rpm  recover(%.0f%%)=%.3f s  std=%.1f rpm  "
+                           "est=%.2f+/-%.2f mNm  peak |i|=%.2f A  chopped %.2f%%%s\n",
+                           (double)speeds[v], (double)(BENCH_LS_LOAD_NM * 1e3f),
+                           (m == 1) ? "current" : "duty", o ? "on" : "off",
+                           (double)ls.rpm_pre, (double)ls.dip_rpm,
+                           (double)(BENCH_LS_BAND * 100.0f), (double)ls.t_recover_s,
+                           (double)ls.rpm_std,
+                           (double)(ls.est_nm * 1e3f), (double)(ls.est_std_nm * 1e3f),
+                           (double)ls.i_peak_a, (double)ls.chop_pct,
+                           ls.faulted ? "  FAULT" : "");
+                    sim_s += BENCH_LS_SETTLE_S + BENCH_LS_HOLD_S;
+                    if (o == 0) {
+                        t_off = ls.t_recover_s;
+                    } else {
+                        bool shorter = !ls.faulted && ls.t_recover_s < t_off;
+                        printf("LOADSTEP %4.0f rpm  observer recovers %.3f s vs %.3f s -> %s\n",
+                               (double)speeds[v], (double)ls.t_recover_s, (double)t_off,
+                               shorter ? "ok" : "FAIL");
+                        failed |= !shorter;
+                    }
+                }
+            }
+        }
+        ran = true;
+    }
+
+    if (all || strcmp(which, "modulation") == 0) {
+        const float loads[2] = { BENCH_MOD_LOAD_LO_NM, BENCH_MOD_LOAD_HI_NM };
+        for (int l = 0; l < 2; ++l) {
+            for (int m = 0; m < PWM_MOD_COUNT; ++m) {
+                ModResult_t mr;
+                if (!bench_modulation(&p, (PwmModulation_t)m, loads[l], &mr)) {
+                    fprintf(stderr, "modulation: rig init failed\n");
+                    return 1;
+                }
+                printf("MOD     %-13s %4.1f mNm: %4.0f rpm  eff=%.1f%%  in=%.2f W  "
+                       "cu=%.3f diode=%.3f sw=%.3f W  float: clamped %.1f%%  "
+                       "err_rms vs Vbus/2=%.2f V, vs midpoint=%.2f V  shoot-through %u%s\n",
+                       PwmPattern_modulationName((PwmModulation_t)m),
+                       (double)(loads[l] * 1e3f), (double)mr.rpm, (double)mr.eff_pct,
+                       (double)mr.p_in_w, (double)mr.p_cu_w, (double)mr.p_diode_w,
+                       (double)mr.p_sw_w, (double)mr.float_clamped_pct,
+                       (double)mr.float_err_rms_v, (double)mr.float_err_mid_rms_v,
+                       mr.shoot_through,
+                       mr.faulted ? "  FAULT" : "");
+                failed |= (mr.shoot_through != 0);
+                sim_s += BENCH_MOD_SETTLE_S + BENCH_MOD_WINDOW_S;
+            }
+        }
+        ran = true;
+    }
+
+    if (all || strcmp(which, "sine") == 0) {
+        for (int s = 0; s < 2; ++s) {
+            BldcPlantParams_t ps = p;
+            ps.bemf_sine = (s == 1);
+            for (int m = MOTOR_COMM_SIX_STEP; m <= MOTOR_COMM_FOC; ++m) {
+                MotorCommutation_t comm = (MotorCommutation_t)m;
+                static const char *const names[] = { "6-step:", "sine:", "FOC:" };
+                SineResult_t sr;
+                if (!bench_sine(&ps, comm, &sr)) {
+                    fprintf(stderr, "sine: rig init failed\n");
+                    return 1;
+                }
+                printf("SINE    %-4s BEMF, %-8s %.0f rpm, %.1f mNm: %.0f rpm (std %.1f)  "
+                       "torque %.2f mNm  ripple std %.1f%% p2p %.1f%% 6th %.1f%%  eff=%.1f%%  "
+                       "angle %.0f%%  step %.0f ns  shoot-through %u%s\n",
+                       ps.bemf_sine ? "sine" : "trap",
+                       names[m],
+                       (double)BENCH_SINE_RPM, (double)(BENCH_SINE_LOAD_NM * 1e3f),
+                       (double)sr.rpm, (double)sr.rpm_std, (double)(sr.torque_nm * 1e3f),
+                       (double)sr.torque_std_pct, (double)sr.torque_p2p_pct,
+                       (double)sr.torque_h6_pct,
+                       (double)sr.eff_pct, (double)sr.angle_pct, (double)sr.step_ns,
+                       sr.shoot_through,
+                       sr.faulted ? "  FAULT" : "");
+                failed |= (sr.shoot_through != 0);
+                sim_s += BENCH_SINE_SETTLE_S + BENCH_SINE_WINDOW_S;
+            }
+        }
+        ran = true;
+    }
+
+    if (all || strcmp(which, "angle") == 0) {
+        AngleResult_t ar;
+        bench_angle(&ar);
+        bool ok = ar.code_err_max < BENCH_ANGLE_MAX_ERR && ar.rad_err_max < BENCH_ANGLE_MAX_ERR;
+        printf("ANGLE   table sin/cos max err: %.2e (all codes), %.2e (float rad in)  -> %s\n",
+               ar.code_err_max, ar.rad_err_max, ok ? "ok" : "FAIL");
+        printf("ANGLE   sin+cos pair: table %.1f ns", ar.lut_ns);
+        if (ar.lut_cycles >= 0.0) printf(" (%.1f cycles)", ar.lut_cycles);
+        printf(", sinf/cosf %.1f ns", ar.libm_ns);
+        if (ar.libm_cycles >= 0.0) printf(" (%.1f cycles)", ar.libm_cycles);
+        printf("\n");
+        failed |= !ok;
+        ran = true;
+    }
+
+    if (all || strcmp(which, "sched") == 0) {
+        for (int v = 1; v <= 2; ++v) {
+            BldcPlantParams_t pv = p;
+            pv.vbus_v = (float)v * p.vbus_v;
+            for (int k = 0; k < BENCH_SCHED_N_RPM; ++k) {
+                for (int s = 0; s <= 1; ++s) {
+                    StepResult_t sr;
+                    if (!bench_sched(&pv, s == 1, s_sched_rpm[k], &sr)) {
+                        fprintf(stderr, "sched: rig init failed\n");
+                        return 1;
+                    }
+                    printf("SCHED   %4.1f V  0->%4.0f rpm %-9s: rise=%.3f s  overshoot=%.1f%%  "
+                           "settle(%.0f%%)=%.3f s  ss_err=%.1f rpm  std=%.1f rpm%s\n",
+                           (double)pv.vbus_v, (double)s_sched_rpm[k],
+                           s ? "scheduled" : "fixed",
+                           (double)sr.t_rise_s, (double)sr.overshoot_pct,
+                           (double)(BENCH_STEP_BAND * 100.0f), (double)sr.t_settle_s,
+                           (double)sr.ss_err_rpm, (double)sr.ss_std_rpm,
+                           sr.faulted ? "  FAULT" : "");
+                    sim_s += BENCH_SCHED_RUN_S;
+                }
+            }
+        }
+        ran = true;
+    }
+
+    if (all || strcmp(which, "autotune") == 0) {
+        for (int c = 0; c <= 1; ++c) {
+            for (int k = -1; k < RELAY_TUNE_RULE_COUNT; ++k) {
+                AutotuneResult_t ar;
+                RelayTuneRule_t rule = (k < 0) ? RELAY_TUNE_ZN : (RelayTuneRule_t)k;
+                if (!bench_autotune(&p, c == 1, k >= 0, rule, &ar)) {
+                    fprintf(stderr, "autotune: rig init failed\n");
+                    return 1;
+                }
+                if (k < 0) {
+                    printf("AUTOTUNE %-7s untuned: ", c ? "current" : "duty");
+                } else {
+                    printf("AUTOTUNE %-7s %s %-7s in %.2f s: Ku=%.4g Pu=%.3f s  kp=%.4g ki=%.4g  ",
+                           c ? "current" : "duty", RelayTuner_ruleName(rule),
+                           RelayTuner_stateName((RelayTuneState_t)ar.state),
+                           (double)ar.tune_s, (double)ar.ku, (double)ar.pu_s,
+                           (double)ar.kp, (double)ar.ki);
+                    if (ar.state == RELAY_TUNE_ABORTED) {
+                        printf("(%s)  ", RelayTuner_abortName((RelayAbort_t)ar.abort));
+                    } else if (ar.state == RELAY_TUNE_DONE) {
+                        bool ok = ar.kept && ar.applied;
+                        printf("%s  ", ok ? "kept until apply ok" : "gains NOT kept until apply");
+                        failed |= !ok;
+                    }
+                }
+                printf("step %.0f->%.0f rpm: overshoot=%.1f%%  settle(%.0f%%)=%.3f s  std=%.1f rpm%s\n",
+                       (double)BENCH_AT_RPM, (double)BENCH_AT_STEP_RPM,
+                       (double)ar.overshoot_pct, (double)(BENCH_STEP_BAND * 100.0f),
+                       (double)ar.t_settle_s, (double)ar.std_rpm,
+                       ar.faulted ? "  FAULT" : "");
+                sim_s += BENCH_AT_SETTLE_S + ar.tune_s + 0.5f + BENCH_AT_STEP_S;
+            }
+        }
+        ran = true;
+    }
+
+    if (all || strcmp(which, "fra") == 0) {
+        for (int c = 0; c <= 1; ++c) {
+            const char *mode = c ? "current" : "duty";
+            FraRunResult_t t, pm, pc;
+            if (!bench_fra(&p, c == 1, MOTOR_FRA_SPEED_REF, FRA_EXC_MULTISINE, &t) ||
+                !bench_fra(&p, c == 1, MOTOR_FRA_OUTPUT,    FRA_EXC_MULTISINE, &pm) ||
+                !bench_fra(&p, c == 1, MOTOR_FRA_OUTPUT,    FRA_EXC_CHIRP,     &pc)) {
+                fprintf(stderr, "fra: rig init failed\n");
+                return 1;
+            }
+            sim_s += 3.0 * BENCH_FRA_RUN_S;
+
+            printf("FRA %-7s at %.0f rpm: T (ref %.0f rpm) %s, P (out %.3g) multisine %s, chirp %s, "
+                   "kp=%.4g ki=%.4g%s\n",
+                   mode, (double)BENCH_FRA_RPM, (double)t.amplitude,
+                   FreqResp_stateName((FraState_t)t.state), (double)pm.amplitude,
+                   FreqResp_stateName((FraState_t)pm.state),
+                   FreqResp_stateName((FraState_t)pc.state),
+                   (double)pm.kp, (double)pm.ki,
+                   (t.faulted || pm.faulted || pc.faulted) ? "  FAULT" : "");
+            if (t.nbins == 0 || pm.nbins != t.nbins || pc.nbins != t.nbins) {
+                failed = true;
+                continue;
+            }
+
+            printf("  %8s  %16s  %16s  %16s  %16s  %16s\n", "f_hz",
+                   "P dB / deg", "P chirp", "T dB / deg", "T from P", "coh P / chirp / T");
+            float t_err_db = 0.0f, t_err_deg = 0.0f, c_err_db = 0.0f, c_err_deg = 0.0f;
+            int   t_used = 0, c_used = 0;
+            for (int i = 0; i < t.nbins; ++i) {
+                const FraBin_t *bt = &t.bin[i], *bp = &pm.bin[i], *bc = &pc.bin[i];
+                float g, ph;
+                fra_predict(bp, pm.kp, pm.ki, &g, &ph);
+                printf("  %8.2f  %7.1f / %6.1f  %7.1f / %6.1f  %7.1f / %6.1f  %7.1f / %6.1f"
+                       "  %4.2f%c %4.2f%c %4.2f%c\n",
+                       (double)bt->f_hz,
+                       (double)fra_db(bp->gain), (double)bp->phase_deg,
+                       (double)fra_db(bc->gain), (double)bc->phase_deg,
+                       (double)fra_db(bt->gain), (double)bt->phase_deg,
+                       (double)fra_db(g), (double)ph,
+                       (double)bp->coherence, bp->ok ? ' ' : '*',
+                       (double)bc->coherence, bc->ok ? ' ' : '*',
+                       (double)bt->coherence, bt->ok ? ' ' : '*');
+
+                if (bt->ok && bp->ok &&
+                    bt->u_amp >= BENCH_FRA_MIN_U_FRAC * t.amplitude &&
+                    bp->u_amp >= BENCH_FRA_MIN_U_FRAC * pm.amplitude) {
+                    t_err_db  = fmaxf(t_err_db,  fabsf(fra_db(bt->gain) - fra_db(g)));
+                    t_err_deg = fmaxf(t_err_deg, fabsf(fra_deg_diff(bt->phase_deg, ph)));
+                    t_used++;
+                }
+                if (bc->ok && bp->ok &&
+                    bc->u_amp >= BENCH_FRA_MIN_U_FRAC * pc.amplitude &&
+                    bp->u_amp >= BENCH_FRA_MIN_U_FRAC * pm.amplitude) {
+                    c_err_db  = fmaxf(c_err_db,  fabsf(fra_db(bc->gain) - fra_db(bp->gain)));
+                    c_err_deg = fmaxf(c_err_deg, fabsf(fra_deg_diff(bc->phase_deg, bp->phase_deg)));
+                    c_used++;
+                }
+            }
+            bool agree = c_err_db <= BENCH_FRA_AGREE_DB && c_err_deg <= BENCH_FRA_AGREE_DEG;
+            printf("  T measured vs from P: max %.2f dB / %.1f deg (%d bins); P chirp vs multisine: "
+                   "max %.2f dB / %.1f deg (%d bins) -> %s\n",
+                   (double)t_err_db, (double)t_err_deg, t_used,
+                   (double)c_err_db, (double)c_err_deg, c_used, agree ? "ok" : "FAIL");
+            failed |= !agree;
+        }
+        ran = true;
+    }
+
+    if (all || strcmp(which, "traj") == 0) {
+        for (int c = 0; c <= 1; ++c) {
+            static const char *names[TRAJ_MODE_COUNT] = {
+                "ramp (old)", "ramp + accel ff", "s-curve + accel ff"
+            };
+            for (int k = 0; k < TRAJ_MODE_COUNT; ++k) {
+                TrajResult_t tr;
+                if (!bench_traj(&p, c == 1, (TrajMode_t)k, &tr)) {
+                    fprintf(stderr, "traj: rig init failed\n");
+                    return 1;
+                }
+                const char *unit = c ? "A" : "duty";
+                printf("TRAJ    %4.0f->%4.0f rpm %-7s %-18s: settle(%.0f%%)=%.3f s  "
+                       "overshoot=%.1f%%  track_rms=%.1f rpm  out peak=%.3f %s  "
+                       "max step=%.3f %s/%.0f ms%s\n",
+                       (double)BENCH_TRAJ_RPM_LO, (double)BENCH_TRAJ_RPM_HI,
+                       c ? "current" : "duty",
+                       names[k],
+                       (double)(BENCH_STEP_BAND * 100.0f), (double)tr.t_settle_s,
+                       (double)tr.overshoot_pct, (double)tr.track_rms_rpm,
+                       (double)tr.out_peak, unit, (double)tr.out_step_max, unit,
+                       (double)(BENCH_TRAJ_WIN_S * 1e3f),
+                       tr.faulted ? "  FAULT" : "");
+                sim_s += BENCH_TRAJ_SETTLE_S + BENCH_TRAJ_STEP_S;
+            }
+        }
+        ran = true;
+    }
+
+    if (all || strcmp(which, "ident") == 0) {
+        IdentResult_t ir;
+        if (!bench_ident(&p, &ir)) {
+            fprintf(stderr, "ident: rig init failed\n");
+            return 1;
+        }
+        const MotorIdentStatus_t *id = &ir.id;
+        printf("IDENT   config x%.1f, test %.0f rpm: %s (%s) in %.2f s, saved+loaded %s, config kept %s\n",
+               (double)BENCH_IDENT_WRONG, (double)IDENT_RPM,
+               ParamIdent_phaseName((ParamIdentPhase_t)id->phase),
+               ParamIdent_abortName((ParamIdentAbort_t)id->abort),
+               (double)ir.t_s, ir.saved ? "ok" : "FAIL", ir.cfg_kept ? "ok" : "FAIL");
+        if (id->phase == PARAM_IDENT_DONE) {
+            printf("  R  %.4f ohm (plant %.4f, %+.1f%%)   L  %.3g H (plant %.3g, %+.1f%%)\n",
+                   (double)id->r_phase_ohm, (double)p.r_phase_ohm,
+                   (double)(100.0f * (id->r_phase_ohm / p.r_phase_ohm - 1.0f)),
+                   (double)id->l_phase_h, (double)p.l_phase_h,
+                   (double)(100.0f * (id->l_phase_h / p.l_phase_h - 1.0f)));
+            printf("  Kv %.1f rpm/V (plant %.1f, %+.1f%%)   J  %.3g kgm2 (plant %.3g, %+.1f%%)\n",
+                   (double)id->kv_rpm_per_v, (double)p.kv_rpm_per_v,
+                   (double)(100.0f * (id->kv_rpm_per_v / p.kv_rpm_per_v - 1.0f)),
+                   (double)id->inertia_kgm2, (double)p.inertia_kgm2,
+                   (double)(100.0f * (id->inertia_kgm2 / p.inertia_kgm2 - 1.0f)));
+            float f_plant = p.coulomb_nm + p.viscous_nm_per_rad_s * IDENT_RPM / RAD_S_TO_RPM;
+            printf("  F  %.3g Nm (plant %.3g, %+.1f%%)\n",
+                   (double)id->friction_nm, (double)f_plant,
+                   (double)(100.0f * (id->friction_nm / f_plant - 1.0f)));
+        }
+        failed |= !ir.cfg_kept;
+        sim_s += (ir.t_s > 0.0f) ? ir.t_s : BENCH_IDENT_MAX_S;
+        ran = true;
+    }
+
+    if (all || strcmp(which, "hall") == 0) {
+        HallResult_t hr;
+        if (!bench_hall(&p, &hr)) {
+            fprintf(stderr, "hall: rig init failed\n");
+            return 1;
+        }
+        const MotorHallLearnStatus_t *hs = &hr.hall;
+        printf("HALL    edges %+.1f deg off: %s (%s) in %.2f s, saved+loaded %s, "
+               "axis decoding %s, config kept %s\n",
+               (double)BENCH_HALL_OFFSET_DEG,
+               HallLearn_stateName((HallLearnState_t)hs->state),
+               HallLearn_failName((HallLearnFail_t)hs->fail),
+               (double)hr.t_s, hr.saved ? "ok" : "FAIL",
+               hr.axis_map ? "ok" : "FAIL", hr.cfg_kept ? "ok" : "FAIL");
+        failed |= !hr.axis_map || !hr.cfg_kept;
+        if (hs->state == HALL_LEARN_DONE) {
+            // The plant's wiring is the default decoding table
+            bool map_ok = true;
+            for (int s = 0; s < 6; s++) {
+                map_ok = map_ok && HallComm_hallToSector(NULL, hs->code[s]) == s;
+            }
+            printf("  codes %d,%d,%d,%d,%d,%d (%s)\n  offsets",
+                   hs->code[0], hs->code[1], hs->code[2],
+                   hs->code[3], hs->code[4], hs->code[5],
+                   map_ok ? "plant wiring" : "WRONG");
+            float worst = 0.0f;
+            for (int s = 0; s < 6; s++) {
+                float e = fabsf(hs->offset_deg[s] - BENCH_HALL_OFFSET_DEG);
+                if (e > worst) worst = e;
+                printf(" %+.2f", (double)hs->offset_deg[s]);
+            }
+            printf(" deg (worst error %.2f deg)\n", (double)worst);
+        }
+        sim_s += (hr.t_s > 0.0f) ? hr.t_s : BENCH_HALL_MAX_S;
+        ran = true;
+    }
+
+    if (all || strcmp(which, "halltiming") == 0) {
+        HallTimingResult_t tr;
+        if (!bench_halltiming(&p, &tr)) {
+            fprintf(stderr, "halltiming: rig init failed\n");
+            return 1;
+        }
+        printf("HALLTIM sensors %+.0f/%+.0f/%+.0f deg, sine %.0f rpm: %u intervals learned, "
+               "width error max %.3f%s\n",
+               (double)s_ht_sensor_err_deg[0], (double)s_ht_sensor_err_deg[1],
+               (double)s_ht_sensor_err_deg[2], (double)BENCH_HT_RPM,
+               tr.learned, (double)tr.width_err_max, tr.faulted ? "  FAULT" : "");
+        for (int c = 0; c < 2; c++) {
+            const HallTimingWin_t *w = c ? &tr.off : &tr.on;
+            printf("  comp %-3s  Hall speed per sector err max %5.2f%%   angle rms %5.2f deg (valid %.0f%%)\n",
+                   c ? "off" : "on", (double)w->rpm_sector_err_pct,
+                   (double)w->angle_rms_deg, (double)w->angle_pct);
+        }
+        sim_s += BENCH_HT_LEARN_S + BENCH_HT_SETTLE_S + 2.0 * BENCH_HT_WINDOW_S;
+        ran = true;
+    }
+
+    if (all || strcmp(which, "uptime") == 0) {
+        for (int k = 0; k < 2; k++) {
+            RigSensor_t sensor = k ? RIG_SENSOR_AUTO : RIG_SENSOR_HALL;
+            UptimeWin_t win[BENCH_UPTIME_STARTS];
+            bool        same = true;
+            for (int i = 0; i < BENCH_UPTIME_STARTS; i++) {
+                if (!bench_uptime_run(&p, sensor, s_uptime_days[i], &win[i])) {
+                    fprintf(stderr, "uptime: rig init failed\n");
+                    return 1;
+                }
+                const UptimeWin_t *w = &win[i];
+                printf("UPTIME  %-4s %.0f rpm, started at %2d days: rpm err mean %+.3f rms %.3f  "
+                       "period resolution %lld ns  %d edges: speed %+.2f%%  period err max %.3f ms "
+                       "(float s %.3f ms)%s\n",
+                       k ? "BEMF" : "Hall", (double)BENCH_UPTIME_RPM, s_uptime_days[i],
+                       (double)w->rpm_err_mean, (double)w->rpm_err_rms,
+                       (long long)w->period_res_ns, w->edges, (double)w->rev_err_pct,
+                       (double)w->period_err_ms, (double)w->float_err_ms,
+                       w->ok ? "" : "  NOT RUNNING");
+                same = same && w->ok &&
+                       fabsf(w->rpm_err_mean - win[0].rpm_err_mean) <= BENCH_UPTIME_TOL_RPM &&
+                       fabsf(w->rpm_err_rms - win[0].rpm_err_rms) <= BENCH_UPTIME_TOL_RPM &&
+                       w->period_res_ns == win[0].period_res_ns;
+                sim_s += BENCH_HO_TIMEOUT_S + BENCH_UPTIME_SETTLE_S + BENCH_UPTIME_WINDOW_S;
+            }
+            bool accurate = true;
+            if (!k) {
+                for (int i = 0; i < BENCH_UPTIME_STARTS; i++) {
+                    accurate = accurate && win[i].edges > 0 &&
+                               fabsf(win[i].rev_err_pct) <= BENCH_UPTIME_SPEED_PCT &&
+                               win[i].period_err_ms <= BENCH_UPTIME_PERIOD_MS;
+                }
+                printf("UPTIME  Hall within %.1f%% / %.2f ms of the plant at every start -> %s\n",
+                       (double)BENCH_UPTIME_SPEED_PCT, (double)BENCH_UPTIME_PERIOD_MS,
+                       accurate ? "PASS" : "FAIL");
+            }
+            printf("UPTIME  %-4s same at every start -> %s\n", k ? "BEMF" : "Hall",
+                   same ? "PASS" : "FAIL");
+            failed |= !same || !accurate;
+        }
+        ran = true;
+    }
+
+    if (!ran) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    double w = wall_s() - w0;
+    printf("Wall time %.2f s (up to %.1f s simulated)\n", w, sim_s);
+    return failed ? 1 : 0;
+}
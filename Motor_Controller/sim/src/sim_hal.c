@@ -0,0 +1,420 @@
+// sim_hal.c
+#include "sim_hal.h"
+#include "clock_source.h"
+#include "motor_config_runtime.h"
+
+#include "adc.h"
+#include "gpio.h"
+#include "hall.h"
+#include "pwm_motor.h"
+#include "pwm_pattern.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// Fake SPI fds handed out by adc_init() (never real descriptors)
+#define SIM_ADC_FD_BASE   1000
+
+// ---------------- Plant selection ----------------
+
+static BldcPlant_t  s_default_plant;
+static bool         s_default_ready = false;
+static BldcPlant_t *s_next_plant    = NULL;
+
+static pthread_mutex_t s_bind_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void SimHal_setPlant(BldcPlant_t *pl)
+{
+    pthread_mutex_lock(&s_bind_lock);
+    s_next_plant = pl;
+    pthread_mutex_unlock(&s_bind_lock);
+}
+
+BldcPlant_t *SimHal_getDefaultPlant(void)
+{
+    pthread_mutex_lock(&s_bind_lock);
+    if (!s_default_ready) {
+        // The app may not have loaded a config yet
+        if (g_motor_cfg.pole_pairs <= 0.0f) {
+            MotorConfig_initDefaults();
+        }
+        BldcPlantParams_t p;
+        BldcPlant_defaultParams(&p);
+        BldcPlant_init(&s_default_plant, &p);
+        s_default_ready = true;
+        printf("SimHal: default plant (Kv=%.0f rpm/V, R=%.3f ohm, L=%.1f uH, "
+               "%d pole pairs, Vbus=%.1f V)\n",
+               (double)p.kv_rpm_per_v, (double)p.r_phase_ohm,
+               (double)(p.l_phase_h * 1e6f), (int)p.pole_pairs, (double)p.vbus_v);
+    }
+    pthread_mutex_unlock(&s_bind_lock);
+    return &s_default_plant;
+}
+
+static BldcPlant_t *plant_for_new_handle(void)
+{
+    BldcPlant_t *pl;
+    pthread_mutex_lock(&s_bind_lock);
+    pl = s_next_plant;
+    pthread_mutex_unlock(&s_bind_lock);
+    return pl ? pl : SimHal_getDefaultPlant();
+}
+
+// ---------------- Handle -> plant bindings ----------------
+// Entries are only appended (under s_bind_lock) and published through
+// s_bind_count, so lookups from the control loops are lock-free.
+
+typedef struct {
+    const void  *key;
+    BldcPlant_t *plant;
+} SimBinding_t;
+
+static SimBinding_t s_bind[SIM_HAL_MAX_BINDINGS];
+static atomic_int   s_bind_count;
+
+static bool bind_handle(const void *key, BldcPlant_t *pl)
+{
+    bool ok = false;
+    pthread_mutex_lock(&s_bind_lock);
+
+    int n = atomic_load_explicit(&s_bind_count, memory_order_relaxed);
+    for (int i = 0; i < n; ++i) {
+        if (s_bind[i].key == key) {
+            s_bind[i].plant = pl;   // re-init of the same handle
+            ok = true;
+            break;
+        }
+    }
+    if (!ok && n < SIM_HAL_MAX_BINDINGS) {
+        s_bind[n].key   = key;
+        s_bind[n].plant = pl;
+        atomic_store_explicit(&s_bind_count, n + 1, memory_order_release);
+        ok = true;
+    }
+
+    pthread_mutex_unlock(&s_bind_lock);
+    if (!ok) {
+        fprintf(stderr, "SimHal: too many handles (max %d)\n", SIM_HAL_MAX_BINDINGS);
+    }
+    return ok;
+}
+
+static BldcPlant_t *lookup(const void *key)
+{
+    int n = atomic_load_explicit(&s_bind_count, memory_order_acquire);
+    for (int i = 0; i < n; ++i) {
+        if (s_bind[i].key == key) {
+            return s_bind[i].plant;
+        }
+    }
+    return NULL;
+}
+
+// ---------------- ADC (MCP3208) ----------------
+
+#define SIM_HAL_MAX_ADC   64
+
+static BldcPlant_t *s_adc[SIM_HAL_MAX_ADC];
+
+int adc_init(const char *device)
+{
+    (void)device;
+
+    pthread_mutex_lock(&s_bind_lock);
+    int slot = -1;
+    for (int i = 0; i < SIM_HAL_MAX_ADC; ++i) {
+        if (!s_adc[i]) {
+            slot = i;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_bind_lock);
+
+    if (slot < 0) {
+        fprintf(stderr, "SimHal: adc_init: no free ADC slots\n");
+        return -1;
+    }
+
+    s_adc[slot] = plant_for_new_handle();
+    return SIM_ADC_FD_BASE + slot;
+}
+
+static BldcPlant_t *adc_plant(int fd)
+{
+    int slot = fd - SIM_ADC_FD_BASE;
+    if (slot < 0 || slot >= SIM_HAL_MAX_ADC) return NULL;
+    return s_adc[slot];
+}
+
+int adc_read_channel(int fd, int channel)
+{
+    if (channel < 0 || channel > 7) {
+        return -1;
+    }
+    BldcPlant_t *pl = adc_plant(fd);
+    if (!pl) return -1;
+    return BldcPlant_readAdc(pl, channel, Clock_nowNs());
+}
+
+int adc_read_channels(int fd, int *out_values, int num_channels)
+{
+    if (!out_values || num_channels < 1 || num_channels > 8) {
+        return -1;
+    }
+    for (int ch = 0; ch < num_channels; ++ch) {
+        out_values[ch] = adc_read_channel(fd, ch);
+        if (out_values[ch] < 0) return -1;
+    }
+    return 0;
+}
+
+void adc_close(int fd)
+{
+    int slot = fd - SIM_ADC_FD_BASE;
+    if (slot < 0 || slot >= SIM_HAL_MAX_ADC) return;
+    s_adc[slot] = NULL;
+}
+
+// ---------------- GPIO (EN_GATE etc.: accepted, no effect) ----------------
+
+static GPIO_Handle s_gpio[GPIO_MAX_HANDLES];
+
+GPIO_Handle *gpio_init(const char *chip_path,
+                       const unsigned int *offsets,
+                       size_t num_lines,
+                       enum gpiod_line_direction direction,
+                       enum gpiod_line_edge edge)
+{
+    (void)chip_path;
+    (void)offsets;
+    (void)direction;
+    (void)edge;
+
+    if (num_lines > GPIO_MAX_LINES) return NULL;
+
+    // Same fixed pool as the real driver: nothing allocates
+    GPIO_Handle *h = NULL;
+    pthread_mutex_lock(&s_bind_lock);
+    for (int i = 0; i < GPIO_MAX_HANDLES; ++i) {
+        if (!s_gpio[i].in_use) {
+            h = &s_gpio[i];
+            memset(h, 0, sizeof(*h));
+            h->in_use    = true;
+            h->num_lines = num_lines;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_bind_lock);
+    return h;
+}
+
+void gpio_close(GPIO_Handle *handle)
+{
+    if (!handle) return;
+    pthread_mutex_lock(&s_bind_lock);
+    handle->in_use = false;
+    pthread_mutex_unlock(&s_bind_lock);
+}
+
+int gpio_read(GPIO_Handle *handle, unsigned int line_index)
+{
+    if (!handle || line_index >= handle->num_lines) return -1;
+    return 0;
+}
+
+int gpio_write(GPIO_Handle *handle, unsigned int line_index, int value)
+{
+    (void)value;
+    if (!handle || line_index >= handle->num_lines) return -1;
+    return 0;
+}
+
+int gpio_read_all(GPIO_Handle *handle, int *values)
+{
+    if (!handle || !values) return -1;
+    memset(values, 0, handle->num_lines * sizeof(*values));
+    return 0;
+}
+
+int gpio_write_all(GPIO_Handle *handle, const int *values)
+{
+    if (!handle || !values) return -1;
+    return 0;
+}
+
+// ---------------- Hall sensors ----------------
+
+bool Hall_init(HallHandle_t *hh,
+               const char *chip_path,
+               unsigned int hall_a_offset,
+               unsigned int hall_b_offset,
+               unsigned int hall_c_offset)
+{
+    (void)chip_path;
+    (void)hall_a_offset;
+    (void)hall_b_offset;
+    (void)hall_c_offset;
+
+    if (!hh) return false;
+    hh->gpio = NULL;
+    return bind_handle(hh, plant_for_new_handle());
+}
+
+uint8_t Hall_readBits(HallHandle_t *hh)
+{
+    BldcPlant_t *pl = lookup(hh);
+    if (!pl) return 0;
+    return BldcPlant_readHall(pl, Clock_nowNs());
+}
+
+int Hall_readChannel(HallHandle_t *hh, HallChannel_t ch)
+{
+    if (ch < HALL_A || ch > HALL_C) return -1;
+    BldcPlant_t *pl = lookup(hh);
+    if (!pl) return -1;
+    return (BldcPlant_readHall(pl, Clock_nowNs()) >> ch) & 1;
+}
+
+void Hall_close(HallHandle_t *hh)
+{
+    if (!hh) return;
+    (void)bind_handle(hh, NULL);
+}
+
+// ---------------- PWM motor driver ----------------
+
+bool PwmMotor_init(PwmMotor_t *m,
+                   const char *pwm_root,
+                   unsigned int inh_a_gpio,
+                   unsigned int inl_a_gpio,
+                   unsigned int inh_b_gpio,
+                   unsigned int inl_b_gpio,
+                   unsigned int inh_c_gpio,
+                   unsigned int inl_c_gpio)
+{
+    (void)inh_a_gpio; (void)inl_a_gpio;
+    (void)inh_b_gpio; (void)inl_b_gpio;
+    (void)inh_c_gpio; (void)inl_c_gpio;
+
+    if (!m || !pwm_root) return false;
+    memset(m, 0, sizeof(*m));
+
+    BldcPlant_t *pl = plant_for_new_handle();
+    if (!bind_handle(m, pl)) return false;
+
+    m->freq_hz   = pl->p.pwm_freq_hz;
+    m->period_ns = (unsigned long long)pl->pwm_period_ns;
+
+    // Same end state as the sysfs driver: configured, duty 0, enabled.
+    // The simulated channels can always be late-aligned.
+    BldcPlant_setGates(pl, NULL, true, Clock_nowNs());
+    m->enabled      = true;
+    m->polarity_ok  = true;
+    m->modulation   = (PwmModulation_t)PWM_MODULATION;
+    m->dead_time_ns = PWM_DEAD_TIME_NS;
+    return true;
+}
+
+void PwmMotor_setEnable(PwmMotor_t *m, bool enable)
+{
+    if (!m) return;
+    m->enabled = enable;
+
+    BldcPlant_t *pl = lookup(m);
+    if (!pl) return;
+
+    // Disabled, or back at duty 0 until the next phase-state command
+    BldcPlant_setGates(pl, NULL, enable, Clock_nowNs());
+}
+
+bool PwmMotor_setModulation(PwmMotor_t *m, PwmModulation_t mod, float dead_time_ns)
+{
+    if (!m || (int)mod < 0 || mod >= PWM_MOD_COUNT) return false;
+    m->modulation   = mod;
+    m->dead_time_ns = (dead_time_ns > 0.0f) ? dead_time_ns : 0.0f;
+    return true;
+}
+
+void PwmMotor_applyPhaseState(PwmMotor_t *m,
+                              int u, int v, int w,
+                              float duty)
+{
+    if (!m) return;
+    BldcPlant_t *pl = lookup(m);
+    if (!pl) return;
+
+    PwmGates_t g;
+    PwmPattern_phaseGates(u, v, w, duty, m->modulation,
+                          m->dead_time_ns / (float)m->period_ns, &g);
+    BldcPlant_setGates(pl, m->enabled ? &g : NULL, m->enabled, Clock_nowNs());
+}
+
+void PwmMotor_setPhaseDuties(PwmMotor_t *m, const float duty[3])
+{
+    if (!m) return;
+    BldcPlant_t *pl = lookup(m);
+    if (!pl) return;
+
+    PwmGates_t g;
+    PwmPattern_halfBridgeGates(duty, m->dead_time_ns / (float)m->period_ns, &g);
+    bool on = m->enabled && m->polarity_ok;
+    BldcPlant_setGates(pl, on ? &g : NULL, on, Clock_nowNs());
+}
+
+void PwmMotor_setSixStep(PwmMotor_t *m,
+                         uint8_t sector,
+                         float duty,
+                         bool forward)
+{
+    if (!m) return;
+    int u = 0, v = 0, w = 0;
+    PwmPattern_sixStepSigns(sector, forward, &u, &v, &w);
+    PwmMotor_applyPhaseState(m, u, v, w, duty);
+}
+
+void PwmMotor_stop(PwmMotor_t *m)
+{
+    if (!m) return;
+    PwmMotor_setEnable(m, false);
+}
+
+void PwmMotor_deinit(PwmMotor_t *m)
+{
+    if (!m) return;
+    PwmMotor_stop(m);
+    (void)bind_handle(m, NULL);
+}
+
+bool PwmMotor_safeStopOpen(PwmMotorSafeStop_t *ss, const PwmMotor_t *m)
+{
+    if (!ss || !m) return false;
+
+    for (int i = 0; i < 6; ++i) {
+        ss->duty_fd[i]     = -1;
+        ss->enable_fd[i]   = -1;
+        ss->polarity_fd[i] = -1;
+    }
+    ss->ready = bind_handle(ss, lookup(m));
+    return ss->ready;
+}
+
+void PwmMotor_safeStop(PwmMotorSafeStop_t *ss)
+{
+    if (!ss || !ss->ready) return;
+    BldcPlant_t *pl = lookup(ss);
+    if (!pl) return;
+
+    BldcPlant_setGates(pl, NULL, false, Clock_nowNs());
+}
+
+void PwmMotor_safeStopClose(PwmMotorSafeStop_t *ss)
+{
+    if (!ss) return;
+    if (ss->ready) {
+        (void)bind_handle(ss, NULL);
+    }
+    ss->ready = false;
+}